@@ -0,0 +1,94 @@
+/**
+ * @file audio_out.c
+ *
+ * Continuous audio output stage
+ */
+#include "audio_out.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#define TASK_STACK_SIZE 3072
+#define STOP_POLL_MS    10
+
+static const char *TAG = "AUDIO_OUT";
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+static void output_task(void *arg)
+{
+    audio_out_t *out = (audio_out_t *)arg;
+
+    while (out->running)
+    {
+        int64_t start = esp_timer_get_time();
+        out->render_cb(out->render_arg, out->block, CONFIG_AUDIO_OUT_BLOCK_LEN);
+        uint32_t render_us = (uint32_t)(esp_timer_get_time() - start);
+        if (render_us > out->render_us)
+            out->render_us = render_us;
+
+        // Blocks while both buffers of the sink are full
+        esp_err_t res = out->sink->write(out->sink, out->block);
+        if (res != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Sink write failed: %d", res);
+            break;
+        }
+        out->blocks++;
+    }
+
+    out->running = false;
+    out->task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t audio_out_start(audio_out_t *out)
+{
+    CHECK_ARG(out && out->sink && out->render_cb && out->sample_rate);
+    if (out->task)
+        return ESP_ERR_INVALID_STATE;
+
+    CHECK(out->sink->start(out->sink, out->sample_rate, CONFIG_AUDIO_OUT_BLOCK_LEN));
+
+    out->blocks = 0;
+    out->render_us = 0;
+    out->running = true;
+    if (xTaskCreatePinnedToCore(output_task, "audio", TASK_STACK_SIZE, out, CONFIG_AUDIO_OUT_TASK_PRIORITY,
+                                &out->task, CONFIG_AUDIO_OUT_TASK_CORE) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create the output task");
+        out->running = false;
+        out->task = NULL;
+        out->sink->stop(out->sink);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Started, %u Hz, blocks of %d samples on core %d", (unsigned)out->sample_rate,
+             CONFIG_AUDIO_OUT_BLOCK_LEN, CONFIG_AUDIO_OUT_TASK_CORE);
+    return ESP_OK;
+}
+
+esp_err_t audio_out_stop(audio_out_t *out)
+{
+    CHECK_ARG(out);
+    if (!out->task)
+        return ESP_ERR_INVALID_STATE;
+
+    // The task finishes the block it's writing, at most two block periods
+    out->running = false;
+    while (out->task)
+        vTaskDelay(STOP_POLL_MS / portTICK_PERIOD_MS);
+
+    out->sink->stop(out->sink);
+
+    ESP_LOGI(TAG, "Stopped");
+    return ESP_OK;
+}
+
+void audio_out_get_stats(audio_out_t *out, audio_out_stats_t *stats)
+{
+    stats->blocks = out->blocks;
+    stats->underruns = out->sink->underruns;
+    stats->render_us = out->render_us;
+    stats->latency_us = out->sink->latency_us;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file audio_out.h
+ * @defgroup audio_out audio_out
+ * @{
+ *
+ * Continuous audio output stage
+ *
+ * A task pinned to CONFIG_AUDIO_OUT_TASK_CORE renders blocks of
+ * CONFIG_AUDIO_OUT_BLOCK_LEN samples with a callback, e.g. dds_render(),
+ * and hands them to a sink. The sink plays out of two buffers: one is being
+ * played while the other waits with the next block, and write() blocks
+ * until the playing one is done. The task only wakes up once per block.
+ *
+ * A sink which finds no block ready when the playing one ends plays silence
+ * and counts an underrun. On the target the sink is the DAC fed by I2S DMA,
+ * see audio_sink_i2s_init(); anything else which plays blocks in real time,
+ * like the WAV file sink of the host simulator, can stand in for it.
+ */
+#ifndef __AUDIO_OUT_H__
+#define __AUDIO_OUT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct audio_sink;
+
+/**
+ * Sink of the rendered blocks
+ */
+typedef struct audio_sink
+{
+    /**
+     * Get ready to play blocks of `block_len` samples, clear the counters.
+     * Playing starts with the first block.
+     */
+    esp_err_t (*start)(struct audio_sink *sink, uint32_t sample_rate, size_t block_len);
+    /**
+     * Queue the next block, wait for a free buffer first. The samples are copied.
+     */
+    esp_err_t (*write)(struct audio_sink *sink, const int16_t *block);
+    /**
+     * Stop playing, no write() is in progress
+     */
+    void (*stop)(struct audio_sink *sink);
+    void *ctx;                      //!< Free for the sink
+    volatile uint32_t underruns;    //!< Blocks of silence played because no block was ready, counted by the sink
+    volatile uint32_t latency_us;   //!< Longest time from write() to the start of the block, measured by the sink
+} audio_sink_t;
+
+/**
+ * Fill the next block
+ * @param arg `render_arg` of the output stage
+ * @param buf Samples, full scale is +-32767
+ * @param n Number of samples
+ */
+typedef void (*audio_out_render_cb_t)(void *arg, int16_t *buf, size_t n);
+
+/**
+ * Output stage descriptor
+ */
+typedef struct
+{
+    audio_sink_t *sink;                 //!< Where the blocks go
+    audio_out_render_cb_t render_cb;    //!< Called from the output task for every block
+    void *render_arg;                   //!< Argument of render_cb
+    uint32_t sample_rate;               //!< Samples per second
+    TaskHandle_t task;
+    volatile bool running;
+    int16_t block[CONFIG_AUDIO_OUT_BLOCK_LEN];
+    volatile uint32_t blocks;           //!< Blocks written to the sink
+    volatile uint32_t render_us;        //!< Longest render_cb call
+} audio_out_t;
+
+/**
+ * Output statistics
+ */
+typedef struct
+{
+    uint32_t blocks;                    //!< Blocks written to the sink
+    uint32_t underruns;                 //!< Blocks of silence played by the sink
+    uint32_t render_us;                 //!< Longest render_cb call
+    uint32_t latency_us;                //!< Longest time a block waited in the sink before it played
+} audio_out_stats_t;
+
+/**
+ * Start the sink and the output task.
+ * `sink`, `render_cb`, `render_arg` and `sample_rate` must be set, the rest is initialized here.
+ * @param out Output stage descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t audio_out_start(audio_out_t *out);
+
+/**
+ * Stop the output task after the block being written, then the sink
+ * @param out Output stage descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t audio_out_stop(audio_out_t *out);
+
+/**
+ * Get the statistics of an output stage since it was started
+ * @param out Output stage descriptor
+ * @param stats Statistics
+ */
+void audio_out_get_stats(audio_out_t *out, audio_out_stats_t *stats);
+
+/**
+ * Set up a sink playing through the built-in DAC, fed by I2S DMA
+ * (see CONFIG_AUDIO_OUT_DAC_CHANNEL_*)
+ * @param sink Sink descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t audio_sink_i2s_init(audio_sink_t *sink);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __AUDIO_OUT_H__ */
@@ -0,0 +1,160 @@
+/**
+ * @file audio_sink_i2s.c
+ *
+ * Audio sink playing through the built-in DAC of the ESP32, fed by I2S DMA
+ *
+ * The I2S driver gets two DMA buffers of one block each: the DMA plays one
+ * while i2s_write() fills the other, and blocks while both are full. A
+ * buffer done raises I2S_EVENT_TX_DONE. With more buffers done than written
+ * the DMA ran dry and played one of them again, cleared to silence by
+ * tx_desc_auto_clear: an underrun.
+ */
+#include "audio_out.h"
+#include <esp_log.h>
+#include <driver/i2s.h>
+#include <freertos/queue.h>
+#include <stdlib.h>
+
+#define I2S_PORT        I2S_NUM_0
+#define DMA_BUF_COUNT   2
+#define EVENT_QUEUE_LEN 8
+
+#if CONFIG_AUDIO_OUT_DAC_CHANNEL_LEFT
+    #define DAC_MODE I2S_DAC_CHANNEL_LEFT_EN
+#elif CONFIG_AUDIO_OUT_DAC_CHANNEL_BOTH
+    #define DAC_MODE I2S_DAC_CHANNEL_BOTH_EN
+#else
+    #define DAC_MODE I2S_DAC_CHANNEL_RIGHT_EN
+#endif
+
+static const char *TAG = "AUDIO_I2S";
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+typedef struct
+{
+    QueueHandle_t events;
+    uint16_t *frames;       // One block as left/right pairs of unsigned DAC samples
+    size_t block_len;
+    uint32_t block_us;
+    uint32_t written;       // Blocks written since the start
+    uint32_t done;          // DMA buffers played since the first write
+} i2s_sink_t;
+
+static i2s_sink_t i2s_sink;
+
+static esp_err_t i2s_sink_start(audio_sink_t *sink, uint32_t sample_rate, size_t block_len)
+{
+    i2s_sink_t *s = (i2s_sink_t *)sink->ctx;
+
+    s->frames = malloc(block_len * 2 * sizeof(uint16_t));
+    if (!s->frames)
+        return ESP_ERR_NO_MEM;
+
+    const i2s_config_t config = {
+        .mode = I2S_MODE_MASTER | I2S_MODE_TX | I2S_MODE_DAC_BUILT_IN,
+        .sample_rate = sample_rate,
+        .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+        .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
+        .communication_format = I2S_COMM_FORMAT_I2S_MSB,
+        .intr_alloc_flags = 0,
+        .dma_buf_count = DMA_BUF_COUNT,
+        .dma_buf_len = block_len,
+        .use_apll = false,
+        .tx_desc_auto_clear = true,
+    };
+    esp_err_t res = i2s_driver_install(I2S_PORT, &config, EVENT_QUEUE_LEN, &s->events);
+    if (res == ESP_OK)
+        res = i2s_set_dac_mode(DAC_MODE);
+    if (res != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to set up I2S: %d", res);
+        i2s_driver_uninstall(I2S_PORT);
+        free(s->frames);
+        s->frames = NULL;
+        return res;
+    }
+    // Silence until the first block, the DAC sits at mid scale
+    i2s_zero_dma_buffer(I2S_PORT);
+
+    s->block_len = block_len;
+    s->block_us = (uint32_t)((uint64_t)block_len * 1000000 / sample_rate);
+    s->written = 0;
+    s->done = 0;
+    sink->underruns = 0;
+    sink->latency_us = 0;
+
+    return ESP_OK;
+}
+
+static esp_err_t i2s_sink_write(audio_sink_t *sink, const int16_t *block)
+{
+    i2s_sink_t *s = (i2s_sink_t *)sink->ctx;
+
+    // The DAC takes the upper byte of each 16-bit sample, as unsigned
+    for (size_t i = 0; i < s->block_len; i++)
+    {
+        uint16_t sample = (uint16_t)block[i] ^ 0x8000;
+        s->frames[2 * i] = sample;
+        s->frames[2 * i + 1] = sample;
+    }
+
+    size_t bytes;
+    CHECK(i2s_write(I2S_PORT, s->frames, s->block_len * 2 * sizeof(uint16_t), &bytes, portMAX_DELAY));
+
+    i2s_event_t ev;
+    if (s->written == 0)
+    {
+        // The DMA played silence until now: that's not an underrun
+        xQueueReset(s->events);
+    }
+    else
+    {
+        while (xQueueReceive(s->events, &ev, 0) == pdTRUE)
+            if (ev.type == I2S_EVENT_TX_DONE)
+                s->done++;
+    }
+    s->written++;
+
+    if (s->done + DMA_BUF_COUNT < s->written)
+    {
+        // Can't happen with a blocking write, the events were lost
+        s->done = s->written - DMA_BUF_COUNT;
+    }
+    if (s->done > s->written)
+    {
+        sink->underruns += s->done - s->written;
+        s->done = s->written;
+    }
+
+    // The block plays after the ones still queued in front of it
+    uint32_t latency = (s->written - s->done - 1) * s->block_us;
+    if (latency > sink->latency_us)
+        sink->latency_us = latency;
+
+    return ESP_OK;
+}
+
+static void i2s_sink_stop(audio_sink_t *sink)
+{
+    i2s_sink_t *s = (i2s_sink_t *)sink->ctx;
+
+    i2s_driver_uninstall(I2S_PORT);
+    free(s->frames);
+    s->frames = NULL;
+}
+
+esp_err_t audio_sink_i2s_init(audio_sink_t *sink)
+{
+    CHECK_ARG(sink);
+
+    sink->start = i2s_sink_start;
+    sink->write = i2s_sink_write;
+    sink->stop = i2s_sink_stop;
+    sink->ctx = &i2s_sink;
+    sink->underruns = 0;
+    sink->latency_us = 0;
+
+    return ESP_OK;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file awg.c
+ *
+ * Arbitrary waveforms of the user, loaded from files through lv_fs
+ */
+#include "awg.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+#include "lvgl/lvgl.h"
+
+static const char *TAG = "AWG";
+
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+// Reads `fn` of `dir` into `samples`, CONFIG_AWG_MAX_SAMPLES long, and resamples it into `wave`
+static esp_err_t load_wave(awg_wave_t *wave, const char *dir, const char *fn, int16_t *samples)
+{
+    char path[LV_FS_MAX_PATH_LENGTH];
+    if (snprintf(path, sizeof(path), "%s/%s", dir, fn) >= (int)sizeof(path))
+        return ESP_ERR_INVALID_ARG;
+
+    lv_fs_file_t file;
+    if (lv_fs_open(&file, path, LV_FS_MODE_RD) != LV_FS_RES_OK)
+    {
+        ESP_LOGW(TAG, "Can't open %s", path);
+        return ESP_FAIL;
+    }
+
+    uint32_t size = 0, len = 0;
+    esp_err_t res = ESP_OK;
+    if (lv_fs_size(&file, &size) != LV_FS_RES_OK || size % 2 || size < 2 * 2 || size > CONFIG_AWG_MAX_SAMPLES * 2)
+    {
+        ESP_LOGW(TAG, "%s: %u bytes, not 2 to %d samples", path, (unsigned int)size, CONFIG_AWG_MAX_SAMPLES);
+        res = ESP_ERR_INVALID_SIZE;
+    }
+    else if (lv_fs_read(&file, samples, size, &len) != LV_FS_RES_OK || len != size)
+    {
+        ESP_LOGW(TAG, "%s: read failed", path);
+        res = ESP_FAIL;
+    }
+    lv_fs_close(&file);
+    if (res != ESP_OK)
+        return res;
+
+    // Little-endian in the file, whatever the CPU
+    size_t n = size / 2;
+    for (size_t i = 0; i < n; i++)
+    {
+        const uint8_t *b = (const uint8_t *)&samples[i];
+        samples[i] = (int16_t)(b[0] | b[1] << 8);
+    }
+
+    size_t name_len = strcspn(fn, ".");
+    if (name_len >= AWG_NAME_LEN)
+        name_len = AWG_NAME_LEN - 1;
+    memcpy(wave->name, fn, name_len);
+    wave->name[name_len] = '\0';
+
+    return dds_table_resample(wave->table, samples, n);
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(((const awg_wave_t *)a)->name, ((const awg_wave_t *)b)->name);
+}
+
+esp_err_t awg_bank_load(awg_bank_t *bank, const char *dir)
+{
+    CHECK_ARG(bank && dir);
+
+    bank->waves = NULL;
+    bank->count = 0;
+
+    lv_fs_dir_t rddir;
+    if (lv_fs_dir_open(&rddir, dir) != LV_FS_RES_OK)
+    {
+        ESP_LOGW(TAG, "No waveform directory %s", dir);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // Room for all of them, shrunk to what was loaded at the end
+    awg_wave_t *waves = malloc(CONFIG_AWG_MAX_WAVES * sizeof(awg_wave_t));
+    int16_t *samples = malloc(CONFIG_AWG_MAX_SAMPLES * sizeof(int16_t));
+    if (!waves || !samples)
+    {
+        free(waves);
+        free(samples);
+        lv_fs_dir_close(&rddir);
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t count = 0;
+    char fn[LV_FS_MAX_FN_LENGTH];
+    while (lv_fs_dir_read(&rddir, fn) == LV_FS_RES_OK && fn[0])
+    {
+        // Directories start with '/'
+        if (fn[0] == '/' || strcmp(lv_fs_get_ext(fn), AWG_FILE_EXT) != 0)
+            continue;
+
+        if (count == CONFIG_AWG_MAX_WAVES)
+        {
+            ESP_LOGW(TAG, "More than %d waveforms in %s, %s and the next ones skipped", CONFIG_AWG_MAX_WAVES, dir, fn);
+            break;
+        }
+
+        if (load_wave(&waves[count], dir, fn, samples) == ESP_OK)
+            count++;
+    }
+    lv_fs_dir_close(&rddir);
+    free(samples);
+
+    if (count == 0)
+    {
+        free(waves);
+        ESP_LOGI(TAG, "No waveform in %s", dir);
+        return ESP_OK;
+    }
+
+    qsort(waves, count, sizeof(awg_wave_t), compare_names);
+    awg_wave_t *shrunk = realloc(waves, count * sizeof(awg_wave_t));
+    bank->waves = shrunk ? shrunk : waves;
+    bank->count = count;
+
+    ESP_LOGI(TAG, "%u waveforms from %s, %u bytes", (unsigned int)count, dir, (unsigned int)(count * sizeof(awg_wave_t)));
+
+    return ESP_OK;
+}
+
+void awg_bank_free(awg_bank_t *bank)
+{
+    if (!bank)
+        return;
+
+    free(bank->waves);
+    bank->waves = NULL;
+    bank->count = 0;
+}
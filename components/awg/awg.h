@@ -0,0 +1,72 @@
+/**
+ * @file awg.h
+ * @defgroup awg awg
+ * @{
+ *
+ * Arbitrary waveforms of the user, loaded from files through lv_fs
+ *
+ * A waveform file holds one period of signed 16-bit little-endian samples,
+ * 2 to CONFIG_AWG_MAX_SAMPLES of them, full scale is +-32767. Its name,
+ * without the extension, names the waveform.
+ *
+ * The files of a directory are read once, by awg_bank_load(), resampled to
+ * DDS_TABLE_SIZE samples and kept in one block of RAM: the tables are ready
+ * for dds_set_table(), switching between them doesn't touch the files. The
+ * waveforms are sorted by name.
+ */
+#ifndef __AWG_H__
+#define __AWG_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_err.h>
+#include "dds.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AWG_FILE_EXT    "bin"   //!< Extension of the waveform files, the others are skipped
+#define AWG_NAME_LEN    12      //!< Longest name, with its terminating zero
+
+/**
+ * Waveform
+ */
+typedef struct
+{
+    char name[AWG_NAME_LEN];            //!< File name without the extension, truncated
+    int16_t table[DDS_TABLE_SIZE + 1];  //!< For dds_set_table()
+} awg_wave_t;
+
+/**
+ * Loaded waveforms
+ */
+typedef struct
+{
+    awg_wave_t *waves;      //!< Sorted by name
+    size_t count;
+} awg_bank_t;
+
+/**
+ * Load the waveform files of a directory. The files which can't be read or
+ * have a wrong size are skipped with a warning.
+ * @param bank Bank, empty or freed
+ * @param dir lv_fs path of the directory, e.g. "S:awg"
+ * @return `ESP_OK` on success, even with no waveform, `ESP_ERR_NOT_FOUND`
+ *         if the directory can't be opened
+ */
+esp_err_t awg_bank_load(awg_bank_t *bank, const char *dir);
+
+/**
+ * Free the waveforms of a bank. None of their tables may be in use.
+ * @param bank Bank
+ */
+void awg_bank_free(awg_bank_t *bank);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __AWG_H__ */
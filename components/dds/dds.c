@@ -0,0 +1,462 @@
+/**
+ * @file dds.c
+ *
+ * Direct digital synthesis of the Waveman waveforms
+ */
+#include "dds.h"
+#include "dds_minblep.h"
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <math.h>
+#include <stdbool.h>
+
+#define PHASE_SHIFT (32 - CONFIG_DDS_TABLE_BITS)    // Phase to table index
+#define FRAC_SHIFT  (PHASE_SHIFT - 15)              // Phase to Q15 interpolation weight
+#define FULL_SCALE  32767
+
+// Phases of the edges and corners, a full period being 2^32
+#define PHASE_QUARTER       0x40000000u
+#define PHASE_HALF          0x80000000u
+#define PHASE_3_QUARTERS    0xc0000000u
+
+// The ringing of the minimum phase step overshoots the level by 37 %: the minBLEP
+// square is rendered 3 dB lower rather than clipped, clipping brings the aliasing back
+#define MINBLEP_SQUARE_LEVEL    (FULL_SCALE * 23 / 32)
+
+#ifdef CONFIG_DDS_QUALITY_NAIVE
+    #define DEFAULT_QUALITY DDS_QUALITY_NAIVE
+#elif defined(CONFIG_DDS_QUALITY_MINBLEP)
+    #define DEFAULT_QUALITY DDS_QUALITY_MINBLEP
+#else
+    #define DEFAULT_QUALITY DDS_QUALITY_POLYBLEP
+#endif
+
+static const char *TAG = "DDS";
+
+// One extra sample, a copy of the first one, saves wrapping the index when interpolating
+static int16_t tables[DDS_WAVE_MAX][DDS_TABLE_SIZE + 1];
+static bool tables_ready = false;
+
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+static void fill_tables(void)
+{
+    for (size_t i = 0; i < DDS_TABLE_SIZE; i++)
+    {
+        // Triangle: 0 -> +1 in the first quarter, +1 -> -1 in the middle half, -1 -> 0 in the last quarter
+        int32_t tri = (int32_t)(4 * (int64_t)FULL_SCALE * i / DDS_TABLE_SIZE);
+        if (i < DDS_TABLE_SIZE / 4)
+            ;
+        else if (i < DDS_TABLE_SIZE * 3 / 4)
+            tri = 2 * FULL_SCALE - tri;
+        else
+            tri -= 4 * FULL_SCALE;
+
+        tables[DDS_WAVE_SINE][i] = (int16_t)lround(FULL_SCALE * sin(2 * M_PI * i / DDS_TABLE_SIZE));
+        tables[DDS_WAVE_TRIANGLE][i] = (int16_t)tri;
+        tables[DDS_WAVE_SQUARE][i] = i < DDS_TABLE_SIZE / 2 ? FULL_SCALE : -FULL_SCALE;
+    }
+
+    for (size_t w = 0; w < DDS_WAVE_MAX; w++)
+        tables[w][DDS_TABLE_SIZE] = tables[w][0];
+
+    tables_ready = true;
+}
+
+esp_err_t dds_init(dds_t *dds, uint32_t sample_rate)
+{
+    CHECK_ARG(dds && sample_rate);
+
+    if (!tables_ready)
+    {
+        fill_tables();
+        ESP_LOGI(TAG, "Wavetables of %d samples ready", DDS_TABLE_SIZE);
+    }
+
+    dds->sample_rate = sample_rate;
+    dds->phase = 0;
+    dds->phase_inc = 0;
+    dds->phase_inc_step = 0;
+    dds->sweep.mode = DDS_SWEEP_OFF;
+    dds->wave = DDS_WAVE_SINE;
+    dds->table = tables[DDS_WAVE_SINE];
+    dds->quality = DDS_QUALITY_NAIVE;
+
+    return dds_set_quality(dds, DEFAULT_QUALITY);
+}
+
+static uint32_t freq_to_inc(const dds_t *dds, uint32_t freq_hz)
+{
+    if (freq_hz >= dds->sample_rate / 2)
+        freq_hz = (dds->sample_rate - 1) / 2;
+
+    return (uint32_t)(((uint64_t)freq_hz << 32) / dds->sample_rate);
+}
+
+esp_err_t dds_set_frequency(dds_t *dds, uint32_t freq_hz)
+{
+    CHECK_ARG(dds && dds->sample_rate);
+
+    dds->phase_inc = freq_to_inc(dds, freq_hz);
+    dds->sweep.mode = DDS_SWEEP_OFF;
+
+    return ESP_OK;
+}
+
+esp_err_t dds_set_sweep(dds_t *dds, dds_sweep_mode_t mode, uint32_t start_hz, uint32_t stop_hz, uint32_t duration_ms)
+{
+    CHECK_ARG(dds && dds->sample_rate && mode < DDS_SWEEP_MAX);
+    CHECK_ARG(mode != DDS_SWEEP_LOG || (start_hz && stop_hz));
+
+    uint32_t len = (uint32_t)((uint64_t)duration_ms * dds->sample_rate / 1000);
+    if (mode == DDS_SWEEP_OFF || len == 0)
+        return dds_set_frequency(dds, start_hz);
+
+    dds_sweep_t *sweep = &dds->sweep;
+    sweep->mode = mode;
+    sweep->start_inc = freq_to_inc(dds, start_hz);
+    sweep->stop_inc = freq_to_inc(dds, stop_hz);
+    sweep->len = len;
+    sweep->pos = 0;
+    sweep->log_rate = logf((float)sweep->stop_inc / sweep->start_inc) / len;
+    dds->phase_inc = sweep->start_inc;
+
+    return ESP_OK;
+}
+
+// Phase step `pos` samples after the start of the sweep
+static uint32_t sweep_inc(const dds_sweep_t *sweep, uint32_t pos)
+{
+    if (pos >= sweep->len)
+        return sweep->stop_inc;
+
+    if (sweep->mode == DDS_SWEEP_LINEAR)
+        return sweep->start_inc + (int32_t)(((int64_t)sweep->stop_inc - sweep->start_inc) * pos / sweep->len);
+
+    // From the start every time, no error piles up. Single precision is
+    // within 1e-7 of the frequency and the FPU of the ESP32 has it.
+    return (uint32_t)lroundf(sweep->start_inc * expf(sweep->log_rate * pos));
+}
+
+float dds_get_frequency(const dds_t *dds)
+{
+    return (float)dds->phase_inc * dds->sample_rate / 4294967296.0f;
+}
+
+esp_err_t dds_set_waveform(dds_t *dds, dds_wave_t wave)
+{
+    CHECK_ARG(dds && wave < DDS_WAVE_MAX);
+
+    dds->wave = wave;
+    dds->table = tables[wave];
+
+    return ESP_OK;
+}
+
+esp_err_t dds_set_table(dds_t *dds, const int16_t *table)
+{
+    CHECK_ARG(dds && table);
+
+    // Never band-limited, render_segment() looks it up
+    dds->wave = DDS_WAVE_CUSTOM;
+    dds->table = table;
+
+    return ESP_OK;
+}
+
+esp_err_t dds_table_resample(int16_t *table, const int16_t *src, size_t n)
+{
+    CHECK_ARG(table && src && n >= 2);
+
+    for (size_t i = 0; i < DDS_TABLE_SIZE; i++)
+    {
+        if (n > DDS_TABLE_SIZE)
+        {
+            // Mean of the source samples within half an entry of the entry, wrapping around:
+            // k from ceil((i - 1/2) * n / size) to before ceil((i + 1/2) * n / size). All signed,
+            // the window of entry 0 starts before the source: it's taken a period later.
+            int64_t len = (int64_t)n;
+            int64_t first = ((int64_t)(2 * i + 2 * DDS_TABLE_SIZE - 1) * len + 2 * DDS_TABLE_SIZE - 1) /
+                            (2 * DDS_TABLE_SIZE) - len;
+            int64_t last = ((int64_t)(2 * i + 1) * len + 2 * DDS_TABLE_SIZE - 1) / (2 * DDS_TABLE_SIZE);
+            if (last <= first)
+                last = first + 1;
+            int64_t sum = 0;
+            for (int64_t k = first; k < last; k++)
+                sum += src[(k + len) % len];
+            table[i] = (int16_t)(sum / (last - first));
+        }
+        else
+        {
+            // Source position in Q16, between src[k] and the next one
+            uint64_t pos = ((uint64_t)i * n << 16) / DDS_TABLE_SIZE;
+            size_t k = pos >> 16;
+            int32_t frac = pos & 0xffff;
+            int32_t a = src[k];
+            int32_t b = src[(k + 1) % n];
+            table[i] = (int16_t)(a + (int32_t)(((int64_t)(b - a) * frac) >> 16));
+        }
+    }
+    table[DDS_TABLE_SIZE] = table[0];
+
+    return ESP_OK;
+}
+
+esp_err_t dds_set_quality(dds_t *dds, dds_quality_t quality)
+{
+    CHECK_ARG(dds && quality < DDS_QUALITY_MAX);
+
+    if (quality == DDS_QUALITY_MINBLEP)
+    {
+        esp_err_t res = dds_minblep_build();
+        if (res != ESP_OK)
+            return res;
+    }
+
+    for (size_t i = 0; i < DDS_BLEP_LEN; i++)
+        dds->blep[i] = 0;
+    dds->blep_pos = 0;
+    dds->quality = quality;
+
+    return ESP_OK;
+}
+
+static inline int16_t clamp16(int32_t v)
+{
+    return v > INT16_MAX ? INT16_MAX : v < -INT16_MAX ? -INT16_MAX : (int16_t)v;
+}
+
+static inline int32_t naive_square(uint32_t phase, int32_t level)
+{
+    return phase < PHASE_HALF ? level : -level;
+}
+
+static inline int32_t naive_triangle(uint32_t phase)
+{
+    int32_t v = (int32_t)(((uint64_t)phase * 4 * FULL_SCALE) >> 32);
+    if (phase < PHASE_QUARTER)
+        return v;
+    if (phase < PHASE_3_QUARTERS)
+        return 2 * FULL_SCALE - v;
+    return v - 4 * FULL_SCALE;
+}
+
+// Slope change of the triangle at a corner, FULL_SCALE per sample, Q15
+static inline int64_t corner_slope(uint32_t inc)
+{
+    return ((int64_t)8 * FULL_SCALE * inc) >> 17;
+}
+
+// PolyBLEP residual of a rising edge of 2 * FULL_SCALE at phase 0, non-zero
+// in the sample on each side of it
+static inline int32_t polyblep(uint32_t t, uint32_t dt)
+{
+    if (t < dt)
+    {
+        int32_t x = 32768 - (int32_t)(((uint64_t)t << 15) / dt);        // 1 - time since the edge
+        return -(((x * x) >> 15) * FULL_SCALE >> 15);
+    }
+    if (0 - t < dt)
+    {
+        int32_t x = 32768 - (int32_t)(((uint64_t)(0 - t) << 15) / dt);  // 1 - time to the edge
+        return ((x * x) >> 15) * FULL_SCALE >> 15;
+    }
+    return 0;
+}
+
+// PolyBLAMP residual, the integral of the PolyBLEP one, of a corner at phase 0
+// where the slope goes up by `corner_slope(dt)`
+static inline int32_t polyblamp(uint32_t t, uint32_t dt)
+{
+    uint32_t dist = t < dt ? t : 0 - t;
+    if (dist >= dt)
+        return 0;
+
+    int64_t x = 32768 - (int64_t)(((uint64_t)dist << 15) / dt);        // 1 - distance to the corner
+    int64_t x3 = (x * x * x) >> 30;
+    return (int32_t)((corner_slope(dt) * x3 / 6) >> 30);
+}
+
+// Spread the residual `table` of an edge `t / dt` samples ago, scaled by `h` (Q15), over the next samples
+static inline void minblep_add(dds_t *dds, const int32_t *table, uint32_t t, uint32_t dt, int64_t h)
+{
+    uint32_t since = (uint32_t)(((uint64_t)t << 15) / dt) * DDS_MINBLEP_OVERSAMPLING;
+
+    for (size_t k = 0; k < DDS_BLEP_LEN; k++)
+    {
+        uint32_t pos = (k * DDS_MINBLEP_OVERSAMPLING << 15) + since;
+        uint32_t i = pos >> 15;
+        int32_t frac = pos & 0x7fff;
+        int32_t r = table[i] + (int32_t)(((int64_t)(table[i + 1] - table[i]) * frac) >> 15);
+        dds->blep[(dds->blep_pos + k) % DDS_BLEP_LEN] += (int32_t)((h * r) >> 30);
+    }
+}
+
+static inline int32_t minblep_next(dds_t *dds)
+{
+    int32_t v = dds->blep[dds->blep_pos];
+    dds->blep[dds->blep_pos] = 0;
+    dds->blep_pos = (dds->blep_pos + 1) % DDS_BLEP_LEN;
+    return v;
+}
+
+static void IRAM_ATTR render_square_polyblep(dds_t *dds, int16_t *buf, size_t n)
+{
+    uint32_t phase = dds->phase;
+    uint32_t inc = dds->phase_inc;
+    int32_t step = dds->phase_inc_step;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        int32_t v = naive_square(phase, FULL_SCALE) + polyblep(phase, inc) - polyblep(phase - PHASE_HALF, inc);
+        buf[i] = clamp16(v);
+        phase += inc;
+        inc += step;
+    }
+
+    dds->phase = phase;
+}
+
+static void IRAM_ATTR render_triangle_polyblep(dds_t *dds, int16_t *buf, size_t n)
+{
+    uint32_t phase = dds->phase;
+    uint32_t inc = dds->phase_inc;
+    int32_t step = dds->phase_inc_step;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        int32_t v = naive_triangle(phase) - polyblamp(phase - PHASE_QUARTER, inc) +
+                    polyblamp(phase - PHASE_3_QUARTERS, inc);
+        buf[i] = clamp16(v);
+        phase += inc;
+        inc += step;
+    }
+
+    dds->phase = phase;
+}
+
+static void IRAM_ATTR render_square_minblep(dds_t *dds, int16_t *buf, size_t n)
+{
+    uint32_t phase = dds->phase;
+    uint32_t inc = dds->phase_inc;
+    int32_t step = dds->phase_inc_step;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        // An edge since the previous sample
+        if (phase < inc)
+            minblep_add(dds, dds_minblep_step, phase, inc, (int64_t)2 * MINBLEP_SQUARE_LEVEL << 15);
+        if (phase - PHASE_HALF < inc)
+            minblep_add(dds, dds_minblep_step, phase - PHASE_HALF, inc, -((int64_t)2 * MINBLEP_SQUARE_LEVEL << 15));
+
+        buf[i] = clamp16(naive_square(phase, MINBLEP_SQUARE_LEVEL) + minblep_next(dds));
+        phase += inc;
+        inc += step;
+    }
+
+    dds->phase = phase;
+}
+
+static void IRAM_ATTR render_triangle_minblep(dds_t *dds, int16_t *buf, size_t n)
+{
+    uint32_t phase = dds->phase;
+    uint32_t inc = dds->phase_inc;
+    int32_t step = dds->phase_inc_step;
+    int64_t slope = corner_slope(inc);
+
+    // The ramp residual doesn't end at 0 but at minus the delay of the filter. The
+    // table is shifted to end at 0 and the rest, one slope change times the delay
+    // from the peak to the trough, added here. Centered: the corrected wave would
+    // otherwise sit half of it above 0.
+    int32_t delay_offset = (int32_t)((-slope * dds_minblep_ramp_end) >> 31);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        // A corner since the previous sample
+        if (phase - PHASE_QUARTER < inc)
+            minblep_add(dds, dds_minblep_ramp, phase - PHASE_QUARTER, inc, -slope);
+        if (phase - PHASE_3_QUARTERS < inc)
+            minblep_add(dds, dds_minblep_ramp, phase - PHASE_3_QUARTERS, inc, slope);
+
+        int32_t v = naive_triangle(phase) + minblep_next(dds);
+        v += phase - PHASE_QUARTER < PHASE_HALF ? delay_offset : -delay_offset;
+        buf[i] = clamp16(v);
+        phase += inc;
+        inc += step;
+    }
+
+    dds->phase = phase;
+}
+
+static void IRAM_ATTR render_table(dds_t *dds, int16_t *buf, size_t n)
+{
+    const int16_t *table = dds->table;
+    uint32_t phase = dds->phase;
+    uint32_t inc = dds->phase_inc;
+    int32_t step = dds->phase_inc_step;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        uint32_t index = phase >> PHASE_SHIFT;
+        int32_t frac = (phase >> FRAC_SHIFT) & 0x7fff;
+        int32_t a = table[index];
+        int32_t b = table[index + 1];
+
+        // |b - a| <= 2 * FULL_SCALE, the product stays within 31 bits
+        buf[i] = (int16_t)(a + (((b - a) * frac) >> 15));
+        phase += inc;
+        inc += step;
+    }
+
+    dds->phase = phase;
+}
+
+static void IRAM_ATTR render_segment(dds_t *dds, int16_t *buf, size_t n)
+{
+    if (dds->wave == DDS_WAVE_SQUARE && dds->quality == DDS_QUALITY_POLYBLEP)
+        render_square_polyblep(dds, buf, n);
+    else if (dds->wave == DDS_WAVE_SQUARE && dds->quality == DDS_QUALITY_MINBLEP)
+        render_square_minblep(dds, buf, n);
+    else if (dds->wave == DDS_WAVE_TRIANGLE && dds->quality == DDS_QUALITY_POLYBLEP)
+        render_triangle_polyblep(dds, buf, n);
+    else if (dds->wave == DDS_WAVE_TRIANGLE && dds->quality == DDS_QUALITY_MINBLEP)
+        render_triangle_minblep(dds, buf, n);
+    else
+        render_table(dds, buf, n);
+}
+
+// In IRAM: a flash operation must not stall the sample path. While sweeping, the
+// block is cut into segments, each one ends on the curve: the step is the only error
+void IRAM_ATTR dds_render(dds_t *dds, int16_t *buf, size_t n)
+{
+    dds_sweep_t *sweep = &dds->sweep;
+
+    if (sweep->mode == DDS_SWEEP_OFF)
+    {
+        dds->phase_inc_step = 0;
+        render_segment(dds, buf, n);
+        return;
+    }
+
+    while (n)
+    {
+        size_t len = n < DDS_SWEEP_SEGMENT ? n : DDS_SWEEP_SEGMENT;
+        if (len > sweep->len - sweep->pos)
+            len = sweep->len - sweep->pos;
+
+        uint32_t end_inc = sweep_inc(sweep, sweep->pos + len);
+        dds->phase_inc_step = (int32_t)(((int64_t)end_inc - dds->phase_inc) / (int64_t)len);
+        render_segment(dds, buf, len);
+        dds->phase_inc = end_inc;
+
+        sweep->pos += len;
+        if (sweep->pos >= sweep->len)
+        {
+            sweep->pos = 0;
+            dds->phase_inc = sweep->start_inc;
+        }
+
+        buf += len;
+        n -= len;
+    }
+}
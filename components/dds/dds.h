@@ -0,0 +1,195 @@
+/**
+ * @file dds.h
+ * @defgroup dds dds
+ * @{
+ *
+ * Direct digital synthesis of the Waveman waveforms
+ *
+ * A 32-bit phase accumulator walks a wavetable of 2^CONFIG_DDS_TABLE_BITS
+ * samples, a full period being 2^32. The upper bits of the phase pick the
+ * table entry, the next 15 bits interpolate linearly to the following one.
+ * The frequency resolution is sample_rate / 2^32, about 11 uHz at 48 kHz.
+ *
+ * Table lookup aliases: the harmonics of the square and triangle waves above
+ * the Nyquist frequency fold back into the audio band. Their band-limited
+ * modes compute them from the phase and smooth every discontinuity, see
+ * dds_quality_t. The sine has no harmonics, it's always looked up.
+ *
+ * A sweep moves the phase step every sample, from the start to the stop
+ * frequency, linearly or exponentially, and starts over. The exact curve is
+ * computed every DDS_SWEEP_SEGMENT samples, the step between them is linear.
+ *
+ * A custom waveform is any table of DDS_TABLE_SIZE + 1 samples, the last one
+ * a copy of the first: dds_table_resample() makes one out of a period of any
+ * length. It's looked up like the sine, the caller keeps it while it's in use.
+ *
+ * The tables are computed once, by the first dds_init(), and shared by all
+ * the generators. dds_render() is the only function of the sample path; it
+ * doesn't lock, the caller serializes it with the setters.
+ */
+#ifndef __DDS_H__
+#define __DDS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_err.h>
+#include <sdkconfig.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DDS_TABLE_SIZE (1 << CONFIG_DDS_TABLE_BITS) //!< Samples per period in a wavetable
+#define DDS_BLEP_LEN   16                           //!< Samples corrected after a minBLEP edge
+#define DDS_SWEEP_SEGMENT 16                        //!< Samples between two points on the sweep curve
+
+/**
+ * Waveform, in the order of the waveform roller
+ */
+typedef enum {
+    DDS_WAVE_SINE = 0,
+    DDS_WAVE_TRIANGLE,
+    DDS_WAVE_SQUARE,
+    DDS_WAVE_MAX,
+    DDS_WAVE_CUSTOM = DDS_WAVE_MAX  //!< Table of the caller, set by dds_set_table()
+} dds_wave_t;
+
+/**
+ * Square and triangle rendering, from the cheapest to the cleanest
+ */
+typedef enum {
+    DDS_QUALITY_NAIVE = 0,  //!< Table lookup, aliases
+    DDS_QUALITY_POLYBLEP,   //!< Polynomial correction of the two samples around each edge
+    DDS_QUALITY_MINBLEP,    //!< Minimum phase band-limited step table over DDS_BLEP_LEN samples after each edge,
+                            //!< the square is 3 dB lower to leave room for its ringing
+    DDS_QUALITY_MAX
+} dds_quality_t;
+
+/**
+ * Frequency sweep
+ */
+typedef enum {
+    DDS_SWEEP_OFF = 0,      //!< Fixed frequency
+    DDS_SWEEP_LINEAR,       //!< Frequency linear in time
+    DDS_SWEEP_LOG,          //!< Frequency exponential in time, the same time per octave
+    DDS_SWEEP_MAX
+} dds_sweep_mode_t;
+
+/**
+ * Sweep state
+ */
+typedef struct
+{
+    dds_sweep_mode_t mode;
+    uint32_t start_inc;     //!< Phase step at the start
+    uint32_t stop_inc;      //!< Phase step at the end
+    uint32_t len;           //!< Samples from the start to the end
+    uint32_t pos;           //!< Samples since the start
+    float log_rate;         //!< DDS_SWEEP_LOG: ln(stop_inc / start_inc) / len
+} dds_sweep_t;
+
+/**
+ * Generator descriptor
+ */
+typedef struct
+{
+    uint32_t sample_rate;   //!< Samples per second
+    uint32_t phase;         //!< Phase accumulator, 2^32 is a full period
+    uint32_t phase_inc;     //!< Phase step per sample
+    int32_t phase_inc_step; // Change of phase_inc per sample, while sweeping
+    dds_sweep_t sweep;
+    dds_wave_t wave;
+    dds_quality_t quality;
+    const int16_t *table;
+    int32_t blep[DDS_BLEP_LEN];     // minBLEP corrections of the next samples
+    uint8_t blep_pos;
+} dds_t;
+
+/**
+ * Set up a generator: sine wave at 0 Hz, phase 0, quality set by CONFIG_DDS_QUALITY_*
+ * @param dds Generator descriptor
+ * @param sample_rate Samples per second
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_init(dds_t *dds, uint32_t sample_rate);
+
+/**
+ * Set the frequency of a generator, the phase goes on from where it is.
+ * Frequencies at or above the Nyquist frequency (sample_rate / 2) would
+ * alias, they are clamped below it. Ends a sweep.
+ * @param dds Generator descriptor
+ * @param freq_hz Frequency, Hz
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_set_frequency(dds_t *dds, uint32_t freq_hz);
+
+/**
+ * Sweep the frequency of a generator over and over, the phase goes on from
+ * where it is. The frequencies are clamped like by dds_set_frequency().
+ * @param dds Generator descriptor
+ * @param mode Sweep, DDS_SWEEP_OFF sets the start frequency
+ * @param start_hz Frequency at the start, Hz, not 0 for DDS_SWEEP_LOG
+ * @param stop_hz Frequency at the end, Hz, not 0 for DDS_SWEEP_LOG
+ * @param duration_ms Time from the start to the end, ms
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_set_sweep(dds_t *dds, dds_sweep_mode_t mode, uint32_t start_hz, uint32_t stop_hz, uint32_t duration_ms);
+
+/**
+ * Instantaneous frequency of a generator
+ * @param dds Generator descriptor
+ * @return Frequency, Hz
+ */
+float dds_get_frequency(const dds_t *dds);
+
+/**
+ * Set the waveform of a generator, the phase goes on from where it is
+ * @param dds Generator descriptor
+ * @param wave Waveform
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_set_waveform(dds_t *dds, dds_wave_t wave);
+
+/**
+ * Set a custom waveform, the phase goes on from where it is
+ * @param dds Generator descriptor
+ * @param table DDS_TABLE_SIZE + 1 samples, the last one equal to the first.
+ *              Not copied: it must stay until another waveform is set.
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_set_table(dds_t *dds, const int16_t *table);
+
+/**
+ * Make a table for dds_set_table() out of one period of any length. Longer
+ * periods are averaged down, shorter ones interpolated linearly.
+ * @param table DDS_TABLE_SIZE + 1 samples, written
+ * @param src One period
+ * @param n Samples in the period, at least 2
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_table_resample(int16_t *table, const int16_t *src, size_t n);
+
+/**
+ * Set how square and triangle waves are rendered.
+ * The minBLEP tables are computed the first time they are needed.
+ * @param dds Generator descriptor
+ * @param quality Quality
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_set_quality(dds_t *dds, dds_quality_t quality);
+
+/**
+ * Render the next samples, full scale is +-32767
+ * @param dds Generator descriptor
+ * @param buf Samples
+ * @param n Number of samples
+ */
+void dds_render(dds_t *dds, int16_t *buf, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __DDS_H__ */
@@ -0,0 +1,75 @@
+/**
+ * @file dds_level.c
+ *
+ * Output level of the DDS samples: amplitude, gain, DC offset and clipping
+ */
+#include "dds_level.h"
+#include <esp_attr.h>
+
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+esp_err_t dds_level_set(dds_level_t *lvl, uint16_t amplitude, uint16_t gain, int16_t offset, int16_t clip)
+{
+    CHECK_ARG(lvl && amplitude <= 32768 && gain <= DDS_LEVEL_GAIN_MAX * 256 && clip > 0);
+
+    // Q15 x Q8 -> Q12, x8 at full amplitude is one LSB too much for 16 bits
+    int32_t scale = ((int32_t)amplitude * gain) >> (15 + 8 - DDS_LEVEL_SHIFT);
+
+    lvl->scale = scale > INT16_MAX ? INT16_MAX : (int16_t)scale;
+    lvl->offset = offset;
+    lvl->min = -clip;
+    lvl->max = clip;
+
+    return ESP_OK;
+}
+
+// In IRAM with dds_render(). Every sample goes through the same
+// operations, the compiler turns the loop into vector code where it can.
+void IRAM_ATTR dds_level_apply(const dds_level_t *lvl, int16_t *buf, size_t n)
+{
+    const int32_t scale = lvl->scale;
+    const int32_t offset = lvl->offset;
+    const int32_t min = lvl->min;
+    const int32_t max = lvl->max;
+
+    // Nothing to do at unity, the default level
+    if (scale == DDS_LEVEL_UNITY && offset == 0 && min <= -INT16_MAX && max >= INT16_MAX)
+        return;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        // Rounded, |buf[i] * scale| < 2^30
+        int32_t v = ((buf[i] * scale + (1 << (DDS_LEVEL_SHIFT - 1))) >> DDS_LEVEL_SHIFT) + offset;
+        v = v < min ? min : v;
+        v = v > max ? max : v;
+        buf[i] = (int16_t)v;
+    }
+}
+
+// The scale and the offset go up by a fraction of a step every sample: they
+// are kept with RAMP_FRAC_BITS more bits, the index finds where they are
+#define RAMP_FRAC_BITS  12
+
+void IRAM_ATTR dds_level_ramp(const dds_level_t *from, const dds_level_t *to, int16_t *buf, size_t n)
+{
+    if (n == 0)
+        return;
+
+    const int32_t scale = (int32_t)from->scale << RAMP_FRAC_BITS;
+    const int32_t scale_step = (((int32_t)to->scale - from->scale) << RAMP_FRAC_BITS) / (int32_t)n;
+    const int32_t offset = (int32_t)from->offset << RAMP_FRAC_BITS;
+    const int32_t offset_step = (((int32_t)to->offset - from->offset) << RAMP_FRAC_BITS) / (int32_t)n;
+    const int32_t min = to->min;
+    const int32_t max = to->max;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        // Reaches `to` with the last sample, give or take the rounding of the steps
+        int32_t s = (scale + scale_step * (int32_t)(i + 1)) >> RAMP_FRAC_BITS;
+        int32_t o = (offset + offset_step * (int32_t)(i + 1)) >> RAMP_FRAC_BITS;
+        int32_t v = ((buf[i] * s + (1 << (DDS_LEVEL_SHIFT - 1))) >> DDS_LEVEL_SHIFT) + o;
+        v = v < min ? min : v;
+        v = v > max ? max : v;
+        buf[i] = (int16_t)v;
+    }
+}
@@ -0,0 +1,75 @@
+/**
+ * @file dds_level.h
+ * @defgroup dds_level dds_level
+ * @{
+ *
+ * Output level of the DDS samples: amplitude, gain, DC offset and clipping
+ *
+ * One fixed-point pass over a rendered block. The amplitude and the gain are
+ * folded into a single Q12 multiplier, so a sample takes one 16 x 16-bit
+ * multiply, a shift, an add and a clamp. The loop is written for the
+ * compiler: no branches and no aliasing, GCC vectorizes it on the host
+ * (SSE, NEON) and the ESP32 gets MUL16S, MIN and MAX from it.
+ */
+#ifndef __DDS_LEVEL_H__
+#define __DDS_LEVEL_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DDS_LEVEL_SHIFT     12                      //!< Fraction bits of dds_level_t::scale
+#define DDS_LEVEL_UNITY     (1 << DDS_LEVEL_SHIFT)  //!< Scale leaving the samples as they are
+#define DDS_LEVEL_GAIN_MAX  8                       //!< Gain limit, the scale is 16 bits
+
+/**
+ * Level descriptor
+ */
+typedef struct
+{
+    int16_t scale;      //!< Amplitude times gain, Q12
+    int16_t offset;     //!< Added after scaling, full scale is 32767
+    int16_t min;        //!< Lower clipping level
+    int16_t max;        //!< Upper clipping level
+} dds_level_t;
+
+/**
+ * Set up a level
+ * @param lvl Level descriptor
+ * @param amplitude Amplitude, Q15: 32768 is full scale
+ * @param gain Gain applied on top of the amplitude, Q8: 256 is x1, up to x8
+ * @param offset DC offset, full scale is 32767
+ * @param clip Samples are clipped to +-clip, 1..32767
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_level_set(dds_level_t *lvl, uint16_t amplitude, uint16_t gain, int16_t offset, int16_t clip);
+
+/**
+ * Apply a level to a block, in place
+ * @param lvl Level descriptor
+ * @param buf Samples
+ * @param n Number of samples
+ */
+void dds_level_apply(const dds_level_t *lvl, int16_t *buf, size_t n);
+
+/**
+ * Apply a level gliding from `from` to `to` over a block, in place: the scale
+ * and the offset move a step every sample, the clipping levels are those of `to`
+ * @param from Level before the block
+ * @param to Level at the end of the block
+ * @param buf Samples
+ * @param n Number of samples
+ */
+void dds_level_ramp(const dds_level_t *from, const dds_level_t *to, int16_t *buf, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __DDS_LEVEL_H__ */
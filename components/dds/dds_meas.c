@@ -0,0 +1,135 @@
+/**
+ * @file dds_meas.c
+ *
+ * Period and duty cycle of the DDS samples, measured on the rendered blocks
+ */
+#include "dds_meas.h"
+#include <esp_attr.h>
+
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+// The result word: period in samples, Q6, above a 10-bit duty cycle
+#define RESULT_PERIOD_FRAC  6
+#define RESULT_DUTY_BITS    10
+#define RESULT_PERIOD_MAX   (UINT32_MAX >> RESULT_DUTY_BITS)
+
+// Crossing levels nothing crosses, for a flat signal
+#define THR_NONE_LO         (INT16_MIN - 1)
+#define THR_NONE_HI         (INT16_MAX + 1)
+
+static void start(dds_meas_t *meas)
+{
+    int32_t swing = (int32_t)meas->hi - meas->lo;
+
+    if (swing < DDS_MEAS_SWING_MIN)
+    {
+        meas->thr_lo = THR_NONE_LO;
+        meas->thr_hi = THR_NONE_HI;
+    }
+    else
+    {
+        int32_t mid = ((int32_t)meas->lo + meas->hi) / 2;
+        meas->thr_lo = mid - swing / 8;
+        meas->thr_hi = mid + swing / 8;
+    }
+
+    meas->lo = INT16_MAX;
+    meas->hi = INT16_MIN;
+    meas->pos = 0;
+    meas->rises = 0;
+    meas->high_cnt = 0;
+    meas->high_at_last = 0;
+}
+
+static void finish(dds_meas_t *meas)
+{
+    uint32_t result = 0;
+
+    if (meas->rises >= 2)
+    {
+        uint32_t span = meas->last_rise - meas->first_rise;
+        uint64_t period = ((uint64_t)span << RESULT_PERIOD_FRAC) / (meas->rises - 1);
+        uint32_t duty = (uint32_t)((uint64_t)meas->high_at_last * 1000 / span);
+
+        if (period <= RESULT_PERIOD_MAX)
+            result = (uint32_t)period << RESULT_DUTY_BITS | duty;
+    }
+    __atomic_store_n(&meas->result, result, __ATOMIC_RELAXED);
+
+    start(meas);
+}
+
+esp_err_t dds_meas_init(dds_meas_t *meas, uint32_t sample_rate)
+{
+    CHECK_ARG(meas && sample_rate);
+
+    meas->sample_rate = sample_rate;
+    meas->window = (uint32_t)((uint64_t)sample_rate * DDS_MEAS_WINDOW_MS / 1000);
+    meas->window_max = (uint32_t)((uint64_t)sample_rate * DDS_MEAS_WINDOW_MAX_MS / 1000);
+    meas->high = false;
+    meas->result = 0;
+    // No range yet: the first measurement only finds the levels of the next one
+    meas->lo = 0;
+    meas->hi = 0;
+    start(meas);
+
+    return ESP_OK;
+}
+
+// In IRAM with dds_render(), it runs on every block after it
+void IRAM_ATTR dds_meas_feed(dds_meas_t *meas, const int16_t *buf, size_t n)
+{
+    int32_t lo = meas->lo, hi = meas->hi;
+    const int32_t thr_lo = meas->thr_lo, thr_hi = meas->thr_hi;
+    bool high = meas->high;
+    uint32_t high_cnt = meas->high_cnt;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        int32_t v = buf[i];
+        lo = v < lo ? v : lo;
+        hi = v > hi ? v : hi;
+
+        if (high)
+        {
+            high = v >= thr_lo;
+        }
+        else if (v > thr_hi)
+        {
+            high = true;
+            uint32_t pos = meas->pos + i;
+            if (meas->rises++ == 0)
+            {
+                meas->first_rise = pos;
+                high_cnt = 0;
+            }
+            meas->last_rise = pos;
+            meas->high_at_last = high_cnt;
+        }
+        high_cnt += high;
+    }
+
+    meas->lo = (int16_t)lo;
+    meas->hi = (int16_t)hi;
+    meas->high = high;
+    meas->high_cnt = high_cnt;
+    meas->pos += n;
+
+    // A flat signal can't cross: no need to wait for the longest measurement
+    bool enough = meas->rises >= 2 || meas->thr_hi == THR_NONE_HI;
+    if ((meas->pos >= meas->window && enough) || meas->pos >= meas->window_max)
+        finish(meas);
+}
+
+bool dds_meas_get(const dds_meas_t *meas, uint32_t *period_ns, uint16_t *duty)
+{
+    uint32_t result = __atomic_load_n(&meas->result, __ATOMIC_RELAXED);
+    if (result == 0)
+        return false;
+
+    uint64_t period = result >> RESULT_DUTY_BITS;
+    *period_ns = (uint32_t)((period * 1000000000ULL) / ((uint64_t)meas->sample_rate << RESULT_PERIOD_FRAC));
+    *duty = result & ((1 << RESULT_DUTY_BITS) - 1);
+
+    return true;
+}
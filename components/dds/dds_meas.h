@@ -0,0 +1,89 @@
+/**
+ * @file dds_meas.h
+ * @defgroup dds_meas dds_meas
+ * @{
+ *
+ * Period and duty cycle of the DDS samples, measured on the rendered blocks
+ *
+ * A counter on the samples as they go out, after the level: it finds the
+ * rising crossings of the middle of the signal and times them. The middle
+ * and a hysteresis of an eighth of the swing on either side come from the
+ * range of the previous measurement, so the measure follows the amplitude
+ * and the offset and ignores the ripple of the band-limited edges.
+ *
+ * A measurement lasts DDS_MEAS_WINDOW_MS, longer when it hasn't seen two
+ * rising crossings yet, up to DDS_MEAS_WINDOW_MAX_MS. The period is the mean
+ * of all the periods in it, the duty cycle their share of high samples.
+ * A flat signal, or one slower than the longest measurement, has no period.
+ *
+ * One writer, the task rendering the samples. The result is a single word,
+ * any task can read it.
+ */
+#ifndef __DDS_MEAS_H__
+#define __DDS_MEAS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DDS_MEAS_WINDOW_MS      100     //!< Shortest measurement
+#define DDS_MEAS_WINDOW_MAX_MS  1000    //!< Longest measurement, two periods of the slowest signal
+#define DDS_MEAS_SWING_MIN      64      //!< Smallest peak to peak swing with a period
+
+/**
+ * Measurement descriptor
+ */
+typedef struct
+{
+    uint32_t sample_rate;   //!< Samples per second
+    uint32_t window;        //!< Samples of the shortest measurement
+    uint32_t window_max;    //!< Samples of the longest measurement
+    int16_t lo, hi;         // Range of the measurement in progress
+    int32_t thr_lo, thr_hi; // Crossing levels, from the range of the previous one
+    bool high;              // Level after the last crossing
+    uint32_t pos;           // Samples since the measurement started
+    uint32_t rises;         // Rising crossings
+    uint32_t first_rise;    // Sample of the first one
+    uint32_t last_rise;     // Sample of the last one
+    uint32_t high_cnt;      // High samples since the first one
+    uint32_t high_at_last;  // High samples from the first one to the last one
+    uint32_t result;        // Period in samples Q6 << 10 | duty, see dds_meas_get()
+} dds_meas_t;
+
+/**
+ * Set up a measurement, without a result
+ * @param meas Measurement descriptor
+ * @param sample_rate Samples per second
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_meas_init(dds_meas_t *meas, uint32_t sample_rate);
+
+/**
+ * Measure a block of samples
+ * @param meas Measurement descriptor
+ * @param buf Samples
+ * @param n Number of samples
+ */
+void dds_meas_feed(dds_meas_t *meas, const int16_t *buf, size_t n);
+
+/**
+ * Get the result of the last measurement done
+ * @param meas Measurement descriptor
+ * @param period_ns Period, ns
+ * @param duty Share of the period the signal is high, per mille
+ * @return false if the last measurement found no period
+ */
+bool dds_meas_get(const dds_meas_t *meas, uint32_t *period_ns, uint16_t *duty);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __DDS_MEAS_H__ */
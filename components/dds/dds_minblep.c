@@ -0,0 +1,157 @@
+/**
+ * @file dds_minblep.c
+ *
+ * Minimum phase band-limited step (minBLEP) tables of the DDS engine
+ *
+ * E. Brandt's method (Hard sync without aliasing, 2001): a Blackman windowed sinc is made minimum
+ * phase through its real cepstrum, then integrated into a step. All its
+ * ringing comes after the edge, so an edge is corrected in the samples
+ * following it and nothing has to be rendered ahead.
+ */
+#include "dds.h"
+#include "dds_minblep.h"
+#include <esp_log.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define FFT_SIZE    2048    // >> DDS_MINBLEP_POINTS: keeps the cepstrum from aliasing
+#define MAG_MIN     1e-9    // Floor of the spectrum magnitude before its log
+
+// Cutoff of the sinc, of the Nyquist frequency. The window is only DDS_BLEP_LEN samples
+// long, its transition band is wide: at the Nyquist frequency most of it would fold back.
+#define CUTOFF      0.7
+
+static const char *TAG = "DDS";
+
+int32_t dds_minblep_step[DDS_MINBLEP_POINTS];
+int32_t dds_minblep_ramp[DDS_MINBLEP_POINTS];
+int32_t dds_minblep_ramp_end;
+static bool ready = false;
+
+// In place radix-2 FFT, scaled by 1/n when inverse
+static void fft(double *re, double *im, size_t n, bool inverse)
+{
+    for (size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+        {
+            double t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        double angle = (inverse ? 2 : -2) * M_PI / len;
+        for (size_t k = 0; k < len / 2; k++)
+        {
+            double wr = cos(angle * k), wi = sin(angle * k);
+            for (size_t i = k; i < n; i += len)
+            {
+                size_t j = i + len / 2;
+                double tr = re[j] * wr - im[j] * wi;
+                double ti = re[j] * wi + im[j] * wr;
+                re[j] = re[i] - tr;
+                im[j] = im[i] - ti;
+                re[i] += tr;
+                im[i] += ti;
+            }
+        }
+    }
+
+    if (inverse)
+        for (size_t i = 0; i < n; i++)
+        {
+            re[i] /= n;
+            im[i] /= n;
+        }
+}
+
+esp_err_t dds_minblep_build(void)
+{
+    if (ready)
+        return ESP_OK;
+
+    double *re = calloc(FFT_SIZE, sizeof(double));
+    double *im = calloc(FFT_SIZE, sizeof(double));
+    if (!re || !im)
+    {
+        free(re);
+        free(im);
+        ESP_LOGE(TAG, "No memory for the minBLEP tables");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Windowed sinc, DDS_MINBLEP_ZERO_CROSSINGS on each side
+    const size_t n = DDS_MINBLEP_POINTS;
+    for (size_t i = 0; i < n; i++)
+    {
+        double x = (double)i / (n - 1);
+        double t = (2 * x - 1) * DDS_MINBLEP_ZERO_CROSSINGS * CUTOFF;
+        double sinc = t == 0 ? 1 : sin(M_PI * t) / (M_PI * t);
+        double window = 0.42 - 0.5 * cos(2 * M_PI * x) + 0.08 * cos(4 * M_PI * x);
+        re[i] = sinc * window;
+    }
+
+    // Real cepstrum
+    fft(re, im, FFT_SIZE, false);
+    for (size_t i = 0; i < FFT_SIZE; i++)
+    {
+        double mag = hypot(re[i], im[i]);
+        re[i] = log(mag > MAG_MIN ? mag : MAG_MIN);
+        im[i] = 0;
+    }
+    fft(re, im, FFT_SIZE, true);
+
+    // Fold the anticausal part onto the causal one: the minimum phase cepstrum
+    for (size_t i = 1; i < FFT_SIZE / 2; i++)
+        re[i] *= 2;
+    for (size_t i = FFT_SIZE / 2 + 1; i < FFT_SIZE; i++)
+        re[i] = 0;
+    for (size_t i = 0; i < FFT_SIZE; i++)
+        im[i] = 0;
+
+    // Back to the time domain through the complex exponential of the spectrum
+    fft(re, im, FFT_SIZE, false);
+    for (size_t i = 0; i < FFT_SIZE; i++)
+    {
+        double mag = exp(re[i]);
+        re[i] = mag * cos(im[i]);
+        im[i] = mag * sin(im[i]);
+    }
+    fft(re, im, FFT_SIZE, true);
+
+    // Integrate the impulse into a step, then into a ramp, one output sample being OVERSAMPLING points
+    double total = 0;
+    for (size_t i = 0; i < n; i++)
+        total += re[i];
+
+    double step = 0, prev_residual = -1, ramp = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        step += re[i] / total;
+        double residual = i == n - 1 ? 0 : step - 1;
+        if (i > 0)
+            ramp += (prev_residual + residual) / 2 / DDS_MINBLEP_OVERSAMPLING;
+        prev_residual = residual;
+
+        dds_minblep_step[i] = (int32_t)lround(residual * 32767);
+        re[i] = ramp;   // Done with the impulse up to i
+    }
+
+    dds_minblep_ramp_end = (int32_t)lround(ramp * 32768);
+    for (size_t i = 0; i < n; i++)
+        dds_minblep_ramp[i] = (int32_t)lround((re[i] - ramp) * 32768);
+
+    free(re);
+    free(im);
+
+    ready = true;
+    ESP_LOGI(TAG, "minBLEP tables of %d points ready, delay %.2f samples", (int)n, -ramp);
+    return ESP_OK;
+}
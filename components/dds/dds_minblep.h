@@ -0,0 +1,46 @@
+/**
+ * @file dds_minblep.h
+ *
+ * Minimum phase band-limited step (minBLEP) tables of the DDS engine, internal
+ */
+#ifndef __DDS_MINBLEP_H__
+#define __DDS_MINBLEP_H__
+
+#include <stdint.h>
+#include "dds.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DDS_MINBLEP_ZERO_CROSSINGS  8   // Of the windowed sinc, on each side
+#define DDS_MINBLEP_OVERSAMPLING    32  // Table points per output sample
+#define DDS_MINBLEP_POINTS          (DDS_BLEP_LEN * DDS_MINBLEP_OVERSAMPLING + 1)
+
+/**
+ * Step residual: the minBLEP minus the ideal step, Q15, from the edge on
+ */
+extern int32_t dds_minblep_step[DDS_MINBLEP_POINTS];
+
+/**
+ * Ramp residual: the integrated minBLEP minus the ideal ramp, Q15 samples per
+ * unit of slope, less its final value so it ends at 0
+ */
+extern int32_t dds_minblep_ramp[DDS_MINBLEP_POINTS];
+
+/**
+ * Final value of the ramp residual: the delay of the minimum phase filter
+ */
+extern int32_t dds_minblep_ramp_end;
+
+/**
+ * Compute the tables, once. Takes a few tens of kB of heap while it runs.
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_minblep_build(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DDS_MINBLEP_H__ */
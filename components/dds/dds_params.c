@@ -0,0 +1,153 @@
+/**
+ * @file dds_params.c
+ *
+ * Parameters of a DDS generator, handed over from the UI to the audio task
+ */
+#include "dds_params.h"
+#include <esp_attr.h>
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+esp_err_t dds_params_init(dds_params_block_t *pb, const dds_params_t *params)
+{
+    CHECK_ARG(pb && params);
+
+    pb->slot[0] = *params;
+    pb->slot[1] = *params;
+    __atomic_store_n(&pb->seq, 0, __ATOMIC_RELEASE);
+
+    return ESP_OK;
+}
+
+void dds_params_publish(dds_params_block_t *pb, const dds_params_t *params)
+{
+    // Only the writer moves seq: no need to load it atomically
+    uint32_t seq = pb->seq + 1;
+
+    // slot[seq & 1] is the one published two snapshots ago, a reader may still
+    // be copying it. The release store of the last bump doesn't keep the stores
+    // after it from passing it: this fence does, so a reader which sees any of
+    // the new slot sees the moved seq on its second load and copies again.
+    // On the ESP32 it's a MEMW between the stores, on the host (x86 stores
+    // stay in order) it only keeps the compiler from moving them.
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    pb->slot[seq & 1] = *params;
+    // The slot is complete before the reader can select it
+    __atomic_store_n(&pb->seq, seq, __ATOMIC_RELEASE);
+}
+
+bool IRAM_ATTR dds_params_fetch(dds_params_block_t *pb, uint32_t *seq, dds_params_t *params)
+{
+    uint32_t current = __atomic_load_n(&pb->seq, __ATOMIC_ACQUIRE);
+    if (current == *seq)
+        return false;
+
+    for (;;)
+    {
+        *params = pb->slot[current & 1];
+
+        // The copy is done before seq is checked again. A moved seq means the
+        // writer may have started on this slot, take the newer one.
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        uint32_t again = __atomic_load_n(&pb->seq, __ATOMIC_RELAXED);
+        if (again == current)
+            break;
+        current = again;
+    }
+
+    *seq = current;
+    return true;
+}
+
+static esp_err_t set_wave(dds_t *dds, const dds_params_t *params)
+{
+    if (params->wave == DDS_WAVE_CUSTOM)
+        return dds_set_table(dds, params->table);
+
+    return dds_set_waveform(dds, params->wave);
+}
+
+esp_err_t dds_params_reader_init(dds_params_reader_t *rd, dds_params_block_t *pb, dds_t *dds)
+{
+    CHECK_ARG(rd && pb && dds);
+
+    dds_params_t *params = &rd->params;
+    rd->block = pb;
+    rd->dds = dds;
+    rd->seq = __atomic_load_n(&pb->seq, __ATOMIC_ACQUIRE) - 1;
+    dds_params_fetch(pb, &rd->seq, params);
+
+    CHECK(dds_set_sweep(dds, params->sweep, params->frequency, params->sweep_stop, params->sweep_ms));
+    CHECK(set_wave(dds, params));
+
+    return ESP_OK;
+}
+
+// Glides from the current frequency to `phase_inc` in steps of DDS_PARAMS_RAMP_STEP samples
+static void IRAM_ATTR render_glide(dds_t *dds, uint32_t phase_inc, int16_t *buf, size_t n)
+{
+    int64_t from = dds->phase_inc;
+    int64_t diff = (int64_t)phase_inc - from;
+
+    for (size_t done = 0; done < n; done += DDS_PARAMS_RAMP_STEP)
+    {
+        size_t len = n - done < DDS_PARAMS_RAMP_STEP ? n - done : DDS_PARAMS_RAMP_STEP;
+        dds->phase_inc = (uint32_t)(from + diff * (int64_t)(done + len) / (int64_t)n);
+        dds_render(dds, buf + done, len);
+    }
+
+    dds->phase_inc = phase_inc;
+}
+
+// In IRAM with dds_render(). The setters run from flash, only when a snapshot is taken.
+void IRAM_ATTR dds_params_render(dds_params_reader_t *rd, int16_t *buf, size_t n)
+{
+    dds_params_t params;
+
+    if (!dds_params_fetch(rd->block, &rd->seq, &params))
+    {
+        dds_render(rd->dds, buf, n);
+        dds_level_apply(&rd->params.level, buf, n);
+        return;
+    }
+
+    // The phase goes on from where it is: the wave keeps its value, only its slope or shape changes
+    uint32_t phase_inc = rd->dds->phase_inc;
+    bool glide = params.ramp && n;
+    set_wave(rd->dds, &params);
+
+    if (params.sweep == DDS_SWEEP_OFF)
+    {
+        dds_set_frequency(rd->dds, params.frequency);
+    }
+    else if (params.sweep != rd->params.sweep || params.frequency != rd->params.frequency ||
+             params.sweep_stop != rd->params.sweep_stop || params.sweep_ms != rd->params.sweep_ms)
+    {
+        // The sweep jumps to its start, gliding there would only delay it
+        dds_set_sweep(rd->dds, params.sweep, params.frequency, params.sweep_stop, params.sweep_ms);
+        glide = false;
+    }
+    else
+    {
+        glide = false;      // Sweeping on as it was
+    }
+
+    if (glide)
+    {
+        uint32_t target_inc = rd->dds->phase_inc;
+        rd->dds->phase_inc = phase_inc;
+        render_glide(rd->dds, target_inc, buf, n);
+    }
+    else
+    {
+        dds_render(rd->dds, buf, n);
+    }
+
+    if (params.ramp)
+        dds_level_ramp(&rd->params.level, &params.level, buf, n);
+    else
+        dds_level_apply(&params.level, buf, n);
+
+    rd->params = params;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file dds_params.h
+ * @defgroup dds_params dds_params
+ * @{
+ *
+ * Parameters of a DDS generator, handed over from the UI to the audio task
+ *
+ * The writer publishes a complete snapshot at a time into a double buffered
+ * block: it fills the slot the reader isn't using, then bumps a sequence
+ * number which selects the current slot. The reader copies the current slot
+ * and checks that the sequence number didn't move meanwhile, else it copies
+ * again. Neither side locks or waits: a reader interrupting the writer reads
+ * the other slot, so it only retries if a whole snapshot was published while
+ * it was copying.
+ *
+ * The reader takes the snapshots at block boundaries, in dds_params_render().
+ * The phase of the generator goes on through every change; with `ramp` set,
+ * the frequency and the level also glide to their new values over the block
+ * instead of stepping. A sweep starts over when its settings change, not
+ * when only the waveform or the level do.
+ *
+ * One writer and one reader per block.
+ */
+#ifndef __DDS_PARAMS_H__
+#define __DDS_PARAMS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <esp_err.h>
+#include "dds.h"
+#include "dds_level.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DDS_PARAMS_RAMP_STEP    16  //!< Samples rendered at each frequency of a glide
+
+/**
+ * Parameter snapshot
+ */
+typedef struct
+{
+    uint32_t frequency;     //!< Hz, where a sweep starts
+    dds_sweep_mode_t sweep; //!< Sweep, DDS_SWEEP_OFF for a fixed frequency
+    uint32_t sweep_stop;    //!< Hz, where a sweep ends
+    uint32_t sweep_ms;      //!< Duration of a sweep, ms
+    dds_wave_t wave;        //!< Waveform
+    const int16_t *table;   //!< DDS_WAVE_CUSTOM: table for dds_set_table(), kept by the writer
+    dds_level_t level;      //!< Amplitude, gain, offset and clipping
+    bool ramp;              //!< Glide to the frequency and level over a block rather than step
+} dds_params_t;
+
+/**
+ * Parameter block, shared by the writer and the reader
+ */
+typedef struct
+{
+    dds_params_t slot[2];
+    uint32_t seq;           // Snapshots published, slot[seq & 1] is the current one
+} dds_params_block_t;
+
+/**
+ * Reader side of a parameter block: the generator and the state of the output
+ */
+typedef struct
+{
+    dds_params_block_t *block;  //!< Where the parameters come from
+    dds_t *dds;                 //!< Generator, rendered from here only
+    dds_params_t params;        //!< Parameters in use
+    uint32_t seq;               //!< Last snapshot taken
+} dds_params_reader_t;
+
+/**
+ * Set up a parameter block with its first snapshot
+ * @param pb Parameter block
+ * @param params Parameters
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_params_init(dds_params_block_t *pb, const dds_params_t *params);
+
+/**
+ * Publish a snapshot. Never blocks, the reader takes it at its next block.
+ * @param pb Parameter block
+ * @param params Parameters
+ */
+void dds_params_publish(dds_params_block_t *pb, const dds_params_t *params);
+
+/**
+ * Take the current snapshot if it's newer than the last one taken
+ * @param pb Parameter block
+ * @param seq Sequence number of the last snapshot taken, updated
+ * @param params Parameters, written only if newer
+ * @return true if a newer snapshot was taken
+ */
+bool dds_params_fetch(dds_params_block_t *pb, uint32_t *seq, dds_params_t *params);
+
+/**
+ * Set up the reader of a parameter block and apply the current snapshot to its generator
+ * @param rd Reader
+ * @param pb Parameter block, initialized
+ * @param dds Generator, initialized
+ * @return `ESP_OK` on success
+ */
+esp_err_t dds_params_reader_init(dds_params_reader_t *rd, dds_params_block_t *pb, dds_t *dds);
+
+/**
+ * Render and level the next block, after taking the parameters published since the previous one
+ * @param rd Reader
+ * @param buf Samples
+ * @param n Number of samples
+ */
+void dds_params_render(dds_params_reader_t *rd, int16_t *buf, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __DDS_PARAMS_H__ */
@@ -1,7 +1,7 @@
 /**
  * @file encoder.c
  *
- * ESP-IDF HW timer-based driver for rotary encoders
+ * ESP-IDF driver for rotary encoders
  *
  * Copyright (C) 2019 Ruslan V. Uss <unclerus@gmail.com>
  *
@@ -23,7 +23,6 @@
 
 static const char *TAG = "ENCODER";
 static rotary_encoder_t *encs[CONFIG_RE_MAX] = { 0 };
-static const int8_t valid_states[] = { 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0 };
 static SemaphoreHandle_t mutex;
 static QueueHandle_t _queue;
 
@@ -31,6 +30,13 @@ static QueueHandle_t _queue;
 #define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
 #define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
 
+inline static uint8_t read_state(rotary_encoder_t *re)
+{
+    return RE_DECODER_STATE(gpio_get_level(re->pin_a), gpio_get_level(re->pin_b));
+}
+
+#if CONFIG_RE_BACKEND_POLL
+
 inline static void read_encoder(rotary_encoder_t *re)
 {
     rotary_encoder_event_t ev = {
@@ -85,25 +91,11 @@ inline static void read_encoder(rotary_encoder_t *re)
         }
     } while(0);
 
-    re->code <<= 2;
-    re->code |= gpio_get_level(re->pin_a);
-    re->code |= gpio_get_level(re->pin_b) << 1;
-    re->code &= 0xf;
-
-    if (!valid_states[re->code])
-        return;
-
-    int8_t inc = 0;
-
-    re->store = (re->store << 4) | re->code;
-
-    if (re->store == 0xe817) inc = 1;
-    if (re->store == 0xd42b) inc = -1;
-
-    if (inc)
+    int32_t diff = re_decoder_feed(&re->decoder, read_state(re));
+    if (diff)
     {
         ev.type = RE_ET_CHANGED;
-        ev.diff = inc;
+        ev.diff = diff;
         xQueueSendToBack(_queue, &ev, 0);
     }
 }
@@ -129,6 +121,141 @@ static const esp_timer_create_args_t timer_args = {
 
 static esp_timer_handle_t timer;
 
+#else /* CONFIG_RE_BACKEND_INTR */
+
+static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+// The ISR service is installed without ESP_INTR_FLAG_IRAM: the handlers may run flash code
+static void rotation_isr(void *arg)
+{
+    rotary_encoder_t *re = (rotary_encoder_t *)arg;
+
+    portENTER_CRITICAL_ISR(&mux);
+    int32_t diff = re_decoder_feed(&re->decoder, read_state(re));
+    portEXIT_CRITICAL_ISR(&mux);
+
+    if (!diff)
+        return;
+
+    rotary_encoder_event_t ev = {
+        .sender = re,
+        .type = RE_ET_CHANGED,
+        .diff = diff
+    };
+    BaseType_t woken = pdFALSE;
+    xQueueSendToBackFromISR(_queue, &ev, &woken);
+    if (woken)
+        portYIELD_FROM_ISR();
+}
+
+// Must be called with mux held. Returns the number of events put into `types`
+static size_t btn_update(rotary_encoder_t *re, bool pressed, rotary_encoder_event_type_t *types)
+{
+    size_t n = 0;
+
+    if (pressed && re->btn_state == RE_BTN_RELEASED)
+    {
+        re->btn_state = RE_BTN_PRESSED;
+        re->btn_pressed_time_us = esp_timer_get_time();
+        types[n++] = RE_ET_BTN_PRESSED;
+    }
+    else if (!pressed && re->btn_state != RE_BTN_RELEASED)
+    {
+        bool clicked = re->btn_state == RE_BTN_PRESSED;
+        re->btn_state = RE_BTN_RELEASED;
+        types[n++] = RE_ET_BTN_RELEASED;
+        if (clicked)
+            types[n++] = RE_ET_BTN_CLICKED;
+    }
+
+    return n;
+}
+
+// The first edge is taken right away, the bounce following it is ignored
+// until btn_timer ends the dead time
+static void btn_isr(void *arg)
+{
+    rotary_encoder_t *re = (rotary_encoder_t *)arg;
+    rotary_encoder_event_type_t types[2];
+    size_t n = 0;
+
+    portENTER_CRITICAL_ISR(&mux);
+    if (!re->btn_settling)
+    {
+        n = btn_update(re, gpio_get_level(re->pin_btn) == CONFIG_RE_BTN_PRESSED_LEVEL, types);
+        re->btn_settling = n > 0;
+    }
+    portEXIT_CRITICAL_ISR(&mux);
+
+    if (!n)
+        return;
+
+    // May be waiting for the long press
+    esp_timer_stop(re->btn_timer);
+    esp_timer_start_once(re->btn_timer, CONFIG_RE_BTN_DEAD_TIME_US);
+
+    rotary_encoder_event_t ev = {
+        .sender = re
+    };
+    BaseType_t woken = pdFALSE;
+    for (size_t i = 0; i < n; i++)
+    {
+        ev.type = types[i];
+        xQueueSendToBackFromISR(_queue, &ev, &woken);
+    }
+    if (woken)
+        portYIELD_FROM_ISR();
+}
+
+// End of the dead time or of the long press timeout
+static void btn_timer_handler(void *arg)
+{
+    rotary_encoder_t *re = (rotary_encoder_t *)arg;
+    rotary_encoder_event_type_t types[2];
+    size_t n;
+    uint64_t timeout = 0;
+
+    portENTER_CRITICAL(&mux);
+    re->btn_settling = false;
+    bool pressed = gpio_get_level(re->pin_btn) == CONFIG_RE_BTN_PRESSED_LEVEL;
+    // The bounce may have ended on the other level than the edge which started it
+    n = btn_update(re, pressed, types);
+    if (n)
+    {
+        re->btn_settling = true;
+        timeout = CONFIG_RE_BTN_DEAD_TIME_US;
+    }
+    else if (re->btn_state == RE_BTN_PRESSED)
+    {
+        uint64_t held = esp_timer_get_time() - re->btn_pressed_time_us;
+        if (held >= CONFIG_RE_BTN_LONG_PRESS_TIME_US)
+        {
+            re->btn_state = RE_BTN_LONG_PRESSED;
+            types[n++] = RE_ET_BTN_LONG_PRESSED;
+        }
+        else
+            timeout = CONFIG_RE_BTN_LONG_PRESS_TIME_US - held;
+    }
+    portEXIT_CRITICAL(&mux);
+
+    if (timeout)
+    {
+        esp_timer_stop(re->btn_timer);
+        esp_timer_start_once(re->btn_timer, timeout);
+    }
+
+    rotary_encoder_event_t ev = {
+        .sender = re
+    };
+    for (size_t i = 0; i < n; i++)
+    {
+        ev.type = types[i];
+        xQueueSendToBack(_queue, &ev, 0);
+    }
+}
+
+#endif
+
 esp_err_t rotary_encoder_init(QueueHandle_t queue)
 {
     CHECK_ARG(queue);
@@ -141,10 +268,22 @@ esp_err_t rotary_encoder_init(QueueHandle_t queue)
         return ESP_ERR_NO_MEM;
     }
 
+#if CONFIG_RE_BACKEND_POLL
     CHECK(esp_timer_create(&timer_args, &timer));
     CHECK(esp_timer_start_periodic(timer, CONFIG_RE_INTERVAL_US));
 
     ESP_LOGI(TAG, "Initialization complete, timer interval: %dms", CONFIG_RE_INTERVAL_US / 1000);
+#else
+    // The service is shared with other drivers, it may be installed already
+    esp_err_t res = gpio_install_isr_service(0);
+    if (res != ESP_OK && res != ESP_ERR_INVALID_STATE)
+    {
+        ESP_LOGE(TAG, "Failed to install the GPIO ISR service");
+        return res;
+    }
+
+    ESP_LOGI(TAG, "Initialization complete, decoding on GPIO interrupts");
+#endif
     return ESP_OK;
 }
 
@@ -178,18 +317,51 @@ esp_err_t rotary_encoder_add(rotary_encoder_t *re)
     memset(&io_conf, 0, sizeof(gpio_config_t));
     io_conf.mode = GPIO_MODE_INPUT;
     io_conf.pull_up_en = GPIO_PULLUP_ENABLE;
+#if CONFIG_RE_BACKEND_POLL
     io_conf.intr_type = GPIO_INTR_DISABLE;
+#else
+    io_conf.intr_type = GPIO_INTR_ANYEDGE;
+#endif
     io_conf.pin_bit_mask = GPIO_BIT(re->pin_a) | GPIO_BIT(re->pin_b);
     if (re->pin_btn < GPIO_NUM_MAX)
         io_conf.pin_bit_mask |= GPIO_BIT(re->pin_btn);
     CHECK(gpio_config(&io_conf));
 
+    re_decoder_init(&re->decoder, read_state(re));
     re->btn_state = RE_BTN_RELEASED;
     re->btn_pressed_time_us = 0;
+    re->btn_settling = false;
+
+#if CONFIG_RE_BACKEND_INTR
+    esp_err_t res = ESP_OK;
+    if (re->pin_btn < GPIO_NUM_MAX)
+    {
+        const esp_timer_create_args_t btn_timer_args = {
+            .name = "__encoder_btn__",
+            .arg = re,
+            .callback = btn_timer_handler,
+            .dispatch_method = ESP_TIMER_TASK
+        };
+        res = esp_timer_create(&btn_timer_args, &re->btn_timer);
+        if (res == ESP_OK)
+            res = gpio_isr_handler_add(re->pin_btn, btn_isr, re);
+    }
+    if (res == ESP_OK)
+        res = gpio_isr_handler_add(re->pin_a, rotation_isr, re);
+    if (res == ESP_OK)
+        res = gpio_isr_handler_add(re->pin_b, rotation_isr, re);
+    if (res != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to set up the interrupts of encoder %u", (unsigned)re->index);
+        encs[re->index] = NULL;
+        xSemaphoreGive(mutex);
+        return res;
+    }
+#endif
 
     xSemaphoreGive(mutex);
 
-    ESP_LOGI(TAG, "Added rotary encoder %d, A: %d, B: %d, BTN: %d", re->index, re->pin_a, re->pin_b, re->pin_btn);
+    ESP_LOGI(TAG, "Added rotary encoder %u, A: %d, B: %d, BTN: %d", (unsigned)re->index, re->pin_a, re->pin_b, re->pin_btn);
     return ESP_OK;
 }
 
@@ -206,7 +378,17 @@ esp_err_t rotary_encoder_remove(rotary_encoder_t *re)
         if (encs[i] == re)
         {
             encs[i] = NULL;
-            ESP_LOGI(TAG, "Removed rotary encoder %d", i);
+#if CONFIG_RE_BACKEND_INTR
+            gpio_isr_handler_remove(re->pin_a);
+            gpio_isr_handler_remove(re->pin_b);
+            if (re->pin_btn < GPIO_NUM_MAX)
+            {
+                gpio_isr_handler_remove(re->pin_btn);
+                esp_timer_stop(re->btn_timer);
+                esp_timer_delete(re->btn_timer);
+            }
+#endif
+            ESP_LOGI(TAG, "Removed rotary encoder %u", (unsigned)i);
             xSemaphoreGive(mutex);
             return ESP_OK;
         }
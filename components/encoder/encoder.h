@@ -3,7 +3,10 @@
  * @defgroup encoder encoder
  * @{
  *
- * ESP-IDF HW timer-based driver for rotary encoders
+ * ESP-IDF driver for rotary encoders
+ *
+ * The encoder pins are decoded on GPIO edge interrupts (RE_BACKEND_INTR) or
+ * sampled by a HW timer every CONFIG_RE_INTERVAL_US (RE_BACKEND_POLL).
  *
  * Copyright (C) 2019 Ruslan V. Uss <unclerus@gmail.com>
  *
@@ -16,6 +19,8 @@
 #include <driver/gpio.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
+#include <esp_timer.h>
+#include "re_decoder.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,11 +41,12 @@ typedef enum {
 typedef struct
 {
     gpio_num_t pin_a, pin_b, pin_btn; //!< Encoder pins. pin_btn can be >= GPIO_NUM_MAX if no button used
-    uint8_t code;
-    uint16_t store;
+    re_decoder_t decoder;
     size_t index;
     uint64_t btn_pressed_time_us;
     rotary_encoder_btn_state_t btn_state;
+    bool btn_settling;
+    esp_timer_handle_t btn_timer;
 } rotary_encoder_t;
 
 /**
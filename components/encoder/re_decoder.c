@@ -0,0 +1,55 @@
+/**
+ * @file re_decoder.c
+ *
+ * Quadrature decoder core of the rotary encoder driver
+ */
+#include "re_decoder.h"
+
+// Position of each state in the clockwise cycle 11 -> 01 -> 00 -> 10 (A, B)
+static const uint8_t position[4] = { 2, 3, 1, 0 };
+
+void re_decoder_init(re_decoder_t *d, uint8_t state)
+{
+    d->state = state & 3;
+    d->dir = 0;
+    d->quarters = 0;
+    d->skipped = 0;
+}
+
+int32_t re_decoder_feed(re_decoder_t *d, uint8_t state)
+{
+    state &= 3;
+
+    int8_t step;
+    switch ((position[state] - position[d->state]) & 3)
+    {
+        case 1:
+            step = 1;
+            break;
+        case 3:
+            step = -1;
+            break;
+        case 2:
+            // Both pins changed: one edge was missed, keep turning the same way
+            step = 2 * d->dir;
+            d->skipped++;
+            break;
+        default:
+            return 0;
+    }
+
+    d->state = state;
+    if (step > 0)
+        d->dir = 1;
+    else if (step < 0)
+        d->dir = -1;
+    d->quarters += step;
+
+    if (state != RE_DECODER_REST)
+        return 0;
+
+    // Back at rest: round to whole detents, what's left over was bounce
+    int32_t detents = (d->quarters + (d->quarters >= 0 ? 2 : -2)) / 4;
+    d->quarters = 0;
+    return detents;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file re_decoder.h
+ * @defgroup re_decoder re_decoder
+ * @{
+ *
+ * Quadrature decoder core of the rotary encoder driver
+ *
+ * Plain C without ESP-IDF dependencies: it's fed with the A/B levels after
+ * every change, whatever observes them (GPIO interrupts, a polling timer
+ * or a synthetic edge stream on the host).
+ *
+ * The encoder is expected to rest on A = B = 1 between detents, a full
+ * detent being four quarter steps. A state two quarter steps away from the
+ * previous one means an edge was missed; it's counted in the direction of
+ * the last step. Contact bounce adds and removes the same quarter step, so
+ * it cancels out by the time the encoder is back at rest.
+ */
+#ifndef __RE_DECODER_H__
+#define __RE_DECODER_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RE_DECODER_STATE(a, b) ((uint8_t)(((a) ? 1 : 0) | ((b) ? 2 : 0)))  //!< State from the pin levels
+#define RE_DECODER_REST RE_DECODER_STATE(1, 1)                             //!< State between detents
+
+/**
+ * Decoder state
+ */
+typedef struct
+{
+    uint8_t state;      //!< Last A/B state, see RE_DECODER_STATE
+    int8_t dir;         //!< Direction of the last quarter step
+    int16_t quarters;   //!< Quarter steps since the encoder left the rest state
+    uint32_t skipped;   //!< Missed edges guessed from the direction
+} re_decoder_t;
+
+/**
+ * Reset a decoder
+ * @param d Decoder
+ * @param state Current A/B state
+ */
+void re_decoder_init(re_decoder_t *d, uint8_t state);
+
+/**
+ * Feed a decoder with the current A/B state
+ * @param d Decoder
+ * @param state A/B state, see RE_DECODER_STATE
+ * @return Detents completed by this change: positive clockwise, negative counterclockwise
+ */
+int32_t re_decoder_feed(re_decoder_t *d, uint8_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __RE_DECODER_H__ */
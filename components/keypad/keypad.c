@@ -0,0 +1,176 @@
+/**
+ * @file keypad.c
+ *
+ * ESP-IDF GPIO interrupt driven keypad with debouncing and an event queue
+ */
+#include "keypad.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <string.h>
+
+#ifdef CONFIG_KEYPAD_PRESSED_LEVEL_0
+    #define KEYPAD_PRESSED_LEVEL 0
+#else
+    #define KEYPAD_PRESSED_LEVEL 1
+#endif
+
+static const char *TAG = "KEYPAD";
+
+#define GPIO_BIT(x) ((x) < 32 ? BIT(x) : ((uint64_t)(((uint64_t)1)<<(x))))
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+// Must be called with kp->mux held
+static inline bool push_event(keypad_t *kp, keypad_key_t *k)
+{
+    uint8_t next = (kp->head + 1) % CONFIG_KEYPAD_QUEUE_LEN;
+    if (next == kp->tail)
+    {
+        kp->dropped++;
+        return false;
+    }
+
+    kp->events[kp->head].key = k->key;
+    kp->events[kp->head].pressed = k->level == KEYPAD_PRESSED_LEVEL;
+    kp->head = next;
+    return true;
+}
+
+// The ISR service is installed without ESP_INTR_FLAG_IRAM: the handler may run flash code
+static void keypad_isr(void *arg)
+{
+    keypad_key_t *k = (keypad_key_t *)arg;
+    keypad_t *kp = k->owner;
+    int64_t now = esp_timer_get_time();
+    bool queued = false;
+
+    portENTER_CRITICAL_ISR(&kp->mux);
+    if (k->settling)
+    {
+        // Bounce, wait for the pin to be quiet again
+        k->edge_us = now;
+    }
+    else
+    {
+        uint8_t level = gpio_get_level(k->pin);
+        if (level != k->level)
+        {
+            k->level = level;
+            k->settling = true;
+            k->edge_us = now;
+            queued = push_event(kp, k);
+        }
+    }
+    portEXIT_CRITICAL_ISR(&kp->mux);
+
+    if (queued && kp->event_cb)
+        kp->event_cb(kp);
+}
+
+// Ends the bounce windows which are over. A bounce can end on the other level
+// than the edge which started it: queue that transition too.
+static void settle(keypad_t *kp)
+{
+    int64_t now = esp_timer_get_time();
+
+    for (size_t i = 0; i < kp->key_cnt; i++)
+    {
+        keypad_key_t *k = &kp->keys[i];
+
+        portENTER_CRITICAL(&kp->mux);
+        if (k->settling && now - k->edge_us >= CONFIG_KEYPAD_DEBOUNCE_US)
+        {
+            k->settling = false;
+            uint8_t level = gpio_get_level(k->pin);
+            if (level != k->level)
+            {
+                k->level = level;
+                k->settling = true;
+                k->edge_us = now;
+                push_event(kp, k);
+            }
+        }
+        portEXIT_CRITICAL(&kp->mux);
+    }
+}
+
+esp_err_t keypad_init(keypad_t *kp)
+{
+    CHECK_ARG(kp && kp->keys && kp->key_cnt);
+
+    kp->head = kp->tail = 0;
+    kp->last_key = 0;
+    kp->dropped = 0;
+    kp->mux = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
+
+    gpio_config_t io_conf;
+    memset(&io_conf, 0, sizeof(gpio_config_t));
+    io_conf.mode = GPIO_MODE_INPUT;
+    io_conf.pull_up_en = KEYPAD_PRESSED_LEVEL ? GPIO_PULLUP_DISABLE : GPIO_PULLUP_ENABLE;
+    io_conf.pull_down_en = KEYPAD_PRESSED_LEVEL ? GPIO_PULLDOWN_ENABLE : GPIO_PULLDOWN_DISABLE;
+    io_conf.intr_type = GPIO_INTR_ANYEDGE;
+    for (size_t i = 0; i < kp->key_cnt; i++)
+        io_conf.pin_bit_mask |= GPIO_BIT(kp->keys[i].pin);
+    CHECK(gpio_config(&io_conf));
+
+    // The service is shared with other drivers, it may be installed already
+    esp_err_t res = gpio_install_isr_service(0);
+    if (res != ESP_OK && res != ESP_ERR_INVALID_STATE)
+    {
+        ESP_LOGE(TAG, "Failed to install the GPIO ISR service");
+        return res;
+    }
+
+    for (size_t i = 0; i < kp->key_cnt; i++)
+    {
+        keypad_key_t *k = &kp->keys[i];
+        k->owner = kp;
+        k->level = gpio_get_level(k->pin);
+        k->settling = false;
+        k->edge_us = 0;
+        CHECK(gpio_isr_handler_add(k->pin, keypad_isr, k));
+    }
+
+    ESP_LOGI(TAG, "Added keypad of %d keys, debounce: %dms", (int)kp->key_cnt, CONFIG_KEYPAD_DEBOUNCE_US / 1000);
+    return ESP_OK;
+}
+
+bool keypad_read(keypad_t *kp, keypad_event_t *ev)
+{
+    settle(kp);
+
+    portENTER_CRITICAL(&kp->mux);
+    if (kp->tail != kp->head)
+    {
+        *ev = kp->events[kp->tail];
+        kp->tail = (kp->tail + 1) % CONFIG_KEYPAD_QUEUE_LEN;
+        kp->last_key = ev->key;
+    }
+    else
+    {
+        ev->key = kp->last_key;
+        ev->pressed = false;
+        for (size_t i = 0; i < kp->key_cnt; i++)
+            if (kp->keys[i].key == kp->last_key && kp->keys[i].level == KEYPAD_PRESSED_LEVEL)
+                ev->pressed = true;
+    }
+    bool more = kp->tail != kp->head;
+    portEXIT_CRITICAL(&kp->mux);
+
+    return more;
+}
+
+bool keypad_is_idle(keypad_t *kp)
+{
+    bool idle = true;
+
+    portENTER_CRITICAL(&kp->mux);
+    if (kp->tail != kp->head)
+        idle = false;
+    for (size_t i = 0; i < kp->key_cnt && idle; i++)
+        if (kp->keys[i].settling || kp->keys[i].level == KEYPAD_PRESSED_LEVEL)
+            idle = false;
+    portEXIT_CRITICAL(&kp->mux);
+
+    return idle;
+}
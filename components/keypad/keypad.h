@@ -0,0 +1,107 @@
+/**
+ * @file keypad.h
+ * @defgroup keypad keypad
+ * @{
+ *
+ * ESP-IDF GPIO interrupt driven keypad with debouncing and an event queue
+ *
+ * Every edge of a key pin raises an interrupt. The first edge after a quiet
+ * period is taken as the new key state right away; the edges following it
+ * within CONFIG_KEYPAD_DEBOUNCE_US are contact bounce and only push the end
+ * of the bounce window further. Once the pin is quiet, the next keypad_read()
+ * checks that the level still matches and queues the missing transition if
+ * the bounce ended on the other level.
+ *
+ * Presses and releases are queued in order, so a key tapped faster than the
+ * reader polls is still seen pressed and released.
+ */
+#ifndef __KEYPAD_H__
+#define __KEYPAD_H__
+
+#include <stdbool.h>
+#include <esp_err.h>
+#include <driver/gpio.h>
+#include <freertos/FreeRTOS.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct keypad;
+
+/**
+ * Called from the interrupt when an event was queued, e.g. to wake the reader
+ */
+typedef void (*keypad_event_cb_t)(struct keypad *kp);
+
+/**
+ * Key descriptor
+ */
+typedef struct
+{
+    gpio_num_t pin;             //!< Key pin
+    uint32_t key;               //!< Code reported in the events, e.g. LV_KEY_UP
+    struct keypad *owner;
+    uint8_t level;
+    bool settling;
+    int64_t edge_us;
+} keypad_key_t;
+
+/**
+ * Key event
+ */
+typedef struct
+{
+    uint32_t key;               //!< Code of the key
+    bool pressed;               //!< true: pressed, false: released
+} keypad_event_t;
+
+/**
+ * Keypad descriptor: a set of keys sharing an event queue
+ */
+typedef struct keypad
+{
+    keypad_key_t *keys;         //!< Keys, the array must stay valid while the keypad is in use
+    size_t key_cnt;             //!< Number of keys
+    keypad_event_cb_t event_cb; //!< Optional, called from the interrupt after an event is queued
+    void *user_data;            //!< Free for the user
+    keypad_event_t events[CONFIG_KEYPAD_QUEUE_LEN];
+    volatile uint8_t head, tail;
+    uint32_t last_key;
+    uint32_t dropped;           //!< Events lost because the queue was full
+    portMUX_TYPE mux;
+} keypad_t;
+
+/**
+ * Set up the pins and interrupts of a keypad.
+ * `keys`, `key_cnt`, `event_cb` and `user_data` must be set, the rest is initialized here.
+ * @param kp Keypad descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t keypad_init(keypad_t *kp);
+
+/**
+ * Take the oldest event of a keypad. With an empty queue `ev` holds the last
+ * key and whether it's still pressed.
+ * Not reentrant: one reader per keypad.
+ * @param kp Keypad descriptor
+ * @param ev Event
+ * @return true if more events are waiting (the return value of an LittlevGL `read_cb`)
+ */
+bool keypad_read(keypad_t *kp, keypad_event_t *ev);
+
+/**
+ * Check if a keypad has nothing to report: no queued event, no key pressed and
+ * no key bouncing. The reader can stop polling until `event_cb` is called.
+ * @param kp Keypad descriptor
+ * @return true if idle
+ */
+bool keypad_is_idle(keypad_t *kp);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __KEYPAD_H__ */
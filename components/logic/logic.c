@@ -0,0 +1,232 @@
+/**
+ * @file logic.c
+ *
+ * Logic input capture: run-length buffer, trigger and decimated view
+ */
+#include "logic.h"
+#include <string.h>
+
+#define RUN_LEVEL_SHIFT 24
+#define RUN(level, len) ((uint32_t)(level) << RUN_LEVEL_SHIFT | (len))
+#define RUN_LEVEL(run)  ((uint8_t)((run) >> RUN_LEVEL_SHIFT))
+#define RUN_LEN(run)    ((run) & LOGIC_RUN_LEN_MAX)
+#define REPEAT4(b)      ((uint32_t)(b) * 0x01010101u)
+
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+// First sample from `i` whose channels of `mask` aren't `level`, `n` if none
+static inline size_t scan_run(const uint8_t *samples, size_t i, size_t n, uint8_t level, uint8_t mask)
+{
+    const uint32_t level4 = REPEAT4(level), mask4 = REPEAT4(mask);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        uint32_t w;
+        memcpy(&w, samples + i, 4);
+        if ((w ^ level4) & mask4)
+            break;
+    }
+    while (i < n && (samples[i] & mask) == level)
+        i++;
+
+    return i;
+}
+
+static bool triggered(const logic_trigger_t *trig, uint8_t prev, uint8_t next)
+{
+    uint8_t bit = 1 << trig->channel;
+
+    switch (trig->type)
+    {
+        case LOGIC_TRIG_RISING:
+            return !(prev & bit) && (next & bit);
+        case LOGIC_TRIG_FALLING:
+            return (prev & bit) && !(next & bit);
+        case LOGIC_TRIG_EDGE:
+            return (prev ^ next) & bit;
+        case LOGIC_TRIG_PATTERN:
+            return (next & trig->mask) == trig->value && (prev & trig->mask) != trig->value;
+        default:
+            return false;
+    }
+}
+
+// Appends a run. A full buffer drops its oldest run, unless the capture is triggered and
+// the run is in the window: then the buffer is left as it is and false returned.
+static bool push_run(logic_t *lg, uint32_t run, logic_state_t state)
+{
+    if (lg->count == CONFIG_LOGIC_RUN_COUNT)
+    {
+        uint32_t oldest = lg->runs[lg->head];
+        if (state == LOGIC_TRIGGERED && lg->first + RUN_LEN(oldest) > lg->trigger_pos - lg->capture.pre_samples)
+            return false;
+
+        lg->first += RUN_LEN(oldest);
+        lg->head = (lg->head + 1) % CONFIG_LOGIC_RUN_COUNT;
+        lg->count--;
+        lg->dropped++;
+    }
+
+    lg->runs[(lg->head + lg->count) % CONFIG_LOGIC_RUN_COUNT] = run;
+    lg->count++;
+    lg->runs_total++;
+
+    return true;
+}
+
+// Ends a triggered capture with its open run, or where that run started if it doesn't fit
+static void finish(logic_t *lg)
+{
+    if (lg->run_len && !push_run(lg, RUN(lg->level, lg->run_len), LOGIC_TRIGGERED))
+        lg->pos -= lg->run_len;
+    lg->run_len = 0;
+    lg->end = lg->pos;
+    lg->captures++;
+
+    // The buffer is complete before the reader can see it done
+    __atomic_store_n(&lg->state, LOGIC_DONE, __ATOMIC_RELEASE);
+}
+
+esp_err_t logic_begin(logic_t *lg, const logic_capture_t *cap)
+{
+    CHECK_ARG(lg && cap && cap->trigger.type < LOGIC_TRIG_MAX && cap->trigger.channel < LOGIC_CHANNELS);
+    CHECK_ARG((uint64_t)cap->pre_samples + cap->post_samples <= LOGIC_WINDOW_MAX);
+
+    lg->capture = *cap;
+    lg->head = 0;
+    lg->count = 0;
+    lg->first = 0;
+    lg->pos = 0;
+    lg->run_len = 0;
+    lg->level = 0;
+
+    if (cap->trigger.type == LOGIC_TRIG_NONE)
+    {
+        // The window is the first samples: never longer than a run, see LOGIC_WINDOW_MAX
+        lg->trigger_pos = cap->pre_samples;
+        lg->end = lg->trigger_pos + cap->post_samples;
+        __atomic_store_n(&lg->state, LOGIC_TRIGGERED, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        lg->trigger_pos = 0;
+        lg->end = 0;
+        __atomic_store_n(&lg->state, LOGIC_ARMED, __ATOMIC_RELEASE);
+    }
+
+    return ESP_OK;
+}
+
+size_t logic_feed(logic_t *lg, const uint8_t *samples, size_t n)
+{
+    // Only the feeding side moves the state while a capture runs
+    logic_state_t state = __atomic_load_n(&lg->state, __ATOMIC_RELAXED);
+    if ((state != LOGIC_ARMED && state != LOGIC_TRIGGERED) || n == 0)
+        return 0;
+
+    const uint8_t mask = lg->channels;
+    size_t i = 0;
+
+    if (lg->run_len == 0 && lg->count == 0)
+        lg->level = samples[0] & mask;
+
+    for (;;)
+    {
+        size_t limit = n;
+        if (state == LOGIC_TRIGGERED && lg->end - lg->pos < n - i)
+            limit = i + (size_t)(lg->end - lg->pos);
+
+        size_t next = scan_run(samples, i, limit, lg->level, mask);
+        size_t len = next - i;
+        lg->pos += len;
+        i = next;
+
+        // Only while armed can a run outgrow LOGIC_RUN_LEN_MAX, the window is shorter
+        while (lg->run_len + len > LOGIC_RUN_LEN_MAX)
+        {
+            len -= LOGIC_RUN_LEN_MAX - lg->run_len;
+            push_run(lg, RUN(lg->level, LOGIC_RUN_LEN_MAX), state);
+            lg->run_len = 0;
+        }
+        lg->run_len += len;
+
+        if (state == LOGIC_TRIGGERED && lg->pos == lg->end)
+        {
+            finish(lg);
+            break;
+        }
+        if (i == n)
+            break;
+
+        // A change: close the run, then look for the trigger on it
+        uint8_t level = samples[i] & mask;
+        if (!push_run(lg, RUN(lg->level, lg->run_len), state))
+        {
+            finish(lg);     // Full: the window ends before this run
+            break;
+        }
+
+        if (state == LOGIC_ARMED && lg->pos >= lg->capture.pre_samples &&
+            triggered(&lg->capture.trigger, lg->level, level))
+        {
+            lg->trigger_pos = lg->pos;
+            lg->end = lg->pos + lg->capture.post_samples;
+            state = LOGIC_TRIGGERED;
+            __atomic_store_n(&lg->state, state, __ATOMIC_RELAXED);
+        }
+
+        lg->level = level;
+        lg->run_len = 0;
+    }
+
+    lg->samples += i;
+    return i;
+}
+
+logic_state_t logic_get_state(logic_t *lg)
+{
+    return __atomic_load_n(&lg->state, __ATOMIC_ACQUIRE);
+}
+
+esp_err_t logic_view(logic_t *lg, logic_column_t *cols, size_t n_cols, size_t *trigger_col)
+{
+    CHECK_ARG(lg && cols && n_cols);
+    // A pending logic_arm() would clear the buffer under the view
+    if (logic_get_state(lg) != LOGIC_DONE || lg->arm_pending)
+        return ESP_ERR_INVALID_STATE;
+
+    const uint64_t start = lg->trigger_pos - lg->capture.pre_samples;
+    const uint64_t span = (uint64_t)lg->capture.pre_samples + lg->capture.post_samples;
+    const uint64_t stop = lg->end < start + span ? lg->end : start + span;
+
+    memset(cols, 0, n_cols * sizeof(logic_column_t));
+    if (trigger_col)
+        *trigger_col = span ? (size_t)((uint64_t)lg->capture.pre_samples * n_cols / span) : 0;
+    if (span == 0)
+        return ESP_OK;
+
+    // A run marks every column it overlaps: on a zoomed in view, a sample spans several
+    uint64_t from = lg->first;
+    for (uint32_t k = 0, idx = lg->head; k < lg->count && from < stop; k++, idx = (idx + 1) % CONFIG_LOGIC_RUN_COUNT)
+    {
+        uint32_t run = lg->runs[idx];
+        uint64_t to = from + RUN_LEN(run);
+        if (to > start)
+        {
+            uint64_t a = (from > start ? from : start) - start;
+            uint64_t b = (to < stop ? to : stop) - start;
+            size_t c0 = (size_t)(a * n_cols / span);
+            size_t c1 = (size_t)((b * n_cols + span - 1) / span);
+            uint8_t high = RUN_LEVEL(run), low = ~high & lg->channels;
+
+            for (size_t c = c0; c < c1; c++)
+            {
+                cols[c].high |= high;
+                cols[c].low |= low;
+            }
+        }
+        from = to;
+    }
+
+    return ESP_OK;
+}
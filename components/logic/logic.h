@@ -0,0 +1,249 @@
+/**
+ * @file logic.h
+ * @defgroup logic logic
+ * @{
+ *
+ * Logic input capture
+ *
+ * A source samples up to 8 inputs at a fixed rate, one byte per sample with
+ * channel i in bit i, and hands them over in blocks of CONFIG_LOGIC_BLOCK_LEN
+ * samples. On the target the source is I2S1 in camera mode fed by DMA, see
+ * logic_source_i2s_init(); anything else which delivers blocks in real time,
+ * like the synthetic bitstreams of the host simulator, can stand in for it.
+ *
+ * The capture keeps runs rather than samples: a level and the number of
+ * samples it lasted, in a circular buffer of CONFIG_LOGIC_RUN_COUNT words.
+ * While a block is fed it's scanned four samples at a time for the next
+ * change, and the trigger is only looked at on a change, so a slow signal
+ * costs little more than the scan and fills the buffer slowly.
+ *
+ * A capture is armed with a trigger and a window of samples before and after
+ * it. While armed, the oldest runs make room for the new ones; once
+ * triggered, the capture goes on for the samples after the trigger, or until
+ * the buffer is full, then it's done. logic_view() decimates the window of a
+ * capture done to one column per pixel.
+ *
+ * The capture task, started by logic_start(), reads the source and feeds the
+ * capture; logic_arm() hands it the next capture. Without the task, e.g. on
+ * the host, logic_begin() and logic_feed() drive a capture directly.
+ */
+#ifndef __LOGIC_H__
+#define __LOGIC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <esp_err.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOGIC_CHANNELS      8           //!< Inputs of a sample, one bit each
+#define LOGIC_RUN_LEN_MAX   0xFFFFFF    //!< Longest run, longer ones are split
+#define LOGIC_WINDOW_MAX    LOGIC_RUN_LEN_MAX   //!< Longest capture, samples before and after the trigger
+
+struct logic_source;
+
+/**
+ * Source of the samples
+ */
+typedef struct logic_source
+{
+    /**
+     * Start sampling at `sample_rate` in blocks of `block_len` samples, clear the counter
+     */
+    esp_err_t (*start)(struct logic_source *src, uint32_t sample_rate, size_t block_len);
+    /**
+     * Wait for the next block, up to `timeout_ms`. The samples stay valid until the next read().
+     * `ESP_ERR_TIMEOUT` if there was none.
+     */
+    esp_err_t (*read)(struct logic_source *src, const uint8_t **block, uint32_t timeout_ms);
+    /**
+     * Stop sampling, no read() is in progress
+     */
+    void (*stop)(struct logic_source *src);
+    void *ctx;                      //!< Free for the source
+    volatile uint32_t overruns;     //!< Blocks lost because read() came too late, counted by the source
+} logic_source_t;
+
+/**
+ * Trigger conditions
+ */
+typedef enum
+{
+    LOGIC_TRIG_NONE = 0,    //!< Free running: the window starts with the capture
+    LOGIC_TRIG_RISING,      //!< A rising edge of `channel`
+    LOGIC_TRIG_FALLING,     //!< A falling edge of `channel`
+    LOGIC_TRIG_EDGE,        //!< Either edge of `channel`
+    LOGIC_TRIG_PATTERN,     //!< The channels of `mask` become `value`
+    LOGIC_TRIG_MAX
+} logic_trigger_type_t;
+
+/**
+ * Trigger
+ */
+typedef struct
+{
+    logic_trigger_type_t type;
+    uint8_t channel;        //!< Channel of the edges
+    uint8_t mask;           //!< Channels of the pattern
+    uint8_t value;          //!< Levels of the pattern
+} logic_trigger_t;
+
+/**
+ * Capture settings
+ */
+typedef struct
+{
+    logic_trigger_t trigger;
+    uint32_t pre_samples;   //!< Window before the trigger, captured before the trigger is looked for
+    uint32_t post_samples;  //!< Window after the trigger
+} logic_capture_t;
+
+/**
+ * State of a capture
+ */
+typedef enum
+{
+    LOGIC_IDLE = 0,         //!< Not armed
+    LOGIC_ARMED,            //!< Looking for the trigger
+    LOGIC_TRIGGERED,        //!< Capturing the samples after the trigger
+    LOGIC_DONE,             //!< Ready for logic_view(), until armed again
+} logic_state_t;
+
+/**
+ * A column of a decimated view
+ */
+typedef struct
+{
+    uint8_t high;           //!< Channels high at some sample of the column
+    uint8_t low;            //!< Channels low at some sample of the column
+} logic_column_t;
+
+/**
+ * Capture descriptor
+ */
+typedef struct
+{
+    logic_source_t *source;         //!< Where the samples come from, for the capture task
+    uint32_t sample_rate;           //!< Samples per second
+    uint8_t channels;               //!< Channels captured, bit i is channel i; the others read low
+    TaskHandle_t task;
+    volatile bool running;
+    logic_capture_t capture;        //!< Settings of the capture
+    logic_capture_t request;        //!< Settings of the next capture, taken by the task
+    volatile bool arm_pending;      //!< `request` is waiting for the task
+    logic_state_t state;            //!< Read and written atomically
+    uint32_t runs[CONFIG_LOGIC_RUN_COUNT];  //!< Runs, level << 24 | length, closed ones only
+    uint32_t head;                  //!< Oldest run
+    uint32_t count;                 //!< Runs in the buffer
+    uint64_t first;                 //!< Sample where the oldest run starts
+    uint64_t pos;                   //!< Samples fed since the capture began
+    uint64_t trigger_pos;           //!< Sample of the trigger
+    uint64_t end;                   //!< Sample after the last one of the window
+    uint32_t run_len;               //!< Length of the open run, 0 before the first sample
+    uint8_t level;                  //!< Level of the open run
+    volatile uint32_t samples;      //!< Samples fed
+    volatile uint32_t runs_total;   //!< Runs closed
+    volatile uint32_t dropped;      //!< Runs dropped from the full buffer while armed
+    volatile uint32_t captures;     //!< Captures done
+} logic_t;
+
+/**
+ * Capture statistics
+ */
+typedef struct
+{
+    uint32_t samples;               //!< Samples fed
+    uint32_t runs;                  //!< Runs closed
+    uint32_t dropped;               //!< Runs dropped from the full buffer while armed
+    uint32_t captures;              //!< Captures done
+    uint32_t overruns;              //!< Blocks lost by the source
+} logic_stats_t;
+
+/**
+ * Clear the buffer and arm a capture. The capture task calls it for logic_arm(),
+ * call it directly only when there is no task.
+ * @param lg Capture descriptor, `channels` set
+ * @param cap Settings, `pre_samples + post_samples` up to LOGIC_WINDOW_MAX
+ * @return `ESP_OK` on success
+ */
+esp_err_t logic_begin(logic_t *lg, const logic_capture_t *cap);
+
+/**
+ * Capture a block of samples
+ * @param lg Capture descriptor
+ * @param samples Samples, channel i in bit i
+ * @param n Number of samples
+ * @return Samples taken: fewer than `n` when the capture ended in the block,
+ *         none when it isn't armed
+ */
+size_t logic_feed(logic_t *lg, const uint8_t *samples, size_t n);
+
+/**
+ * Get the state of the capture
+ * @param lg Capture descriptor
+ * @return State
+ */
+logic_state_t logic_get_state(logic_t *lg);
+
+/**
+ * Decimate the window of a capture done: column c covers samples
+ * [c * W / n_cols, (c + 1) * W / n_cols) of the W of the window, the
+ * samples the buffer didn't keep are neither high nor low.
+ * @param lg Capture descriptor
+ * @param cols Columns
+ * @param n_cols Number of columns
+ * @param trigger_col Column of the trigger, may be NULL
+ * @return `ESP_OK` on success, `ESP_ERR_INVALID_STATE` if the capture isn't done or is being re-armed
+ */
+esp_err_t logic_view(logic_t *lg, logic_column_t *cols, size_t n_cols, size_t *trigger_col);
+
+/**
+ * Start the source and the capture task, idle.
+ * `source`, `sample_rate` and `channels` must be set, the rest is initialized here.
+ * @param lg Capture descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t logic_start(logic_t *lg);
+
+/**
+ * Stop the capture task after the block being fed, then the source
+ * @param lg Capture descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t logic_stop(logic_t *lg);
+
+/**
+ * Arm the next capture, from the task's next block. The capture in progress is dropped.
+ * @param lg Capture descriptor, started
+ * @param cap Settings, copied
+ * @return `ESP_OK` on success, `ESP_ERR_INVALID_STATE` if the previous request wasn't taken yet
+ */
+esp_err_t logic_arm(logic_t *lg, const logic_capture_t *cap);
+
+/**
+ * Get the statistics since the capture task was started
+ * @param lg Capture descriptor
+ * @param stats Statistics
+ */
+void logic_get_stats(logic_t *lg, logic_stats_t *stats);
+
+/**
+ * Set up a source sampling CONFIG_LOGIC_PIN_0..3 as channels 0..3 through
+ * I2S1 in camera mode, clocked by the LEDC on CONFIG_LOGIC_CLOCK_PIN
+ * @param src Source descriptor
+ * @return `ESP_OK` on success
+ */
+esp_err_t logic_source_i2s_init(logic_source_t *src);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __LOGIC_H__ */
@@ -0,0 +1,275 @@
+/**
+ * @file logic_source_i2s.c
+ *
+ * Logic input source sampling four GPIOs through I2S1 in camera mode, fed by DMA
+ *
+ * In camera mode I2S takes its data lines on every edge of the pixel clock
+ * and writes them to memory by DMA. I2S0 drives the DAC, the inputs go to
+ * I2S1, which the I2S driver can't set up for camera mode: it's done on the
+ * registers. The pixel clock is generated by the LEDC on
+ * CONFIG_LOGIC_CLOCK_PIN and read back from the same pin through the GPIO
+ * matrix; the sync inputs are tied high so every clock takes a sample.
+ *
+ * The FIFO runs in its 16-bit single channel mode: a 32-bit word of the DMA
+ * buffer holds two samples, the first one in its upper half. The DMA goes
+ * round a ring of DMA_BUF_COUNT descriptors of one block each and raises
+ * in_suc_eof at the end of each. The interrupt queues the block for read(),
+ * which unpacks it to a byte per sample. The queue holds one block less than
+ * the ring: when it's full, the DMA has gone on into the buffer of the oldest
+ * block queued. The interrupt takes that one out, counts it as an overrun
+ * and queues the block just done, which is intact.
+ */
+#include "logic.h"
+#include <esp_log.h>
+#include <esp_intr_alloc.h>
+#include <esp_heap_caps.h>
+#include <freertos/queue.h>
+#include <driver/gpio.h>
+#include <driver/ledc.h>
+#include <driver/periph_ctrl.h>
+#include <soc/i2s_struct.h>
+#include <soc/i2s_reg.h>
+#include <soc/gpio_sig_map.h>
+#include <esp32/rom/lldesc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DMA_BUF_COUNT       4
+#define SOURCE_PIN_COUNT    4
+#define GPIO_MATRIX_LOW     0x30    // Constant input levels of the GPIO matrix
+#define GPIO_MATRIX_HIGH    0x38
+#define CLOCK_TIMER         LEDC_TIMER_3
+#define CLOCK_CHANNEL       LEDC_CHANNEL_7
+
+static const char *TAG = "LOGIC_I2S";
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+typedef struct
+{
+    logic_source_t *src;
+    lldesc_t *desc;             // DMA_BUF_COUNT descriptors in a ring
+    uint32_t *dma;              // Their buffers, one block each
+    uint8_t *samples;           // The block read last, unpacked
+    size_t block_len;
+    QueueHandle_t blocks;       // Indexes of the blocks done
+    intr_handle_t intr;
+} i2s_source_t;
+
+static i2s_source_t i2s_source;
+
+static const int source_pins[SOURCE_PIN_COUNT] = {
+    CONFIG_LOGIC_PIN_0, CONFIG_LOGIC_PIN_1, CONFIG_LOGIC_PIN_2, CONFIG_LOGIC_PIN_3
+};
+
+static void IRAM_ATTR i2s_source_isr(void *arg)
+{
+    i2s_source_t *s = (i2s_source_t *)arg;
+    uint32_t status = I2S1.int_st.val;
+    BaseType_t higher_prio_woken = pdFALSE;
+
+    I2S1.int_clr.val = status;
+    if (status & I2S_IN_SUC_EOF_INT_ST_M)
+    {
+        uint32_t idx = (lldesc_t *)I2S1.in_eof_des_addr - s->desc;
+        if (xQueueSendToBackFromISR(s->blocks, &idx, &higher_prio_woken) != pdTRUE)
+        {
+            // The oldest block is being written over, not this one
+            uint32_t lost;
+            if (xQueueReceiveFromISR(s->blocks, &lost, &higher_prio_woken) == pdTRUE)
+                s->src->overruns++;
+            xQueueSendToBackFromISR(s->blocks, &idx, &higher_prio_woken);
+        }
+    }
+
+    if (higher_prio_woken)
+        portYIELD_FROM_ISR();
+}
+
+static void i2s_source_pins(void)
+{
+    for (int i = 0; i < SOURCE_PIN_COUNT; i++)
+    {
+        gpio_set_direction(source_pins[i], GPIO_MODE_INPUT);
+        gpio_matrix_in(source_pins[i], I2S1I_DATA_IN0_IDX + i, false);
+    }
+    for (int i = SOURCE_PIN_COUNT; i < LOGIC_CHANNELS; i++)
+        gpio_matrix_in(GPIO_MATRIX_LOW, I2S1I_DATA_IN0_IDX + i, false);
+
+    gpio_matrix_in(GPIO_MATRIX_HIGH, I2S1I_V_SYNC_IDX, false);
+    gpio_matrix_in(GPIO_MATRIX_HIGH, I2S1I_H_SYNC_IDX, false);
+    gpio_matrix_in(GPIO_MATRIX_HIGH, I2S1I_H_ENABLE_IDX, false);
+}
+
+static esp_err_t i2s_source_clock(uint32_t sample_rate)
+{
+    const ledc_timer_config_t timer = {
+        .speed_mode = LEDC_HIGH_SPEED_MODE,
+        .duty_resolution = LEDC_TIMER_1_BIT,
+        .timer_num = CLOCK_TIMER,
+        .freq_hz = sample_rate,
+    };
+    const ledc_channel_config_t channel = {
+        .gpio_num = CONFIG_LOGIC_CLOCK_PIN,
+        .speed_mode = LEDC_HIGH_SPEED_MODE,
+        .channel = CLOCK_CHANNEL,
+        .timer_sel = CLOCK_TIMER,
+        .duty = 1,              // Half of the 1-bit period
+    };
+    CHECK(ledc_timer_config(&timer));
+    CHECK(ledc_channel_config(&channel));
+
+    // The LEDC drives the pin through the GPIO matrix, I2S1 reads it back from there
+    PIN_INPUT_ENABLE(GPIO_PIN_MUX_REG[CONFIG_LOGIC_CLOCK_PIN]);
+    gpio_matrix_in(CONFIG_LOGIC_CLOCK_PIN, I2S1I_WS_IN_IDX, false);
+
+    return ESP_OK;
+}
+
+static void i2s_source_reset(void)
+{
+    I2S1.conf.rx_reset = 1;
+    I2S1.conf.rx_reset = 0;
+    I2S1.conf.rx_fifo_reset = 1;
+    I2S1.conf.rx_fifo_reset = 0;
+    I2S1.lc_conf.in_rst = 1;
+    I2S1.lc_conf.in_rst = 0;
+    I2S1.lc_conf.ahbm_fifo_rst = 1;
+    I2S1.lc_conf.ahbm_fifo_rst = 0;
+    I2S1.lc_conf.ahbm_rst = 1;
+    I2S1.lc_conf.ahbm_rst = 0;
+}
+
+static void i2s_source_free(i2s_source_t *s)
+{
+    if (s->intr)
+        esp_intr_free(s->intr);
+    if (s->blocks)
+        vQueueDelete(s->blocks);
+    heap_caps_free(s->desc);
+    heap_caps_free(s->dma);
+    free(s->samples);
+    memset(s, 0, sizeof(*s));
+}
+
+static esp_err_t i2s_source_start(logic_source_t *src, uint32_t sample_rate, size_t block_len)
+{
+    i2s_source_t *s = (i2s_source_t *)src->ctx;
+    CHECK_ARG(block_len % 2 == 0 && block_len * 2 <= DMA_DESCRIPTOR_BUFFER_MAX_SIZE);
+
+    size_t dma_len = block_len * 2;     // Two bytes a sample
+    s->src = src;
+    s->block_len = block_len;
+    s->desc = heap_caps_calloc(DMA_BUF_COUNT, sizeof(lldesc_t), MALLOC_CAP_DMA);
+    s->dma = heap_caps_malloc(DMA_BUF_COUNT * dma_len, MALLOC_CAP_DMA);
+    s->samples = malloc(block_len);
+    s->blocks = xQueueCreate(DMA_BUF_COUNT - 1, sizeof(uint32_t));     // One buffer is the DMA's
+    if (!s->desc || !s->dma || !s->samples || !s->blocks)
+    {
+        i2s_source_free(s);
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < DMA_BUF_COUNT; i++)
+    {
+        s->desc[i].size = dma_len;
+        s->desc[i].length = dma_len;
+        s->desc[i].owner = 1;
+        s->desc[i].eof = 1;
+        s->desc[i].buf = (uint8_t *)s->dma + i * dma_len;
+        s->desc[i].qe.stqe_next = &s->desc[(i + 1) % DMA_BUF_COUNT];
+    }
+
+    periph_module_enable(PERIPH_I2S1_MODULE);
+    i2s_source_reset();
+
+    // Camera mode, clocked from outside
+    I2S1.conf.val = 0;
+    I2S1.conf.rx_slave_mod = 1;
+    I2S1.conf2.val = 0;
+    I2S1.conf2.lcd_en = 1;
+    I2S1.conf2.camera_en = 1;
+    I2S1.clkm_conf.clkm_div_a = 1;
+    I2S1.clkm_conf.clkm_div_b = 0;
+    I2S1.clkm_conf.clkm_div_num = 2;
+    I2S1.sample_rate_conf.rx_bck_div_num = 1;
+    I2S1.sample_rate_conf.rx_bits_mod = 0;
+    I2S1.timing.val = 0;
+    I2S1.timing.rx_dsync_sw = 1;
+
+    // 16-bit single channel: two samples a word, through DMA
+    I2S1.fifo_conf.dscr_en = 1;
+    I2S1.fifo_conf.rx_fifo_mod = 1;
+    I2S1.fifo_conf.rx_fifo_mod_force_en = 1;
+    I2S1.conf_chan.rx_chan_mod = 1;
+    I2S1.rx_eof_num = dma_len / sizeof(uint32_t);
+
+    esp_err_t res = esp_intr_alloc(ETS_I2S1_INTR_SOURCE, ESP_INTR_FLAG_IRAM, i2s_source_isr, s, &s->intr);
+    if (res == ESP_OK)
+        res = i2s_source_clock(sample_rate);
+    if (res != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to set up the capture: %d", res);
+        periph_module_disable(PERIPH_I2S1_MODULE);
+        i2s_source_free(s);
+        return res;
+    }
+    i2s_source_pins();
+
+    src->overruns = 0;
+    I2S1.in_link.addr = (uint32_t)&s->desc[0];
+    I2S1.in_link.start = 1;
+    I2S1.int_clr.val = I2S1.int_raw.val;
+    I2S1.int_ena.val = 0;
+    I2S1.int_ena.in_suc_eof = 1;
+    I2S1.conf.rx_start = 1;
+
+    ESP_LOGI(TAG, "Sampling at %u Hz, clock on GPIO%d", (unsigned)sample_rate, CONFIG_LOGIC_CLOCK_PIN);
+    return ESP_OK;
+}
+
+static esp_err_t i2s_source_read(logic_source_t *src, const uint8_t **block, uint32_t timeout_ms)
+{
+    i2s_source_t *s = (i2s_source_t *)src->ctx;
+    uint32_t idx;
+
+    if (xQueueReceive(s->blocks, &idx, timeout_ms / portTICK_PERIOD_MS) != pdTRUE)
+        return ESP_ERR_TIMEOUT;
+
+    const uint32_t *words = (const uint32_t *)s->desc[idx].buf;
+    for (size_t i = 0; i < s->block_len / 2; i++)
+    {
+        s->samples[2 * i] = (uint8_t)(words[i] >> 16);
+        s->samples[2 * i + 1] = (uint8_t)words[i];
+    }
+
+    *block = s->samples;
+    return ESP_OK;
+}
+
+static void i2s_source_stop(logic_source_t *src)
+{
+    i2s_source_t *s = (i2s_source_t *)src->ctx;
+
+    I2S1.conf.rx_start = 0;
+    I2S1.int_ena.val = 0;
+    I2S1.in_link.stop = 1;
+    ledc_stop(LEDC_HIGH_SPEED_MODE, CLOCK_CHANNEL, 0);
+    i2s_source_reset();
+    periph_module_disable(PERIPH_I2S1_MODULE);
+    i2s_source_free(s);
+}
+
+esp_err_t logic_source_i2s_init(logic_source_t *src)
+{
+    CHECK_ARG(src);
+
+    src->start = i2s_source_start;
+    src->read = i2s_source_read;
+    src->stop = i2s_source_stop;
+    src->ctx = &i2s_source;
+    src->overruns = 0;
+
+    return ESP_OK;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file logic_task.c
+ *
+ * Logic input capture task: reads the source and feeds the capture
+ */
+#include "logic.h"
+#include <esp_log.h>
+
+#define TASK_STACK_SIZE 3072
+#define STOP_POLL_MS    10
+#define READ_TIMEOUT_MS 100     // How late the task notices a stop when the source is silent
+
+static const char *TAG = "LOGIC";
+
+#define CHECK(x) do { esp_err_t __; if ((__ = x) != ESP_OK) return __; } while (0)
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+static void capture_task(void *arg)
+{
+    logic_t *lg = (logic_t *)arg;
+
+    while (lg->running)
+    {
+        // Between two blocks, the capture is only touched from here
+        if (__atomic_load_n(&lg->arm_pending, __ATOMIC_ACQUIRE))
+        {
+            logic_begin(lg, &lg->request);
+            __atomic_store_n(&lg->arm_pending, false, __ATOMIC_RELEASE);
+        }
+
+        const uint8_t *block;
+        esp_err_t res = lg->source->read(lg->source, &block, READ_TIMEOUT_MS);
+        if (res == ESP_ERR_TIMEOUT)
+            continue;
+        if (res != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Source read failed: %d", res);
+            break;
+        }
+
+        logic_feed(lg, block, CONFIG_LOGIC_BLOCK_LEN);
+    }
+
+    lg->running = false;
+    lg->task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t logic_start(logic_t *lg)
+{
+    CHECK_ARG(lg && lg->source && lg->sample_rate && lg->channels);
+    if (lg->task)
+        return ESP_ERR_INVALID_STATE;
+
+    CHECK(lg->source->start(lg->source, lg->sample_rate, CONFIG_LOGIC_BLOCK_LEN));
+
+    lg->arm_pending = false;
+    lg->state = LOGIC_IDLE;
+    lg->samples = 0;
+    lg->runs_total = 0;
+    lg->dropped = 0;
+    lg->captures = 0;
+    lg->running = true;
+    if (xTaskCreatePinnedToCore(capture_task, "logic", TASK_STACK_SIZE, lg, CONFIG_LOGIC_TASK_PRIORITY,
+                                &lg->task, CONFIG_LOGIC_TASK_CORE) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create the capture task");
+        lg->running = false;
+        lg->task = NULL;
+        lg->source->stop(lg->source);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Started, %u Hz, blocks of %d samples on core %d", (unsigned)lg->sample_rate,
+             CONFIG_LOGIC_BLOCK_LEN, CONFIG_LOGIC_TASK_CORE);
+    return ESP_OK;
+}
+
+esp_err_t logic_stop(logic_t *lg)
+{
+    CHECK_ARG(lg);
+    if (!lg->task)
+        return ESP_ERR_INVALID_STATE;
+
+    // The task finishes the block it's feeding, or gives up waiting for one
+    lg->running = false;
+    while (lg->task)
+        vTaskDelay(STOP_POLL_MS / portTICK_PERIOD_MS);
+
+    lg->source->stop(lg->source);
+    __atomic_store_n(&lg->state, LOGIC_IDLE, __ATOMIC_RELEASE);
+
+    ESP_LOGI(TAG, "Stopped");
+    return ESP_OK;
+}
+
+esp_err_t logic_arm(logic_t *lg, const logic_capture_t *cap)
+{
+    CHECK_ARG(lg && cap);
+    if (!lg->task || __atomic_load_n(&lg->arm_pending, __ATOMIC_ACQUIRE))
+        return ESP_ERR_INVALID_STATE;
+
+    lg->request = *cap;
+    __atomic_store_n(&lg->arm_pending, true, __ATOMIC_RELEASE);
+
+    return ESP_OK;
+}
+
+void logic_get_stats(logic_t *lg, logic_stats_t *stats)
+{
+    stats->samples = lg->samples;
+    stats->runs = lg->runs_total;
+    stats->dropped = lg->dropped;
+    stats->captures = lg->captures;
+    stats->overruns = lg->source->overruns;
+}
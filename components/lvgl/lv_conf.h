@@ -59,6 +59,19 @@
 #define LV_COLOR_16_SWAP   1
 #endif
 
+/* 1: The VDB of a 1 bit display is packed in pages like the SSD1306 RAM
+ * (8 vertical pixels per byte, LSB on top, bit set for black pixels).
+ * Fills, letters and images are written a byte at a time instead of calling `set_px_cb` for every pixel.
+ * Requires `LV_COLOR_DEPTH = 1` and a `rounder_cb` which aligns the areas to pages.
+ * Can be set on the command line: the draw benchmark of the simulator builds both. */
+#ifndef LV_VDB_MONO_PAGE
+#if defined CONFIG_LVGL_TFT_DISPLAY_CONTROLLER_SSD1306
+#define LV_VDB_MONO_PAGE   1
+#else
+#define LV_VDB_MONO_PAGE   0
+#endif
+#endif
+
 /* 1: Enable screen transparency.
  * Useful for OSD or other overlapping GUIs.
  * Requires `LV_COLOR_DEPTH = 32` colors and the screen's style should be modified: `style.body.opa = ...`*/
@@ -107,6 +120,32 @@ typedef int16_t lv_coord_t;
 
 /* Automatically defrag. on free. Defrag. means joining the adjacent free cells. */
 #  define LV_MEM_AUTO_DEFRAG  1
+
+/* 1: keep the free cells in lists by size (Two-Level Segregated Fit): allocation and free take a
+ * constant time, the free cells are always joined. 0: search the cells one by one from the start.
+ * Can be set on the command line: the memory benchmark of the simulator builds both. */
+#  ifndef LV_MEM_TLSF
+#  define LV_MEM_TLSF         1
+#  endif
+
+/* 1: Record every `lv_mem_alloc`, `lv_mem_realloc` and `lv_mem_free`: call site, size and time, in a ring
+ * of the last `LV_MEM_TRACE_CNT` (16 bytes each). `lv_mem_trace_dump()` writes them with the used entries,
+ * for `mem_prof` of the simulator to replay the fragmentation and find the owners of the memory.
+ * Can be set on the command line: the simulator does. */
+#  ifndef LV_USE_MEM_TRACE
+#  define LV_USE_MEM_TRACE    0
+#  endif
+#  if LV_USE_MEM_TRACE
+#  ifndef LV_MEM_TRACE_CNT
+#  define LV_MEM_TRACE_CNT            512                 /*Number of records kept*/
+#  endif
+#  define LV_MEM_TRACE_TIME_INCLUDE   "esp_timer.h"       /*Header for the time function*/
+#  define LV_MEM_TRACE_TIME_EXPR      ((uint32_t)esp_timer_get_time()) /*Expression evaluating to a free running time in us*/
+#  ifdef __XTENSA__
+/*Return address of the function it's in: the top 2 bits are the register window of the call, the code is at 0x40000000*/
+#  define LV_MEM_TRACE_CALLER ((void *)(((uintptr_t)__builtin_return_address(0) & 0x3fffffff) | 0x40000000))
+#  endif
+#  endif
 #else       /*LV_MEM_CUSTOM*/
 #  define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
 #  define LV_MEM_CUSTOM_ALLOC   malloc       /*Wrapper to malloc*/
@@ -234,12 +273,21 @@ typedef void * lv_img_decoder_user_data_t;
 
 /* 1: use a custom tick source.
  * It removes the need to manually update the tick with `lv_tick_inc`) */
-#define LV_TICK_CUSTOM     0
+#define LV_TICK_CUSTOM     1
 #if LV_TICK_CUSTOM == 1
-#define LV_TICK_CUSTOM_INCLUDE  "something.h"       /*Header for the sys time function*/
-#define LV_TICK_CUSTOM_SYS_TIME_EXPR (millis())     /*Expression evaluating to current systime in ms*/
+#define LV_TICK_CUSTOM_INCLUDE  "esp_timer.h"       /*Header for the sys time function*/
+#define LV_TICK_CUSTOM_SYS_TIME_EXPR ((uint32_t)(esp_timer_get_time() / 1000))  /*Expression evaluating to current systime in ms*/
 #endif   /*LV_TICK_CUSTOM*/
 
+/* 1: Keep per frame refresh statistics (areas, pixels, render and flush times)
+ * in a ring buffer. See `lv_refr_prof_get_frame()` and `lv_refr_prof_dump()`*/
+#define LV_USE_REFR_PROF    1
+#if LV_USE_REFR_PROF
+#define LV_REFR_PROF_FRAME_CNT      32                  /*Number of frames kept in the history*/
+#define LV_REFR_PROF_TIME_INCLUDE   "esp_timer.h"       /*Header for the time function*/
+#define LV_REFR_PROF_TIME_EXPR      (esp_timer_get_time()) /*Expression evaluating to a free running time in us*/
+#endif   /*LV_USE_REFR_PROF*/
+
 typedef void * lv_disp_drv_user_data_t;             /*Type of user data in the display driver*/
 typedef void * lv_indev_drv_user_data_t;            /*Type of user data in the input device driver*/
 
@@ -436,6 +484,17 @@ typedef void * lv_obj_user_data_t;
 /*1: enable `lv_obj_realaign()` based on `lv_obj_align()` parameters*/
 #define LV_USE_OBJ_REALIGN          1
 
+/* Slabs of the objects and of the ext. data of the types created the most: blocks of one size
+ * allocated from the work memory when the first one is needed. Creating and deleting an object
+ * takes a block in a constant time and doesn't fragment the work memory; when a slab is full the
+ * memory comes from `lv_mem_alloc`. 0: no slab. See `lv_mem_slab_get_next()` for their use. */
+#define LV_OBJ_SLAB_CNT             80      /*Every object*/
+#define LV_BTN_SLAB_CNT             8
+#define LV_LABEL_SLAB_CNT           32
+#define LV_LIST_SLAB_CNT            1
+#define LV_SPINBOX_SLAB_CNT         3
+#define LV_ROLLER_SLAB_CNT          3
+
 /* Enable to make the object clickable on a larger area.
  * LV_EXT_CLICK_AREA_OFF or 0: Disable this feature
  * LV_EXT_CLICK_AREA_TINY: The extra area can be adjusted horizontally and vertically (0..255 px)
@@ -35,6 +35,12 @@
  * Useful if the display has a 8 bit interface (e.g. SPI)*/
 #define LV_COLOR_16_SWAP   0
 
+/* 1: The VDB of a 1 bit display is packed in pages like the SSD1306 RAM
+ * (8 vertical pixels per byte, LSB on top, bit set for black pixels).
+ * Fills, letters and images are written a byte at a time instead of calling `set_px_cb` for every pixel.
+ * Requires `LV_COLOR_DEPTH = 1` and a `rounder_cb` which aligns the areas to pages*/
+#define LV_VDB_MONO_PAGE   0
+
 /* 1: Enable screen transparency.
  * Useful for OSD or other overlapping GUIs.
  * Requires `LV_COLOR_DEPTH = 32` colors and the screen's style should be modified: `style.body.opa = ...`*/
@@ -83,6 +89,20 @@ typedef int16_t lv_coord_t;
 
 /* Automatically defrag. on free. Defrag. means joining the adjacent free cells. */
 #  define LV_MEM_AUTO_DEFRAG  1
+
+/* 1: keep the free cells in lists by size (Two-Level Segregated Fit): allocation and free take a
+ * constant time, the free cells are always joined. 0: search the cells one by one from the start. */
+#  define LV_MEM_TLSF         0
+
+/* 1: Record every `lv_mem_alloc`, `lv_mem_realloc` and `lv_mem_free`: call site, size and time, in a ring
+ * of the last `LV_MEM_TRACE_CNT` (16 bytes each). `lv_mem_trace_dump()` writes them with the used entries. */
+#  define LV_USE_MEM_TRACE    0
+#  if LV_USE_MEM_TRACE
+#  define LV_MEM_TRACE_CNT            512                 /*Number of records kept*/
+#  define LV_MEM_TRACE_TIME_INCLUDE   "something.h"       /*Header for the time function*/
+#  define LV_MEM_TRACE_TIME_EXPR      (micros())          /*Expression evaluating to a free running time in us*/
+#  define LV_MEM_TRACE_CALLER         (__builtin_return_address(0)) /*Return address of the function it's in*/
+#  endif
 #else       /*LV_MEM_CUSTOM*/
 #  define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
 #  define LV_MEM_CUSTOM_ALLOC   malloc       /*Wrapper to malloc*/
@@ -216,6 +236,15 @@ typedef void * lv_img_decoder_user_data_t;
 #define LV_TICK_CUSTOM_SYS_TIME_EXPR (millis())     /*Expression evaluating to current systime in ms*/
 #endif   /*LV_TICK_CUSTOM*/
 
+/* 1: Keep per frame refresh statistics (areas, pixels, render and flush times)
+ * in a ring buffer. See `lv_refr_prof_get_frame()` and `lv_refr_prof_dump()`*/
+#define LV_USE_REFR_PROF    0
+#if LV_USE_REFR_PROF
+#define LV_REFR_PROF_FRAME_CNT      32                  /*Number of frames kept in the history*/
+#define LV_REFR_PROF_TIME_INCLUDE   "something.h"       /*Header for the time function*/
+#define LV_REFR_PROF_TIME_EXPR      (micros())          /*Expression evaluating to a free running time in us*/
+#endif   /*LV_USE_REFR_PROF*/
+
 typedef void * lv_disp_drv_user_data_t;             /*Type of user data in the display driver*/
 typedef void * lv_indev_drv_user_data_t;            /*Type of user data in the input device driver*/
 
@@ -400,6 +429,17 @@ typedef void * lv_obj_user_data_t;
 /*1: enable `lv_obj_realaign()` based on `lv_obj_align()` parameters*/
 #define LV_USE_OBJ_REALIGN          1
 
+/* Slabs of the objects and of the ext. data of the types created the most: blocks of one size
+ * allocated from the work memory when the first one is needed. Creating and deleting an object
+ * takes a block in a constant time and doesn't fragment the work memory; when a slab is full the
+ * memory comes from `lv_mem_alloc`. 0: no slab. See `lv_mem_slab_get_next()` for their use. */
+#define LV_OBJ_SLAB_CNT             0       /*Every object*/
+#define LV_BTN_SLAB_CNT             0
+#define LV_LABEL_SLAB_CNT           0
+#define LV_LIST_SLAB_CNT            0
+#define LV_SPINBOX_SLAB_CNT         0
+#define LV_ROLLER_SLAB_CNT          0
+
 /* Enable to make the object clickable on a larger area.
  * LV_EXT_CLICK_AREA_OFF or 0: Disable this feature
  * LV_EXT_CLICK_AREA_TINY: The extra area can be adjusted horizontally and vertically (0..255 px)
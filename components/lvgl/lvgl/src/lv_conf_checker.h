@@ -38,6 +38,14 @@
 #define LV_COLOR_16_SWAP   0
 #endif
 
+/* 1: The VDB of a 1 bit display is packed in pages like the SSD1306 RAM
+ * (8 vertical pixels per byte, LSB on top, bit set for black pixels).
+ * Fills, letters and images are written a byte at a time instead of calling `set_px_cb` for every pixel.
+ * Requires `LV_COLOR_DEPTH = 1` and a `rounder_cb` which aligns the areas to pages*/
+#ifndef LV_VDB_MONO_PAGE
+#define LV_VDB_MONO_PAGE   0
+#endif
+
 /* 1: Enable screen transparency.
  * Useful for OSD or other overlapping GUIs.
  * Requires `LV_COLOR_DEPTH = 32` colors and the screen's style should be modified: `style.body.opa = ...`*/
@@ -107,6 +115,30 @@
 #ifndef LV_MEM_AUTO_DEFRAG
 #  define LV_MEM_AUTO_DEFRAG  1
 #endif
+
+/* 1: keep the free cells in lists by size (Two-Level Segregated Fit): allocation and free take a
+ * constant time, the free cells are always joined. 0: search the cells one by one from the start. */
+#ifndef LV_MEM_TLSF
+#  define LV_MEM_TLSF         0
+#endif
+#ifndef LV_USE_MEM_TRACE
+#  define LV_USE_MEM_TRACE    0
+#endif
+#if LV_USE_MEM_TRACE
+#ifndef LV_MEM_TRACE_CNT
+#  define LV_MEM_TRACE_CNT            512
+#endif
+/*Without a time source fall back to the (millisecond) tick*/
+#ifndef LV_MEM_TRACE_TIME_INCLUDE
+#  define LV_MEM_TRACE_TIME_INCLUDE   "../lv_hal/lv_hal_tick.h"
+#endif
+#ifndef LV_MEM_TRACE_TIME_EXPR
+#  define LV_MEM_TRACE_TIME_EXPR      (lv_tick_get() * 1000)
+#endif
+#ifndef LV_MEM_TRACE_CALLER
+#  define LV_MEM_TRACE_CALLER         (__builtin_return_address(0))
+#endif
+#endif
 #else       /*LV_MEM_CUSTOM*/
 #ifndef LV_MEM_CUSTOM_INCLUDE
 #  define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
@@ -294,6 +326,24 @@
 #endif
 #endif   /*LV_TICK_CUSTOM*/
 
+/* 1: Keep per frame refresh statistics (areas, pixels, render and flush times)
+ * in a ring buffer. See `lv_refr_prof_get_frame()` and `lv_refr_prof_dump()`*/
+#ifndef LV_USE_REFR_PROF
+#define LV_USE_REFR_PROF    0
+#endif
+#if LV_USE_REFR_PROF
+#ifndef LV_REFR_PROF_FRAME_CNT
+#define LV_REFR_PROF_FRAME_CNT      32                  /*Number of frames kept in the history*/
+#endif
+/*Without a time source fall back to the (millisecond) tick*/
+#ifndef LV_REFR_PROF_TIME_INCLUDE
+#define LV_REFR_PROF_TIME_INCLUDE   "../lv_hal/lv_hal_tick.h"
+#endif
+#ifndef LV_REFR_PROF_TIME_EXPR
+#define LV_REFR_PROF_TIME_EXPR      (lv_tick_get() * 1000)
+#endif
+#endif   /*LV_USE_REFR_PROF*/
+
 
 /*================
  * Log settings
@@ -558,6 +608,30 @@
 #define LV_USE_OBJ_REALIGN          1
 #endif
 
+#ifndef LV_OBJ_SLAB_CNT
+#define LV_OBJ_SLAB_CNT          0
+#endif
+
+#ifndef LV_BTN_SLAB_CNT
+#define LV_BTN_SLAB_CNT          0
+#endif
+
+#ifndef LV_LABEL_SLAB_CNT
+#define LV_LABEL_SLAB_CNT        0
+#endif
+
+#ifndef LV_LIST_SLAB_CNT
+#define LV_LIST_SLAB_CNT         0
+#endif
+
+#ifndef LV_SPINBOX_SLAB_CNT
+#define LV_SPINBOX_SLAB_CNT      0
+#endif
+
+#ifndef LV_ROLLER_SLAB_CNT
+#define LV_ROLLER_SLAB_CNT       0
+#endif
+
 /* Enable to make the object clickable on a larger area.
  * LV_EXT_CLICK_AREA_OFF or 0: Disable this feature
  * LV_EXT_CLICK_AREA_TINY: The extra area can be adjusted horizontally and vertically (0..255 px)
@@ -57,6 +57,7 @@ static void lv_event_mark_deleted(lv_obj_t * obj);
 static void lv_obj_del_async_cb(void * obj);
 static bool lv_obj_design(lv_obj_t * obj, const lv_area_t * mask_p, lv_design_mode_t mode);
 static lv_res_t lv_obj_signal(lv_obj_t * obj, lv_signal_t sign, void * param);
+static lv_obj_t * obj_ins_head(lv_ll_t * ll_p);
 
 /**********************
  *  STATIC VARIABLES
@@ -64,6 +65,7 @@ static lv_res_t lv_obj_signal(lv_obj_t * obj, lv_signal_t sign, void * param);
 static bool lv_initialized = false;
 static lv_event_temp_data_t * event_temp_data_head;
 static const void * event_act_data;
+static lv_mem_slab_t obj_slab = LV_MEM_SLAB_INIT("obj", LV_LL_NODE_SIZE(sizeof(lv_obj_t)), LV_OBJ_SLAB_CNT);
 
 /**********************
  *      MACROS
@@ -159,7 +161,8 @@ lv_obj_t * lv_obj_create(lv_obj_t * parent, const lv_obj_t * copy)
             return NULL;
         }
 
-        new_obj = lv_ll_ins_head(&disp->scr_ll);
+        LV_MEM_TRACE_SET_CALLER();
+        new_obj = obj_ins_head(&disp->scr_ll);
         LV_ASSERT_MEM(new_obj);
         if(new_obj == NULL) return NULL;
 
@@ -240,7 +243,8 @@ lv_obj_t * lv_obj_create(lv_obj_t * parent, const lv_obj_t * copy)
         LV_LOG_TRACE("Object create started");
         LV_ASSERT_OBJ(parent, LV_OBJX_NAME);
 
-        new_obj = lv_ll_ins_head(&parent->child_ll);
+        LV_MEM_TRACE_SET_CALLER();
+        new_obj = obj_ins_head(&parent->child_ll);
         LV_ASSERT_MEM(new_obj);
         if(new_obj == NULL) return NULL;
 
@@ -1610,11 +1614,37 @@ void * lv_obj_allocate_ext_attr(lv_obj_t * obj, uint16_t ext_size)
 {
     LV_ASSERT_OBJ(obj, LV_OBJX_NAME);
 
+    LV_MEM_TRACE_SET_CALLER();
     obj->ext_attr = lv_mem_realloc(obj->ext_attr, ext_size);
 
     return (void *)obj->ext_attr;
 }
 
+/**
+ * Allocate a new ext. data for an object from a slab, or from the heap if every block is used
+ * @param obj pointer to an object
+ * @param slab slab of the type of the object, its blocks of the size of its ext. data
+ * @return pointer to the allocated ext
+ */
+void * lv_obj_allocate_ext_attr_slab(lv_obj_t * obj, lv_mem_slab_t * slab)
+{
+    LV_ASSERT_OBJ(obj, LV_OBJX_NAME);
+
+    /*Kept for the reallocation if the slab is full*/
+    LV_MEM_TRACE_SET_CALLER();
+    void * ext = lv_mem_slab_alloc(slab);
+    if(ext == NULL) return lv_obj_allocate_ext_attr(obj, slab->block_size);
+
+    /*The ext. data of the ancestor is at the start of the new one*/
+    if(obj->ext_attr != NULL) {
+        memcpy(ext, obj->ext_attr, LV_MATH_MIN(lv_mem_get_size(obj->ext_attr), slab->block_size));
+        lv_mem_free(obj->ext_attr);
+    }
+    obj->ext_attr = ext;
+
+    return ext;
+}
+
 /**
  * Send a 'LV_SIGNAL_REFR_EXT_SIZE' signal to the object
  * @param obj pointer to an object
@@ -2413,6 +2443,20 @@ lv_res_t lv_obj_handle_get_type_signal(lv_obj_type_t * buf, const char * name)
  *   STATIC FUNCTIONS
  **********************/
 
+/**
+ * Add a new object to the head of a list of children or screens.
+ * The node comes from the slab of the objects while it has free blocks.
+ * @param ll_p pointer to the list
+ * @return the new object or NULL if there is no memory
+ */
+static lv_obj_t * obj_ins_head(lv_ll_t * ll_p)
+{
+    void * node = lv_mem_slab_alloc(&obj_slab);
+    if(node != NULL) return lv_ll_ins_head_node(ll_p, node);
+
+    return lv_ll_ins_head(ll_p);
+}
+
 static void lv_obj_del_async_cb(void * obj)
 {
     LV_ASSERT_OBJ(obj, LV_OBJX_NAME);
@@ -633,6 +633,14 @@ void lv_obj_set_design_cb(lv_obj_t * obj, lv_design_cb_t design_cb);
  */
 void * lv_obj_allocate_ext_attr(lv_obj_t * obj, uint16_t ext_size);
 
+/**
+ * Allocate a new ext. data for an object from a slab, or from the heap if every block is used
+ * @param obj pointer to an object
+ * @param slab slab of the type of the object, its blocks of the size of its ext. data
+ * @return pointer to the allocated ext
+ */
+void * lv_obj_allocate_ext_attr_slab(lv_obj_t * obj, lv_mem_slab_t * slab);
+
 /**
  * Send a 'LV_SIGNAL_REFR_EXT_SIZE' signal to the object
  * @param obj pointer to an object
@@ -15,6 +15,11 @@
 #include "../lv_misc/lv_mem.h"
 #include "../lv_misc/lv_gc.h"
 #include "../lv_draw/lv_draw.h"
+#include "../lv_misc/lv_printf.h"
+
+#if LV_USE_REFR_PROF
+#include LV_REFR_PROF_TIME_INCLUDE
+#endif
 
 #if defined(LV_GC_INCLUDE)
 #include LV_GC_INCLUDE
@@ -26,6 +31,17 @@
 /* Draw translucent random colored areas on the invalidated (redrawn) areas*/
 #define MASK_AREA_DEBUG 0
 
+#if LV_USE_REFR_PROF
+#define PROF_TIME() ((uint32_t)(LV_REFR_PROF_TIME_EXPR))
+
+/*Full memory barrier between writing the history and publishing the frame counters*/
+#if defined(__GNUC__)
+#define PROF_BARRIER() __sync_synchronize()
+#else
+#define PROF_BARRIER()
+#endif
+#endif
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -41,6 +57,11 @@ static lv_obj_t * lv_refr_get_top_obj(const lv_area_t * area_p, lv_obj_t * obj);
 static void lv_refr_obj_and_children(lv_obj_t * top_p, const lv_area_t * mask_p);
 static void lv_refr_obj(lv_obj_t * obj, const lv_area_t * mask_ori_p);
 static void lv_refr_vdb_flush(void);
+static void lv_refr_wait_flushing(lv_disp_buf_t * vdb);
+#if LV_USE_REFR_PROF
+static void prof_flush_collect(lv_disp_buf_t * vdb);
+static void prof_publish(void);
+#endif
 
 /**********************
  *  STATIC VARIABLES
@@ -48,6 +69,13 @@ static void lv_refr_vdb_flush(void);
 static uint32_t px_num;
 static lv_disp_t * disp_refr; /*Display being refreshed*/
 
+#if LV_USE_REFR_PROF
+static lv_refr_prof_frame_t prof_frame; /*The frame being refreshed*/
+static lv_refr_prof_frame_t prof_history[LV_REFR_PROF_FRAME_CNT];
+static volatile uint32_t prof_started; /*Last frame whose history slot is being written*/
+static volatile uint32_t prof_done;    /*Last frame completely written to the history*/
+#endif
+
 /**********************
  *      MACROS
  **********************/
@@ -131,6 +159,9 @@ void lv_inv_area(lv_disp_t * disp, const lv_area_t * area_p)
             lv_area_copy(&disp->inv_areas[disp->inv_p], &scr_area);
         }
         disp->inv_p++;
+
+        /*The refresh task sleeps while there is nothing to redraw*/
+        if(disp->refr_task) lv_task_resume(disp->refr_task);
     }
 }
 
@@ -166,6 +197,16 @@ void lv_disp_refr_task(lv_task_t * task)
 
     disp_refr = task->user_data;
 
+    /*Paused before the areas are taken: one invalidated from now on, even while the clean up
+     * below clears `inv_p`, resumes it through `lv_inv_area`*/
+    lv_task_pause(task);
+
+#if LV_USE_REFR_PROF
+    memset(&prof_frame, 0, sizeof(prof_frame));
+    prof_frame.start     = PROF_TIME();
+    prof_frame.inv_areas = disp_refr->inv_p;
+#endif
+
     lv_refr_join_area();
 
     lv_refr_areas();
@@ -183,8 +224,7 @@ void lv_disp_refr_task(lv_task_t * task)
             /* With true double buffering the flushing should be only the address change of the
              * current frame buffer. Wait until the address change is ready and copy the changed
              * content to the other frame buffer (new active VDB) to keep the buffers synchronized*/
-            while(vdb->flushing)
-                ;
+            lv_refr_wait_flushing(vdb);
 
             uint8_t * buf_act = (uint8_t *)vdb->buf_act;
             uint8_t * buf_ina = (uint8_t *)vdb->buf_act == vdb->buf1 ? vdb->buf2 : vdb->buf1;
@@ -215,13 +255,125 @@ void lv_disp_refr_task(lv_task_t * task)
         if(disp_refr->driver.monitor_cb) {
             disp_refr->driver.monitor_cb(&disp_refr->driver, lv_tick_elaps(start), px_num);
         }
+
+#if LV_USE_REFR_PROF
+        /*A flush still in progress is counted in the next frame*/
+        prof_flush_collect(lv_disp_get_buf(disp_refr));
+        prof_frame.px_num     = px_num;
+        prof_frame.total_time = PROF_TIME() - prof_frame.start;
+        prof_publish();
+#endif
     }
 
     lv_draw_free_buf();
 
+    /*Everything is redrawn, unless an area came after the clean up: run again for it*/
+    if(disp_refr->inv_p != 0) lv_task_resume(task);
+
     LV_LOG_TRACE("lv_refr_task: ready");
 }
 
+#if LV_USE_REFR_PROF
+/**
+ * Get the sequence number of the last profiled frame.
+ * Only refreshes which redrew something are counted.
+ * @return number of the last frame, 0 if there was no refresh yet
+ */
+uint32_t lv_refr_prof_get_last(void)
+{
+    return prof_done;
+}
+
+/**
+ * Copy the statistics of a frame from the history.
+ * It doesn't lock anything so it can be called from any task while the GUI task is refreshing.
+ * The last `LV_REFR_PROF_FRAME_CNT` frames are kept.
+ * @param frame sequence number of the frame (see `lv_refr_prof_get_last`)
+ * @param dst store the statistics here
+ * @return true: `dst` is valid; false: the frame is not recorded yet or was already overwritten
+ */
+bool lv_refr_prof_get_frame(uint32_t frame, lv_refr_prof_frame_t * dst)
+{
+    if(frame == 0 || frame > prof_done) return false;
+
+    PROF_BARRIER();
+    memcpy(dst, &prof_history[(frame - 1) % LV_REFR_PROF_FRAME_CNT], sizeof(lv_refr_prof_frame_t));
+    PROF_BARRIER();
+
+    /*The slot is reused by `frame + LV_REFR_PROF_FRAME_CNT`. If the writer has started that frame
+     * the copy might be torn*/
+    if(prof_started - frame >= LV_REFR_PROF_FRAME_CNT) return false;
+
+    return true;
+}
+
+/**
+ * Print the last frames one line each, followed by their sum and maximum.
+ * Like `lv_refr_prof_get_frame` it can be called from any task.
+ * @param frame_cnt number of frames to print (at most `LV_REFR_PROF_FRAME_CNT`)
+ * @param print_cb called with every line
+ */
+void lv_refr_prof_dump(uint32_t frame_cnt, lv_refr_prof_print_cb_t print_cb)
+{
+    static const char * row_fmt = "%7s %5lu/%-3lu %7lu %7lu %7lu %7lu %7lu %3lu";
+    char line[96];
+    char name[12];
+    lv_refr_prof_frame_t f;
+    lv_refr_prof_frame_t sum;
+    lv_refr_prof_frame_t max;
+    uint32_t last = prof_done;
+    uint32_t frame;
+
+    if(frame_cnt > LV_REFR_PROF_FRAME_CNT) frame_cnt = LV_REFR_PROF_FRAME_CNT;
+    if(frame_cnt > last) frame_cnt = last;
+
+    memset(&sum, 0, sizeof(sum));
+    memset(&max, 0, sizeof(max));
+
+    print_cb("  frame inv/joined     px    total  render    wait   flush flushes (us)");
+
+    for(frame = last - frame_cnt + 1; frame <= last; frame++) {
+        if(lv_refr_prof_get_frame(frame, &f) == false) continue; /*Overwritten meanwhile*/
+
+        lv_snprintf(name, sizeof(name), "%lu", (unsigned long)f.frame);
+        lv_snprintf(line, sizeof(line), row_fmt, name, (unsigned long)f.inv_areas, (unsigned long)f.joined_areas,
+                    (unsigned long)f.px_num, (unsigned long)f.total_time, (unsigned long)f.render_time,
+                    (unsigned long)f.flush_wait_time, (unsigned long)f.flush_time, (unsigned long)f.flush_cnt);
+        print_cb(line);
+
+        sum.frame++;
+        sum.inv_areas += f.inv_areas;
+        sum.joined_areas += f.joined_areas;
+        sum.px_num += f.px_num;
+        sum.total_time += f.total_time;
+        sum.render_time += f.render_time;
+        sum.flush_wait_time += f.flush_wait_time;
+        sum.flush_time += f.flush_time;
+        sum.flush_cnt += f.flush_cnt;
+
+        if(f.inv_areas > max.inv_areas) max.inv_areas = f.inv_areas;
+        if(f.joined_areas > max.joined_areas) max.joined_areas = f.joined_areas;
+        if(f.px_num > max.px_num) max.px_num = f.px_num;
+        if(f.total_time > max.total_time) max.total_time = f.total_time;
+        if(f.render_time > max.render_time) max.render_time = f.render_time;
+        if(f.flush_wait_time > max.flush_wait_time) max.flush_wait_time = f.flush_wait_time;
+        if(f.flush_time > max.flush_time) max.flush_time = f.flush_time;
+        if(f.flush_cnt > max.flush_cnt) max.flush_cnt = f.flush_cnt;
+    }
+
+    if(sum.frame == 0) return;
+
+    lv_snprintf(line, sizeof(line), row_fmt, "sum", (unsigned long)sum.inv_areas, (unsigned long)sum.joined_areas,
+                (unsigned long)sum.px_num, (unsigned long)sum.total_time, (unsigned long)sum.render_time,
+                (unsigned long)sum.flush_wait_time, (unsigned long)sum.flush_time, (unsigned long)sum.flush_cnt);
+    print_cb(line);
+    lv_snprintf(line, sizeof(line), row_fmt, "max", (unsigned long)max.inv_areas, (unsigned long)max.joined_areas,
+                (unsigned long)max.px_num, (unsigned long)max.total_time, (unsigned long)max.render_time,
+                (unsigned long)max.flush_wait_time, (unsigned long)max.flush_time, (unsigned long)max.flush_cnt);
+    print_cb(line);
+}
+#endif
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -277,7 +429,10 @@ static void lv_refr_areas(void)
 
             lv_refr_area(&disp_refr->inv_areas[i]);
 
-            if(disp_refr->driver.monitor_cb) px_num += lv_area_get_size(&disp_refr->inv_areas[i]);
+            if(disp_refr->driver.monitor_cb || LV_USE_REFR_PROF) px_num += lv_area_get_size(&disp_refr->inv_areas[i]);
+#if LV_USE_REFR_PROF
+            prof_frame.joined_areas++;
+#endif
         }
     }
 }
@@ -379,8 +534,7 @@ static void lv_refr_area_part(const lv_area_t * area_p)
     /*In non double buffered mode, before rendering the next part wait until the previous image is
      * flushed*/
     if(lv_disp_is_double_buf(disp_refr) == false) {
-        while(vdb->flushing)
-            ;
+        lv_refr_wait_flushing(vdb);
     }
 
     lv_obj_t * top_p;
@@ -393,6 +547,10 @@ static void lv_refr_area_part(const lv_area_t * area_p)
     /*Get the most top object which is not covered by others*/
     top_p = lv_refr_get_top_obj(&start_mask, lv_disp_get_scr_act(disp_refr));
 
+#if LV_USE_REFR_PROF
+    uint32_t render_start = PROF_TIME();
+#endif
+
     /*Do the refreshing from the top object*/
     lv_refr_obj_and_children(top_p, &start_mask);
 
@@ -400,6 +558,10 @@ static void lv_refr_area_part(const lv_area_t * area_p)
     lv_refr_obj_and_children(lv_disp_get_layer_top(disp_refr), &start_mask);
     lv_refr_obj_and_children(lv_disp_get_layer_sys(disp_refr), &start_mask);
 
+#if LV_USE_REFR_PROF
+    prof_frame.render_time += PROF_TIME() - render_start;
+#endif
+
     /* In true double buffered mode flush only once when all areas were rendered.
      * In normal mode flush after every area */
     if(lv_disp_is_true_double_buf(disp_refr) == false) {
@@ -564,10 +726,16 @@ static void lv_refr_vdb_flush(void)
     /*In double buffered mode wait until the other buffer is flushed before flushing the current
      * one*/
     if(lv_disp_is_double_buf(disp_refr)) {
-        while(vdb->flushing)
-            ;
+        lv_refr_wait_flushing(vdb);
     }
 
+#if LV_USE_REFR_PROF
+    prof_flush_collect(vdb);
+    prof_frame.flush_cnt++;
+    vdb->prof_flush_pending = 1;
+    vdb->prof_flush_start   = PROF_TIME();
+#endif
+
     vdb->flushing = 1;
 
     /*Flush the rendered content to the display*/
@@ -581,3 +749,53 @@ static void lv_refr_vdb_flush(void)
             vdb->buf_act = vdb->buf1;
     }
 }
+
+/**
+ * Wait until the driver reports the last flush ready with `lv_disp_flush_ready`
+ * @param vdb pointer to the display buffer being flushed
+ */
+static void lv_refr_wait_flushing(lv_disp_buf_t * vdb)
+{
+#if LV_USE_REFR_PROF
+    if(vdb->flushing) {
+        uint32_t wait_start = PROF_TIME();
+        while(vdb->flushing)
+            ;
+        prof_frame.flush_wait_time += PROF_TIME() - wait_start;
+    }
+
+    prof_flush_collect(vdb);
+#else
+    while(vdb->flushing)
+        ;
+#endif
+}
+
+#if LV_USE_REFR_PROF
+/**
+ * Add the duration of the last flush to the current frame if it's ready and not counted yet
+ * @param vdb pointer to the display buffer being flushed
+ */
+static void prof_flush_collect(lv_disp_buf_t * vdb)
+{
+    if(vdb->prof_flush_pending == 0 || vdb->flushing) return;
+
+    prof_frame.flush_time += vdb->prof_flush_end - vdb->prof_flush_start;
+    vdb->prof_flush_pending = 0;
+}
+
+/**
+ * Save the current frame into the history.
+ * Only the GUI task writes, readers check `prof_started` to detect a slot reused during their copy.
+ */
+static void prof_publish(void)
+{
+    prof_frame.frame = prof_done + 1;
+
+    prof_started = prof_frame.frame;
+    PROF_BARRIER();
+    memcpy(&prof_history[(prof_frame.frame - 1) % LV_REFR_PROF_FRAME_CNT], &prof_frame, sizeof(lv_refr_prof_frame_t));
+    PROF_BARRIER();
+    prof_done = prof_frame.frame;
+}
+#endif
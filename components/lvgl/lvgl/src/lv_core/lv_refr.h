@@ -24,6 +24,30 @@ extern "C" {
  *      TYPEDEFS
  **********************/
 
+#if LV_USE_REFR_PROF
+/**
+ * Statistics of one refresh. The times are in microseconds.
+ */
+typedef struct
+{
+    uint32_t frame;           /**< Sequence number of the frame, the first one is 1*/
+    uint32_t start;           /**< When the refresh started*/
+    uint32_t total_time;      /**< Time spent in `lv_disp_refr_task`*/
+    uint32_t render_time;     /**< Time spent in `lv_refr_obj_and_children` (drawing)*/
+    uint32_t flush_wait_time; /**< Time blocked waiting for `vdb->flushing`*/
+    uint32_t flush_time;      /**< From `flush_cb` to `lv_disp_flush_ready`, summed over the flushes*/
+    uint32_t px_num;          /**< Number of pixels rendered*/
+    uint16_t inv_areas;       /**< Invalidated areas before `lv_refr_join_area`*/
+    uint16_t joined_areas;    /**< Areas left (and refreshed) after joining*/
+    uint16_t flush_cnt;       /**< Number of `flush_cb` calls*/
+} lv_refr_prof_frame_t;
+
+/**
+ * Called by `lv_refr_prof_dump` with one line of text (without new line character)
+ */
+typedef void (*lv_refr_prof_print_cb_t)(const char * line);
+#endif
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
@@ -82,6 +106,33 @@ void lv_refr_set_disp_refreshing(lv_disp_t * disp);
  */
 void lv_disp_refr_task(lv_task_t * task);
 
+#if LV_USE_REFR_PROF
+/**
+ * Get the sequence number of the last profiled frame.
+ * Only refreshes which redrew something are counted.
+ * @return number of the last frame, 0 if there was no refresh yet
+ */
+uint32_t lv_refr_prof_get_last(void);
+
+/**
+ * Copy the statistics of a frame from the history.
+ * It doesn't lock anything so it can be called from any task while the GUI task is refreshing.
+ * The last `LV_REFR_PROF_FRAME_CNT` frames are kept.
+ * @param frame sequence number of the frame (see `lv_refr_prof_get_last`)
+ * @param dst store the statistics here
+ * @return true: `dst` is valid; false: the frame is not recorded yet or was already overwritten
+ */
+bool lv_refr_prof_get_frame(uint32_t frame, lv_refr_prof_frame_t * dst);
+
+/**
+ * Print the last frames one line each, followed by their sum and maximum.
+ * Like `lv_refr_prof_get_frame` it can be called from any task.
+ * @param frame_cnt number of frames to print (at most `LV_REFR_PROF_FRAME_CNT`)
+ * @param print_cb called with every line
+ */
+void lv_refr_prof_dump(uint32_t frame_cnt, lv_refr_prof_print_cb_t print_cb);
+#endif
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -49,6 +49,15 @@ static void sw_color_fill(lv_color_t * mem, lv_coord_t mem_width, const lv_area_
 static inline lv_color_t color_mix_2_alpha(lv_color_t bg_color, lv_opa_t bg_opa, lv_color_t fg_color, lv_opa_t fg_opa);
 #endif
 
+#if LV_COLOR_DEPTH == 1 && LV_VDB_MONO_PAGE
+static inline void mono_page_px(uint8_t * buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y, lv_color_t color);
+static void mono_page_fill(uint8_t * buf, lv_coord_t buf_w, const lv_area_t * fill_area, lv_color_t color);
+static void mono_page_letter(uint8_t * buf, lv_coord_t buf_w, lv_coord_t pos_x, lv_coord_t pos_y, const uint8_t * map_p,
+                             uint16_t box_w, uint8_t bpp, const lv_area_t * map_area, lv_color_t color);
+static void mono_page_map(uint8_t * buf, lv_coord_t buf_w, const lv_area_t * map_area, const uint8_t * map_p,
+                          uint32_t map_stride);
+#endif
+
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -88,6 +97,9 @@ void lv_draw_px(lv_coord_t x, lv_coord_t y, const lv_area_t * mask_p, lv_color_t
     x -= vdb->area.x1;
     y -= vdb->area.y1;
 
+#if LV_COLOR_DEPTH == 1 && LV_VDB_MONO_PAGE
+    mono_page_px((uint8_t *)vdb->buf_act, vdb_width, x, y, color);
+#else
     if(disp->driver.set_px_cb) {
         disp->driver.set_px_cb(&disp->driver, (uint8_t *)vdb->buf_act, vdb_width, x, y, color, opa);
     } else {
@@ -111,6 +123,7 @@ void lv_draw_px(lv_coord_t x, lv_coord_t y, const lv_area_t * mask_p, lv_color_t
 #endif
         }
     }
+#endif
 }
 
 /**
@@ -321,6 +334,20 @@ void lv_draw_letter(const lv_point_t * pos_p, const lv_area_t * mask_p, const lv
         row_end   = pos_y + g.box_h <= mask_p->y2 ? g.box_h : mask_p->y2 - pos_y + 1;
     }
 
+#if LV_COLOR_DEPTH == 1 && LV_VDB_MONO_PAGE
+    /*Sub pixel rendering is meaningless on 1 bpp so only the normal letters are handled here*/
+    if(subpx == false) {
+        lv_area_t map_area;
+        map_area.x1 = col_start;
+        map_area.y1 = row_start;
+        map_area.x2 = col_end - 1;
+        map_area.y2 = row_end - 1;
+        mono_page_letter((uint8_t *)vdb->buf_act, vdb_width, pos_x - vdb->area.x1, pos_y - vdb->area.y1, map_p,
+                         g.box_w, g.bpp, &map_area, color);
+        return;
+    }
+#endif
+
     /*Set a pointer on VDB to the first pixel of the letter*/
     vdb_buf_tmp += ((pos_y - vdb->area.y1) * vdb_width) + pos_x - vdb->area.x1;
 
@@ -514,6 +541,10 @@ void lv_draw_map(const lv_area_t * cords_p, const lv_area_t * mask_p, const uint
     /*The simplest case just copy the pixels into the VDB*/
     if(chroma_key == false && alpha_byte == false && opa == LV_OPA_COVER && recolor_opa == LV_OPA_TRANSP) {
 
+#if LV_COLOR_DEPTH == 1 && LV_VDB_MONO_PAGE
+        /*Write the page packed VDB a byte at a time*/
+        mono_page_map((uint8_t *)vdb->buf_act, vdb_width, &masked_a, map_p, map_width * px_size_byte);
+#else
         /*Use the custom VDB write function is exists*/
         if(disp->driver.set_px_cb) {
             lv_coord_t col;
@@ -542,6 +573,7 @@ void lv_draw_map(const lv_area_t * cords_p, const lv_area_t * mask_p, const uint
                 vdb_buf_tmp += vdb_width;          /*Next row on the VDB*/
             }
         }
+#endif
     }
 
     /*In the other cases every pixel need to be checked one-by-one*/
@@ -663,6 +695,11 @@ static void sw_mem_blend(lv_color_t * dest, const lv_color_t * src, uint32_t len
 static void sw_color_fill(lv_color_t * mem, lv_coord_t mem_width, const lv_area_t * fill_area, lv_color_t color,
                           lv_opa_t opa)
 {
+#if LV_COLOR_DEPTH == 1 && LV_VDB_MONO_PAGE
+    /*Like `set_px_cb` of the mono displays the opacity is ignored*/
+    (void)opa;
+    mono_page_fill((uint8_t *)mem, mem_width, fill_area, color);
+#else
     /*Set all row in vdb to the given color*/
     lv_coord_t row;
     lv_coord_t col;
@@ -725,8 +762,161 @@ static void sw_color_fill(lv_color_t * mem, lv_coord_t mem_width, const lv_area_
             }
         }
     }
+#endif
 }
 
+#if LV_COLOR_DEPTH == 1 && LV_VDB_MONO_PAGE
+/**
+ * Set a pixel in a page packed 1 bpp VDB
+ * @param buf pointer to the VDB
+ * @param buf_w width of the VDB
+ * @param x x coordinate relative to the VDB
+ * @param y y coordinate relative to the VDB
+ * @param color pixel color (black sets the bit)
+ */
+static inline void mono_page_px(uint8_t * buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y, lv_color_t color)
+{
+    uint8_t * byte_p = &buf[(y >> 3) * buf_w + x];
+
+    if(color.full == 0) {
+        *byte_p |= (uint8_t)(1 << (y & 0x7));
+    } else {
+        *byte_p &= (uint8_t)~(1 << (y & 0x7));
+    }
+}
+
+/**
+ * Fill an area of a page packed 1 bpp VDB. Full pages are filled with `memset`,
+ * the partial pages at the top and bottom are masked.
+ * @param buf pointer to the VDB
+ * @param buf_w width of the VDB
+ * @param fill_area area to fill relative to the VDB
+ * @param color fill color
+ */
+static void mono_page_fill(uint8_t * buf, lv_coord_t buf_w, const lv_area_t * fill_area, lv_color_t color)
+{
+    lv_coord_t page_first = fill_area->y1 >> 3;
+    lv_coord_t page_last  = fill_area->y2 >> 3;
+    lv_coord_t w          = lv_area_get_width(fill_area);
+    lv_coord_t page;
+    lv_coord_t col;
+
+    for(page = page_first; page <= page_last; page++) {
+        /*Bits of this page covered by the area*/
+        uint8_t mask = 0xFF;
+        if(page == page_first) mask &= (uint8_t)(0xFF << (fill_area->y1 & 0x7));
+        if(page == page_last) mask &= (uint8_t)(0xFF >> (7 - (fill_area->y2 & 0x7)));
+
+        uint8_t * page_p = &buf[page * buf_w + fill_area->x1];
+        if(mask == 0xFF) {
+            memset(page_p, color.full == 0 ? 0xFF : 0x00, w);
+        } else if(color.full == 0) {
+            for(col = 0; col < w; col++) page_p[col] |= mask;
+        } else {
+            mask = ~mask;
+            for(col = 0; col < w; col++) page_p[col] &= mask;
+        }
+    }
+}
+
+/**
+ * Draw a glyph into a page packed 1 bpp VDB. The glyph rows falling into the same page
+ * are collected into one byte per column so every page byte is written only once.
+ * Like with `set_px_cb` every non zero glyph pixel is drawn with 'color'.
+ * @param buf pointer to the VDB
+ * @param buf_w width of the VDB
+ * @param pos_x x coordinate of the glyph relative to the VDB
+ * @param pos_y y coordinate of the glyph relative to the VDB
+ * @param map_p pointer to the glyph's bitmap
+ * @param box_w width of the glyph
+ * @param bpp bit per pixel of the bitmap (1, 2, 4 or 8)
+ * @param map_area visible columns and rows of the glyph (relative to the glyph)
+ * @param color letter color
+ */
+static void mono_page_letter(uint8_t * buf, lv_coord_t buf_w, lv_coord_t pos_x, lv_coord_t pos_y, const uint8_t * map_p,
+                             uint16_t box_w, uint8_t bpp, const lv_area_t * map_area, lv_color_t color)
+{
+    uint32_t width_bit = (uint32_t)box_w * bpp;
+    uint8_t px_mask    = (uint8_t)((1 << bpp) - 1);
+    lv_coord_t row     = map_area->y1;
+    lv_coord_t col;
+
+    while(row <= map_area->y2) {
+        lv_coord_t y = pos_y + row;
+
+        /*Last glyph row which still falls into the page of 'y'*/
+        lv_coord_t page_row_last = row + 7 - (y & 0x7);
+        if(page_row_last > map_area->y2) page_row_last = map_area->y2;
+
+        uint8_t * page_p = &buf[(y >> 3) * buf_w + pos_x];
+        for(col = map_area->x1; col <= map_area->x2; col++) {
+            uint32_t bit_ofs = row * width_bit + col * bpp;
+            uint8_t bit      = y & 0x7;
+            uint8_t bits     = 0;
+            lv_coord_t r;
+            for(r = row; r <= page_row_last; r++) {
+                uint8_t letter_px = (map_p[bit_ofs >> 3] >> (8 - (bit_ofs & 0x7) - bpp)) & px_mask;
+                bits |= (uint8_t)((letter_px != 0) << bit);
+                bit++;
+                bit_ofs += width_bit;
+            }
+
+            if(bits == 0) continue;
+            if(color.full == 0) page_p[col] |= bits;
+            else page_p[col] &= (uint8_t)~bits;
+        }
+
+        row = page_row_last + 1;
+    }
+}
+
+/**
+ * Copy a 1 bpp color map into a page packed VDB. The rows of the area are cleared in a page
+ * then the black pixels of the map are set row by row, reading the map in its order.
+ * @param buf pointer to the VDB
+ * @param buf_w width of the VDB
+ * @param map_area area to copy relative to the VDB
+ * @param map_p pointer to the first visible pixel of the map
+ * @param map_stride length of a map row in bytes
+ */
+static void mono_page_map(uint8_t * buf, lv_coord_t buf_w, const lv_area_t * map_area, const uint8_t * map_p,
+                          uint32_t map_stride)
+{
+    lv_coord_t page_first = map_area->y1 >> 3;
+    lv_coord_t page_last  = map_area->y2 >> 3;
+    lv_coord_t w          = lv_area_get_width(map_area);
+    lv_coord_t page;
+    lv_coord_t col;
+    lv_coord_t row;
+
+    for(page = page_first; page <= page_last; page++) {
+        lv_coord_t row_first = page == page_first ? map_area->y1 : (page << 3);
+        lv_coord_t row_last  = page == page_last ? map_area->y2 : (page << 3) + 7;
+
+        uint8_t mask = (uint8_t)(0xFF << (row_first & 0x7));
+        mask &= (uint8_t)(0xFF >> (7 - (row_last & 0x7)));
+
+        uint8_t * page_p = &buf[page * buf_w + map_area->x1];
+        if(mask == 0xFF) {
+            memset(page_p, 0x00, w);
+        } else {
+            mask = ~mask;
+            for(col = 0; col < w; col++) page_p[col] &= mask;
+        }
+
+        const lv_color_t * row_p = (const lv_color_t *)&map_p[(uint32_t)(row_first - map_area->y1) * map_stride];
+        for(row = row_first; row <= row_last; row++) {
+            /*No branch on the pixel: it would be mispredicted on every dithered image*/
+            uint8_t bit_ofs = row & 0x7;
+            for(col = 0; col < w; col++) {
+                page_p[col] |= (uint8_t)((row_p[col].full == 0) << bit_ofs);
+            }
+            row_p = (const lv_color_t *)((const uint8_t *)row_p + map_stride);
+        }
+    }
+}
+#endif
+
 #if LV_COLOR_DEPTH == 32 && LV_COLOR_SCREEN_TRANSP
 /**
  * Mix two colors. Both color can have alpha value. It requires ARGB888 colors.
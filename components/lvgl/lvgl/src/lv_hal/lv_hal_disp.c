@@ -18,6 +18,10 @@
 #include "../lv_core/lv_refr.h"
 #include "../lv_misc/lv_gc.h"
 
+#if LV_USE_REFR_PROF
+#include LV_REFR_PROF_TIME_INCLUDE
+#endif
+
 #if defined(LV_GC_INCLUDE)
 #include LV_GC_INCLUDE
 #endif /* LV_ENABLE_GC */
@@ -135,7 +139,8 @@ lv_disp_t * lv_disp_drv_register(lv_disp_drv_t * driver)
     disp_def                 = disp; /*Temporarily change the default screen to create the default screens on the
                                         new display*/
 
-    disp->inv_p = 0;
+    disp->inv_p     = 0;
+    disp->refr_task = NULL; /*Created below, the invalidations until then need no wake up*/
 
     disp->act_scr   = lv_obj_create(NULL, NULL); /*Create a default screen on the display*/
     disp->top_layer = lv_obj_create(NULL, NULL); /*Create top layer on the display*/
@@ -276,6 +281,10 @@ LV_ATTRIBUTE_FLUSH_READY void lv_disp_flush_ready(lv_disp_drv_t * disp_drv)
     }
 #endif
 
+#if LV_USE_REFR_PROF
+    disp_drv->buffer->prof_flush_end = (uint32_t)(LV_REFR_PROF_TIME_EXPR);
+#endif
+
     disp_drv->buffer->flushing = 0;
 }
 
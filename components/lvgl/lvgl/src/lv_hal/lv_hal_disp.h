@@ -54,6 +54,11 @@ typedef struct
     uint32_t size; /*In pixel count*/
     lv_area_t area;
     volatile uint32_t flushing : 1;
+#if LV_USE_REFR_PROF
+    uint8_t prof_flush_pending;         /*The duration of the last flush is not counted yet*/
+    uint32_t prof_flush_start;          /*When `flush_cb` was called [us]*/
+    volatile uint32_t prof_flush_end;   /*When the flush was reported ready [us]*/
+#endif
 } lv_disp_buf_t;
 
 /**
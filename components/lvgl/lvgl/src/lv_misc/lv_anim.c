@@ -42,6 +42,7 @@ static bool anim_ready_handler(lv_anim_t * a);
  **********************/
 static uint32_t last_task_run;
 static bool anim_list_changed;
+static lv_task_t * anim_task_p;
 
 /**********************
  *      MACROS
@@ -58,7 +59,7 @@ void lv_anim_core_init(void)
 {
     lv_ll_init(&LV_GC_ROOT(_lv_anim_ll), sizeof(lv_anim_t));
     last_task_run = lv_tick_get();
-    lv_task_create(anim_task, LV_DISP_DEF_REFR_PERIOD, LV_TASK_PRIO_MID, NULL);
+    anim_task_p   = lv_task_create(anim_task, LV_DISP_DEF_REFR_PERIOD, LV_TASK_PRIO_MID, NULL);
 }
 
 /**
@@ -104,6 +105,12 @@ void lv_anim_create(lv_anim_t * a)
      * It's important if it happens in a ready callback. (see `anim_task`)*/
     anim_list_changed = true;
 
+    /*The animation task sleeps while there are no animations. Don't count the sleep as elapsed time*/
+    if(anim_task_p->paused) {
+        last_task_run = lv_tick_get();
+        lv_task_resume(anim_task_p);
+    }
+
     LV_LOG_TRACE("animation created")
 }
 
@@ -424,6 +431,9 @@ static void anim_task(lv_task_t * param)
     }
 
     last_task_run = lv_tick_get();
+
+    /*Sleep until `lv_anim_create` adds an animation*/
+    if(lv_ll_get_head(&LV_GC_ROOT(_lv_anim_ll)) == NULL) lv_task_pause(anim_task_p);
 }
 
 /**
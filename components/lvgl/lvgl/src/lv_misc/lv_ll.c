@@ -77,20 +77,34 @@ void * lv_ll_ins_head(lv_ll_t * ll_p)
 {
     lv_ll_node_t * n_new;
 
+    LV_MEM_TRACE_SET_CALLER();
     n_new = lv_mem_alloc(ll_p->n_size + LL_NODE_META_SIZE);
 
     if(n_new != NULL) {
-        node_set_prev(ll_p, n_new, NULL);       /*No prev. before the new head*/
-        node_set_next(ll_p, n_new, ll_p->head); /*After new comes the old head*/
+        lv_ll_ins_head_node(ll_p, n_new);
+    }
 
-        if(ll_p->head != NULL) { /*If there is old head then before it goes the new*/
-            node_set_prev(ll_p, ll_p->head, n_new);
-        }
+    return n_new;
+}
 
-        ll_p->head = n_new;      /*Set the new head in the dsc.*/
-        if(ll_p->tail == NULL) { /*If there is no tail (1. node) set the tail too*/
-            ll_p->tail = n_new;
-        }
+/**
+ * Add a node allocated by the caller to the head of a linked list
+ * @param ll_p pointer to linked list
+ * @param n_new memory of `LV_LL_NODE_SIZE(node_size)` bytes, e.g. a block of a slab
+ * @return `n_new`, the new head
+ */
+void * lv_ll_ins_head_node(lv_ll_t * ll_p, void * n_new)
+{
+    node_set_prev(ll_p, n_new, NULL);       /*No prev. before the new head*/
+    node_set_next(ll_p, n_new, ll_p->head); /*After new comes the old head*/
+
+    if(ll_p->head != NULL) { /*If there is old head then before it goes the new*/
+        node_set_prev(ll_p, ll_p->head, n_new);
+    }
+
+    ll_p->head = n_new;      /*Set the new head in the dsc.*/
+    if(ll_p->tail == NULL) { /*If there is no tail (1. node) set the tail too*/
+        ll_p->tail = n_new;
     }
 
     return n_new;
@@ -109,6 +123,7 @@ void * lv_ll_ins_prev(lv_ll_t * ll_p, void * n_act)
 
     if(NULL == ll_p || NULL == n_act) return NULL;
 
+    LV_MEM_TRACE_SET_CALLER();
     if(lv_ll_get_head(ll_p) == n_act) {
         n_new = lv_ll_ins_head(ll_p);
         if(n_new == NULL) return NULL;
@@ -135,6 +150,7 @@ void * lv_ll_ins_tail(lv_ll_t * ll_p)
 {
     lv_ll_node_t * n_new;
 
+    LV_MEM_TRACE_SET_CALLER();
     n_new = lv_mem_alloc(ll_p->n_size + LL_NODE_META_SIZE);
     if(n_new == NULL) return NULL;
 
@@ -21,6 +21,8 @@ extern "C" {
 /*********************
  *      DEFINES
  *********************/
+/** Memory enough for a node of `n_size` bytes of data and its links*/
+#define LV_LL_NODE_SIZE(n_size) ((((n_size) + 7) & ~7) + 2 * sizeof(lv_ll_node_t *))
 
 /**********************
  *      TYPEDEFS
@@ -55,6 +57,14 @@ void lv_ll_init(lv_ll_t * ll_p, uint32_t node_size);
  */
 void * lv_ll_ins_head(lv_ll_t * ll_p);
 
+/**
+ * Add a node allocated by the caller to the head of a linked list
+ * @param ll_p pointer to linked list
+ * @param n_new memory of `LV_LL_NODE_SIZE(node_size)` bytes, e.g. a block of a slab
+ * @return `n_new`, the new head
+ */
+void * lv_ll_ins_head_node(lv_ll_t * ll_p, void * n_new);
+
 /**
  * Insert a new node in front of the n_act node
  * @param ll_p pointer to linked list
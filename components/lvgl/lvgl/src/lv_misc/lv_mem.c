@@ -2,6 +2,24 @@
  * @file lv_mem.c
  * General and portable implementation of malloc and free.
  * The dynamic memory monitoring is also supported.
+ *
+ * With `LV_MEM_TLSF` the free entries are kept in segregated lists (Two-Level
+ * Segregated Fit): a list per size class, a power of 2 split in
+ * `TLSF_SL_CNT` ranges, and a bitmap of the non-empty lists. An allocation
+ * takes the first entry of the first non-empty list of a class at least as big
+ * as the size, a free joins the entry with its free neighbours: both take
+ * a constant time, however many entries the work memory holds. A free entry
+ * keeps its size in its last word, so the next one can find it.
+ *
+ * A slab (`lv_mem_slab_t`) is an array of blocks of one size allocated here
+ * at once, its free blocks chained through their first word. `lv_mem_free`,
+ * `lv_mem_realloc` and `lv_mem_get_size` recognize its blocks by their address.
+ *
+ * With `LV_USE_MEM_TRACE` every call from outside is recorded in a ring: the
+ * calls lv_mem makes to itself (e.g. the allocation of a reallocation) are
+ * part of the outer one. A reallocation is the free of the old entry and the
+ * allocation of the new one, both recorded, so replaying the records backward
+ * from the entries at the dump gives the work memory at every record.
  */
 
 /*********************
@@ -9,12 +27,17 @@
  *********************/
 #include "lv_mem.h"
 #include "lv_math.h"
+#include <stdbool.h>
 #include <string.h>
 
 #if LV_MEM_CUSTOM != 0
 #include LV_MEM_CUSTOM_INCLUDE
 #endif
 
+#if LV_USE_MEM_TRACE
+#include LV_MEM_TRACE_TIME_INCLUDE
+#endif
+
 /*********************
  *      DEFINES
  *********************/
@@ -25,8 +48,39 @@
 
 #ifdef LV_ARCH_64
 #define MEM_UNIT uint64_t
+#define MEM_ALIGN_LOG2 3
 #else
 #define MEM_UNIT uint32_t
+#define MEM_ALIGN_LOG2 2
+#endif
+
+#if LV_MEM_CUSTOM == 0 && LV_MEM_TLSF
+#define MEM_TLSF 1
+#else
+#define MEM_TLSF 0
+#endif
+
+#if LV_USE_MEM_TRACE && LV_MEM_CUSTOM != 0
+#error "LV_USE_MEM_TRACE: the trace is of the work memory of the built-in allocator, set LV_MEM_CUSTOM to 0"
+#endif
+
+#if MEM_TLSF
+/*Second level: the sizes between two powers of 2 are split in TLSF_SL_CNT lists*/
+#define TLSF_SL_LOG2    3
+#define TLSF_SL_CNT     (1 << TLSF_SL_LOG2)
+/*Below TLSF_SMALL_SIZE the lists are linear: one per multiple of the alignment*/
+#define TLSF_FL_SHIFT   (TLSF_SL_LOG2 + MEM_ALIGN_LOG2)
+#define TLSF_SMALL_SIZE (1 << TLSF_FL_SHIFT)
+/*First level: a class per power of 2 up to the work memory*/
+#define TLSF_FL_MAX     17
+#define TLSF_FL_CNT     (TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+/*The data of a free entry holds its links and its size*/
+#define TLSF_MIN_SIZE   ((sizeof(tlsf_links_t) + sizeof(uint32_t) + sizeof(MEM_UNIT) - 1) & ~(sizeof(MEM_UNIT) - 1))
+#define TLSF_NONE       UINT32_MAX
+
+#if LV_MEM_SIZE > (1 << TLSF_FL_MAX)
+#error "LV_MEM_TLSF: LV_MEM_SIZE is bigger than the size classes, raise TLSF_FL_MAX"
+#endif
 #endif
 
 /**********************
@@ -41,7 +95,12 @@ typedef union
     struct
     {
         MEM_UNIT used : 1;    /* 1: if the entry is used*/
+#if MEM_TLSF
+        MEM_UNIT prev_free : 1; /* 1: the previous entry is free, its size is in its last word*/
+        MEM_UNIT d_size : 30; /* Size off the data (1 means 4 bytes)*/
+#else
         MEM_UNIT d_size : 31; /* Size off the data (1 means 4 bytes)*/
+#endif
     } s;
     MEM_UNIT header; /* The header (used + d_size)*/
 } lv_mem_header_t;
@@ -54,14 +113,42 @@ typedef struct
 
 #endif /* LV_ENABLE_GC */
 
+#if MEM_TLSF
+/*Neighbours of a free entry in its list, as offsets in the work memory*/
+typedef struct
+{
+    uint32_t next;
+    uint32_t prev;
+} tlsf_links_t;
+#endif
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static lv_mem_slab_t * slab_find(const void * data);
+static void slab_free(lv_mem_slab_t * slab, const void * data);
+static void * slab_realloc(lv_mem_slab_t * slab, void * data_p, size_t new_size);
+#if LV_USE_MEM_TRACE
+static const void * trace_site_take(const void * caller);
+static void * trace_alloc(size_t size, const void * caller);
+static void trace_free(const void * data, const void * caller);
+static void * trace_realloc(void * data_p, size_t new_size, const void * caller);
+static void * trace_slab_alloc(lv_mem_slab_t * slab, const void * caller);
+static void trace_add(lv_mem_trace_type_t type, const void * site, const void * data, uint32_t size);
+#endif
 #if LV_MEM_CUSTOM == 0
 static lv_mem_ent_t * ent_get_next(lv_mem_ent_t * act_e);
+#if MEM_TLSF
+static void tlsf_init(void);
+static void * tlsf_alloc(size_t size);
+static void tlsf_free(lv_mem_ent_t * e);
+static void tlsf_trunc(lv_mem_ent_t * e, size_t size);
+static bool tlsf_grow(lv_mem_ent_t * e, size_t size);
+#else
 static void * ent_alloc(lv_mem_ent_t * e, size_t size);
 static void ent_trunc(lv_mem_ent_t * e, size_t size);
 #endif
+#endif
 
 /**********************
  *  STATIC VARIABLES
@@ -70,7 +157,22 @@ static void ent_trunc(lv_mem_ent_t * e, size_t size);
 static uint8_t * work_mem;
 #endif
 
+#if MEM_TLSF
+static uint32_t tlsf_fl_map;                              /*Bit `fl`: a list of the class `fl` isn't empty*/
+static uint32_t tlsf_sl_map[TLSF_FL_CNT];                 /*Bit `sl`: the list `sl` of the class isn't empty*/
+static uint32_t tlsf_heads[TLSF_FL_CNT][TLSF_SL_CNT];     /*First entry of each list*/
+#endif
+
 static uint32_t zero_mem; /*Give the address of this variable if 0 byte should be allocated*/
+static lv_mem_slab_t * slab_first; /*The slabs which have their memory*/
+
+#if LV_USE_MEM_TRACE
+static lv_mem_trace_rec_t trace_ring[LV_MEM_TRACE_CNT];
+static uint32_t trace_cnt;      /*Records written since `lv_mem_init`*/
+static uint32_t trace_fail_cnt;
+static uint8_t trace_nest;      /*Calls in progress: only the outer one is recorded*/
+static const void * trace_site; /*Set by `lv_mem_trace_set_site` for the next call*/
+#endif
 
 /**********************
  *      MACROS
@@ -95,11 +197,21 @@ void lv_mem_init(void)
     work_mem = (uint8_t *)LV_MEM_ADR;
 #endif
 
+#if MEM_TLSF
+    tlsf_init();
+#else
     lv_mem_ent_t * full = (lv_mem_ent_t *)work_mem;
     full->header.s.used = 0;
     /*The total mem size id reduced by the first header and the close patterns */
     full->header.s.d_size = LV_MEM_SIZE - sizeof(lv_mem_header_t);
 #endif
+#endif
+
+#if LV_USE_MEM_TRACE
+    trace_cnt      = 0;
+    trace_fail_cnt = 0;
+    trace_site     = NULL;
+#endif
 }
 
 /**
@@ -110,11 +222,25 @@ void lv_mem_deinit(void)
 {
 #if LV_MEM_CUSTOM == 0
     memset(work_mem, 0x00, (LV_MEM_SIZE / sizeof(MEM_UNIT)) * sizeof(MEM_UNIT));
+
+    /*The memory of the slabs is gone: their next allocation takes it again*/
+    while(slab_first != NULL) {
+        lv_mem_slab_t * slab = slab_first;
+        slab_first           = slab->next;
+        slab->buf            = NULL;
+        slab->free_p         = NULL;
+        slab->used_cnt       = 0;
+        slab->next           = NULL;
+    }
+#if MEM_TLSF
+    tlsf_init();
+#else
     lv_mem_ent_t * full = (lv_mem_ent_t *)work_mem;
     full->header.s.used = 0;
     /*The total mem size id reduced by the first header and the close patterns */
     full->header.s.d_size = LV_MEM_SIZE - sizeof(lv_mem_header_t);
 #endif
+#endif
 }
 
 /**
@@ -124,6 +250,10 @@ void lv_mem_deinit(void)
  */
 void * lv_mem_alloc(size_t size)
 {
+#if LV_USE_MEM_TRACE
+    if(trace_nest == 0) return trace_alloc(size, LV_MEM_TRACE_CALLER);
+#endif
+
     if(size == 0) {
         return &zero_mem;
     }
@@ -143,7 +273,9 @@ void * lv_mem_alloc(size_t size)
 #endif
     void * alloc = NULL;
 
-#if LV_MEM_CUSTOM == 0
+#if MEM_TLSF
+    alloc = tlsf_alloc(size);
+#elif LV_MEM_CUSTOM == 0
     /*Use the built-in allocators*/
     lv_mem_ent_t * e = NULL;
 
@@ -190,9 +322,22 @@ void * lv_mem_alloc(size_t size)
  */
 void lv_mem_free(const void * data)
 {
+#if LV_USE_MEM_TRACE
+    if(trace_nest == 0) {
+        trace_free(data, LV_MEM_TRACE_CALLER);
+        return;
+    }
+#endif
+
     if(data == &zero_mem) return;
     if(data == NULL) return;
 
+    lv_mem_slab_t * slab = slab_find(data);
+    if(slab != NULL) {
+        slab_free(slab, data);
+        return;
+    }
+
 #if LV_MEM_ADD_JUNK
     memset((void *)data, 0xbb, lv_mem_get_size(data));
 #endif
@@ -203,7 +348,9 @@ void lv_mem_free(const void * data)
     e->header.s.used = 0;
 #endif
 
-#if LV_MEM_CUSTOM == 0
+#if MEM_TLSF
+    tlsf_free(e);
+#elif LV_MEM_CUSTOM == 0
 #if LV_MEM_AUTO_DEFRAG
     /* Make a simple defrag.
      * Join the following free entries after this*/
@@ -239,6 +386,14 @@ void lv_mem_free(const void * data)
 
 void * lv_mem_realloc(void * data_p, size_t new_size)
 {
+#if LV_USE_MEM_TRACE
+    if(trace_nest == 0) return trace_realloc(data_p, new_size, LV_MEM_TRACE_CALLER);
+#endif
+
+    /*A block of a slab has no header*/
+    lv_mem_slab_t * slab = slab_find(data_p);
+    if(slab != NULL) return slab_realloc(slab, data_p, new_size);
+
     /*data_p could be previously freed pointer (in this case it is invalid)*/
     if(data_p != NULL) {
         lv_mem_ent_t * e = (lv_mem_ent_t *)((uint8_t *)data_p - sizeof(lv_mem_header_t));
@@ -250,7 +405,17 @@ void * lv_mem_realloc(void * data_p, size_t new_size)
     uint32_t old_size = lv_mem_get_size(data_p);
     if(old_size == new_size) return data_p; /*Also avoid reallocating the same memory*/
 
-#if LV_MEM_CUSTOM == 0
+#if MEM_TLSF
+    /* Truncate the memory if the new size is smaller, take the next entry if it's free and big enough. */
+    if(old_size != 0) {
+        lv_mem_ent_t * e = (lv_mem_ent_t *)((uint8_t *)data_p - sizeof(lv_mem_header_t));
+        if(new_size < old_size) {
+            tlsf_trunc(e, new_size);
+            return data_p;
+        }
+        if(tlsf_grow(e, new_size)) return data_p;
+    }
+#elif LV_MEM_CUSTOM == 0
     /* Truncate the memory if the new size is smaller. */
     if(new_size < old_size) {
         lv_mem_ent_t * e = (lv_mem_ent_t *)((uint8_t *)data_p - sizeof(lv_mem_header_t));
@@ -279,6 +444,9 @@ void * lv_mem_realloc(void * data_p, size_t new_size)
 
 void * lv_mem_realloc(void * data_p, size_t new_size)
 {
+    lv_mem_slab_t * slab = slab_find(data_p);
+    if(slab != NULL) return slab_realloc(slab, data_p, new_size);
+
     void * new_p = LV_MEM_CUSTOM_REALLOC(data_p, new_size);
     if(new_p == NULL) LV_LOG_WARN("Couldn't allocate memory");
     return new_p;
@@ -291,7 +459,9 @@ void * lv_mem_realloc(void * data_p, size_t new_size)
  */
 void lv_mem_defrag(void)
 {
-#if LV_MEM_CUSTOM == 0
+#if MEM_TLSF
+    /*Nothing to do: a free entry is joined with its free neighbours right away*/
+#elif LV_MEM_CUSTOM == 0
     lv_mem_ent_t * e_free;
     lv_mem_ent_t * e_next;
     e_free = ent_get_next(NULL);
@@ -361,6 +531,12 @@ void lv_mem_monitor(lv_mem_monitor_t * mon_p)
     mon_p->frag_pct   = (uint32_t)mon_p->free_biggest_size * 100U / mon_p->free_size;
     mon_p->frag_pct   = 100 - mon_p->frag_pct;
 #endif
+
+    lv_mem_slab_t * slab;
+    for(slab = slab_first; slab != NULL; slab = slab->next) {
+        mon_p->slab_size += slab->block_size * slab->block_cnt;
+        mon_p->slab_free_size += slab->block_size * (slab->block_cnt - slab->used_cnt);
+    }
 }
 
 /**
@@ -376,6 +552,9 @@ uint32_t lv_mem_get_size(const void * data)
     if(data == NULL) return 0;
     if(data == &zero_mem) return 0;
 
+    lv_mem_slab_t * slab = slab_find(data);
+    if(slab != NULL) return slab->block_size;
+
     lv_mem_ent_t * e = (lv_mem_ent_t *)((uint8_t *)data - sizeof(lv_mem_header_t));
 
     return e->header.s.d_size;
@@ -385,15 +564,326 @@ uint32_t lv_mem_get_size(const void * data)
 
 uint32_t lv_mem_get_size(const void * data)
 {
+    lv_mem_slab_t * slab = slab_find(data);
+    if(slab != NULL) return slab->block_size;
+
     return LV_MEM_CUSTOM_GET_SIZE(data);
 }
 
 #endif /*LV_ENABLE_GC*/
 
+/**
+ * Take a block of a slab. The first one allocates the memory of the slab.
+ * @param slab pointer to a slab
+ * @return pointer to a block of `slab->block_size` bytes or NULL if every block is used
+ *         (or there is no memory for the slab): allocate with `lv_mem_alloc` then
+ */
+void * lv_mem_slab_alloc(lv_mem_slab_t * slab)
+{
+#if LV_USE_MEM_TRACE
+    if(trace_nest == 0) return trace_slab_alloc(slab, LV_MEM_TRACE_CALLER);
+#endif
+
+    if(slab->buf == NULL) {
+        if(slab->block_cnt == 0) {
+            slab->full_cnt++;
+            return NULL;
+        }
+
+        /*A free block holds the next one, and the blocks are aligned like the entries*/
+        uint32_t size    = LV_MATH_MAX(slab->block_size, sizeof(void *));
+        slab->block_size = (size + sizeof(MEM_UNIT) - 1) & ~(sizeof(MEM_UNIT) - 1);
+        slab->buf        = lv_mem_alloc((size_t)slab->block_size * slab->block_cnt);
+        if(slab->buf == NULL) return NULL;
+
+        /*Chain the blocks in the order of their address*/
+        uint32_t i;
+        slab->free_p = NULL;
+        for(i = slab->block_cnt; i > 0; i--) {
+            void * block = &slab->buf[(i - 1) * slab->block_size];
+            *(void **)block = slab->free_p;
+            slab->free_p    = block;
+        }
+        slab->used_cnt = 0;
+        slab->next     = slab_first;
+        slab_first     = slab;
+    }
+
+    void * block = slab->free_p;
+    if(block == NULL) {
+        slab->full_cnt++;
+        return NULL;
+    }
+
+    slab->free_p = *(void **)block;
+    slab->used_cnt++;
+    if(slab->used_cnt > slab->used_max) slab->used_max = slab->used_cnt;
+
+#if LV_MEM_ADD_JUNK
+    memset(block, 0xaa, slab->block_size);
+#endif
+
+    return block;
+}
+
+/**
+ * Iterate the slabs which have their memory
+ * @param slab pointer to a slab or NULL to get the first one
+ * @return the slab after `slab` or NULL if there are no more
+ */
+lv_mem_slab_t * lv_mem_slab_get_next(const lv_mem_slab_t * slab)
+{
+    return slab != NULL ? slab->next : slab_first;
+}
+
+#if LV_USE_MEM_TRACE
+/**
+ * Trace the next allocation or free at another call site, e.g. in a function which allocates for its caller.
+ * A site set before is kept: the outer function wins. See `LV_MEM_TRACE_SET_CALLER`.
+ * @param site a return address
+ */
+void lv_mem_trace_set_site(const void * site)
+{
+    if(trace_site == NULL) trace_site = site;
+}
+
+/**
+ * Get the number of allocations which failed since `lv_mem_init`
+ * @return the number of failed allocations
+ */
+uint32_t lv_mem_trace_get_fail_cnt(void)
+{
+    return trace_fail_cnt;
+}
+
+/**
+ * Write the trace: the records still in the ring, then the used entries and the slabs
+ * at the moment, so the heap can be replayed back to the oldest record. See `lv_mem_trace_head_t`.
+ * @param write_cb called with the bytes of the dump in order
+ */
+void lv_mem_trace_dump(lv_mem_trace_write_cb_t write_cb)
+{
+    lv_mem_trace_head_t head;
+    lv_mem_ent_t * e;
+    lv_mem_slab_t * slab;
+
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, "LVMT", sizeof(head.magic));
+    head.version     = 1;
+    head.header_size = sizeof(lv_mem_header_t);
+#if MEM_TLSF
+    head.heap_size = LV_MEM_SIZE - sizeof(lv_mem_header_t); /*Without the closing entry*/
+#else
+    head.heap_size = LV_MEM_SIZE;
+#endif
+    head.time     = LV_MEM_TRACE_TIME_EXPR;
+    head.rec_cnt  = LV_MATH_MIN(trace_cnt, LV_MEM_TRACE_CNT);
+    head.lost_cnt = trace_cnt - head.rec_cnt;
+    for(e = ent_get_next(NULL); e != NULL; e = ent_get_next(e)) {
+        if(e->header.s.used) head.ent_cnt++;
+    }
+    for(slab = slab_first; slab != NULL; slab = slab->next) head.slab_cnt++;
+    write_cb(&head, sizeof(head));
+
+    /*The ring from the oldest record*/
+    uint32_t oldest = head.lost_cnt ? trace_cnt % LV_MEM_TRACE_CNT : 0;
+    write_cb(&trace_ring[oldest], (head.rec_cnt - oldest) * sizeof(lv_mem_trace_rec_t));
+    if(oldest != 0) write_cb(trace_ring, oldest * sizeof(lv_mem_trace_rec_t));
+
+    for(e = ent_get_next(NULL); e != NULL; e = ent_get_next(e)) {
+        if(e->header.s.used == 0) continue;
+
+        lv_mem_trace_ent_t ent;
+        ent.offset = &e->first_data - work_mem;
+        ent.size   = e->header.s.d_size;
+        write_cb(&ent, sizeof(ent));
+    }
+
+    for(slab = slab_first; slab != NULL; slab = slab->next) {
+        lv_mem_trace_slab_t s;
+        memset(&s, 0, sizeof(s));
+        s.offset     = slab->buf - work_mem;
+        s.block_size = slab->block_size;
+        s.block_cnt  = slab->block_cnt;
+        s.used_cnt   = slab->used_cnt;
+        strncpy(s.name, slab->name, sizeof(s.name));
+        write_cb(&s, sizeof(s));
+    }
+}
+#endif
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
 
+/**
+ * Find the slab of a block
+ * @param data pointer to an allocated memory
+ * @return the slab of `data` or NULL if it's not a block of a slab
+ */
+static lv_mem_slab_t * slab_find(const void * data)
+{
+    const uint8_t * p = data;
+    lv_mem_slab_t * slab;
+
+    for(slab = slab_first; slab != NULL; slab = slab->next) {
+        if(p >= slab->buf && p < slab->buf + slab->block_size * slab->block_cnt) break;
+    }
+
+    return slab;
+}
+
+/**
+ * Give a block back to its slab
+ * @param slab the slab of `data`
+ * @param data pointer to a block of `slab`
+ */
+static void slab_free(lv_mem_slab_t * slab, const void * data)
+{
+    void * block = (void *)data;
+
+#if LV_MEM_ADD_JUNK
+    memset(block, 0xbb, slab->block_size);
+#endif
+
+    *(void **)block = slab->free_p;
+    slab->free_p    = block;
+    slab->used_cnt--;
+}
+
+/**
+ * Reallocate a block of a slab. It keeps its size: the data moves to the heap only if it's bigger.
+ * @param slab the slab of `data_p`
+ * @param data_p pointer to a block of `slab`
+ * @param new_size the desired new size in byte
+ * @return pointer to the new memory
+ */
+static void * slab_realloc(lv_mem_slab_t * slab, void * data_p, size_t new_size)
+{
+    if(new_size <= slab->block_size) return data_p;
+
+    void * new_p = lv_mem_alloc(new_size);
+    if(new_p != NULL) {
+        memcpy(new_p, data_p, slab->block_size);
+        slab_free(slab, data_p);
+    }
+
+    return new_p;
+}
+
+#if LV_USE_MEM_TRACE
+/**
+ * The site of a call: the one set by `lv_mem_trace_set_site` or its return address
+ */
+static const void * trace_site_take(const void * caller)
+{
+    const void * site = trace_site != NULL ? trace_site : caller;
+    trace_site        = NULL;
+    return site;
+}
+
+static void * trace_alloc(size_t size, const void * caller)
+{
+    const void * site = trace_site_take(caller);
+
+    trace_nest++;
+    void * alloc = lv_mem_alloc(size);
+    trace_nest--;
+
+    if(alloc == NULL) trace_add(LV_MEM_TRACE_FAIL, site, NULL, size);
+    else if(alloc != &zero_mem) trace_add(LV_MEM_TRACE_ALLOC, site, alloc, lv_mem_get_size(alloc));
+
+    return alloc;
+}
+
+static void trace_free(const void * data, const void * caller)
+{
+    const void * site = trace_site_take(caller);
+
+    if(data != NULL && data != &zero_mem) {
+        lv_mem_trace_type_t type = slab_find(data) ? LV_MEM_TRACE_FREE | LV_MEM_TRACE_BLOCK : LV_MEM_TRACE_FREE;
+        trace_add(type, site, data, lv_mem_get_size(data));
+    }
+
+    trace_nest++;
+    lv_mem_free(data);
+    trace_nest--;
+}
+
+static void * trace_realloc(void * data_p, size_t new_size, const void * caller)
+{
+    const void * site = trace_site_take(caller);
+
+    /*The old data the way lv_mem_realloc sees it: a freed entry is nothing*/
+    uint32_t old_size = 0;
+    lv_mem_trace_type_t old_type = LV_MEM_TRACE_FREE;
+    if(slab_find(data_p) != NULL) {
+        old_size = lv_mem_get_size(data_p);
+        old_type |= LV_MEM_TRACE_BLOCK;
+    } else if(data_p != NULL && data_p != &zero_mem) {
+        lv_mem_ent_t * e = (lv_mem_ent_t *)((uint8_t *)data_p - sizeof(lv_mem_header_t));
+        if(e->header.s.used) old_size = e->header.s.d_size;
+    }
+
+    trace_nest++;
+    void * new_p = lv_mem_realloc(data_p, new_size);
+    trace_nest--;
+
+    if(new_p == NULL) {
+        trace_add(LV_MEM_TRACE_FAIL, site, NULL, new_size);
+        return NULL;
+    }
+    if(new_p == data_p && lv_mem_get_size(new_p) == old_size) return new_p;
+
+    if(old_size != 0) trace_add(old_type, site, data_p, old_size);
+    if(new_p != &zero_mem) {
+        lv_mem_trace_type_t type = old_size != 0 ? LV_MEM_TRACE_REALLOC : LV_MEM_TRACE_ALLOC;
+        if(slab_find(new_p) != NULL) type |= LV_MEM_TRACE_BLOCK;
+        trace_add(type, site, new_p, lv_mem_get_size(new_p));
+    }
+
+    return new_p;
+}
+
+static void * trace_slab_alloc(lv_mem_slab_t * slab, const void * caller)
+{
+    const void * site = trace_site != NULL ? trace_site : caller;
+    uint8_t * buf     = slab->buf;
+
+    trace_nest++;
+    void * block = lv_mem_slab_alloc(slab);
+    trace_nest--;
+
+    if(slab->buf != buf) {
+        lv_mem_ent_t * e = (lv_mem_ent_t *)(slab->buf - sizeof(lv_mem_header_t));
+        trace_add(LV_MEM_TRACE_SLAB, site, slab->buf, e->header.s.d_size);
+    } else if(buf == NULL && slab->block_cnt != 0) {
+        trace_add(LV_MEM_TRACE_FAIL, site, NULL, slab->block_size * slab->block_cnt);
+    }
+
+    /*Full: the site is for the allocation which stands in for the block*/
+    if(block == NULL) return NULL;
+
+    trace_site = NULL;
+    trace_add(LV_MEM_TRACE_ALLOC | LV_MEM_TRACE_BLOCK, site, block, slab->block_size);
+
+    return block;
+}
+
+static void trace_add(lv_mem_trace_type_t type, const void * site, const void * data, uint32_t size)
+{
+    lv_mem_trace_rec_t * rec = &trace_ring[trace_cnt % LV_MEM_TRACE_CNT];
+
+    rec->time      = LV_MEM_TRACE_TIME_EXPR;
+    rec->site      = (int32_t)((uintptr_t)site - (uintptr_t)lv_mem_alloc);
+    rec->offset    = data != NULL ? (uint32_t)((const uint8_t *)data - work_mem) : 0;
+    rec->size_type = (size & 0xffffff) | ((uint32_t)type << 24);
+    trace_cnt++;
+
+    if(type == LV_MEM_TRACE_FAIL) trace_fail_cnt++;
+}
+#endif
+
 #if LV_MEM_CUSTOM == 0
 /**
  * Give the next entry after 'act_e'
@@ -416,6 +906,7 @@ static lv_mem_ent_t * ent_get_next(lv_mem_ent_t * act_e)
     return next_e;
 }
 
+#if MEM_TLSF == 0
 /**
  * Try to do the real allocation with a given size
  * @param e try to allocate to this entry
@@ -478,4 +969,282 @@ static void ent_trunc(lv_mem_ent_t * e, size_t size)
     e->header.s.d_size = (uint32_t)size;
 }
 
+#else /*MEM_TLSF*/
+
+static inline lv_mem_ent_t * tlsf_ent(uint32_t offset)
+{
+    return (lv_mem_ent_t *)&work_mem[offset];
+}
+
+static inline uint32_t tlsf_offset(lv_mem_ent_t * e)
+{
+    return (uint32_t)((uint8_t *)e - work_mem);
+}
+
+static inline tlsf_links_t * tlsf_links(lv_mem_ent_t * e)
+{
+    return (tlsf_links_t *)&e->first_data;
+}
+
+/*The entry after `e` in the work memory: the closing entry after the last one*/
+static inline lv_mem_ent_t * tlsf_next(lv_mem_ent_t * e)
+{
+    return (lv_mem_ent_t *)(&e->first_data + e->header.s.d_size);
+}
+
+/*The entry before `e`, only when it's free*/
+static inline lv_mem_ent_t * tlsf_prev(lv_mem_ent_t * e)
+{
+    uint32_t prev_size = ((uint32_t *)e)[-1];
+    return (lv_mem_ent_t *)((uint8_t *)e - prev_size - sizeof(lv_mem_header_t));
+}
+
+/*Index of the most significant bit set, `x` not 0*/
+static inline uint32_t tlsf_fls(uint32_t x)
+{
+    return 31 - __builtin_clz(x);
+}
+
+/*Index of the least significant bit set, `x` not 0*/
+static inline uint32_t tlsf_ffs(uint32_t x)
+{
+    return __builtin_ctz(x);
+}
+
+/**
+ * Give the list of the entries of a size
+ * @param size size of the data in bytes, a multiple of the alignment
+ * @param fl store the class here
+ * @param sl store the list in the class here
+ */
+static void tlsf_mapping(size_t size, uint32_t * fl, uint32_t * sl)
+{
+    if(size < TLSF_SMALL_SIZE) {
+        *fl = 0;
+        *sl = (uint32_t)size >> MEM_ALIGN_LOG2;
+    } else {
+        uint32_t t = tlsf_fls((uint32_t)size);
+        *sl = ((uint32_t)size >> (t - TLSF_SL_LOG2)) ^ TLSF_SL_CNT;
+        *fl = t - TLSF_FL_SHIFT + 1;
+    }
+}
+
+/**
+ * Give the first non-empty list from a list on, in its class or in a bigger one
+ * @param fl class, updated to the class of the list found
+ * @param sl list in the class, updated to the list found
+ * @return true if a list was found
+ */
+static bool tlsf_find(uint32_t * fl, uint32_t * sl)
+{
+    if(*fl >= TLSF_FL_CNT) return false;
+
+    uint32_t sl_map = tlsf_sl_map[*fl] & (~0U << *sl);
+    if(sl_map == 0) {
+        uint32_t fl_map = tlsf_fl_map & (~0U << (*fl + 1));
+        if(fl_map == 0) return false;
+
+        *fl = tlsf_ffs(fl_map);
+        sl_map = tlsf_sl_map[*fl];
+    }
+    *sl = tlsf_ffs(sl_map);
+
+    return true;
+}
+
+/**
+ * Add an entry to the list of its size and mark it free
+ * @param e pointer to an entry, not in a list
+ */
+static void tlsf_insert(lv_mem_ent_t * e)
+{
+    uint32_t fl, sl;
+    tlsf_mapping(e->header.s.d_size, &fl, &sl);
+
+    tlsf_links_t * links = tlsf_links(e);
+    links->prev = TLSF_NONE;
+    links->next = tlsf_heads[fl][sl];
+    if(links->next != TLSF_NONE) tlsf_links(tlsf_ent(links->next))->prev = tlsf_offset(e);
+    tlsf_heads[fl][sl] = tlsf_offset(e);
+    tlsf_fl_map |= 1U << fl;
+    tlsf_sl_map[fl] |= 1U << sl;
+
+    e->header.s.used = 0;
+    ((uint32_t *)tlsf_next(e))[-1] = e->header.s.d_size;
+    tlsf_next(e)->header.s.prev_free = 1;
+}
+
+/**
+ * Remove a free entry from its list
+ * @param e pointer to a free entry
+ */
+static void tlsf_remove(lv_mem_ent_t * e)
+{
+    uint32_t fl, sl;
+    tlsf_mapping(e->header.s.d_size, &fl, &sl);
+
+    tlsf_links_t * links = tlsf_links(e);
+    if(links->next != TLSF_NONE) tlsf_links(tlsf_ent(links->next))->prev = links->prev;
+    if(links->prev != TLSF_NONE) {
+        tlsf_links(tlsf_ent(links->prev))->next = links->next;
+    } else {
+        tlsf_heads[fl][sl] = links->next;
+        if(links->next == TLSF_NONE) {
+            tlsf_sl_map[fl] &= ~(1U << sl);
+            if(tlsf_sl_map[fl] == 0) tlsf_fl_map &= ~(1U << fl);
+        }
+    }
+}
+
+/**
+ * Mark a free entry used
+ * @param e pointer to a free entry
+ */
+static void tlsf_take(lv_mem_ent_t * e)
+{
+    tlsf_remove(e);
+    e->header.s.used = 1;
+    tlsf_next(e)->header.s.prev_free = 0;
+}
+
+/**
+ * Round a size up to the alignment and to the smallest entry
+ * @param size size in bytes
+ * @return the size of the entry
+ */
+static size_t tlsf_size(size_t size)
+{
+    size = (size + sizeof(MEM_UNIT) - 1) & ~(sizeof(MEM_UNIT) - 1);
+    return size < TLSF_MIN_SIZE ? TLSF_MIN_SIZE : size;
+}
+
+/**
+ * Empty the lists and make the work memory a single free entry, closed by a used one without data
+ * which spares checking the end of the work memory when looking at the next entry.
+ */
+static void tlsf_init(void)
+{
+    tlsf_fl_map = 0;
+    memset(tlsf_sl_map, 0, sizeof(tlsf_sl_map));
+    memset(tlsf_heads, 0xff, sizeof(tlsf_heads));
+
+    lv_mem_ent_t * full = (lv_mem_ent_t *)work_mem;
+    full->header.header = 0;
+    full->header.s.d_size = LV_MEM_SIZE - 2 * sizeof(lv_mem_header_t);
+
+    lv_mem_ent_t * end = tlsf_next(full);
+    end->header.header = 0;
+    end->header.s.used = 1;
+
+    tlsf_insert(full);
+}
+
+/**
+ * Allocate an entry
+ * @param size size of the data in bytes
+ * @return pointer to the data or NULL if there is no free entry big enough
+ */
+static void * tlsf_alloc(size_t size)
+{
+    /*Also keeps the classes in the lists*/
+    if(size > LV_MEM_SIZE - 2 * sizeof(lv_mem_header_t)) return NULL;
+    size = tlsf_size(size);
+
+    /*A list whose entries are all big enough: the size rounded up to the next list*/
+    uint32_t fl, sl;
+    size_t search = size;
+    if(search >= TLSF_SMALL_SIZE) search += (1U << (tlsf_fls((uint32_t)search) - TLSF_SL_LOG2)) - 1;
+    tlsf_mapping(search, &fl, &sl);
+
+    lv_mem_ent_t * e = NULL;
+    if(tlsf_find(&fl, &sl)) {
+        e = tlsf_ent(tlsf_heads[fl][sl]);
+    } else {
+        /*Almost full: an entry of the list of the size itself may still be big enough*/
+        tlsf_mapping(size, &fl, &sl);
+        uint32_t offset = tlsf_heads[fl][sl];
+        while(offset != TLSF_NONE && tlsf_ent(offset)->header.s.d_size < size) {
+            offset = tlsf_links(tlsf_ent(offset))->next;
+        }
+        if(offset == TLSF_NONE) return NULL;
+        e = tlsf_ent(offset);
+    }
+
+    tlsf_take(e);
+    tlsf_trunc(e, size);
+
+    return &e->first_data;
+}
+
+/**
+ * Free an entry and join it with its free neighbours
+ * @param e pointer to a used entry
+ */
+static void tlsf_free(lv_mem_ent_t * e)
+{
+    e->header.s.used = 0;
+
+    if(e->header.s.prev_free) {
+        lv_mem_ent_t * prev = tlsf_prev(e);
+        tlsf_remove(prev);
+        prev->header.s.d_size += sizeof(lv_mem_header_t) + e->header.s.d_size;
+        e = prev;
+    }
+
+    lv_mem_ent_t * next = tlsf_next(e);
+    if(next->header.s.used == 0) {
+        tlsf_remove(next);
+        e->header.s.d_size += sizeof(lv_mem_header_t) + next->header.s.d_size;
+    }
+
+    tlsf_insert(e);
+}
+
+/**
+ * Free the end of a used entry, if it's big enough for an entry
+ * @param e pointer to a used entry
+ * @param size new size of the data in bytes
+ */
+static void tlsf_trunc(lv_mem_ent_t * e, size_t size)
+{
+    size = tlsf_size(size);
+    if(e->header.s.d_size < size + sizeof(lv_mem_header_t) + TLSF_MIN_SIZE) return;
+
+    lv_mem_ent_t * rest = (lv_mem_ent_t *)(&e->first_data + size);
+    rest->header.header = 0;
+    rest->header.s.d_size = e->header.s.d_size - size - sizeof(lv_mem_header_t);
+    e->header.s.d_size = size;
+
+    lv_mem_ent_t * next = tlsf_next(rest);
+    if(next->header.s.used == 0) {
+        tlsf_remove(next);
+        rest->header.s.d_size += sizeof(lv_mem_header_t) + next->header.s.d_size;
+    }
+
+    tlsf_insert(rest);
+}
+
+/**
+ * Enlarge a used entry with the next one, if it's free and big enough
+ * @param e pointer to a used entry
+ * @param size new size of the data in bytes
+ * @return true if `e` was enlarged
+ */
+static bool tlsf_grow(lv_mem_ent_t * e, size_t size)
+{
+    lv_mem_ent_t * next = tlsf_next(e);
+    size = tlsf_size(size);
+    if(next->header.s.used || e->header.s.d_size + sizeof(lv_mem_header_t) + next->header.s.d_size < size) {
+        return false;
+    }
+
+    tlsf_take(next);
+    e->header.s.d_size += sizeof(lv_mem_header_t) + next->header.s.d_size;
+    tlsf_trunc(e, size);
+
+    return true;
+}
+
+#endif /*MEM_TLSF*/
+
 #endif
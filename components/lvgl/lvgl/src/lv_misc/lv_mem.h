@@ -44,8 +44,99 @@ typedef struct
     uint32_t used_cnt;
     uint8_t used_pct; /**< Percentage used */
     uint8_t frag_pct; /**< Amount of fragmentation */
+    uint32_t slab_size;      /**< Memory of the slabs, counted as used above */
+    uint32_t slab_free_size; /**< Size of the free blocks of the slabs */
 } lv_mem_monitor_t;
 
+/**
+ * A slab: blocks of one size for the data allocated and freed often.
+ * Its memory is allocated at once by its first `lv_mem_slab_alloc`, after that a block is
+ * taken and given back in a constant time and doesn't fragment the work memory.
+ * A block is freed by `lv_mem_free` like any other memory.
+ * Declare it with `LV_MEM_SLAB_INIT`.
+ */
+typedef struct _lv_mem_slab_t
+{
+    const char * name;    /**< For the monitors */
+    uint32_t block_size;
+    uint16_t block_cnt;
+    uint16_t used_cnt;
+    uint16_t used_max;    /**< Most blocks used at once */
+    uint16_t full_cnt;    /**< Allocations which found every block used */
+    uint8_t * buf;
+    void * free_p;        /**< First free block, each one holds the next */
+    struct _lv_mem_slab_t * next;
+} lv_mem_slab_t;
+
+#if LV_USE_MEM_TRACE
+/** Kind of a record of the trace, in the top 8 bits of `size_type`*/
+enum {
+    LV_MEM_TRACE_ALLOC,   /**< An entry allocated*/
+    LV_MEM_TRACE_REALLOC, /**< An entry allocated by a reallocation, the record before frees the old one*/
+    LV_MEM_TRACE_FREE,    /**< An entry freed*/
+    LV_MEM_TRACE_FAIL,    /**< No memory for the size*/
+    LV_MEM_TRACE_SLAB,    /**< The entry of the blocks of a slab allocated*/
+};
+typedef uint8_t lv_mem_trace_type_t;
+
+/** Or-ed to the kind of a record about a block of a slab instead of an entry*/
+#define LV_MEM_TRACE_BLOCK 0x80
+
+/**
+ * A record of the trace
+ */
+typedef struct
+{
+    uint32_t time;      /**< `LV_MEM_TRACE_TIME_EXPR` at the call */
+    int32_t site;       /**< Return address of the call, from the address of `lv_mem_alloc` */
+    uint32_t offset;    /**< Data of the entry or the block, from the start of the work memory */
+    uint32_t size_type; /**< Size of the entry or the block (asked if it failed), the kind in the top 8 bits */
+} lv_mem_trace_rec_t;
+
+/**
+ * Start of a dump of the trace, followed by `rec_cnt` records from the oldest,
+ * `ent_cnt` `lv_mem_trace_ent_t` and `slab_cnt` `lv_mem_trace_slab_t`
+ */
+typedef struct
+{
+    char magic[4];        /**< "LVMT" */
+    uint16_t version;     /**< 1 */
+    uint16_t header_size; /**< Size of the header of an entry */
+    uint32_t heap_size;   /**< Size of the work memory the entries cover */
+    uint32_t time;        /**< `LV_MEM_TRACE_TIME_EXPR` at the dump */
+    uint32_t rec_cnt;
+    uint32_t lost_cnt;    /**< Records overwritten before the dump */
+    uint32_t ent_cnt;
+    uint32_t slab_cnt;
+} lv_mem_trace_head_t;
+
+/**
+ * A used entry of the work memory at the dump
+ */
+typedef struct
+{
+    uint32_t offset; /**< Of its data */
+    uint32_t size;
+} lv_mem_trace_ent_t;
+
+/**
+ * A slab at the dump
+ */
+typedef struct
+{
+    uint32_t offset; /**< Of its entry */
+    uint32_t block_size;
+    uint16_t block_cnt;
+    uint16_t used_cnt;
+    char name[8];
+} lv_mem_trace_slab_t;
+
+/**
+ * Called by `lv_mem_trace_dump` with the next bytes of the dump
+ */
+typedef void (*lv_mem_trace_write_cb_t)(const void * data, uint32_t size);
+#endif
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -102,10 +193,64 @@ void lv_mem_monitor(lv_mem_monitor_t * mon_p);
  */
 uint32_t lv_mem_get_size(const void * data);
 
+/**
+ * Take a block of a slab. The first one allocates the memory of the slab.
+ * @param slab pointer to a slab
+ * @return pointer to a block of `slab->block_size` bytes or NULL if every block is used
+ *         (or there is no memory for the slab): allocate with `lv_mem_alloc` then
+ */
+void * lv_mem_slab_alloc(lv_mem_slab_t * slab);
+
+/**
+ * Iterate the slabs which have their memory
+ * @param slab pointer to a slab or NULL to get the first one
+ * @return the slab after `slab` or NULL if there are no more
+ */
+lv_mem_slab_t * lv_mem_slab_get_next(const lv_mem_slab_t * slab);
+
+#if LV_USE_MEM_TRACE
+/**
+ * Trace the next allocation or free at another call site, e.g. in a function which allocates for its caller.
+ * A site set before is kept: the outer function wins. See `LV_MEM_TRACE_SET_CALLER`.
+ * @param site a return address
+ */
+void lv_mem_trace_set_site(const void * site);
+
+/**
+ * Get the number of allocations which failed since `lv_mem_init`
+ * @return the number of failed allocations
+ */
+uint32_t lv_mem_trace_get_fail_cnt(void);
+
+/**
+ * Write the trace: the records still in the ring, then the used entries and the slabs
+ * at the moment, so the heap can be replayed back to the oldest record. See `lv_mem_trace_head_t`.
+ * @param write_cb called with the bytes of the dump in order
+ */
+void lv_mem_trace_dump(lv_mem_trace_write_cb_t write_cb);
+#endif
+
 /**********************
  *      MACROS
  **********************/
 
+/**
+ * Initializer of a slab
+ * @param name name of the slab, for the monitors
+ * @param block_size size of a block in bytes
+ * @param block_cnt number of blocks
+ */
+#define LV_MEM_SLAB_INIT(name, block_size, block_cnt) {(name), (block_size), (block_cnt), 0, 0, 0, NULL, NULL, NULL}
+
+/**
+ * In a function which allocates for its caller: trace its next allocation or free at the call of the function
+ */
+#if LV_USE_MEM_TRACE
+#define LV_MEM_TRACE_SET_CALLER() lv_mem_trace_set_site(LV_MEM_TRACE_CALLER)
+#else
+#define LV_MEM_TRACE_SET_CALLER()
+#endif
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -32,6 +32,8 @@
  *  STATIC PROTOTYPES
  **********************/
 static bool lv_task_exec(lv_task_t * task);
+static uint32_t lv_task_time_until_next(void);
+static void lv_task_wake_handler(void);
 
 /**********************
  *  STATIC VARIABLES
@@ -40,6 +42,8 @@ static bool lv_task_run  = false;
 static uint8_t idle_last = 0;
 static bool task_deleted;
 static bool task_created;
+static bool handler_running;
+static lv_task_wake_cb_t wake_cb;
 
 /**********************
  *      MACROS
@@ -62,23 +66,24 @@ void lv_task_core_init(void)
 
 /**
  * Call it  periodically to handle lv_tasks.
+ * @return time until the next task is due [ms], `LV_NO_TASK_READY` if no task is waiting for its period.
+ *         The caller can sleep for this time, or until the wake callback is called (see `lv_task_set_wake_cb`)
  */
-LV_ATTRIBUTE_TASK_HANDLER void lv_task_handler(void)
+LV_ATTRIBUTE_TASK_HANDLER uint32_t lv_task_handler(void)
 {
     LV_LOG_TRACE("lv_task_handler started");
 
     /*Avoid concurrent running of the task handler*/
-    static bool already_running = false;
-    if(already_running) return;
-    already_running = true;
+    if(handler_running) return 1;
+    handler_running = true;
 
     static uint32_t idle_period_start = 0;
     static uint32_t handler_start     = 0;
     static uint32_t busy_time         = 0;
 
     if(lv_task_run == false) {
-        already_running = false; /*Release mutex*/
-        return;
+        handler_running = false; /*Release mutex*/
+        return 1;
     }
 
     handler_start = lv_tick_get();
@@ -161,9 +166,13 @@ LV_ATTRIBUTE_TASK_HANDLER void lv_task_handler(void)
         idle_period_start = lv_tick_get();
     }
 
-    already_running = false; /*Release the mutex*/
+    uint32_t time_till_next = lv_task_time_until_next();
+
+    handler_running = false; /*Release the mutex*/
 
     LV_LOG_TRACE("lv_task_handler ready");
+
+    return time_till_next;
 }
 /**
  * Create an "empty" task. It needs to initialzed with at least
@@ -209,6 +218,7 @@ lv_task_t * lv_task_create_basic(void)
     new_task->prio    = DEF_PRIO;
 
     new_task->once     = 0;
+    new_task->paused   = 0;
     new_task->last_run = lv_tick_get();
 
     new_task->user_data = NULL;
@@ -239,6 +249,8 @@ lv_task_t * lv_task_create(lv_task_cb_t task_cb, uint32_t period, lv_task_prio_t
     lv_task_set_prio(new_task, prio);
     new_task->user_data = user_data;
 
+    lv_task_wake_handler();
+
     return new_task;
 }
 
@@ -290,6 +302,8 @@ void lv_task_set_prio(lv_task_t * task, lv_task_prio_t prio)
     }
 
     task->prio = prio;
+
+    lv_task_wake_handler();
 }
 
 /**
@@ -300,6 +314,8 @@ void lv_task_set_prio(lv_task_t * task, lv_task_prio_t prio)
 void lv_task_set_period(lv_task_t * task, uint32_t period)
 {
     task->period = period;
+
+    lv_task_wake_handler();
 }
 
 /**
@@ -309,6 +325,8 @@ void lv_task_set_period(lv_task_t * task, uint32_t period)
 void lv_task_ready(lv_task_t * task)
 {
     task->last_run = lv_tick_get() - task->period - 1;
+
+    lv_task_wake_handler();
 }
 
 /**
@@ -348,6 +366,50 @@ uint8_t lv_task_get_idle(void)
     return idle_last;
 }
 
+/**
+ * Stop running a task until `lv_task_resume` is called.
+ * Paused tasks are not considered in the return value of `lv_task_handler`.
+ * @param task pointer to a lv_task
+ */
+void lv_task_pause(lv_task_t * task)
+{
+    task->paused = 1;
+}
+
+/**
+ * Run a paused task again. It's called when its period elapses since its last run.
+ * @param task pointer to a lv_task
+ */
+void lv_task_resume(lv_task_t * task)
+{
+    if(task->paused == 0) return;
+
+    task->paused = 0;
+    lv_task_wake_handler();
+}
+
+/**
+ * Set a callback to wake the caller of `lv_task_handler` when a task may be due earlier than
+ * `lv_task_handler` returned, e.g. a task was created, resumed or made ready.
+ * It's not called while `lv_task_handler` runs.
+ * @param cb the callback, typically a notification of the GUI task. NULL to disable.
+ */
+void lv_task_set_wake_cb(lv_task_wake_cb_t cb)
+{
+    wake_cb = cb;
+}
+
+/**
+ * Call the wake callback (see `lv_task_set_wake_cb`).
+ * Unlike the other lv_task functions it can be called from an interrupt or an other thread
+ * if the callback allows it. Typically used by input device interrupts.
+ */
+void lv_task_wake(void)
+{
+    lv_task_wake_cb_t cb = wake_cb;
+    if(cb) cb();
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -361,6 +423,8 @@ static bool lv_task_exec(lv_task_t * task)
 {
     bool exec = false;
 
+    if(task->paused) return false;
+
     /*Execute if at least 'period' time elapsed*/
     uint32_t elp = lv_tick_elaps(task->last_run);
     if(elp >= task->period) {
@@ -380,3 +444,37 @@ static bool lv_task_exec(lv_task_t * task)
 
     return exec;
 }
+
+/**
+ * Find the task which is due first
+ * @return time until the task is due [ms] or `LV_NO_TASK_READY` if all tasks are paused or off
+ */
+static uint32_t lv_task_time_until_next(void)
+{
+    uint32_t time_till_next = LV_NO_TASK_READY;
+    lv_task_t * task;
+
+    LV_LL_READ(LV_GC_ROOT(_lv_task_ll), task)
+    {
+        /*The tasks are ordered by priority, only turned off tasks are left*/
+        if(task->prio == LV_TASK_PRIO_OFF) break;
+        if(task->paused) continue;
+
+        uint32_t elp = lv_tick_elaps(task->last_run);
+        uint32_t remaining = elp >= task->period ? 0 : task->period - elp;
+        if(remaining < time_till_next) time_till_next = remaining;
+    }
+
+    return time_till_next;
+}
+
+/**
+ * Tell the caller of `lv_task_handler` that a task might be due earlier.
+ * While the handler runs it's not required: the time is calculated after running the tasks.
+ */
+static void lv_task_wake_handler(void)
+{
+    if(handler_running) return;
+
+    lv_task_wake();
+}
@@ -31,6 +31,9 @@ extern "C" {
 #ifndef LV_ATTRIBUTE_TASK_HANDLER
 #define LV_ATTRIBUTE_TASK_HANDLER
 #endif
+
+/*Returned by `lv_task_handler` if no task has to run until something wakes it*/
+#define LV_NO_TASK_READY 0xFFFFFFFF
 /**********************
  *      TYPEDEFS
  **********************/
@@ -42,6 +45,11 @@ struct _lv_task_t;
  */
 typedef void (*lv_task_cb_t)(struct _lv_task_t *);
 
+/**
+ * Called when a task might be due earlier than `lv_task_handler` told. See `lv_task_set_wake_cb`
+ */
+typedef void (*lv_task_wake_cb_t)(void);
+
 /**
  * Possible priorities for lv_tasks
  */
@@ -69,6 +77,7 @@ typedef struct _lv_task_t
 
     uint8_t prio : 3; /**< Task priority */
     uint8_t once : 1; /**< 1: one shot task */
+    uint8_t paused : 1; /**< 1: don't run the task until `lv_task_resume` */
 } lv_task_t;
 
 /**********************
@@ -84,8 +93,10 @@ void lv_task_core_init(void);
 
 /**
  * Call it  periodically to handle lv_tasks.
+ * @return time until the next task is due [ms], `LV_NO_TASK_READY` if no task is waiting for its period.
+ *         The caller can sleep for this time, or until the wake callback is called (see `lv_task_set_wake_cb`)
  */
-LV_ATTRIBUTE_TASK_HANDLER void lv_task_handler(void);
+LV_ATTRIBUTE_TASK_HANDLER uint32_t lv_task_handler(void);
 
 //! @endcond
 
@@ -166,6 +177,34 @@ void lv_task_enable(bool en);
  */
 uint8_t lv_task_get_idle(void);
 
+/**
+ * Stop running a task until `lv_task_resume` is called.
+ * Paused tasks are not considered in the return value of `lv_task_handler`.
+ * @param task pointer to a lv_task
+ */
+void lv_task_pause(lv_task_t * task);
+
+/**
+ * Run a paused task again. It's called when its period elapses since its last run.
+ * @param task pointer to a lv_task
+ */
+void lv_task_resume(lv_task_t * task);
+
+/**
+ * Set a callback to wake the caller of `lv_task_handler` when a task may be due earlier than
+ * `lv_task_handler` returned, e.g. a task was created, resumed or made ready.
+ * It's not called while `lv_task_handler` runs.
+ * @param cb the callback, typically a notification of the GUI task. NULL to disable.
+ */
+void lv_task_set_wake_cb(lv_task_wake_cb_t cb);
+
+/**
+ * Call the wake callback (see `lv_task_set_wake_cb`).
+ * Unlike the other lv_task functions it can be called from an interrupt or an other thread
+ * if the callback allows it. Typically used by input device interrupts.
+ */
+void lv_task_wake(void);
+
 /**********************
  *      MACROS
  **********************/
@@ -46,6 +46,7 @@ static void lv_btn_ink_effect_anim_ready(lv_anim_t * a);
  **********************/
 static lv_signal_cb_t ancestor_signal;
 static lv_design_cb_t ancestor_design;
+static lv_mem_slab_t btn_slab = LV_MEM_SLAB_INIT("btn", sizeof(lv_btn_ext_t), LV_BTN_SLAB_CNT);
 
 #if LV_USE_ANIMATION && LV_BTN_INK_EFFECT
 static lv_coord_t ink_act_value;
@@ -85,7 +86,7 @@ lv_obj_t * lv_btn_create(lv_obj_t * par, const lv_obj_t * copy)
     if(ancestor_design == NULL) ancestor_design = lv_obj_get_design_cb(new_btn);
 
     /*Allocate the extended data*/
-    lv_btn_ext_t * ext = lv_obj_allocate_ext_attr(new_btn, sizeof(lv_btn_ext_t));
+    lv_btn_ext_t * ext = lv_obj_allocate_ext_attr_slab(new_btn, &btn_slab);
     LV_ASSERT_MEM(ext);
     if(ext == NULL) return NULL;
 
@@ -56,6 +56,7 @@ static void lv_label_dot_tmp_free(lv_obj_t * label);
  *  STATIC VARIABLES
  **********************/
 static lv_signal_cb_t ancestor_signal;
+static lv_mem_slab_t label_slab = LV_MEM_SLAB_INIT("label", sizeof(lv_label_ext_t), LV_LABEL_SLAB_CNT);
 
 /**********************
  *      MACROS
@@ -83,7 +84,7 @@ lv_obj_t * lv_label_create(lv_obj_t * par, const lv_obj_t * copy)
     if(ancestor_signal == NULL) ancestor_signal = lv_obj_get_signal_cb(new_label);
 
     /*Extend the basic object to a label object*/
-    lv_obj_allocate_ext_attr(new_label, sizeof(lv_label_ext_t));
+    lv_obj_allocate_ext_attr_slab(new_label, &label_slab);
 
     lv_label_ext_t * ext = lv_obj_get_ext_attr(new_label);
     LV_ASSERT_MEM(ext);
@@ -50,6 +50,7 @@ static lv_signal_cb_t img_signal;
 static lv_signal_cb_t label_signal;
 static lv_signal_cb_t ancestor_page_signal;
 static lv_signal_cb_t ancestor_btn_signal;
+static lv_mem_slab_t list_slab = LV_MEM_SLAB_INIT("list", sizeof(lv_list_ext_t), LV_LIST_SLAB_CNT);
 
 
 /**********************
@@ -77,7 +78,7 @@ lv_obj_t * lv_list_create(lv_obj_t * par, const lv_obj_t * copy)
 
     if(ancestor_page_signal == NULL) ancestor_page_signal = lv_obj_get_signal_cb(new_list);
 
-    lv_list_ext_t * ext = lv_obj_allocate_ext_attr(new_list, sizeof(lv_list_ext_t));
+    lv_list_ext_t * ext = lv_obj_allocate_ext_attr_slab(new_list, &list_slab);
     LV_ASSERT_MEM(ext);
     if(ext == NULL) return NULL;
 
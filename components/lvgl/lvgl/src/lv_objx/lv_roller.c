@@ -47,6 +47,7 @@ static void draw_bg(lv_obj_t * roller, const lv_area_t * mask);
  **********************/
 static lv_signal_cb_t ancestor_signal;
 static lv_signal_cb_t ancestor_scrl_signal;
+static lv_mem_slab_t roller_slab = LV_MEM_SLAB_INIT("roller", sizeof(lv_roller_ext_t), LV_ROLLER_SLAB_CNT);
 
 /**********************
  *      MACROS
@@ -75,7 +76,7 @@ lv_obj_t * lv_roller_create(lv_obj_t * par, const lv_obj_t * copy)
     if(ancestor_signal == NULL) ancestor_signal = lv_obj_get_signal_cb(new_roller);
 
     /*Allocate the roller type specific extended data*/
-    lv_roller_ext_t * ext = lv_obj_allocate_ext_attr(new_roller, sizeof(lv_roller_ext_t));
+    lv_roller_ext_t * ext = lv_obj_allocate_ext_attr_slab(new_roller, &roller_slab);
     LV_ASSERT_MEM(ext);
     if(ext == NULL) return NULL;
     ext->ddlist.draw_arrow = 0; /*Do not draw arrow by default*/
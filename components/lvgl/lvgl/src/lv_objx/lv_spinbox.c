@@ -34,6 +34,7 @@ static void lv_spinbox_updatevalue(lv_obj_t * spinbox);
  **********************/
 static lv_signal_cb_t ancestor_signal;
 static lv_design_cb_t ancestor_design;
+static lv_mem_slab_t spinbox_slab = LV_MEM_SLAB_INIT("spinbox", sizeof(lv_spinbox_ext_t), LV_SPINBOX_SLAB_CNT);
 
 /**********************
  *      MACROS
@@ -59,7 +60,7 @@ lv_obj_t * lv_spinbox_create(lv_obj_t * par, const lv_obj_t * copy)
     if(new_spinbox == NULL) return NULL;
 
     /*Allocate the spinbox type specific extended data*/
-    lv_spinbox_ext_t * ext = lv_obj_allocate_ext_attr(new_spinbox, sizeof(lv_spinbox_ext_t));
+    lv_spinbox_ext_t * ext = lv_obj_allocate_ext_attr_slab(new_spinbox, &spinbox_slab);
     LV_ASSERT_MEM(ext);
     if(ext == NULL) return NULL;
     if(ancestor_signal == NULL) ancestor_signal = lv_obj_get_signal_cb(new_spinbox);
@@ -0,0 +1,4 @@
+# Rotary encoder input device
+
+COMPONENT_SRCDIRS := .
+COMPONENT_ADD_INCLUDEDIRS := .
@@ -0,0 +1,111 @@
+/**
+ * @file encoder_indev.c
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "encoder_indev.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+/*A turn after this long a pause is a fresh start, not a continuation of the last one*/
+#define ENCODER_INDEV_IDLE_MS   250
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static QueueHandle_t event_queue;
+static bool btn_pressed;
+static bool btn_pending;                /*A button change is waiting for the next read*/
+static bool btn_pending_pressed;
+static uint32_t last_turn_ms;
+static uint32_t last_read_ms;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void encoder_indev_init(QueueHandle_t queue)
+{
+    event_queue = queue;
+    btn_pressed = false;
+    btn_pending = false;
+    last_turn_ms = lv_tick_get() - ENCODER_INDEV_IDLE_MS;
+    last_read_ms = lv_tick_get();
+}
+
+bool encoder_indev_read(lv_indev_drv_t * drv, lv_indev_data_t * data)
+{
+    (void) drv;
+
+    bool btn_changed = false;
+    bool more = false;
+    int32_t diff = 0;
+
+    if(btn_pending) {
+        btn_pressed = btn_pending_pressed;
+        btn_pending = false;
+        btn_changed = true;
+    }
+
+    rotary_encoder_event_t ev;
+    while(event_queue && xQueueReceive(event_queue, &ev, 0) == pdTRUE) {
+        if(ev.type == RE_ET_CHANGED) {
+            diff += ev.diff;
+            continue;
+        }
+
+        if(ev.type != RE_ET_BTN_PRESSED && ev.type != RE_ET_BTN_RELEASED) continue;  /*LittlevGL times the clicks itself*/
+
+        bool pressed = ev.type == RE_ET_BTN_PRESSED;
+        if(btn_changed) {
+            /*Report one change per read or a click within a read period is lost*/
+            btn_pending = true;
+            btn_pending_pressed = pressed;
+            more = true;
+            break;
+        }
+        btn_pressed = pressed;
+        btn_changed = true;
+    }
+
+    uint32_t now = lv_tick_get();
+    if(diff) {
+        /*Speed over the time since the previous turn. After a pause the turn starts with
+         *the first detent, somewhere after the last read: only the others count*/
+        uint32_t detents = diff < 0 ? -diff : diff;
+        uint32_t elapsed = lv_tick_elaps(last_turn_ms);
+        if(elapsed >= ENCODER_INDEV_IDLE_MS) {
+            detents--;
+            elapsed = lv_tick_elaps(last_read_ms);
+        }
+        last_turn_ms = now;
+
+        /*Reads closer than the period (more data, a late task) would overstate the speed*/
+        if(elapsed < LV_INDEV_DEF_READ_PERIOD) elapsed = LV_INDEV_DEF_READ_PERIOD;
+        uint32_t speed = detents * 1000 / elapsed;
+        int32_t steps = diff * (int32_t)encoder_indev_accel(speed);
+
+        if(steps > INT16_MAX) steps = INT16_MAX;
+        else if(steps < -INT16_MAX) steps = -INT16_MAX;
+        diff = steps;
+    }
+
+    last_read_ms = now;
+
+    data->enc_diff = (int16_t)diff;
+    data->state = btn_pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+
+    return more;
+}
+
+uint32_t encoder_indev_accel(uint32_t detents_per_s)
+{
+    uint32_t speed = CONFIG_LVGL_ENCODER_ACCEL_SPEED;
+    if(detents_per_s <= speed) return 1;
+
+    uint64_t steps = (uint64_t)detents_per_s * detents_per_s / (speed * speed);
+    return steps < CONFIG_LVGL_ENCODER_ACCEL_MAX ? (uint32_t)steps : CONFIG_LVGL_ENCODER_ACCEL_MAX;
+}
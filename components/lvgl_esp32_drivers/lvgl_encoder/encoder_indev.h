@@ -0,0 +1,53 @@
+/**
+ * @file encoder_indev.h
+ * Rotary encoder (components/encoder) as a LittlevGL encoder input device
+ */
+
+#ifndef ENCODER_INDEV_H
+#define ENCODER_INDEV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "lvgl/lvgl.h"
+#include "encoder.h"
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Read the events of the encoder from `queue`, the one given to rotary_encoder_init.
+ * Only one encoder input device is supported.
+ * @param queue queue of `rotary_encoder_event_t`
+ */
+void encoder_indev_init(QueueHandle_t queue);
+
+/**
+ * `read_cb` of an `LV_INDEV_TYPE_ENCODER` input device.
+ * The turns queued since the previous read are summed up and scaled by the
+ * acceleration. A button change waiting behind another one is returned by
+ * the next call, made right away.
+ */
+bool encoder_indev_read(lv_indev_drv_t * drv, lv_indev_data_t * data);
+
+/**
+ * Steps per detent for a speed, see CONFIG_LVGL_ENCODER_ACCEL_SPEED
+ * @param detents_per_s turning speed
+ * @return steps per detent, 1..CONFIG_LVGL_ENCODER_ACCEL_MAX
+ */
+uint32_t encoder_indev_accel(uint32_t detents_per_s);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* ENCODER_INDEV_H */
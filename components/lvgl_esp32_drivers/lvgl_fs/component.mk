@@ -0,0 +1,4 @@
+# LittlevGL file system driver over the C library files
+
+COMPONENT_SRCDIRS := .
+COMPONENT_ADD_INCLUDEDIRS := .
@@ -0,0 +1,197 @@
+/**
+ * @file fs_stdio.c
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "fs_stdio.h"
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static bool full_path(char * buf, const char * path);
+static lv_fs_res_t fs_open(lv_fs_drv_t * drv, void * file_p, const char * path, lv_fs_mode_t mode);
+static lv_fs_res_t fs_close(lv_fs_drv_t * drv, void * file_p);
+static lv_fs_res_t fs_read(lv_fs_drv_t * drv, void * file_p, void * buf, uint32_t btr, uint32_t * br);
+static lv_fs_res_t fs_write(lv_fs_drv_t * drv, void * file_p, const void * buf, uint32_t btw, uint32_t * bw);
+static lv_fs_res_t fs_seek(lv_fs_drv_t * drv, void * file_p, uint32_t pos);
+static lv_fs_res_t fs_tell(lv_fs_drv_t * drv, void * file_p, uint32_t * pos_p);
+static lv_fs_res_t fs_size(lv_fs_drv_t * drv, void * file_p, uint32_t * size_p);
+static lv_fs_res_t fs_dir_open(lv_fs_drv_t * drv, void * rddir_p, const char * path);
+static lv_fs_res_t fs_dir_read(lv_fs_drv_t * drv, void * rddir_p, char * fn);
+static lv_fs_res_t fs_dir_close(lv_fs_drv_t * drv, void * rddir_p);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * fs_root;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void fs_stdio_init(char letter, const char * root)
+{
+    fs_root = root;
+
+    /*The driver is copied by lv_fs_drv_register()*/
+    lv_fs_drv_t drv;
+    lv_fs_drv_init(&drv);
+    drv.letter = letter;
+    drv.file_size = sizeof(FILE *);
+    drv.rddir_size = sizeof(DIR *);
+    drv.open_cb = fs_open;
+    drv.close_cb = fs_close;
+    drv.read_cb = fs_read;
+    drv.write_cb = fs_write;
+    drv.seek_cb = fs_seek;
+    drv.tell_cb = fs_tell;
+    drv.size_cb = fs_size;
+    drv.dir_open_cb = fs_dir_open;
+    drv.dir_read_cb = fs_dir_read;
+    drv.dir_close_cb = fs_dir_close;
+    lv_fs_drv_register(&drv);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Path of the drive to path of the C library, in a buffer of LV_FS_MAX_PATH_LENGTH
+ * @return false if it doesn't fit
+ */
+static bool full_path(char * buf, const char * path)
+{
+    const char * sep = path[0] == '/' ? "" : "/";
+    int len = snprintf(buf, LV_FS_MAX_PATH_LENGTH, "%s%s%s", fs_root, sep, path);
+    return len > 0 && len < LV_FS_MAX_PATH_LENGTH;
+}
+
+static lv_fs_res_t fs_open(lv_fs_drv_t * drv, void * file_p, const char * path, lv_fs_mode_t mode)
+{
+    (void) drv;
+
+    char buf[LV_FS_MAX_PATH_LENGTH];
+    if(!full_path(buf, path)) return LV_FS_RES_INV_PARAM;
+
+    const char * flags = "rb";
+    if(mode == LV_FS_MODE_WR) flags = "wb";
+    else if(mode == (LV_FS_MODE_WR | LV_FS_MODE_RD)) flags = "r+b";
+
+    FILE * f = fopen(buf, flags);
+    if(f == NULL) return LV_FS_RES_NOT_EX;
+
+    *(FILE **)file_p = f;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t fs_close(lv_fs_drv_t * drv, void * file_p)
+{
+    (void) drv;
+    return fclose(*(FILE **)file_p) == 0 ? LV_FS_RES_OK : LV_FS_RES_FS_ERR;
+}
+
+static lv_fs_res_t fs_read(lv_fs_drv_t * drv, void * file_p, void * buf, uint32_t btr, uint32_t * br)
+{
+    (void) drv;
+
+    FILE * f = *(FILE **)file_p;
+    *br = fread(buf, 1, btr, f);
+    return ferror(f) ? LV_FS_RES_FS_ERR : LV_FS_RES_OK;
+}
+
+static lv_fs_res_t fs_write(lv_fs_drv_t * drv, void * file_p, const void * buf, uint32_t btw, uint32_t * bw)
+{
+    (void) drv;
+
+    FILE * f = *(FILE **)file_p;
+    *bw = fwrite(buf, 1, btw, f);
+    return *bw == btw ? LV_FS_RES_OK : LV_FS_RES_FULL;
+}
+
+static lv_fs_res_t fs_seek(lv_fs_drv_t * drv, void * file_p, uint32_t pos)
+{
+    (void) drv;
+    return fseek(*(FILE **)file_p, pos, SEEK_SET) == 0 ? LV_FS_RES_OK : LV_FS_RES_FS_ERR;
+}
+
+static lv_fs_res_t fs_tell(lv_fs_drv_t * drv, void * file_p, uint32_t * pos_p)
+{
+    (void) drv;
+
+    long pos = ftell(*(FILE **)file_p);
+    if(pos < 0) return LV_FS_RES_FS_ERR;
+
+    *pos_p = pos;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t fs_size(lv_fs_drv_t * drv, void * file_p, uint32_t * size_p)
+{
+    (void) drv;
+
+    /*To the end and back*/
+    FILE * f = *(FILE **)file_p;
+    long pos = ftell(f);
+    if(pos < 0 || fseek(f, 0, SEEK_END) != 0) return LV_FS_RES_FS_ERR;
+
+    long size = ftell(f);
+    if(fseek(f, pos, SEEK_SET) != 0 || size < 0) return LV_FS_RES_FS_ERR;
+
+    *size_p = size;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t fs_dir_open(lv_fs_drv_t * drv, void * rddir_p, const char * path)
+{
+    (void) drv;
+
+    char buf[LV_FS_MAX_PATH_LENGTH];
+    if(!full_path(buf, path)) return LV_FS_RES_INV_PARAM;
+
+    DIR * d = opendir(buf);
+    if(d == NULL) return LV_FS_RES_NOT_EX;
+
+    *(DIR **)rddir_p = d;
+    return LV_FS_RES_OK;
+}
+
+/**
+ * The next entry in `fn` (LV_FS_MAX_FN_LENGTH bytes), directories start with '/'
+ * as lv_fs expects. Empty at the end of the directory. The entries with a longer
+ * name are skipped: cut, the name would open another file or none.
+ */
+static lv_fs_res_t fs_dir_read(lv_fs_drv_t * drv, void * rddir_p, char * fn)
+{
+    (void) drv;
+
+    struct dirent * entry;
+    const char * prefix;
+    size_t prefix_len, name_len;
+    do {
+        entry = readdir(*(DIR **)rddir_p);
+        if(entry == NULL) {
+            fn[0] = '\0';
+            return LV_FS_RES_OK;
+        }
+        prefix = entry->d_type == DT_DIR ? "/" : "";
+        prefix_len = strlen(prefix);
+        name_len = strlen(entry->d_name);
+    } while(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0 ||
+            prefix_len + name_len >= LV_FS_MAX_FN_LENGTH);
+
+    memcpy(fn, prefix, prefix_len);
+    memcpy(fn + prefix_len, entry->d_name, name_len + 1);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t fs_dir_close(lv_fs_drv_t * drv, void * rddir_p)
+{
+    (void) drv;
+    return closedir(*(DIR **)rddir_p) == 0 ? LV_FS_RES_OK : LV_FS_RES_FS_ERR;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file fs_stdio.h
+ * A directory of the C library files (the ESP-IDF VFS on the board, the host
+ * file system in the simulator) as a LittlevGL drive
+ */
+
+#ifndef FS_STDIO_H
+#define FS_STDIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl/lvgl.h"
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Register the drive `letter`: "<letter>:dir/file" is the file `root`/dir/file.
+ * Only one drive is supported.
+ * @param letter drive letter, 'A'..'Z'
+ * @param root directory of the drive, kept: it must stay valid
+ */
+void fs_stdio_init(char letter, const char * root);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* FS_STDIO_H */
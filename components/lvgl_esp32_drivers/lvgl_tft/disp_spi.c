@@ -32,6 +32,11 @@
  #define TFT_SPI_HOST VSPI_HOST
  #endif
 
+/* Transactions which can be queued at once. A flush queues 6 of them
+ * (CASET, its data, PASET, its data, RAMWR, colors), the pool holds two flushes
+ * so the setup of the next area never waits for the colors of the current one. */
+#define DISP_SPI_QUEUE_SIZE 12
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -40,14 +45,26 @@
  *  STATIC PROTOTYPES
  **********************/
 static void IRAM_ATTR spi_ready (spi_transaction_t *trans);
+static void IRAM_ATTR spi_pre_transfer (spi_transaction_t *trans);
+static spi_transaction_t * trans_pool_get(void);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
 static spi_device_handle_t spi;
-static volatile bool spi_trans_in_progress;
-static volatile bool spi_color_sent;
+static transaction_cb_t chained_pre_cb;
 static transaction_cb_t chained_post_cb;
+static int dc_pin = -1;
+
+/* The pool is a ring: the device returns the transactions in queue order,
+ * so the oldest slot is the one reclaimed when the pool is full. */
+static spi_transaction_t trans_pool[DISP_SPI_QUEUE_SIZE];
+static uint8_t trans_pool_head;
+static uint32_t trans_reclaimed_cnt;        // Results taken back with spi_device_get_trans_result
+
+// Written only by the task and only by the ISR respectively, so no locking is needed
+static volatile uint32_t trans_queued_cnt;
+static volatile uint32_t trans_done_cnt;
 
 /**********************
  *      MACROS
@@ -58,8 +75,11 @@ static transaction_cb_t chained_post_cb;
  **********************/
 void disp_spi_add_device_config(spi_host_device_t host, spi_device_interface_config_t *devcfg)
 {
+    chained_pre_cb=devcfg->pre_cb;
     chained_post_cb=devcfg->post_cb;
+    devcfg->pre_cb=spi_pre_transfer;
     devcfg->post_cb=spi_ready;
+    devcfg->queue_size=DISP_SPI_QUEUE_SIZE;
     esp_err_t ret=spi_bus_add_device(host, devcfg, &spi);
     assert(ret==ESP_OK);
 }
@@ -85,7 +105,7 @@ void disp_spi_add_device(spi_host_device_t host)
 	    .mode=0,				                // SPI mode 0
 #endif
 	    .spics_io_num=DISP_SPI_CS,              // CS pin
-        .queue_size=1,
+        .queue_size=DISP_SPI_QUEUE_SIZE,
         .pre_cb=NULL,
         .post_cb=NULL,
         .flags = SPI_DEVICE_HALFDUPLEX
@@ -128,59 +148,135 @@ void disp_spi_init(void)
     disp_spi_add_device(TFT_SPI_HOST);
 }
 
-void disp_spi_send_data(uint8_t * data, uint16_t length)
+void disp_spi_set_dc_pin(int pin)
+{
+    dc_pin = pin;
+}
+
+uint32_t disp_spi_transaction(const uint8_t * data, size_t length, disp_spi_send_flag_t flags)
 {
-    if (length == 0) return;           //no need to send anything
+    if (length == 0) return trans_queued_cnt;   //no need to send anything
+
+    spi_transaction_t * t = trans_pool_get();
+    memset(t, 0, sizeof(spi_transaction_t));
+    t->length = length * 8;             // transaction length is in bits
+    t->user = (void *) (uintptr_t) flags;
+
+    // Short parameters travel inside the transaction, the caller's buffer can go out of scope
+    if (length <= sizeof(t->tx_data)) {
+        memcpy(t->tx_data, data, length);
+        t->flags = SPI_TRANS_USE_TXDATA;
+    } else {
+        t->tx_buffer = data;
+    }
+
+    trans_queued_cnt++;
+    spi_device_queue_trans(spi, t, portMAX_DELAY);
+
+    if (flags & DISP_SPI_SEND_SYNCHRONOUS) {
+        disp_spi_wait_for_pending_transactions();
+    }
 
-    while(spi_trans_in_progress);
+    return trans_queued_cnt;
+}
 
-    spi_transaction_t t = {
-        .length = length * 8, // transaction length is in bits
-        .tx_buffer = data
+void disp_spi_send_area(uint8_t caset, uint8_t paset, uint8_t ramwr, const lv_area_t * area,
+        uint8_t * colors, size_t length)
+{
+    uint8_t xb[] = {
+        (area->x1 >> 8) & 0xFF, area->x1 & 0xFF,
+        (area->x2 >> 8) & 0xFF, area->x2 & 0xFF,
+    };
+    uint8_t yb[] = {
+        (area->y1 >> 8) & 0xFF, area->y1 & 0xFF,
+        (area->y2 >> 8) & 0xFF, area->y2 & 0xFF,
     };
 
-    spi_trans_in_progress = true;
-    spi_color_sent = false;             //Mark the "lv_flush_ready" NOT needs to be called in "spi_ready"
-    spi_device_queue_trans(spi, &t, portMAX_DELAY);
-//	spi_transaction_t *ta = &t;
-//	spi_device_get_trans_result(spi,&ta, portMAX_DELAY);
+    /* Everything is queued at once, D/C is driven in spi_pre_transfer.
+     * The colors are sent from the VDB which stays valid until lv_disp_flush_ready.
+     * With no colors only the address window and RAMWR are queued. */
+    disp_spi_transaction(&caset, 1, DISP_SPI_DC_CMD);
+    disp_spi_transaction(xb, sizeof(xb), DISP_SPI_DC_DATA);
+    disp_spi_transaction(&paset, 1, DISP_SPI_DC_CMD);
+    disp_spi_transaction(yb, sizeof(yb), DISP_SPI_DC_DATA);
+    disp_spi_transaction(&ramwr, 1, DISP_SPI_DC_CMD);
+    disp_spi_transaction(colors, length, DISP_SPI_DC_DATA | DISP_SPI_SIGNAL_FLUSH);
 }
 
-void disp_spi_send_colors(uint8_t * data, uint16_t length)
+void disp_spi_wait_for_transaction(uint32_t ticket)
 {
-    if (length == 0) {
-	return;
+    spi_transaction_t *presult;
+
+    // The results come back in queue order
+    while ((int32_t) (ticket - trans_reclaimed_cnt) > 0) {
+        spi_device_get_trans_result(spi, &presult, portMAX_DELAY);
+        trans_reclaimed_cnt++;
     }
+}
 
-    while(spi_trans_in_progress);
+void disp_spi_wait_for_pending_transactions(void)
+{
+    disp_spi_wait_for_transaction(trans_queued_cnt);
+}
 
-    spi_transaction_t t = {
-        .length = length * 8, // transaction length is in bits
-        .tx_buffer = data
-    };
+void disp_spi_send_data(uint8_t * data, uint16_t length)
+{
+    disp_spi_transaction(data, length, DISP_SPI_SEND_SYNCHRONOUS);
+}
 
-    spi_trans_in_progress = true;
-    spi_color_sent = true;              //Mark the "lv_flush_ready" needs to be called in "spi_ready"
-    spi_device_queue_trans(spi, &t, portMAX_DELAY);
-//	spi_transaction_t *ta = &t;
-//	spi_device_get_trans_result(spi,&ta, portMAX_DELAY);
+void disp_spi_send_colors(uint8_t * data, uint16_t length)
+{
+    disp_spi_transaction(data, length, DISP_SPI_SIGNAL_FLUSH);
 }
 
 
 bool disp_spi_is_busy(void)
 {
-    return spi_trans_in_progress;
+    return trans_queued_cnt != trans_done_cnt;
 }
 
 /**********************
  *   STATIC FUNCTIONS
  **********************/
 
+static spi_transaction_t * trans_pool_get(void)
+{
+    spi_transaction_t *presult;
+
+    // Every slot is in flight: wait for the oldest one
+    if (trans_queued_cnt - trans_reclaimed_cnt == DISP_SPI_QUEUE_SIZE) {
+        spi_device_get_trans_result(spi, &presult, portMAX_DELAY);
+        trans_reclaimed_cnt++;
+    }
+
+    spi_transaction_t * t = &trans_pool[trans_pool_head];
+    trans_pool_head = (trans_pool_head + 1) % DISP_SPI_QUEUE_SIZE;
+
+    return t;
+}
+
+static void IRAM_ATTR spi_pre_transfer (spi_transaction_t *trans)
+{
+    disp_spi_send_flag_t flags = (disp_spi_send_flag_t) (uintptr_t) trans->user;
+
+    // Transactions without a D/C flag are sent by drivers which drive D/C themselves
+    if (dc_pin >= 0) {
+        if (flags & DISP_SPI_DC_CMD) gpio_set_level(dc_pin, 0);
+        else if (flags & DISP_SPI_DC_DATA) gpio_set_level(dc_pin, 1);
+    }
+
+    if(chained_pre_cb) chained_pre_cb(trans);
+}
+
 static void IRAM_ATTR spi_ready (spi_transaction_t *trans)
 {
-    spi_trans_in_progress = false;
+    disp_spi_send_flag_t flags = (disp_spi_send_flag_t) (uintptr_t) trans->user;
 
-    lv_disp_t * disp = lv_refr_get_disp_refreshing();
-    if(spi_color_sent) lv_disp_flush_ready(&disp->driver);
+    trans_done_cnt++;
+
+    if(flags & DISP_SPI_SIGNAL_FLUSH) {
+        lv_disp_t * disp = lv_refr_get_disp_refreshing();
+        lv_disp_flush_ready(&disp->driver);
+    }
     if(chained_post_cb) chained_post_cb(trans);
 }
@@ -15,8 +15,11 @@ extern "C" {
  *********************/
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <driver/spi_master.h>
 
+#include "lvgl/lvgl.h"
+
 /*********************
  *      DEFINES
  *********************/
@@ -24,6 +27,13 @@ extern "C" {
 /**********************
  *      TYPEDEFS
  **********************/
+typedef enum _disp_spi_send_flag_t {
+    DISP_SPI_SEND_QUEUED        = 0x00,     // Queue the transaction and return
+    DISP_SPI_SEND_SYNCHRONOUS   = 0x01,     // Return when the transaction (and all before it) is done
+    DISP_SPI_SIGNAL_FLUSH       = 0x02,     // Call lv_disp_flush_ready when the transaction is done
+    DISP_SPI_DC_CMD             = 0x04,     // Drive D/C low before the transaction (see disp_spi_set_dc_pin)
+    DISP_SPI_DC_DATA            = 0x08,     // Drive D/C high before the transaction
+} disp_spi_send_flag_t;
 
 /**********************
  * GLOBAL PROTOTYPES
@@ -31,6 +41,12 @@ extern "C" {
 void disp_spi_init(void);
 void disp_spi_add_device(spi_host_device_t host);
 void disp_spi_add_device_config(spi_host_device_t host, spi_device_interface_config_t *devcfg);
+void disp_spi_set_dc_pin(int pin);
+uint32_t disp_spi_transaction(const uint8_t * data, size_t length, disp_spi_send_flag_t flags);
+void disp_spi_send_area(uint8_t caset, uint8_t paset, uint8_t ramwr, const lv_area_t * area,
+        uint8_t * colors, size_t length);
+void disp_spi_wait_for_transaction(uint32_t ticket);
+void disp_spi_wait_for_pending_transactions(void);
 void disp_spi_send_data(uint8_t * data, uint16_t length);
 void disp_spi_send_colors(uint8_t * data, uint16_t length);
 bool disp_spi_is_busy(void);
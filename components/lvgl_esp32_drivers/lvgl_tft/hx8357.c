@@ -51,7 +51,6 @@ typedef struct {
  **********************/
 static void hx8357_send_cmd(uint8_t cmd);
 static void hx8357_send_data(void * data, uint16_t length);
-static void hx8357_send_color(void * data, uint16_t length);
 
 
 /**********************
@@ -159,6 +158,7 @@ void hx8357_init(uint8_t displayType)
 {
 	//Initialize non-SPI GPIOs
 	gpio_set_direction(HX8357_DC, GPIO_MODE_OUTPUT);
+	disp_spi_set_dc_pin(HX8357_DC);
 	gpio_set_direction(HX8357_RST, GPIO_MODE_OUTPUT);
 
 #if HX8357_ENABLE_BACKLIGHT_CONTROL
@@ -206,34 +206,9 @@ void hx8357_init(uint8_t displayType)
 void hx8357_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
 	uint32_t size = lv_area_get_width(area) * lv_area_get_height(area);
-	
-	/* Column addresses  */
-	uint8_t xb[] = {
-	    (uint8_t) (area->x1 >> 8) & 0xFF,
-	    (uint8_t) (area->x1) & 0xFF,
-	    (uint8_t) (area->x2 >> 8) & 0xFF,
-	    (uint8_t) (area->x2) & 0xFF,
-	};
-	
-	/* Page addresses  */
-	uint8_t yb[] = {
-	    (uint8_t) (area->y1 >> 8) & 0xFF,
-	    (uint8_t) (area->y1) & 0xFF,
-	    (uint8_t) (area->y2 >> 8) & 0xFF,
-	    (uint8_t) (area->y2) & 0xFF,
-	};
-
-	/*Column addresses*/
-	hx8357_send_cmd(HX8357_CASET);
-	hx8357_send_data(xb, 4);
-
-	/*Page addresses*/
-	hx8357_send_cmd(HX8357_PASET);
-	hx8357_send_data(yb, 4);
 
-	/*Memory write*/
-	hx8357_send_cmd(HX8357_RAMWR);
-	hx8357_send_color((void*)color_map, size * 2);
+	/*Column addresses, page addresses and memory write are queued at once*/
+	disp_spi_send_area(HX8357_CASET, HX8357_PASET, HX8357_RAMWR, area, (uint8_t *) color_map, size * 2);
 }
 
 void hx8357_enable_backlight(bool backlight)
@@ -297,9 +272,3 @@ static void hx8357_send_data(void * data, uint16_t length)
 }
 
 
-static void hx8357_send_color(void * data, uint16_t length)
-{
-	while(disp_spi_is_busy()) {}
-	gpio_set_level(HX8357_DC, 1);   /*Data mode*/
-	disp_spi_send_colors(data, length);
-}
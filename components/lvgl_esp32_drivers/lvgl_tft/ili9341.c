@@ -34,7 +34,6 @@ typedef struct {
  **********************/
 static void ili9341_send_cmd(uint8_t cmd);
 static void ili9341_send_data(void * data, uint16_t length);
-static void ili9341_send_color(void * data, uint16_t length);
 
 /**********************
  *  STATIC VARIABLES
@@ -91,6 +90,7 @@ void ili9341_init(void)
 	//Initialize non-SPI GPIOs
 	gpio_set_direction(ILI9341_DC, GPIO_MODE_OUTPUT);
 	gpio_set_direction(ILI9341_RST, GPIO_MODE_OUTPUT);
+	disp_spi_set_dc_pin(ILI9341_DC);
 
 #if ILI9341_ENABLE_BACKLIGHT_CONTROL
     gpio_set_direction(ILI9341_BCKL, GPIO_MODE_OUTPUT);
@@ -149,31 +149,11 @@ void ili9341_init(void)
 
 void ili9341_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
-	uint8_t data[4];
-
-	/*Column addresses*/
-	ili9341_send_cmd(0x2A);
-	data[0] = (area->x1 >> 8) & 0xFF;
-	data[1] = area->x1 & 0xFF;
-	data[2] = (area->x2 >> 8) & 0xFF;
-	data[3] = area->x2 & 0xFF;
-	ili9341_send_data(data, 4);
-
-	/*Page addresses*/
-	ili9341_send_cmd(0x2B);
-	data[0] = (area->y1 >> 8) & 0xFF;
-	data[1] = area->y1 & 0xFF;
-	data[2] = (area->y2 >> 8) & 0xFF;
-	data[3] = area->y2 & 0xFF;
-	ili9341_send_data(data, 4);
-
-	/*Memory write*/
-	ili9341_send_cmd(0x2C);
-
-
 	uint32_t size = lv_area_get_width(area) * lv_area_get_height(area);
 
-	ili9341_send_color((void*)color_map, size * 2);
+	/*Column addresses, page addresses and memory write are queued at once,
+	 *LittlevGL renders the next area while the colors are sent*/
+	disp_spi_send_area(0x2A, 0x2B, 0x2C, area, (uint8_t *) color_map, size * 2);
 }
 
 void ili9341_enable_backlight(bool backlight)
@@ -225,10 +205,4 @@ static void ili9341_send_data(void * data, uint16_t length)
 	  disp_spi_send_data(data, length);
 }
 
-static void ili9341_send_color(void * data, uint16_t length)
-{
-		while(disp_spi_is_busy()) {}
-    gpio_set_level(ILI9341_DC, 1);   /*Data mode*/
-    disp_spi_send_colors(data, length);
-}
 
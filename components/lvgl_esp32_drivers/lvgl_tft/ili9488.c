@@ -10,6 +10,7 @@
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
+#include <assert.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -19,6 +20,10 @@
  *********************/
  #define TAG "ILI9488"
 
+/* Pixels converted to RGB666 per DMA chunk, a multiple of 4 for the word converter.
+ * Two chunk buffers are allocated once: one is on the wire while the other is filled. */
+#define ILI9488_CHUNK_PX    (LV_HOR_RES_MAX * 4)
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -35,11 +40,13 @@ typedef struct {
  **********************/
 static void ili9488_send_cmd(uint8_t cmd);
 static void ili9488_send_data(void * data, uint16_t length);
-static void ili9488_send_color(void * data, uint16_t length);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static uint8_t * chunk_buf[2];
+static uint32_t chunk_ticket[2];    // disp_spi ticket of the last transaction sent from the buffer
+static uint8_t chunk_act;
 
 /**********************
  *      MACROS
@@ -76,6 +83,12 @@ void ili9488_init(void)
 	//Initialize non-SPI GPIOs
 	gpio_set_direction(ILI9488_DC, GPIO_MODE_OUTPUT);
 	gpio_set_direction(ILI9488_RST, GPIO_MODE_OUTPUT);
+	disp_spi_set_dc_pin(ILI9488_DC);
+
+	for (uint8_t i = 0; i < 2; i++) {
+		chunk_buf[i] = (uint8_t *) heap_caps_malloc(ILI9488_CHUNK_PX * 3, MALLOC_CAP_DMA);
+		assert(chunk_buf[i] != NULL);
+	}
 
 #if ILI9488_ENABLE_BACKLIGHT_CONTROL
 	gpio_set_direction(ILI9488_BCKL, GPIO_MODE_OUTPUT);
@@ -119,52 +132,28 @@ void ili9488_init(void)
 void ili9488_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
     uint32_t size = lv_area_get_width(area) * lv_area_get_height(area);
+    const uint16_t * src = (const uint16_t *) color_map;
 
-    lv_color16_t *buffer_16bit = (lv_color16_t *) color_map;
-    uint8_t *mybuf = (uint8_t *) heap_caps_malloc(3 * size * sizeof(uint8_t), MALLOC_CAP_DMA);
-
-    uint32_t LD = 0;
-    uint32_t j = 0;
-
-    for (uint32_t i = 0; i < size; i++) {
-        LD = buffer_16bit[i].full;
-        mybuf[j] = (uint8_t) ((LD & 0xF800) >> 8);
-        j++;
-        mybuf[j] = (uint8_t) ((LD & 0x07E0) >> 3);
-        j++;
-        mybuf[j] = (uint8_t) ((LD & 0x001F) << 3);
-        j++;
-    }
-
-	/* Column addresses  */
-	uint8_t xb[] = {
-	    (uint8_t) (area->x1 >> 8) & 0xFF,
-	    (uint8_t) (area->x1) & 0xFF,
-	    (uint8_t) (area->x2 >> 8) & 0xFF,
-	    (uint8_t) (area->x2) & 0xFF,
-	};
-	
-	/* Page addresses  */
-	uint8_t yb[] = {
-	    (uint8_t) (area->y1 >> 8) & 0xFF,
-	    (uint8_t) (area->y1) & 0xFF,
-	    (uint8_t) (area->y2 >> 8) & 0xFF,
-	    (uint8_t) (area->y2) & 0xFF,
-	};
+    /*Column addresses, page addresses and memory write*/
+    disp_spi_send_area(ILI9488_CMD_COLUMN_ADDRESS_SET, ILI9488_CMD_PAGE_ADDRESS_SET,
+            ILI9488_CMD_MEMORY_WRITE, area, NULL, 0);
 
-	/*Column addresses*/
-	ili9488_send_cmd(ILI9488_CMD_COLUMN_ADDRESS_SET);
-	ili9488_send_data(xb, 4);
+    while (size > 0) {
+        uint32_t px_num = size > ILI9488_CHUNK_PX ? ILI9488_CHUNK_PX : size;
+        uint8_t * buf = chunk_buf[chunk_act];
 
-	/*Page addresses*/
-	ili9488_send_cmd(ILI9488_CMD_PAGE_ADDRESS_SET);
-	ili9488_send_data(yb, 4);
+        /*The buffer was queued two chunks ago, it must have left the wire*/
+        disp_spi_wait_for_transaction(chunk_ticket[chunk_act]);
+        ili9488_rgb565_to_rgb666(buf, src, px_num);
+        src += px_num;
+        size -= px_num;
 
-	/*Memory write*/
-	ili9488_send_cmd(ILI9488_CMD_MEMORY_WRITE);
+        /*Everything is copied out of the VDB, LittlevGL can render into it again*/
+        if (size == 0) lv_disp_flush_ready(drv);
 
-	ili9488_send_color((void *) mybuf, size * 3);
-        heap_caps_free(mybuf);
+        chunk_ticket[chunk_act] = disp_spi_transaction(buf, px_num * 3, DISP_SPI_DC_DATA);
+        chunk_act ^= 1;
+    }
 }
 
 void ili9488_enable_backlight(bool backlight)
@@ -183,6 +172,45 @@ void ili9488_enable_backlight(bool backlight)
 #endif
 }
 
+/**
+ * Convert RGB565 pixels to the 3 byte RGB666 format of the ILI9488 SPI interface.
+ * 4 pixels are packed into three words, so the DMA buffer is written a word at a time.
+ * @param dest 4 byte aligned destination, 3 bytes per pixel
+ * @param src RGB565 pixels
+ * @param px_num number of pixels
+ */
+void ili9488_rgb565_to_rgb666(uint8_t * dest, const uint16_t * src, uint32_t px_num)
+{
+#define R666(c) (((c) & 0xF800) >> 8)
+#define G666(c) (((c) & 0x07E0) >> 3)
+#define B666(c) (((c) & 0x001F) << 3)
+
+    uint32_t * dest32 = (uint32_t *) dest;
+
+    for (; px_num >= 4; px_num -= 4) {
+        uint32_t c0 = src[0], c1 = src[1], c2 = src[2], c3 = src[3];
+        src += 4;
+
+        /*Little endian: R0 G0 B0 R1 | G1 B1 R2 G2 | B2 R3 G3 B3*/
+        *dest32++ = R666(c0) | (G666(c0) << 8) | (B666(c0) << 16) | (R666(c1) << 24);
+        *dest32++ = G666(c1) | (B666(c1) << 8) | (R666(c2) << 16) | (G666(c2) << 24);
+        *dest32++ = B666(c2) | (R666(c3) << 8) | (G666(c3) << 16) | (B666(c3) << 24);
+    }
+
+    /*Less than 4 pixels at the end of the area*/
+    dest = (uint8_t *) dest32;
+    for (; px_num > 0; px_num--) {
+        uint32_t c = *src++;
+        *dest++ = R666(c);
+        *dest++ = G666(c);
+        *dest++ = B666(c);
+    }
+
+#undef R666
+#undef G666
+#undef B666
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -201,11 +229,3 @@ static void ili9488_send_data(void * data, uint16_t length)
 	  gpio_set_level(ILI9488_DC, 1);	 /*Data mode*/
 	  disp_spi_send_data(data, length);
 }
-
-static void ili9488_send_color(void * data, uint16_t length)
-{
-		while(disp_spi_is_busy()) {}
-    gpio_set_level(ILI9488_DC, 1);   /*Data mode*/
-    disp_spi_send_colors(data, length);
-}
-
@@ -154,6 +154,7 @@ typedef struct {
 void ili9488_init(void);
 void ili9488_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map);
 void ili9488_enable_backlight(bool backlight);
+void ili9488_rgb565_to_rgb666(uint8_t * dest, const uint16_t * src, uint32_t px_num);
 
 /**********************
  *      MACROS
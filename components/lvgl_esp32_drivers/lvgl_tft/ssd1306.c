@@ -32,6 +32,7 @@
 #define OLED_COLUMNS                        128
 #define OLED_PAGES                          8
 #define OLED_PIXEL_PER_PAGE                 8
+#define OLED_COLUMN_OFFSET                  2       // RAM is 132 columns wide, the panel starts at column 2
 
 // Control byte
 #define OLED_CONTROL_BYTE_CMD_SINGLE        0x80
@@ -171,72 +172,39 @@ void ssd1306_flush(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_color_t
 {
 	i2c_cmd_handle_t cmd;
 
-	for (uint8_t cur_page = 0; cur_page < 8; cur_page++){
-		// vTaskDelay(20/portTICK_PERIOD_MS);
+	// The VDB is page packed by ssd1306_set_px_cb: one byte holds 8 vertical
+	// pixels and every page row is as wide as the flushed area.
+	uint8_t * ptr = (uint8_t *) color_p;
+	uint8_t row1 = area->y1 >> 3;
+	uint8_t row2 = area->y2 >> 3;
+	uint16_t columns = area->x2 - area->x1 + 1;
 
+	// An offset of 2 column exists on both sides of screen (left and right)
+	uint8_t column = area->x1 + OLED_COLUMN_OFFSET;
+
+	for (uint8_t cur_page = row1; cur_page <= row2; cur_page++){
+		// Page address and column start are sent as single commands (Co = 1)
+		// in front of the data stream, so a page costs one I2C transaction.
 		cmd = i2c_cmd_link_create();
 		i2c_master_start(cmd);
 		i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-		i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_STREAM, true);
-		i2c_master_write_byte(cmd, 0xB0 | cur_page, true); // reset page
+		i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_SINGLE, true);
+		i2c_master_write_byte(cmd, 0xB0 | cur_page, true); // set page
 
-		// Set lower column Address between 0x00  - 0x0F
-		// An offset of 2 column exists on both sides of screen (left and right)
 		// 8 byte column Address is divided in two halves lower and higher half bytes
-		// 0x02 lower half and 0x10 upperis first column
-		i2c_master_write_byte(cmd, 0x02, true); // Lower half byte
-		i2c_master_write_byte(cmd, 0x10, true); // Higher half byte
-		i2c_master_stop(cmd);
-		i2c_master_cmd_begin(I2C_NUM_0, cmd, 10 / portTICK_PERIOD_MS);
-		i2c_cmd_link_delete(cmd);
+		i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_SINGLE, true);
+		i2c_master_write_byte(cmd, 0x00 | (column & 0x0F), true); // Lower half byte
+		i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_SINGLE, true);
+		i2c_master_write_byte(cmd, 0x10 | (column >> 4), true);   // Higher half byte
 
-		cmd = i2c_cmd_link_create();
-		i2c_master_start(cmd);
-		i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
 		i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_DATA_STREAM, true);
-
-		for (uint8_t column = 2; column <= 0x81;column++){
-
-			i2c_master_write_byte(cmd, (int) color_p->full, true);
-			color_p++;
-
-		}
+		i2c_master_write(cmd, ptr, columns, true);
 		i2c_master_stop(cmd);
 		i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
 		i2c_cmd_link_delete(cmd);
 
-
+		ptr += columns;
 	}
-    // uint8_t row1 = 0, row2 = 0;
-   	// i2c_cmd_handle_t cmd;
-	//
-	// cmd = i2c_cmd_link_create();
-	// i2c_master_start(cmd);
-	// i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-	//
-	// i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_CMD_STREAM, true);
-	//
-	// i2c_master_write_byte(cmd, OLED_CMD_SET_MEMORY_ADDR_MODE, true);
-	// i2c_master_write_byte(cmd, 0x00, true);
-	// i2c_master_write_byte(cmd, OLED_CMD_SET_COLUMN_RANGE, true);
-	// i2c_master_write_byte(cmd, area->x1, true);
-	// i2c_master_write_byte(cmd, area->x2, true);
-	// i2c_master_write_byte(cmd, OLED_CMD_SET_PAGE_RANGE, true);
-	// i2c_master_write_byte(cmd, row1, true);
-	// i2c_master_write_byte(cmd, row2, true);
-	// i2c_master_stop(cmd);
-	// i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
-	// i2c_cmd_link_delete(cmd);
-	//
-	// cmd = i2c_cmd_link_create();
-	// i2c_master_start(cmd);
-	// i2c_master_write_byte(cmd, (OLED_I2C_ADDRESS << 1) | I2C_MASTER_WRITE, true);
-	//
-	// i2c_master_write_byte(cmd, OLED_CONTROL_BYTE_DATA_STREAM, true);
-	// i2c_master_write(cmd, (uint8_t *)color_p, OLED_COLUMNS * (1+row2-row1), true);
-	// i2c_master_stop(cmd);
-	// i2c_master_cmd_begin(I2C_NUM_0, cmd, 10/portTICK_PERIOD_MS);
-	// i2c_cmd_link_delete(cmd);
 
     lv_disp_flush_ready(disp_drv);
 }
@@ -33,7 +33,6 @@ typedef struct {
  **********************/
 static void st7789_send_cmd(uint8_t cmd);
 static void st7789_send_data(void *data, uint16_t length);
-static void st7789_send_color(void *data, uint16_t length);
 
 /**********************
  *  STATIC VARIABLES
@@ -79,6 +78,7 @@ void st7789_init(void)
 
     //Initialize non-SPI GPIOs
     gpio_set_direction(ST7789_DC, GPIO_MODE_OUTPUT);
+    disp_spi_set_dc_pin(ST7789_DC);
     gpio_set_direction(ST7789_RST, GPIO_MODE_OUTPUT);
     
 #if ST7789_ENABLE_BACKLIGHT_CONTROL
@@ -126,31 +126,10 @@ void st7789_enable_backlight(bool backlight)
 
 void st7789_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_map)
 {
-    uint8_t data[4] = {0};
-
-    /*Column addresses*/
-    st7789_send_cmd(ST7789_CASET);
-    data[0] = (area->x1 >> 8) & 0xFF;
-    data[1] = area->x1 & 0xFF;
-    data[2] = (area->x2 >> 8) & 0xFF;
-    data[3] = area->x2 & 0xFF;
-    st7789_send_data(data, 4);
-
-    /*Page addresses*/
-    st7789_send_cmd(ST7789_RASET);
-    data[0] = (area->y1 >> 8) & 0xFF;
-    data[1] = area->y1 & 0xFF;
-    data[2] = (area->y2 >> 8) & 0xFF;
-    data[3] = area->y2 & 0xFF;
-    st7789_send_data(data, 4);
-
-    /*Memory write*/
-    st7789_send_cmd(ST7789_RAMWR);
-
     uint32_t size = lv_area_get_width(area) * lv_area_get_height(area);
 
-    st7789_send_color((void*)color_map, size * 2);
-
+    /*Column addresses, page addresses and memory write are queued at once*/
+    disp_spi_send_area(ST7789_CASET, ST7789_RASET, ST7789_RAMWR, area, (uint8_t *) color_map, size * 2);
 }
 
 /**********************
@@ -170,9 +149,3 @@ static void st7789_send_data(void * data, uint16_t length)
     disp_spi_send_data(data, length);
 }
 
-static void st7789_send_color(void * data, uint16_t length)
-{
-    while (disp_spi_is_busy()) {}
-    gpio_set_level(ST7789_DC, 1);
-    disp_spi_send_colors(data, length);
-}
@@ -0,0 +1,226 @@
+/**
+ * @file screen.c
+ *
+ * Screens of a LittlevGL application, built once and shown in turn
+ */
+#include "screen.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+
+static const char *TAG = "SCREEN";
+
+#define CHECK_ARG(VAL) do { if (!(VAL)) return ESP_ERR_INVALID_ARG; } while (0)
+
+// An empty container the size of the parent and its group, then the objects of the screen, hidden
+static esp_err_t build(screen_mgr_t *mgr, screen_t *scr)
+{
+    scr->cont = lv_cont_create(scr->parent, NULL);
+    scr->group = lv_group_create();
+    if (!scr->cont || !scr->group)
+    {
+        ESP_LOGE(TAG, "No memory for %s", scr->name);
+        if (scr->cont) lv_obj_del(scr->cont);
+        if (scr->group) lv_group_del(scr->group);
+        scr->cont = NULL;
+        scr->group = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    lv_cont_set_style(scr->cont, LV_CONT_STYLE_MAIN, &lv_style_transp_fit);
+    lv_obj_set_size(scr->cont, lv_obj_get_width(scr->parent), lv_obj_get_height(scr->parent));
+    // On the parent itself: the objects created in a page go to its scrollable part, which moves as it fits them
+    lv_obj_align(scr->cont, scr->parent, LV_ALIGN_IN_TOP_LEFT, 0, 0);
+    lv_obj_set_hidden(scr->cont, true);
+    scr->build(scr);
+    mgr->stats.built++;
+
+    return ESP_OK;
+}
+
+// The group first: deleting the objects would move its focus from one to the next
+static void destroy(screen_t *scr)
+{
+    lv_group_del(scr->group);
+    lv_obj_del(scr->cont);
+    scr->group = NULL;
+    scr->cont = NULL;
+}
+
+// A key held across the transition belongs to the old screen: its release isn't sent to the new one
+static void set_group(lv_indev_t *indev, lv_group_t *group)
+{
+    if (indev->proc.types.keypad.last_state == LV_INDEV_STATE_PR)
+        lv_indev_wait_release(indev);
+    lv_indev_set_group(indev, group);
+}
+
+// The update callback of the screen shown; the task is paused while the screen has none
+static void update_task_cb(lv_task_t *task)
+{
+    screen_mgr_t *mgr = task->user_data;
+
+    if (mgr->current && mgr->current->update)
+        mgr->current->update(mgr->current);
+}
+
+static esp_err_t post(screen_mgr_t *mgr, screen_t *scr)
+{
+    uint32_t head = mgr->queue_head;
+
+    if (head - __atomic_load_n(&mgr->queue_tail, __ATOMIC_ACQUIRE) >= SCREEN_QUEUE_LEN)
+    {
+        mgr->stats.dropped++;
+        ESP_LOGW(TAG, "Transition to %s dropped, queue full", scr ? scr->name : "back");
+        return ESP_ERR_NO_MEM;
+    }
+
+    mgr->queue[head % SCREEN_QUEUE_LEN] = scr;
+    __atomic_store_n(&mgr->queue_head, head + 1, __ATOMIC_RELEASE);
+
+    return ESP_OK;
+}
+
+esp_err_t screen_mgr_init(screen_mgr_t *mgr)
+{
+    CHECK_ARG(mgr);
+
+    mgr->current = NULL;
+    mgr->previous = NULL;
+    mgr->queue_head = 0;
+    mgr->queue_tail = 0;
+    mgr->stats = (screen_stats_t){0};
+
+    // Created once: a transition only pauses or resumes it
+    mgr->update_task = lv_task_create(update_task_cb, 1000, LV_TASK_PRIO_LOW, mgr);
+    if (!mgr->update_task)
+        return ESP_ERR_NO_MEM;
+    lv_task_pause(mgr->update_task);
+
+    return ESP_OK;
+}
+
+esp_err_t screen_show(screen_mgr_t *mgr, screen_t *scr)
+{
+    CHECK_ARG(mgr && scr && scr->parent && scr->build);
+
+    if (scr == mgr->current)
+        return ESP_OK;
+
+    int64_t start = esp_timer_get_time();
+
+    // Built before the old one is hidden: without memory for it nothing changes
+    if (!scr->cont)
+    {
+        esp_err_t res = build(mgr, scr);
+        if (res != ESP_OK)
+            return res;
+    }
+
+    screen_t *old = mgr->current;
+    if (old)
+    {
+        if (old->hide)
+            old->hide(old);
+        if (mgr->rebuild)
+            destroy(old);
+        else
+            lv_obj_set_hidden(old->cont, true);
+    }
+
+    if (mgr->tabview)
+        lv_tabview_set_tab_act(mgr->tabview, scr->tab, LV_ANIM_ON);
+
+    for (size_t i = 0; i < SCREEN_INDEV_MAX; i++)
+    {
+        if (mgr->indevs[i])
+            set_group(mgr->indevs[i], scr->group);
+    }
+    if (mgr->indev_lr)
+    {
+        set_group(mgr->indev_lr, scr->keys_lr ? scr->group : NULL);
+        lv_indev_enable(mgr->indev_lr, scr->keys_lr);
+    }
+
+    lv_obj_set_hidden(scr->cont, false);
+    mgr->previous = old;
+    mgr->current = scr;
+    if (scr->show)
+        scr->show(scr);
+
+    if (scr->update)
+    {
+        scr->update(scr);
+        lv_task_set_period(mgr->update_task, scr->update_ms);
+        lv_task_reset(mgr->update_task);
+        lv_task_resume(mgr->update_task);
+    }
+    else
+        lv_task_pause(mgr->update_task);
+
+    int64_t time = esp_timer_get_time() - start;
+    mgr->stats.shown++;
+    mgr->stats.time_us = time;
+    mgr->stats.time_total_us += time;
+    if (time > mgr->stats.time_max_us)
+        mgr->stats.time_max_us = time;
+    ESP_LOGD(TAG, "%s shown in %lld us", scr->name, (long long)time);
+
+    return ESP_OK;
+}
+
+esp_err_t screen_post(screen_mgr_t *mgr, screen_t *scr)
+{
+    CHECK_ARG(mgr && scr);
+
+    return post(mgr, scr);
+}
+
+esp_err_t screen_post_back(screen_mgr_t *mgr)
+{
+    CHECK_ARG(mgr);
+
+    return post(mgr, NULL);
+}
+
+esp_err_t screen_process(screen_mgr_t *mgr)
+{
+    CHECK_ARG(mgr);
+
+    esp_err_t res = ESP_OK;
+    uint32_t tail = mgr->queue_tail;
+
+    while (tail != __atomic_load_n(&mgr->queue_head, __ATOMIC_ACQUIRE))
+    {
+        screen_t *scr = mgr->queue[tail % SCREEN_QUEUE_LEN];
+        __atomic_store_n(&mgr->queue_tail, ++tail, __ATOMIC_RELEASE);
+
+        if (!scr)
+            scr = mgr->current ? mgr->current->back : NULL;
+        if (!scr)
+            continue;
+
+        esp_err_t err = screen_show(mgr, scr);
+        if (err != ESP_OK)
+            res = err;
+    }
+
+    return res;
+}
+
+esp_err_t screen_free(screen_mgr_t *mgr, screen_t *scr)
+{
+    CHECK_ARG(mgr && scr);
+
+    if (scr == mgr->current)
+        return ESP_ERR_INVALID_STATE;
+
+    if (scr->cont)
+        destroy(scr);
+
+    return ESP_OK;
+}
+
+bool screen_is_shown(const screen_mgr_t *mgr, const screen_t *scr)
+{
+    return mgr->current == scr;
+}
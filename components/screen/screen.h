@@ -0,0 +1,175 @@
+/**
+ * @file screen.h
+ * @defgroup screen screen
+ * @{
+ *
+ * Screens of a LittlevGL application, built once and shown in turn
+ *
+ * A screen is a container of objects and an input group. The first time it's
+ * shown, its build callback creates the objects in the container and adds
+ * the ones taking keys to the group. Showing another screen hides the
+ * container rather than deleting it, and hands the input devices of the
+ * manager the group of the new one: once every screen was built, a
+ * transition allocates nothing and the heap keeps its shape.
+ *
+ * The show and hide callbacks only move the values in and out of the objects
+ * and start or stop what runs while the screen is shown. The update callback
+ * runs right after show, then periodically from an lv_task of the manager.
+ * Hidden objects aren't drawn and their invalidations are dropped.
+ *
+ * The screens form a table the application indexes. A transition is an event
+ * posted to the queue of the manager, e.g. from an event callback of an
+ * object or an input device read, and handled once by screen_process() after
+ * lv_task_handler(): a callback never hides or deletes the objects it runs on.
+ * The back event leads to the `back` screen of the one shown when it's
+ * handled.
+ *
+ * With `rebuild` set, the manager deletes a screen when it's hidden and
+ * builds it again when it's shown, like a UI creating and deleting its
+ * objects on every transition: the build callback must then set up every
+ * object, not only the new ones.
+ */
+#ifndef __SCREEN_H__
+#define __SCREEN_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <esp_err.h>
+#include "lvgl/lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCREEN_INDEV_MAX    4           //!< Input devices following the screen shown
+#define SCREEN_QUEUE_LEN    4           //!< Transitions waiting for screen_process(), a power of 2
+
+struct screen;
+
+/**
+ * Build, show, hide or update callback of a screen
+ */
+typedef void (*screen_cb_t)(struct screen *scr);
+
+/**
+ * Screen descriptor
+ */
+typedef struct screen
+{
+    const char *name;           //!< For the log
+    lv_obj_t *parent;           //!< Where the container is created, e.g. a tab of the tabview of the manager
+    uint16_t tab;               //!< Tab of the tabview shown with the screen
+    bool keys_lr;               //!< The screen takes the left and right keys too, see `indev_lr`
+    screen_cb_t build;          //!< Creates the objects in `cont` and adds the ones taking keys to `group`
+    screen_cb_t show;           //!< Optional: puts the values in the objects, starts what runs while shown
+    screen_cb_t hide;           //!< Optional: reads the values back, stops what show() started
+    screen_cb_t update;         //!< Optional: refreshes the objects, right after show() then every `update_ms`
+    uint32_t update_ms;         //!< Period of the update callback
+    struct screen *back;        //!< Screen the back event leads to, NULL to stay
+    void *user_data;            //!< Free for the user
+    lv_obj_t *cont;             //!< Container of the objects, the size of `parent`, NULL until built
+    lv_group_t *group;          //!< Input group, NULL until built
+} screen_t;
+
+/**
+ * Transition statistics
+ */
+typedef struct
+{
+    uint32_t shown;             //!< Screens shown
+    uint32_t built;             //!< Screens built, the first time or again with `rebuild`
+    uint32_t dropped;           //!< Transitions not posted, the queue full
+    int64_t time_us;            //!< Time the last transition took, hide, build, show and update callbacks included
+    int64_t time_max_us;        //!< Longest transition
+    int64_t time_total_us;      //!< Time of all the transitions
+} screen_stats_t;
+
+/**
+ * Screen manager descriptor
+ */
+typedef struct
+{
+    lv_indev_t *indevs[SCREEN_INDEV_MAX]; //!< Input devices taking the group of the screen shown, unused ones NULL
+    lv_indev_t *indev_lr;       //!< Optional: input device enabled only on the screens with `keys_lr`
+    lv_obj_t *tabview;          //!< Optional: tabview switched to the `tab` of the screen shown
+    bool rebuild;               //!< Delete the screens when hidden and build them again when shown
+    screen_t *current;          //!< Screen shown, NULL before the first one
+    screen_t *previous;         //!< Screen shown before `current`, NULL if none
+    lv_task_t *update_task;     //!< Runs the update callback of the screen shown
+    screen_t *queue[SCREEN_QUEUE_LEN]; //!< Transitions posted, NULL for the back event
+    uint32_t queue_head;        //!< Transitions posted so far
+    uint32_t queue_tail;        //!< Transitions handled so far
+    screen_stats_t stats;       //!< Transition statistics
+} screen_mgr_t;
+
+/**
+ * Set up a screen manager, nothing shown.
+ * `indevs`, `indev_lr`, `tabview` and `rebuild` must be set, the rest is initialized here.
+ * Call it after lv_init().
+ * @param mgr Screen manager descriptor
+ * @return `ESP_OK` on success, `ESP_ERR_NO_MEM` if the update task couldn't be created
+ */
+esp_err_t screen_mgr_init(screen_mgr_t *mgr);
+
+/**
+ * Hide the screen shown and show `scr`, building it if it wasn't yet.
+ * Nothing happens if `scr` is shown already.
+ * Call it from the task running lv_task_handler(), but not from a callback of the screens:
+ * post the transition with screen_post() there.
+ * @param mgr Screen manager descriptor
+ * @param scr Screen to show
+ * @return `ESP_OK` on success, `ESP_ERR_NO_MEM` if it couldn't be built: the screen shown stays
+ */
+esp_err_t screen_show(screen_mgr_t *mgr, screen_t *scr);
+
+/**
+ * Queue the transition to a screen.
+ * It doesn't touch LittlevGL: call it from any callback, or from another task
+ * as long as only one task posts.
+ * @param mgr Screen manager descriptor
+ * @param scr Screen to show
+ * @return `ESP_OK` on success, `ESP_ERR_NO_MEM` if the queue is full: the transition is dropped
+ */
+esp_err_t screen_post(screen_mgr_t *mgr, screen_t *scr);
+
+/**
+ * Queue the transition to the `back` screen of the screen shown when it's handled.
+ * Nothing happens then if it has none.
+ * @param mgr Screen manager descriptor
+ * @return `ESP_OK` on success, `ESP_ERR_NO_MEM` if the queue is full: the transition is dropped
+ */
+esp_err_t screen_post_back(screen_mgr_t *mgr);
+
+/**
+ * Handle the transitions posted, in order, each one once.
+ * Call it from the task running lv_task_handler(), between two calls of it.
+ * @param mgr Screen manager descriptor
+ * @return `ESP_OK` on success, else the error of the last screen_show() which failed
+ */
+esp_err_t screen_process(screen_mgr_t *mgr);
+
+/**
+ * Delete the objects and the input group of a hidden screen, e.g. one rarely
+ * shown, to get their memory back. It's built again the next time it's shown.
+ * @param mgr Screen manager descriptor
+ * @param scr Screen
+ * @return `ESP_OK` on success, `ESP_ERR_INVALID_STATE` if the screen is shown
+ */
+esp_err_t screen_free(screen_mgr_t *mgr, screen_t *scr);
+
+/**
+ * Check if a screen is the one shown
+ * @param mgr Screen manager descriptor
+ * @param scr Screen
+ * @return true if shown
+ */
+bool screen_is_shown(const screen_mgr_t *mgr, const screen_t *scr);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@}*/
+
+#endif /* __SCREEN_H__ */
@@ -9,6 +9,7 @@
 #include "freertos/semphr.h"
 #include "esp_system.h"
 #include "driver/gpio.h"
+#include "keypad.h"
 
 /* Littlevgl specific */
 #include "lvgl/lvgl.h"
@@ -22,20 +23,127 @@
 #define TAG "Wave"
 
 
-#define MENU_SCREEN 10
+#define MENU_SCREEN 6
 #define MENU_FREQUENCY_SET_SCREEN 0
 #define MENU_AMPLITUDE_SET_SCREEN 1
 #define MENU_WAVEFORM_SET_SCREEN  2
 #define MENU_LOGIC_SET_SCREEN     3
 #define MENU_STATS_SET_SCREEN     4
+#define MENU_SWEEP_SET_SCREEN     5
+#define SCREEN_CNT                7
+
+#define PROF_DUMP_PERIOD_MS       10000
+#define MEM_TRACE_LINE_BYTES      32
+#define STORAGE_DRIVE             'S'
+#define AWG_DIR                   "S:awg"
+#define ENCODER_QUEUE_LEN         64
+#define PREVIEW_POINTS            32	//One period, a point per column
+#define PREVIEW_HEIGHT            28
+#define LOGIC_VIEW_WIDTH          120	//A column per pixel
+#define LOGIC_ROW_HEIGHT          7		//A channel: high on its second line, low on its second to last
+#define LOGIC_CHANNEL_CNT         4
+#define LOGIC_WINDOW_US           10000	//A quarter before the trigger
+#define LOGIC_REFRESH_MS          100
+#define STATS_REFRESH_MS          500
+#define STATS_ROW_HEIGHT          9
+#define STATS_VALUE_X             32	//Up to 7 characters before the preview
+#define SCREEN_TITLE_POS          5		//The title label of a setting screen, from the top left of the tab
+
+#if CONFIG_WAVEMAN_ENCODER
+//The DAC channels of audio_out: right on GPIO25, left on GPIO26
+#define ENCODER_ON_PIN(pin) (CONFIG_WAVEMAN_ENCODER_PIN_A == (pin) || CONFIG_WAVEMAN_ENCODER_PIN_B == (pin) || \
+                             CONFIG_WAVEMAN_ENCODER_PIN_BTN == (pin))
+#if !CONFIG_AUDIO_OUT_DAC_CHANNEL_LEFT && ENCODER_ON_PIN(25)
+#error "The rotary encoder is on GPIO25, the right DAC channel"
+#endif
+#if (CONFIG_AUDIO_OUT_DAC_CHANNEL_LEFT || CONFIG_AUDIO_OUT_DAC_CHANNEL_BOTH) && ENCODER_ON_PIN(26)
+#error "The rotary encoder is on GPIO26, the left DAC channel"
+#endif
+#endif
 
 // Static Variables and Structs
-static uint8_t Current_Screen = MENU_FREQUENCY_SET_SCREEN;
-static uint8_t Change_Screen  = 1;
-static uint8_t Next_Screen    = MENU_SCREEN;
-
 static struct MENU_DATA  MENU_CONFIG;
 
+//The screens, each one built the first time it's shown and hidden when another one is, see components/screen.
+//The menu buttons and the BACK key post the transitions, guiTask handles them between two rounds of lv_task_handler.
+//The parents are the tabs, known once the tabview is created.
+static screen_mgr_t screen_mgr;
+static screen_t screens[SCREEN_CNT] = {
+	[MENU_SCREEN]               = {.name = "Menu",      .build = menu_build,      .show = menu_show},
+	[MENU_FREQUENCY_SET_SCREEN] = {.name = "Frequency", .build = frequency_build, .show = frequency_show, .hide = frequency_hide,
+	                               .keys_lr = true, .back = &screens[MENU_SCREEN]},
+	[MENU_AMPLITUDE_SET_SCREEN] = {.name = "Amplitude", .build = amplitude_build, .back = &screens[MENU_SCREEN]},
+	[MENU_WAVEFORM_SET_SCREEN]  = {.name = "Waveform",  .build = waveform_build,  .show = waveform_show,  .hide = waveform_hide,
+	                               .back = &screens[MENU_SCREEN]},
+	[MENU_LOGIC_SET_SCREEN]     = {.name = "Logic In",  .build = logic_build,     .show = logic_show,     .hide = logic_hide,
+	                               .update = logic_refresh, .update_ms = LOGIC_REFRESH_MS, .back = &screens[MENU_SCREEN]},
+	[MENU_STATS_SET_SCREEN]     = {.name = "Stats",     .build = stats_build,     .show = stats_show,
+	                               .update = stats_refresh, .update_ms = STATS_REFRESH_MS, .tab = 1, .back = &screens[MENU_SCREEN]},
+	[MENU_SWEEP_SET_SCREEN]     = {.name = "Sweep",     .build = sweep_build,     .show = sweep_show,
+	                               .keys_lr = true, .back = &screens[MENU_SCREEN]},
+};
+static lv_obj_t *menulist, *list_btn[6];
+static lv_obj_t *spinbox_frequency;
+static lv_obj_t *roller_waveform;
+static lv_obj_t *roller_logic_trigger;
+static lv_obj_t *roller_sweep, *spinbox_sweep_stop, *spinbox_sweep_time;
+static dds_t dds;
+static dds_params_block_t dds_params;       //Written by the UI, read by the audio task
+static dds_params_reader_t dds_reader;
+static dds_meas_t dds_meas;                 //Written by the audio task, read by the Stats screen
+static uint32_t dds_phase_inc;              //The frequency played, published by the audio task for the Stats screen
+static audio_sink_t audio_sink;
+static audio_out_t audio_out = {.sink = &audio_sink, .render_cb = audio_render_cb, .render_arg = &dds_reader};
+
+//The waveform roller: the built-in waveforms, then those of the storage
+static const char *waveform_names[DDS_WAVE_MAX] = {"Sinosoid", "Triangular", "Square"};
+static awg_bank_t awg_bank;
+static char waveform_options[(DDS_WAVE_MAX + CONFIG_AWG_MAX_WAVES) * AWG_NAME_LEN];
+
+//One period of the output on the ACTIVE tab, drawn while the Stats screen is shown
+static lv_obj_t *preview_chart = NULL;
+static lv_chart_series_t *preview_ser;
+static lv_design_cb_t preview_design_ancestor;
+
+//The logic inputs, captured only while the Logic In screen is shown
+static logic_source_t logic_source;
+static logic_t logic = {.source = &logic_source, .sample_rate = CONFIG_LOGIC_SAMPLE_RATE, .channels = (1 << LOGIC_CHANNEL_CNT) - 1};
+static const logic_trigger_t logic_triggers[] = {
+	{.type = LOGIC_TRIG_NONE},
+	{.type = LOGIC_TRIG_RISING, .channel = 0}, {.type = LOGIC_TRIG_FALLING, .channel = 0},
+	{.type = LOGIC_TRIG_RISING, .channel = 1}, {.type = LOGIC_TRIG_FALLING, .channel = 1},
+	{.type = LOGIC_TRIG_RISING, .channel = 2}, {.type = LOGIC_TRIG_FALLING, .channel = 2},
+	{.type = LOGIC_TRIG_RISING, .channel = 3}, {.type = LOGIC_TRIG_FALLING, .channel = 3},
+};
+static lv_obj_t *logic_canvas = NULL;
+static bool logic_rearm;				//The next capture still has to be handed over
+static logic_column_t logic_view_shown[LOGIC_VIEW_WIDTH];
+static size_t logic_trigger_shown;
+static uint8_t logic_canvas_buf[LV_CANVAS_BUF_SIZE_INDEXED_1BIT(LOGIC_VIEW_WIDTH, LOGIC_CHANNEL_CNT * LOGIC_ROW_HEIGHT)];
+
+//The Stats screen, refreshed by stats_refresh while it's shown
+static const char *stats_names[STATS_VALUE_CNT] = {"FRQ", "PER", "DTY", "UND", "CPU"};
+static stats_value_t stats_values[STATS_VALUE_CNT];
+static volatile uint32_t cpu_ticks[portNUM_PROCESSORS], cpu_idle_ticks[portNUM_PROCESSORS];
+
+static TaskHandle_t gui_task_handle;
+
+// Keypad wiring, one LittlevGL input device per keypad
+static keypad_key_t keys_UP_DOWN[]    = {{.pin = GPIO_NUM_22, .key = LV_KEY_UP}, {.pin = GPIO_NUM_23, .key = LV_KEY_DOWN}};
+static keypad_key_t keys_Back[]       = {{.pin = GPIO_NUM_19, .key = LV_KEY_HOME}};
+static keypad_key_t keys_LEFT_RIGHT[] = {{.pin = GPIO_NUM_17, .key = LV_KEY_LEFT}, {.pin = GPIO_NUM_16, .key = LV_KEY_RIGHT}};
+static keypad_key_t keys_ENTER[]      = {{.pin = GPIO_NUM_21, .key = LV_KEY_ENTER}};
+
+static keypad_t keypad_UD    = {.keys = keys_UP_DOWN,    .key_cnt = 2, .event_cb = keypad_event_cb};
+static keypad_t keypad_BK    = {.keys = keys_Back,       .key_cnt = 1, .event_cb = keypad_event_cb};
+static keypad_t keypad_LR    = {.keys = keys_LEFT_RIGHT, .key_cnt = 2, .event_cb = keypad_event_cb};
+static keypad_t keypad_EN    = {.keys = keys_ENTER,      .key_cnt = 1, .event_cb = keypad_event_cb};
+static keypad_t *keypads[]   = {&keypad_UD, &keypad_BK, &keypad_LR, &keypad_EN};
+
+#if CONFIG_WAVEMAN_ENCODER
+static lv_indev_t *encoder_Button;
+#endif
+
 /**********************
  *   APPLICATION MAIN
  **********************/
@@ -44,12 +152,687 @@ void app_main() {
     //If you want to use a task to create the graphic, you NEED to create a Pinned task
     //Otherwise there can be problem such as memory corruption and so on
     xTaskCreatePinnedToCore(guiTask, "gui", 4096*2, NULL, 0, NULL, 1);
+
+#if LV_USE_REFR_PROF
+    //The profiler history is lock free, the dump doesn't need xGuiSemaphore
+    xTaskCreatePinnedToCore(profTask, "prof", 3072, NULL, 0, NULL, 0);
+#endif
 }
 
-static void IRAM_ATTR lv_tick_task(void *arg) {
+#if LV_USE_REFR_PROF
+//Prints the refresh statistics of the frames drawn since the last dump
+static void profTask(void *arg) {
     (void) arg;
+    uint32_t last_dumped = 0;
 
-    lv_tick_inc(portTICK_RATE_MS);
+    while (1) {
+        vTaskDelay(PROF_DUMP_PERIOD_MS / portTICK_PERIOD_MS);
+
+        uint32_t last = lv_refr_prof_get_last();
+        if (last != last_dumped) {
+            printf("Refresh profile, frames %u-%u\n", (unsigned int)last_dumped + 1, (unsigned int)last);
+            lv_refr_prof_dump(last - last_dumped, prof_print_cb);
+            last_dumped = last;
+        }
+    }
+}
+
+static void prof_print_cb(const char * line) {
+    printf("%s\n", line);
+}
+#endif
+
+#if LV_USE_MEM_TRACE
+//After an allocation failed prints the trace of lv_mem in hex, for mem_prof of the simulator:
+//the records of the calls before it, the entries and the slabs. Needs xGuiSemaphore.
+static void mem_trace_check(void) {
+    static uint32_t fail_dumped;
+    uint32_t fail = lv_mem_trace_get_fail_cnt();
+
+    if (fail != fail_dumped) {
+        fail_dumped = fail;
+        printf("lv_mem trace: begin, %u allocations failed\n", (unsigned int)fail);
+        lv_mem_trace_dump(mem_trace_write_cb);
+        printf("lv_mem trace: end\n");
+    }
+}
+
+static void mem_trace_write_cb(const void * data, uint32_t size) {
+    const uint8_t *p = data;
+
+    while (size) {
+        uint32_t n = size < MEM_TRACE_LINE_BYTES ? size : MEM_TRACE_LINE_BYTES;
+        printf("lv_mem trace: ");
+        for (uint32_t i = 0; i < n; i++) printf("%02x", p[i]);
+        printf("\n");
+        p += n;
+        size -= n;
+    }
+}
+#endif
+
+//Wakes guiTask before the time returned by lv_task_handler, e.g. when a task was created
+//or an object was invalidated. Safe to call from an ISR through lv_task_wake().
+static void IRAM_ATTR gui_wake_cb(void) {
+    if (xPortInIsrContext()) {
+        BaseType_t higher_prio_woken = pdFALSE;
+        vTaskNotifyGiveFromISR(gui_task_handle, &higher_prio_woken);
+        if (higher_prio_woken) portYIELD_FROM_ISR();
+    } else {
+        xTaskNotifyGive(gui_task_handle);
+    }
+}
+
+//Converts the time returned by lv_task_handler to a notification timeout. It's rounded up:
+//waking before the next task is due would only cost an extra round of the loop.
+static TickType_t gui_sleep_ticks(uint32_t sleep_ms) {
+    if (sleep_ms == LV_NO_TASK_READY) return portMAX_DELAY;
+
+    TickType_t ticks = (sleep_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+    return ticks > 0 ? ticks : 1;
+}
+
+//Output stage callback, runs in the audio task
+static void audio_render_cb(void *arg, int16_t *buf, size_t n) {
+    dds_params_reader_t *rd = (dds_params_reader_t *)arg;
+
+    dds_params_render(rd, buf, n);
+    dds_meas_feed(&dds_meas, buf, n);
+    //A sweep or a glide moves it within the block: the value at its end
+    __atomic_store_n(&dds_phase_inc, rd->dds->phase_inc, __ATOMIC_RELAXED);
+}
+
+//The menu settings as generator parameters: amplitude in V peak, offset in mV
+static void audio_params_get(dds_params_t *params) {
+    uint32_t amplitude = (uint32_t)MENU_CONFIG.amplitude * 1000 * 32768 / CONFIG_WAVEMAN_FULL_SCALE_MV;
+    uint32_t gain = MENU_CONFIG.gain < DDS_LEVEL_GAIN_MAX ? MENU_CONFIG.gain : DDS_LEVEL_GAIN_MAX;
+    int32_t offset = (int32_t)MENU_CONFIG.offset * INT16_MAX / CONFIG_WAVEMAN_FULL_SCALE_MV;
+
+    if (amplitude > 32768) amplitude = 32768;
+    if (offset > INT16_MAX) offset = INT16_MAX;
+    else if (offset < -INT16_MAX) offset = -INT16_MAX;
+
+    params->frequency = MENU_CONFIG.frequency;
+    params->sweep = MENU_CONFIG.sweep;
+    params->sweep_stop = MENU_CONFIG.sweep_stop;
+    params->sweep_ms = MENU_CONFIG.sweep_ms;
+    if (MENU_CONFIG.waveform < DDS_WAVE_MAX) {
+        params->wave = MENU_CONFIG.waveform;
+        params->table = NULL;
+    } else {
+        //The bank is loaded once, the table stays where it is
+        params->wave = DDS_WAVE_CUSTOM;
+        params->table = awg_bank.waves[MENU_CONFIG.waveform - DDS_WAVE_MAX].table;
+    }
+#if CONFIG_WAVEMAN_PARAM_RAMP
+    params->ramp = true;
+#else
+    params->ramp = false;
+#endif
+    dds_level_set(&params->level, amplitude, gain * 256, offset, INT16_MAX);
+}
+
+//Hands the menu settings over to the audio task, it takes them at its next block
+static void audio_params_publish(void) {
+    dds_params_t params;
+    audio_params_get(&params);
+    dds_params_publish(&dds_params, &params);
+    preview_update(&params);
+}
+
+//Chart of one period of the output, drawn by preview_update()
+static void preview_create(lv_obj_t *parent) {
+    static lv_style_t style;
+    lv_style_copy(&style, &lv_style_plain);
+    style.body.border.width = 1;
+    style.body.border.color = LV_COLOR_BLACK;
+    style.body.padding.left = style.body.padding.right = 0;
+    style.body.padding.top = style.body.padding.bottom = 0;
+
+    preview_chart = lv_chart_create(parent, NULL);
+    lv_chart_set_style(preview_chart, LV_CHART_STYLE_MAIN, &style);
+    lv_obj_set_size(preview_chart, PREVIEW_POINTS, PREVIEW_HEIGHT);
+    lv_chart_set_type(preview_chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_div_line_count(preview_chart, 0, 0);
+    lv_chart_set_point_count(preview_chart, PREVIEW_POINTS);
+    lv_chart_set_range(preview_chart, 0, PREVIEW_HEIGHT - 1);
+    lv_chart_set_series_width(preview_chart, 1);
+    //Points are written in place by lv_chart_set_next(), each one invalidating only its own lines
+    lv_chart_set_update_mode(preview_chart, LV_CHART_UPDATE_MODE_CIRCULAR);
+    preview_ser = lv_chart_add_series(preview_chart, LV_COLOR_BLACK);
+    preview_design_ancestor = lv_obj_get_design_cb(preview_chart);
+    lv_obj_set_design_cb(preview_chart, preview_design);
+    lv_chart_init_points(preview_chart, preview_ser, LV_CHART_POINT_DEF);
+}
+
+//The chart without antialiasing: on the monochrome display the blended pixels turn black and the line triples
+static bool preview_design(lv_obj_t *chart, const lv_area_t *mask, lv_design_mode_t mode) {
+    lv_disp_t *disp = lv_obj_get_disp(chart);
+    uint32_t antialiasing = disp->driver.antialiasing;
+
+    disp->driver.antialiasing = 0;
+    bool res = preview_design_ancestor(chart, mask, mode);
+    disp->driver.antialiasing = antialiasing;
+
+    return res;
+}
+
+//Renders a period of the output at one sample per point, levelled, and moves the points which changed row.
+//Between two settings most of them stay: amplitude and offset move the tops, the waveform can keep the zeros.
+static void preview_update(const dds_params_t *params) {
+    if (!screen_is_shown(&screen_mgr, &screens[MENU_STATS_SET_SCREEN])) return;
+
+    dds_t gen;
+    int16_t buf[PREVIEW_POINTS];
+    dds_init(&gen, CONFIG_DDS_SAMPLE_RATE);
+    dds_set_quality(&gen, DDS_QUALITY_NAIVE);		//The shape, not what a band-limited edge looks like when decimated
+    if (params->wave == DDS_WAVE_CUSTOM) dds_set_table(&gen, params->table);
+    else dds_set_waveform(&gen, params->wave);
+    gen.phase_inc = UINT32_MAX / PREVIEW_POINTS + 1;
+    dds_render(&gen, buf, PREVIEW_POINTS);
+    dds_level_apply(&params->level, buf, PREVIEW_POINTS);
+
+    for (uint16_t i = 0; i < PREVIEW_POINTS; i++) {
+        lv_coord_t y = (lv_coord_t)(((int32_t)buf[i] + INT16_MAX) * (PREVIEW_HEIGHT - 1) / (2 * INT16_MAX));
+        if (y == preview_ser->points[i]) continue;
+
+        preview_ser->start_point = i;
+        lv_chart_set_next(preview_chart, preview_ser, y);
+    }
+}
+
+//The capture window and trigger of the menu
+static void logic_capture_get(logic_capture_t *cap) {
+	uint32_t window = (uint32_t)((uint64_t)CONFIG_LOGIC_SAMPLE_RATE * LOGIC_WINDOW_US / 1000000);
+
+	cap->trigger = logic_triggers[MENU_CONFIG.logic_trigger];
+	cap->pre_samples = window / 4;
+	cap->post_samples = window - cap->pre_samples;
+}
+
+//Shows the capture when it's done, then arms the next one. The capture task takes the request
+//at its next block; until it does, the capture shown stays done and is not drawn again.
+static void logic_refresh(screen_t *scr) {
+	(void) scr;
+
+	if (!logic_rearm && logic_draw()) logic_rearm = true;
+	if (logic_rearm) {
+		logic_capture_t cap;
+		logic_capture_get(&cap);
+		if (logic_arm(&logic, &cap) == ESP_OK) logic_rearm = false;
+	}
+}
+
+//Draws the view of the capture done, a row per channel and the trigger dotted.
+//The canvas is only invalidated when the view changed: a steady signal isn't flushed again.
+static bool logic_draw(void) {
+	logic_column_t cols[LOGIC_VIEW_WIDTH];
+	size_t trigger_col;
+
+	if (logic_view(&logic, cols, LOGIC_VIEW_WIDTH, &trigger_col) != ESP_OK) return false;
+	if (memcmp(cols, logic_view_shown, sizeof(cols)) == 0 && trigger_col == logic_trigger_shown) return true;
+	memcpy(logic_view_shown, cols, sizeof(cols));
+	logic_trigger_shown = trigger_col;
+
+	lv_img_dsc_t *img = lv_canvas_get_img(logic_canvas);
+	lv_canvas_fill_bg(logic_canvas, LV_COLOR_WHITE);
+	for (uint8_t ch = 0; ch < LOGIC_CHANNEL_CNT; ch++) {
+		lv_coord_t y_high = ch * LOGIC_ROW_HEIGHT + 1, y_low = (ch + 1) * LOGIC_ROW_HEIGHT - 2;
+		bool prev_high = false, prev_low = false;
+
+		for (lv_coord_t x = 0; x < LOGIC_VIEW_WIDTH; x++) {
+			bool high = cols[x].high & (1 << ch), low = cols[x].low & (1 << ch);
+			//An edge inside the column, or on its left border
+			bool edge = (high && low) || (high && prev_low && !prev_high) || (low && prev_high && !prev_low);
+
+			if (edge) {
+				for (lv_coord_t y = y_high; y <= y_low; y++) lv_img_buf_set_px_color(img, x, y, LV_COLOR_BLACK);
+			} else if (high) {
+				lv_img_buf_set_px_color(img, x, y_high, LV_COLOR_BLACK);
+			} else if (low) {
+				lv_img_buf_set_px_color(img, x, y_low, LV_COLOR_BLACK);
+			}
+			prev_high = high;
+			prev_low = low;
+		}
+	}
+	for (lv_coord_t y = 0; y < img->header.h; y += 2) lv_img_buf_set_px_color(img, trigger_col, y, LV_COLOR_BLACK);
+
+	lv_obj_invalidate(logic_canvas);
+	return true;
+}
+
+//Samples what each core runs at every tick: the share of the ticks where it was idle is its idle time
+static void IRAM_ATTR cpu_tick_hook(void) {
+	BaseType_t cpu = xPortGetCoreID();
+
+	cpu_ticks[cpu]++;
+	if (xTaskGetCurrentTaskHandleForCPU(cpu) == xTaskGetIdleTaskHandleForCPU(cpu)) cpu_idle_ticks[cpu]++;
+}
+
+//Load of each core since the last call, percent
+static void cpu_load_get(uint8_t *load) {
+	static uint32_t ticks_seen[portNUM_PROCESSORS], idle_seen[portNUM_PROCESSORS];
+
+	for (int cpu = 0; cpu < portNUM_PROCESSORS; cpu++) {
+		uint32_t ticks = cpu_ticks[cpu], idle = cpu_idle_ticks[cpu];
+
+		load[cpu] = ticks != ticks_seen[cpu] ? 100 - (idle - idle_seen[cpu]) * 100 / (ticks - ticks_seen[cpu]) : 0;
+		ticks_seen[cpu] = ticks;
+		idle_seen[cpu] = idle;
+	}
+}
+
+//A row per value, the labels show the text of their cache entry. The tab fits itself to what it holds:
+//each row is aligned on the first one rather than placed in a tab which moves as it grows.
+static void stats_create(lv_obj_t *parent) {
+	lv_obj_t *first = NULL;
+
+	for (int i = 0; i < STATS_VALUE_CNT; i++) {
+		lv_obj_t *name = lv_label_create(parent, NULL);
+		lv_label_set_static_text(name, stats_names[i]);
+		if (first == NULL) {
+			lv_obj_align(name, NULL, LV_ALIGN_IN_TOP_LEFT, 4, 0);
+			first = name;
+		} else {
+			lv_obj_align(name, first, LV_ALIGN_IN_TOP_LEFT, 0, i * STATS_ROW_HEIGHT);
+		}
+
+		stats_values[i].text[0] = '\0';
+		stats_values[i].label = lv_label_create(parent, NULL);
+		lv_label_set_static_text(stats_values[i].label, stats_values[i].text);
+		lv_obj_align(stats_values[i].label, name, LV_ALIGN_IN_TOP_LEFT, STATS_VALUE_X - 4, 0);
+	}
+}
+
+//Formats the values and shows those which changed
+static void stats_refresh(screen_t *scr) {
+	(void) scr;
+	char text[STATS_TEXT_LEN];
+	uint32_t period_ns;
+	uint16_t duty;
+	audio_out_stats_t out;
+	uint8_t load[portNUM_PROCESSORS];
+
+	//What is played now, sweeping or not: mHz, rounded
+	uint64_t phase_inc = __atomic_load_n(&dds_phase_inc, __ATOMIC_RELAXED);
+	stats_format_milli(text, sizeof(text), (uint32_t)((phase_inc * CONFIG_DDS_SAMPLE_RATE * 1000 + (1ULL << 31)) >> 32), "Hz");
+	stats_value_set(&stats_values[STATS_FREQUENCY], text);
+
+	if (dds_meas_get(&dds_meas, &period_ns, &duty)) {
+		if (period_ns < 1000000) stats_format_milli(text, sizeof(text), period_ns, "us");
+		else if (period_ns < 1000000000) stats_format_milli(text, sizeof(text), period_ns / 1000, "ms");
+		else stats_format_milli(text, sizeof(text), period_ns / 1000000, "s");
+		stats_value_set(&stats_values[STATS_PERIOD], text);
+		snprintf(text, sizeof(text), "%u.%u%%", duty / 10, duty % 10);
+		stats_value_set(&stats_values[STATS_DUTY], text);
+	} else {
+		stats_value_set(&stats_values[STATS_PERIOD], "-");
+		stats_value_set(&stats_values[STATS_DUTY], "-");
+	}
+
+	audio_out_get_stats(&audio_out, &out);
+	snprintf(text, sizeof(text), "%u", (unsigned)out.underruns);
+	stats_value_set(&stats_values[STATS_UNDERRUNS], text);
+
+	cpu_load_get(load);
+	size_t len = 0;
+	for (int cpu = 0; cpu < portNUM_PROCESSORS; cpu++) {
+		int res = snprintf(text + len, sizeof(text) - len, cpu ? " %u%%" : "%u%%", load[cpu]);
+		if (res < 0 || (size_t)res >= sizeof(text) - len) break;	//Cut, but terminated
+		len += res;
+	}
+	stats_value_set(&stats_values[STATS_CPU], text);
+}
+
+//Shows `text` unless it's shown already: a label is only invalidated, and flushed, when its text changed
+static void stats_value_set(stats_value_t *value, const char *text) {
+	if (strcmp(value->text, text) == 0) return;
+
+	snprintf(value->text, sizeof(value->text), "%s", text);
+	lv_label_set_static_text(value->label, value->text);
+}
+
+//Four significant digits, five from 10000: 1.234, 12.34, 123.4, 1234, 12345
+static void stats_format_milli(char *buf, size_t len, uint32_t milli, const char *unit) {
+	unsigned int whole = milli / 1000, frac = milli % 1000;
+
+	if (milli < 10000) snprintf(buf, len, "%u.%03u%s", whole, frac, unit);
+	else if (milli < 100000) snprintf(buf, len, "%u.%02u%s", whole, frac / 10, unit);
+	else if (milli < 1000000) snprintf(buf, len, "%u.%u%s", whole, frac / 100, unit);
+	else snprintf(buf, len, "%u%s", whole, unit);
+}
+
+//The menu: a button per screen. The button of the screen left is selected when it's shown again.
+static void menu_build(screen_t *scr) {
+	static lv_style_t style4, style5, style6;
+	style4 = lv_style_transp_fit;
+	style5 = lv_style_transp_fit; //lv_style_pretty
+	style6 = lv_style_pretty;
+
+	menulist = lv_list_create(scr->cont, NULL);
+	lv_obj_set_size(menulist, 128, 50);
+	lv_obj_align(menulist, NULL,  LV_ALIGN_IN_TOP_LEFT, 0, 0);
+	lv_list_set_anim_time(menulist, 60);
+	lv_list_set_sb_mode(menulist, LV_SB_MODE_OFF); 	// LIST Disable Scroll Bar
+	lv_list_set_single_mode(menulist, true);
+
+	style4.body.border.width =0;
+	style4.body.padding.left = -1;
+	style4.body.padding.right = -1;
+	// style4.body.padding.top = 0;
+	lv_list_set_style(menulist, LV_LIST_STYLE_BG, &style4);
+
+	style5.body.padding.inner = -3;
+	style5.body.border.width = 0;
+	// style5.body.padding.top = -5;
+	lv_list_set_style(menulist, LV_LIST_STYLE_SCRL, &style5);
+
+	// To adjust the height of an individual list button,
+	// dimensions of the container need to be changed.
+	style6.body.padding.top = 6;
+	style6.body.padding.bottom = 5;
+	style6.body.radius = 0;
+
+	// Long Strings cause glitchy scroll, in the button label.
+	static const char *names[] = {"1.Frequency", "2.Amplitude", "3.Waveform", "4.Logic In", "5.Stats", "6.Sweep"};
+	for (int i = 0; i < 6; i++) {
+		list_btn[i] = lv_list_add_btn(menulist, NULL, names[i]);
+		lv_obj_set_event_cb(list_btn[i], menu_select_cb);
+		lv_btn_set_style(list_btn[i], LV_CONT_STYLE_MAIN, &style6);
+	}
+
+	lv_group_add_obj(scr->group, menulist);
+}
+
+static void menu_show(screen_t *scr) {
+	(void) scr;
+	printf("MENU_SCREEN\n");
+	//The button of the screen left, the first one at start up
+	screen_t *from = screen_mgr.previous;
+	lv_list_set_btn_selected(menulist, list_btn[from ? from - screens : MENU_FREQUENCY_SET_SCREEN]);
+}
+
+//The spinbox reshapes the spinbox and label styles of the theme: the screens built after it inherit that.
+//lv_*_get_style() hands them out const, the casts are for writing to them all the same.
+static void frequency_build(screen_t *scr) {
+	lv_style_t *spinbox_cursor_style, *spinbox_text_style;
+	lv_obj_t *label;
+
+	spinbox_frequency = lv_spinbox_create(scr->cont, NULL);
+	lv_spinbox_set_digit_format(spinbox_frequency, 9, 0);
+	lv_spinbox_step_prev(spinbox_frequency);
+	lv_obj_set_width(spinbox_frequency, 110);
+	lv_spinbox_set_range(spinbox_frequency, 1, 268435456);
+	lv_obj_set_event_cb(spinbox_frequency, spinbox_frequency_cb);
+	spinbox_text_style = (lv_style_t *)lv_spinbox_get_style(spinbox_frequency, LV_LABEL_STYLE_MAIN);
+	spinbox_text_style->text.letter_space = 4;
+	lv_spinbox_set_style(spinbox_frequency, LV_LABEL_STYLE_MAIN, spinbox_text_style);
+
+	spinbox_text_style = (lv_style_t *)lv_spinbox_get_style(spinbox_frequency, LV_SPINBOX_STYLE_BG);
+	spinbox_text_style->body.padding.top = 7;
+	spinbox_text_style->body.padding.bottom = 2;
+	spinbox_text_style->body.border.width = 1;
+	lv_spinbox_set_style(spinbox_frequency, LV_SPINBOX_STYLE_BG, spinbox_text_style);
+
+	spinbox_cursor_style = (lv_style_t *)lv_spinbox_get_style(spinbox_frequency, LV_SPINBOX_STYLE_CURSOR);
+	// spinbox_cursor_style->line.width = 1;
+	spinbox_cursor_style->body.radius = 2;
+	// spinbox_cursor_style.body.padding.inner  = 3;
+	spinbox_cursor_style->body.padding.right = 1;
+	spinbox_cursor_style->body.padding.left  = 2;
+	spinbox_cursor_style->body.padding.top = 5;
+	spinbox_cursor_style->body.padding.bottom = 3;
+	lv_spinbox_set_style(spinbox_frequency,LV_SPINBOX_STYLE_CURSOR, spinbox_cursor_style);
+
+	lv_ta_set_cursor_type(spinbox_frequency, LV_CURSOR_BLOCK);
+	lv_spinbox_set_padding_left(spinbox_frequency, 1);
+	lv_ta_set_cursor_blink_time(spinbox_frequency, 0);
+
+	label = lv_label_create(scr->cont, NULL);
+	lv_label_set_text(label, "Set Frequency:");
+	lv_obj_set_pos(label, SCREEN_TITLE_POS, SCREEN_TITLE_POS);
+
+	lv_obj_align(spinbox_frequency, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -8);
+
+	spinbox_text_style = (lv_style_t *)lv_label_get_style(label, LV_LABEL_STYLE_MAIN);
+	spinbox_text_style->body.opa = LV_OPA_TRANSP;
+	spinbox_text_style->text.letter_space = -1;
+	lv_label_set_style(label, LV_LABEL_STYLE_MAIN, spinbox_text_style);
+
+	lv_group_add_obj(scr->group, spinbox_frequency);
+}
+
+static void frequency_show(screen_t *scr) {
+	(void) scr;
+	printf("SET_FREQUENCY\n");
+	lv_spinbox_set_value(spinbox_frequency, MENU_CONFIG.frequency);
+}
+
+static void frequency_hide(screen_t *scr) {
+	(void) scr;
+	MENU_CONFIG.frequency = lv_spinbox_get_value(spinbox_frequency);
+}
+
+static void amplitude_build(screen_t *scr) {
+	lv_obj_t *label = lv_label_create(scr->cont, NULL);
+	lv_label_set_text(label, "SET_AMPLITUDE");
+	lv_obj_set_pos(label, SCREEN_TITLE_POS, SCREEN_TITLE_POS);
+}
+
+static void waveform_build(screen_t *scr) {
+	lv_style_t *roller_text_style;
+	lv_obj_t *label;
+
+	roller_waveform = lv_roller_create(scr->cont, NULL);
+	lv_roller_set_options(roller_waveform, waveform_options, LV_ROLLER_MODE_NORMAL);
+	lv_roller_set_visible_row_count(roller_waveform, 2);
+	lv_obj_align(roller_waveform, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -4);
+	lv_obj_set_event_cb(roller_waveform, roller_waveform_cb);
+
+	label = lv_label_create(scr->cont, NULL);
+	lv_label_set_text(label, "SET WAVEFORM");
+	lv_obj_set_pos(label, SCREEN_TITLE_POS, SCREEN_TITLE_POS);
+
+	roller_text_style = (lv_style_t *)lv_label_get_style(label, LV_LABEL_STYLE_MAIN);
+	roller_text_style->body.opa = LV_OPA_TRANSP;
+	roller_text_style->text.letter_space = -1;
+	lv_label_set_style(label, LV_LABEL_STYLE_MAIN, roller_text_style);
+
+	lv_group_add_obj(scr->group, roller_waveform);
+}
+
+static void waveform_show(screen_t *scr) {
+	(void) scr;
+	printf("SET_WAVEFORM\n");
+	lv_roller_set_selected(roller_waveform, MENU_CONFIG.waveform, LV_ANIM_ON);
+}
+
+static void waveform_hide(screen_t *scr) {
+	(void) scr;
+	MENU_CONFIG.waveform = lv_roller_get_selected(roller_waveform);
+}
+
+//The trigger on the first row, a row per channel below. The inputs are captured while the screen is shown.
+static void logic_build(screen_t *scr) {
+	roller_logic_trigger = lv_roller_create(scr->cont, NULL);
+	lv_roller_set_options(roller_logic_trigger, "Free\nCH0 rise\nCH0 fall\nCH1 rise\nCH1 fall\nCH2 rise\nCH2 fall\nCH3 rise\nCH3 fall",
+						  LV_ROLLER_MODE_NORMAL);
+	lv_roller_set_visible_row_count(roller_logic_trigger, 1);
+	lv_roller_set_fix_width(roller_logic_trigger, 64);
+	lv_obj_align(roller_logic_trigger, NULL, LV_ALIGN_IN_TOP_RIGHT, -4, 0);
+	lv_obj_set_event_cb(roller_logic_trigger, roller_logic_trigger_cb);
+
+	lv_obj_t *label = lv_label_create(scr->cont, NULL);
+	lv_label_set_text(label, "TRIG");
+	lv_obj_align(label, roller_logic_trigger, LV_ALIGN_OUT_LEFT_MID, 0, 0);
+	lv_obj_set_x(label, 4);
+
+	//lv_img_buf_set_px_color() takes the lowest bit of the color as the index: black is 0
+	logic_canvas = lv_canvas_create(scr->cont, NULL);
+	lv_canvas_set_buffer(logic_canvas, logic_canvas_buf, LOGIC_VIEW_WIDTH, LOGIC_CHANNEL_CNT * LOGIC_ROW_HEIGHT,
+						 LV_IMG_CF_INDEXED_1BIT);
+	lv_canvas_set_palette(logic_canvas, 0, LV_COLOR_BLACK);
+	lv_canvas_set_palette(logic_canvas, 1, LV_COLOR_WHITE);
+	((lv_color32_t *) logic_canvas_buf)[0].ch.alpha = LV_OPA_COVER;	//lv_color_to32() makes black transparent on a 1-bit display
+	lv_obj_align(logic_canvas, roller_logic_trigger, LV_ALIGN_OUT_BOTTOM_RIGHT, 0, 1);
+	lv_obj_set_x(logic_canvas, 4);
+
+	lv_group_add_obj(scr->group, roller_logic_trigger);
+}
+
+//The capture of the last time the screen was shown is gone: start blank
+static void logic_show(screen_t *scr) {
+	(void) scr;
+	printf("SET_LOGIC_IN\n");
+	lv_roller_set_selected(roller_logic_trigger, MENU_CONFIG.logic_trigger, LV_ANIM_OFF);
+	lv_canvas_fill_bg(logic_canvas, LV_COLOR_WHITE);
+	memset(logic_view_shown, 0, sizeof(logic_view_shown));
+	logic_trigger_shown = SIZE_MAX;
+
+	if (logic_start(&logic) != ESP_OK) printf("Logic capture not started\n");
+	logic_rearm = true;
+}
+
+static void logic_hide(screen_t *scr) {
+	(void) scr;
+	logic_stop(&logic);
+}
+
+//From the set frequency to STOP in TIME, over and over. ENTER moves to the next row.
+static void sweep_build(screen_t *scr) {
+	static lv_style_t sweep_spinbox_style, sweep_cursor_style;
+	static const char *sweep_labels[] = {"SWEEP", "STOP Hz", "TIME ms"};
+
+	roller_sweep = lv_roller_create(scr->cont, NULL);
+	lv_roller_set_options(roller_sweep, "Off\nLinear\nLog", LV_ROLLER_MODE_NORMAL);
+	lv_roller_set_visible_row_count(roller_sweep, 1);
+	lv_roller_set_fix_width(roller_sweep, 52);
+	lv_obj_align(roller_sweep, NULL, LV_ALIGN_IN_TOP_RIGHT, -4, 0);
+	lv_obj_set_event_cb(roller_sweep, roller_sweep_cb);
+
+	//Own styles: the frequency screen reshapes the spinbox styles of the theme
+	spinbox_sweep_stop = lv_spinbox_create(scr->cont, NULL);
+	lv_style_copy(&sweep_spinbox_style, lv_spinbox_get_style(spinbox_sweep_stop, LV_SPINBOX_STYLE_BG));
+	sweep_spinbox_style.body.padding.top = 1;
+	sweep_spinbox_style.body.padding.bottom = 1;
+	sweep_spinbox_style.body.padding.left = 2;
+	sweep_spinbox_style.body.padding.right = 2;
+	sweep_spinbox_style.body.border.width = 1;
+	lv_style_copy(&sweep_cursor_style, lv_spinbox_get_style(spinbox_sweep_stop, LV_SPINBOX_STYLE_CURSOR));
+	sweep_cursor_style.body.padding.top = 0;
+	sweep_cursor_style.body.padding.bottom = 0;
+	sweep_cursor_style.body.padding.left = 0;
+	sweep_cursor_style.body.padding.right = 0;
+
+	for (int i = 0; i < 2; i++) {
+		lv_obj_t *spinbox = i ? lv_spinbox_create(scr->cont, NULL) : spinbox_sweep_stop;
+		lv_spinbox_set_digit_format(spinbox, 5, 0);
+		lv_spinbox_set_style(spinbox, LV_SPINBOX_STYLE_BG, &sweep_spinbox_style);
+		lv_spinbox_set_style(spinbox, LV_SPINBOX_STYLE_CURSOR, &sweep_cursor_style);
+		lv_ta_set_cursor_type(spinbox, LV_CURSOR_BLOCK);
+		lv_ta_set_cursor_blink_time(spinbox, 0);
+		lv_obj_set_width(spinbox, 52);
+		lv_obj_align(spinbox, roller_sweep, LV_ALIGN_OUT_BOTTOM_RIGHT, 0, 1 + i * 14);
+		if (i) spinbox_sweep_time = spinbox;
+	}
+	lv_spinbox_set_range(spinbox_sweep_stop, 1, CONFIG_DDS_SAMPLE_RATE / 2 - 1);
+	lv_obj_set_event_cb(spinbox_sweep_stop, spinbox_sweep_stop_cb);
+	lv_spinbox_set_range(spinbox_sweep_time, 10, 99999);
+	lv_obj_set_event_cb(spinbox_sweep_time, spinbox_sweep_time_cb);
+
+	//A label on the left of each row
+	lv_obj_t *sweep_rows[] = {roller_sweep, spinbox_sweep_stop, spinbox_sweep_time};
+	for (int i = 0; i < 3; i++) {
+		lv_obj_t *label = lv_label_create(scr->cont, NULL);
+		lv_label_set_text(label, sweep_labels[i]);
+		lv_obj_align(label, sweep_rows[i], LV_ALIGN_OUT_LEFT_MID, 0, 0);
+		lv_obj_set_x(label, 4);
+	}
+
+	lv_group_add_obj(scr->group, roller_sweep);
+	lv_group_add_obj(scr->group, spinbox_sweep_stop);
+	lv_group_add_obj(scr->group, spinbox_sweep_time);
+}
+
+//Back on the first row
+static void sweep_show(screen_t *scr) {
+	(void) scr;
+	printf("SET_SWEEP\n");
+	lv_roller_set_selected(roller_sweep, MENU_CONFIG.sweep, LV_ANIM_OFF);
+	lv_spinbox_set_value(spinbox_sweep_stop, MENU_CONFIG.sweep_stop);
+	lv_spinbox_set_value(spinbox_sweep_time, MENU_CONFIG.sweep_ms);
+	lv_group_focus_obj(roller_sweep);
+}
+
+static void stats_build(screen_t *scr) {
+	stats_create(scr->cont);
+	preview_create(scr->cont);
+	lv_obj_align(preview_chart, NULL, LV_ALIGN_IN_TOP_RIGHT, -4, 0);
+}
+
+//The load is shown from now on
+static void stats_show(screen_t *scr) {
+	(void) scr;
+	uint8_t load[portNUM_PROCESSORS];
+	dds_params_t params;
+
+	printf("OPEN_STATS\n");
+	cpu_load_get(load);
+
+	audio_params_get(&params);
+	preview_update(&params);
+}
+
+//Called from the key interrupt when an event was queued
+static void keypad_event_cb(keypad_t *kp) {
+    (void) kp;
+    lv_task_wake();
+}
+
+//The keypad read tasks pause themselves when their keypad is idle, start the ones with something to report.
+//A disabled input device isn't read at all: throw its events away like the key was never pressed.
+static void keypad_resume_reads(void) {
+    for (size_t i = 0; i < sizeof(keypads) / sizeof(keypads[0]); i++) {
+        keypad_t *kp = keypads[i];
+        lv_indev_t *indev = kp->user_data;
+
+        if (indev == NULL || keypad_is_idle(kp)) continue;
+
+        if (indev->proc.disabled) {
+            keypad_event_t ev;
+            while (keypad_read(kp, &ev));
+        } else {
+            lv_task_resume(indev->driver.read_task);
+        }
+    }
+}
+
+//Loads the arbitrary waveforms of the storage partition, once, and lists all the waveforms for the roller
+static void storage_init(void) {
+    esp_vfs_spiffs_conf_t conf = {
+        .base_path = CONFIG_WAVEMAN_STORAGE_PATH,
+        .partition_label = "storage",
+        .max_files = 2,
+        .format_if_mount_failed = false,
+    };
+    esp_err_t res = esp_vfs_spiffs_register(&conf);
+    if (res == ESP_OK) {
+        fs_stdio_init(STORAGE_DRIVE, CONFIG_WAVEMAN_STORAGE_PATH);
+        awg_bank_load(&awg_bank, AWG_DIR);
+    } else {
+        printf("No storage partition (%d), built-in waveforms only\n", res);
+    }
+
+    char *p = waveform_options;
+    for (uint8_t i = 0; i < DDS_WAVE_MAX + awg_bank.count; i++) {
+        p += sprintf(p, "%s%s", i ? "\n" : "", waveform_get_name(i));
+    }
+}
+
+static const char *waveform_get_name(uint8_t waveform) {
+    if (waveform < DDS_WAVE_MAX) return waveform_names[waveform];
+    return awg_bank.waves[waveform - DDS_WAVE_MAX].name;
 }
 
 //Creates a semaphore to handle concurrent call to lvgl stuff
@@ -60,17 +843,48 @@ SemaphoreHandle_t xGuiSemaphore;
 void guiTask() {
 
 	xGuiSemaphore = xSemaphoreCreateMutex();
+    gui_task_handle = xTaskGetCurrentTaskHandle();
     lv_init();
+    lv_task_set_wake_cb(gui_wake_cb);
     lvgl_driver_init();
+    storage_init();
 
     static lv_color_t buf1[DISP_BUF_SIZE];
+#if defined CONFIG_LVGL_TFT_DISPLAY_MONOCHROME
+    //The monochrome buffers are screen sized, two of them would select true double buffering
+    //which flushes the whole screen on every refresh. The I2C flush blocks anyway.
+    lv_color_t *buf2 = NULL;
+#else
     static lv_color_t buf2[DISP_BUF_SIZE];
+#endif
     static lv_disp_buf_t disp_buf;
 
 	MENU_CONFIG.frequency = 5;
 	MENU_CONFIG.amplitude = 1;
 	MENU_CONFIG.waveform = 0;
 	MENU_CONFIG.gain = 1;
+	MENU_CONFIG.offset = 0;
+	MENU_CONFIG.sweep = DDS_SWEEP_OFF;
+	MENU_CONFIG.sweep_stop = 20000;
+	MENU_CONFIG.sweep_ms = 1000;
+	MENU_CONFIG.logic_trigger = 0;
+
+	dds_params_t params;
+	audio_params_get(&params);
+	dds_init(&dds, CONFIG_DDS_SAMPLE_RATE);
+	dds_params_init(&dds_params, &params);
+	dds_params_reader_init(&dds_reader, &dds_params, &dds);
+	dds_meas_init(&dds_meas, CONFIG_DDS_SAMPLE_RATE);
+	dds_phase_inc = dds.phase_inc;
+
+	//The samples are rendered and played on core 0, away from this task
+	audio_out.sample_rate = CONFIG_DDS_SAMPLE_RATE;
+	ESP_ERROR_CHECK(audio_sink_i2s_init(&audio_sink));
+	ESP_ERROR_CHECK(audio_out_start(&audio_out));
+	ESP_ERROR_CHECK(logic_source_i2s_init(&logic_source));
+	for (UBaseType_t cpu = 0; cpu < portNUM_PROCESSORS; cpu++) {
+		ESP_ERROR_CHECK(esp_register_freertos_tick_hook_for_cpu(cpu_tick_hook, cpu));
+	}
 
 	static lv_obj_t *tabview, *tab0, *tab1;		//Create tabs
 
@@ -89,15 +903,6 @@ void guiTask() {
 
 
 
-    const esp_timer_create_args_t periodic_timer_args = {
-            .callback = &lv_tick_task,
-            /* name is optional, but may help identify the timer when debugging */
-            .name = "periodic_gui"
-    };
-    esp_timer_handle_t periodic_timer;
-    ESP_ERROR_CHECK(esp_timer_create(&periodic_timer_args, &periodic_timer));
-    //On ESP32 it's better to create a periodic task instead of esp_register_freertos_tick_hook
-    ESP_ERROR_CHECK(esp_timer_start_periodic(periodic_timer, 10*1000)); //10ms (expressed as microseconds)
 
 	static lv_indev_drv_t keypad_UP_DOWN;
 	lv_indev_drv_init(&keypad_UP_DOWN);             /*Basic initialization*/
@@ -127,36 +932,38 @@ void guiTask() {
 	/*Register the driver in LittlevGL and save the created input device object*/
 	lv_indev_t * keypad_ENTER_Button = lv_indev_drv_register(&keypad_ENTER);
 
-	gpio_config_t io_conf;
-	io_conf.intr_type = GPIO_PIN_INTR_DISABLE;
-	io_conf.mode = GPIO_MODE_INPUT;
-	io_conf.pull_down_en = 1;
-	io_conf.pull_up_en = 0;
-
-	io_conf.pin_bit_mask = GPIO_SEL_21; // Select
-	gpio_config(&io_conf);
-
-	io_conf.pin_bit_mask = GPIO_SEL_22; // UP Button
-	gpio_config(&io_conf);
-
-	io_conf.pin_bit_mask = GPIO_SEL_23; // Down Button
-	gpio_config(&io_conf);
-
-	io_conf.pin_bit_mask = GPIO_SEL_19; // Back
-	gpio_config(&io_conf);
-
-	io_conf.pin_bit_mask = GPIO_SEL_16; // Right Button
-	gpio_config(&io_conf);
+	//The keys have pull downs and raise an interrupt on both edges
+	keypad_UD.user_data = keypad_UD_Button;
+	keypad_BK.user_data = keypad_Back_Button;
+	keypad_LR.user_data = keypad_LR_Button;
+	keypad_EN.user_data = keypad_ENTER_Button;
+	for (size_t i = 0; i < sizeof(keypads) / sizeof(keypads[0]); i++) {
+		ESP_ERROR_CHECK(keypad_init(keypads[i]));
+	}
 
-	io_conf.pin_bit_mask = GPIO_SEL_17; // Left Button
-	gpio_config(&io_conf);
+#if CONFIG_WAVEMAN_ENCODER
+	static rotary_encoder_t encoder = {
+		.pin_a = CONFIG_WAVEMAN_ENCODER_PIN_A,
+		.pin_b = CONFIG_WAVEMAN_ENCODER_PIN_B,
+		.pin_btn = CONFIG_WAVEMAN_ENCODER_PIN_BTN,
+	};
+	QueueHandle_t encoder_queue = xQueueCreate(ENCODER_QUEUE_LEN, sizeof(rotary_encoder_event_t));
+	ESP_ERROR_CHECK(rotary_encoder_init(encoder_queue));
+	ESP_ERROR_CHECK(rotary_encoder_add(&encoder));
+	encoder_indev_init(encoder_queue);
+
+	static lv_indev_drv_t encoder_drv;
+	lv_indev_drv_init(&encoder_drv);
+	encoder_drv.type = LV_INDEV_TYPE_ENCODER;
+	encoder_drv.read_cb = encoder_indev_read;	//Turns are batched between reads and accelerated
+	encoder_Button = lv_indev_drv_register(&encoder_drv);
+#endif
 
 	/*Create a Tab view object*/
 	tabview = lv_tabview_create(lv_scr_act(), NULL);
 	/*Add 2 tabs (the tabs are page (lv_page) and can be scrolled*/
 	tab0 = lv_tabview_add_tab(tabview, "SET");
 	tab1 = lv_tabview_add_tab(tabview, "ACTIVE");
-	static lv_group_t *tabview_input_group = NULL;
 
 	lv_style_t style2 = lv_style_plain_color;
 	style2.body.padding.inner = 0;
@@ -172,6 +979,7 @@ void guiTask() {
 	style7.body.opa = LV_OPA_TRANSP;
 	style7.body.border.width = 0;
 	lv_page_set_style(tab0, LV_PAGE_STYLE_SB, &style7);		// PAGE Scroll bar hidden
+	lv_page_set_style(tab1, LV_PAGE_STYLE_SB, &style7);
 
 	lv_style_t style1 = lv_style_transp;
 	style1.body.padding.top = 1;
@@ -183,427 +991,128 @@ void guiTask() {
 	lv_btnm_set_btn_width(ext->btns, 1, 2);
 	lv_obj_refresh_style(tabview);
 
-	lv_style_t style4 = lv_style_transp_fit;
-	lv_style_t style5 = lv_style_transp_fit; //lv_style_pretty
-	lv_style_t style6 = lv_style_pretty;
-
-	static lv_obj_t *menulist = NULL, *list_btn[5] ;			/*Create a list*/
-	static lv_group_t * menulist_input_group = NULL;
-
-	static lv_obj_t * trial_text_label = NULL;
-
-	static lv_obj_t * spinbox_frequency = NULL;
-	static lv_group_t * spinbox_input_group = NULL;
-	lv_style_t *spinbox_cursor_style, *spinbox_text_style;
-
-	static lv_obj_t * roller_waveform = NULL;
-	lv_style_t *roller_text_style = NULL;
-	static lv_group_t *roller_input_group = NULL;
-
-	static lv_obj_t *frequency_status_label = NULL,*frequency_status_value = NULL;
-	static lv_obj_t *amplitude_status_label = NULL,*amplitude_status_value = NULL;
-	static lv_obj_t *waveform_status_label  = NULL,*waveform_status_value  = NULL;
-	static char freq[20];
-
-	char waveform_name[3][12] = {"Sinosoid","Triangular", "Square"};
-
-
+	//The keypad and the encoder, when the board has one, follow the screen shown; left and right only some of them
+	screen_mgr.indevs[0] = keypad_UD_Button;
+	screen_mgr.indevs[1] = keypad_ENTER_Button;
+#if CONFIG_WAVEMAN_ENCODER
+	screen_mgr.indevs[2] = encoder_Button;
+#endif
+	screen_mgr.indev_lr = keypad_LR_Button;
+	screen_mgr.tabview = tabview;
+	ESP_ERROR_CHECK(screen_mgr_init(&screen_mgr));
+	for (int i = 0; i < SCREEN_CNT; i++) screens[i].parent = screens[i].tab ? tab1 : tab0;
+	ESP_ERROR_CHECK(screen_post(&screen_mgr, &screens[MENU_SCREEN]));
 
     while (1) {
-        vTaskDelay(1);
-        //Try to lock the semaphore, if success, call lvgl stuff
+        uint32_t sleep_ms = 0;
 
+        //Try to lock the semaphore, if success, call lvgl stuff
         if (xSemaphoreTake(xGuiSemaphore, (TickType_t) 10) == pdTRUE) {
-            lv_task_handler();
+            keypad_resume_reads();
+            sleep_ms = lv_task_handler();
+            screen_process(&screen_mgr);
+#if LV_USE_MEM_TRACE
+            mem_trace_check();
+#endif
             xSemaphoreGive(xGuiSemaphore);
-			// vTaskDelay(1000 / portTICK_PERIOD_MS);
         }
 
-		if (Change_Screen){							//DELETE Old Objects
-			switch (Current_Screen){
-				case MENU_SCREEN:
-					if(menulist != NULL){
-						lv_group_del(menulist_input_group);
-						menulist_input_group = NULL;
-						// lv_obj_set_hidden(menulist, false);
-						lv_obj_del(menulist);
-					}
-					lv_tabview_clean(tab0);
-					lv_tabview_clean(tab1);
-					printf("Deleted Menu objects\n");
-					break;
-				case MENU_FREQUENCY_SET_SCREEN:
-					if(menulist != NULL){
-						MENU_CONFIG.frequency = lv_spinbox_get_value(spinbox_frequency);
-						printf("Delete old FREQUENCY stuff\n");
-						lv_group_del(spinbox_input_group);
-						lv_indev_enable(keypad_LR_Button, false);
-						lv_obj_del(spinbox_frequency);
-					}
-					lv_tabview_clean(tab0);
-					break;
-				case MENU_AMPLITUDE_SET_SCREEN:
-					lv_obj_del(trial_text_label);
-					lv_obj_set_hidden(trial_text_label, true);
-					lv_tabview_clean(tab0);
-					break;
-				case MENU_WAVEFORM_SET_SCREEN:
-					MENU_CONFIG.waveform = lv_roller_get_selected(roller_waveform);
-					printf("Delete old WAVEFORM stuff %d\n",MENU_CONFIG.waveform);
-					lv_group_del(roller_input_group);
-					lv_obj_set_hidden(roller_waveform, true);
-					// lv_obj_del(roller_waveform);
-					// roller_waveform=NULL;
-					lv_tabview_clean(tab0);
-					break;
-				case MENU_LOGIC_SET_SCREEN:
-					lv_obj_del(trial_text_label);
-					lv_obj_set_hidden(trial_text_label, true);
-					lv_tabview_clean(tab0);
-					break;
-				case MENU_STATS_SET_SCREEN:
-					printf("Delete old STATS stuff\n");
-					lv_obj_del(frequency_status_label);
-					lv_obj_del(amplitude_status_label);
-
-					lv_tabview_clean(tab1);
-					lv_tabview_set_tab_act(tabview, 0, LV_ANIM_ON);
-					break;
-			}
-			switch (Next_Screen){					//Draw New Objects
-
-				case MENU_SCREEN:
-					printf("MENU_SCREEN\n");
-					lv_tabview_set_tab_act(tabview, 0, LV_ANIM_ON);
-					menulist = lv_list_create(tab0, NULL);
-					lv_obj_set_size(menulist, 128, 50);
-					lv_obj_align(menulist, NULL,  LV_ALIGN_IN_TOP_LEFT, 0, 0);
-					lv_list_set_anim_time(menulist, 60);
-					lv_list_set_sb_mode(menulist, LV_SB_MODE_OFF); 	// LIST Disable Scroll Bar
-					lv_list_set_single_mode(menulist, true);
-
-					style4.body.border.width =0;
-					style4.body.padding.left = -1;
-					style4.body.padding.right = -1;
-					// style4.body.padding.top = 0;
-					lv_list_set_style(menulist, LV_LIST_STYLE_BG, &style4);
-
-					style5.body.padding.inner = -3;
-					style5.body.border.width = 0;
-					// style5.body.padding.top = -5;
-					lv_list_set_style(menulist, LV_LIST_STYLE_SCRL, &style5);
-
-					// To adjust the height of an individual list button,
-					// dimensions of the container need to be changed.
-					style6.body.padding.top = 6;
-					style6.body.padding.bottom = 5;
-					style6.body.radius = 0;
-
-					// Long Strings cause glitchy scroll, in the button label.
-					list_btn[0] = lv_list_add_btn(menulist, NULL, "1.Frequency");
-					lv_obj_set_event_cb(list_btn[0], select_frequency);
-					lv_btn_set_style(list_btn[0],LV_CONT_STYLE_MAIN, &style6);
-					// lv_list_set_btn_selected(menulist, list_btn[0]);
-
-					list_btn[1] = lv_list_add_btn(menulist, NULL, "2.Amplitude");
-					lv_obj_set_event_cb(list_btn[1], select_amplitude);
-					lv_btn_set_style(list_btn[1],LV_CONT_STYLE_MAIN, &style6);
-
-					list_btn[2] = lv_list_add_btn(menulist, NULL, "3.Waveform");
-					lv_obj_set_event_cb(list_btn[2], select_waveform);
-					lv_btn_set_style(list_btn[2],LV_CONT_STYLE_MAIN, &style6);
-					// lv_list_set_btn_selected(menulist, list_btn[2]);
-
-					list_btn[3] = lv_list_add_btn(menulist, NULL, "4.Logic In");
-					lv_obj_set_event_cb(list_btn[3], select_logic);
-					lv_btn_set_style(list_btn[3],LV_CONT_STYLE_MAIN, &style6);
-
-					list_btn[4] = lv_list_add_btn(menulist, NULL, "5.Stats");
-					lv_obj_set_event_cb(list_btn[4], select_stats);
-					lv_btn_set_style(list_btn[4],LV_CONT_STYLE_MAIN, &style6);
-
-					menulist_input_group = lv_group_create();
-					lv_group_add_obj(menulist_input_group, menulist);
-					lv_indev_set_group(keypad_UD_Button, menulist_input_group);
-					lv_indev_set_group(keypad_ENTER_Button, menulist_input_group);
-					lv_list_set_btn_selected(menulist, list_btn[Current_Screen]);
-
-					Change_Screen = 0;
-					Current_Screen = Next_Screen;
-					break;
-				case MENU_FREQUENCY_SET_SCREEN:
-					printf("SET_FREQUENCY\n");
-					lv_tabview_set_tab_act(tabview, 0, LV_ANIM_ON);
-					spinbox_frequency = lv_spinbox_create(lv_scr_act(), NULL);
-					lv_spinbox_set_digit_format(spinbox_frequency, 9, 0);
-					lv_spinbox_step_prev(spinbox_frequency);
-					lv_obj_set_width(spinbox_frequency, 110);
-					lv_spinbox_set_range(spinbox_frequency, 1, 268435456);
-					lv_obj_set_event_cb(spinbox_frequency, spinbox_frequency_cb);
-					lv_spinbox_set_value(spinbox_frequency, MENU_CONFIG.frequency);
-					spinbox_text_style = lv_spinbox_get_style(spinbox_frequency, LV_LABEL_STYLE_MAIN);
-					spinbox_text_style->text.letter_space = 4;
-					lv_spinbox_set_style(spinbox_frequency, LV_LABEL_STYLE_MAIN, spinbox_text_style);
-
-					spinbox_text_style = lv_spinbox_get_style(spinbox_frequency, LV_SPINBOX_STYLE_BG);
-					spinbox_text_style->body.padding.top = 7;
-					spinbox_text_style->body.padding.bottom = 2;
-					spinbox_text_style->body.border.width = 1;
-					lv_spinbox_set_style(spinbox_frequency, LV_SPINBOX_STYLE_BG, spinbox_text_style);
-
-					spinbox_cursor_style = lv_spinbox_get_style(spinbox_frequency, LV_SPINBOX_STYLE_CURSOR);
-					// spinbox_cursor_style->line.width = 1;
-					spinbox_cursor_style->body.radius = 2;
-					// spinbox_cursor_style.body.padding.inner  = 3;
-					spinbox_cursor_style->body.padding.right = 1;
-					spinbox_cursor_style->body.padding.left  = 2;
-					spinbox_cursor_style->body.padding.top = 5;
-					spinbox_cursor_style->body.padding.bottom = 3;
-					lv_spinbox_set_style(spinbox_frequency,LV_SPINBOX_STYLE_CURSOR, spinbox_cursor_style);
-
-					lv_ta_set_cursor_type(spinbox_frequency, LV_CURSOR_BLOCK);
-					lv_spinbox_set_padding_left(spinbox_frequency, 1);
-					lv_ta_set_cursor_blink_time(spinbox_frequency, 0);
-
-					trial_text_label = lv_label_create(tab0, NULL);
-					lv_label_set_text(trial_text_label, "Set Frequency:");
-
-					lv_obj_align(spinbox_frequency, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -8);
-
-					spinbox_text_style = lv_label_get_style(trial_text_label, LV_LABEL_STYLE_MAIN);
-					spinbox_text_style->body.opa = LV_OPA_TRANSP;
-					spinbox_text_style->text.letter_space = -1;
-					lv_label_set_style(trial_text_label, LV_LABEL_STYLE_MAIN, spinbox_text_style);
-
-					spinbox_input_group = lv_group_create();
-					lv_group_add_obj(spinbox_input_group, spinbox_frequency);
-					lv_indev_set_group(keypad_UD_Button, spinbox_input_group);
-					lv_indev_set_group(keypad_ENTER_Button, spinbox_input_group);
-					lv_indev_set_group(keypad_LR_Button, spinbox_input_group);
-					lv_indev_enable(keypad_LR_Button, true);
-					Change_Screen = 0;
-					Current_Screen = Next_Screen;
-					break;
-				case MENU_AMPLITUDE_SET_SCREEN:
-					printf("SET_AMPLITUDE\n");
-					lv_tabview_set_tab_act(tabview, 0, LV_ANIM_ON);
-					trial_text_label = lv_label_create(tab0, NULL);
-					lv_label_set_text(trial_text_label, "SET_AMPLITUDE");
-					Change_Screen = 0;
-					Current_Screen = Next_Screen;
-					break;
-				case MENU_WAVEFORM_SET_SCREEN:
-					printf("SET_WAVEFORM\n");
-					lv_tabview_set_tab_act(tabview, 0, LV_ANIM_ON);
-					roller_waveform = lv_roller_create(lv_scr_act(), NULL);
-				    lv_roller_set_options(roller_waveform,
-				                        "Sinosoid\n"
-				                        "Triangular\n"
-				                        "Square",
-				                        LV_ROLLER_MODE_NORMAL);
-
-				    lv_roller_set_visible_row_count(roller_waveform, 2);
-				    lv_obj_align(roller_waveform, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -4);
-					lv_roller_set_selected(roller_waveform, MENU_CONFIG.waveform, LV_ANIM_ON);
-				    lv_obj_set_event_cb(roller_waveform, roller_waveform_cb);
-
-					trial_text_label = lv_label_create(tab0, NULL);
-					lv_label_set_text(trial_text_label, "SET WAVEFORM");
-
-					roller_text_style = lv_label_get_style(trial_text_label, LV_LABEL_STYLE_MAIN);
-					roller_text_style->body.opa = LV_OPA_TRANSP;
-					roller_text_style->text.letter_space = -1;
-					lv_label_set_style(trial_text_label, LV_LABEL_STYLE_MAIN, roller_text_style);
-
-					roller_input_group = lv_group_create();
-					lv_group_add_obj(roller_input_group, roller_waveform);
-					lv_indev_set_group(keypad_UD_Button, roller_input_group);
-					lv_indev_set_group(keypad_ENTER_Button, roller_input_group);
-
-
-					Change_Screen = 0;
-					Current_Screen = Next_Screen;
-					break;
-				case MENU_LOGIC_SET_SCREEN:
-					printf("SET_LOGIC_IN\n");
-					lv_tabview_set_tab_act(tabview, 0, LV_ANIM_ON);
-					trial_text_label = lv_label_create(tab0, NULL);
-					lv_label_set_text(trial_text_label, "SET_LOGIC_IN");
-					Change_Screen = 0;
-					Current_Screen = Next_Screen;
-					break;
-				case MENU_STATS_SET_SCREEN:
-					lv_tabview_set_tab_act(tabview, 1, LV_ANIM_ON);
-					printf("OPEN_STATS\n");
-					lv_page_set_style(tab1, LV_PAGE_STYLE_SB, &style7);		// PAGE Scroll bar hidden
-
-					frequency_status_label = lv_label_create(tab1, NULL);
-					frequency_status_value = lv_label_create(tab1, NULL);
-
-					amplitude_status_label = lv_label_create(tab1, NULL);
-					amplitude_status_value = lv_label_create(tab1, NULL);
-
-					waveform_status_label = lv_label_create(tab1, NULL);
-					waveform_status_value = lv_label_create(tab1, NULL);
-
-					lv_label_set_text(frequency_status_label, "FREQ");
-					lv_obj_align(frequency_status_label, NULL, LV_ALIGN_IN_TOP_LEFT, 4-1, 0+8);
-					itoa(MENU_CONFIG.frequency, freq, 10);
-					strcat(freq,"Hz");
-					lv_label_set_text(frequency_status_value, freq);
-					lv_obj_align(frequency_status_value, NULL, LV_ALIGN_IN_TOP_LEFT, 48, 8);
-
-					lv_label_set_text(amplitude_status_label, "AMPL");
-					lv_obj_align(amplitude_status_label, NULL, LV_ALIGN_IN_TOP_LEFT, 4, 12+8);
-					itoa(MENU_CONFIG.amplitude, freq, 10);
-					strcat(freq,"V");
-					lv_label_set_text(amplitude_status_value, freq);
-					lv_obj_align(amplitude_status_value, NULL, LV_ALIGN_IN_TOP_LEFT, 48,12+8);
-
-					lv_label_set_text(waveform_status_label, "WAVE");
-					lv_obj_align(waveform_status_label, NULL, LV_ALIGN_IN_TOP_LEFT, 4+1, 24+8);
-					lv_label_set_text(waveform_status_value, waveform_name[MENU_CONFIG.waveform]);
-					lv_obj_align(waveform_status_value, NULL, LV_ALIGN_IN_TOP_LEFT, 48,24+8);
-
-					Change_Screen = 0;
-					Current_Screen = Next_Screen;
-					break;
-			}
-		}
+		//Sleep until the next lv_task is due, the keypad, lv_async_call or an invalidation wake it earlier
+		ulTaskNotifyTake(pdTRUE, gui_sleep_ticks(sleep_ms));
     }
 
     //A task should NEVER return
     vTaskDelete(NULL);
 }
 
-static void select_frequency(lv_obj_t * obj, lv_event_t event){
+//The buttons are in the order of the screens
+static void menu_select_cb(lv_obj_t * obj, lv_event_t event){
     if(event == LV_EVENT_PRESSED) {
-
         printf("Clicked: %s\n", lv_list_get_btn_text(obj));
-		Next_Screen = MENU_FREQUENCY_SET_SCREEN;
 		lv_list_focus(obj, LV_ANIM_ON);
-		Change_Screen = 1;
-		// lv_list_set_btn_selected(menulist, obj);
+		screen_post(&screen_mgr, &screens[lv_list_get_btn_index(menulist, obj)]);
     }
-	// else printf("NO select_frequency %d\n", event);
 }
-static void select_amplitude(lv_obj_t * obj, lv_event_t event){
-    if(event == LV_EVENT_PRESSED) {
 
-        printf("Clicked: %s\n", lv_list_get_btn_text(obj));
-		Next_Screen = MENU_AMPLITUDE_SET_SCREEN;
-		lv_list_focus(obj, LV_ANIM_ON);
-		Change_Screen = 1;
-    }
-	// else printf("NO select_amplitude %d\n", event);
-}
-static void select_waveform(lv_obj_t * obj, lv_event_t event){
-    if(event == LV_EVENT_PRESSED) {
+//Reports the next key event of a keypad. The events are queued by the key interrupt,
+//when there are several the read is repeated right away so no press is lost.
+static bool keypad_indev_read(keypad_t *kp, lv_indev_drv_t *drv, lv_indev_data_t *data) {
+	keypad_event_t ev;
+	bool more = keypad_read(kp, &ev);
 
-        printf("Clicked: %s\n", lv_list_get_btn_text(obj));
-		Next_Screen = MENU_WAVEFORM_SET_SCREEN;
-		lv_list_focus(obj, LV_ANIM_ON);
-		Change_Screen = 1;
-    }
-	// else printf("NO select_waveform %d\n", event);
-}
-static void select_logic(lv_obj_t * obj, lv_event_t event){
-    if(event == LV_EVENT_PRESSED) {
+	data->key = ev.key;
+	data->state = ev.pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
 
-        printf("Clicked: %s\n", lv_list_get_btn_text(obj));
-		Next_Screen = MENU_LOGIC_SET_SCREEN;
-		lv_list_focus(obj, LV_ANIM_ON);
-		Change_Screen = 1;
-    }
-	// else printf("NO select_logic %d\n", event);
-}
-static void select_stats(lv_obj_t * obj, lv_event_t event){
-    if(event == LV_EVENT_PRESSED) {
+	//Nothing left to report: stop polling until the next key interrupt, see keypad_resume_reads
+	if (!more && keypad_is_idle(kp)) lv_task_pause(drv->read_task);
 
-        printf("Clicked: %s\n", lv_list_get_btn_text(obj));
-		Next_Screen = MENU_STATS_SET_SCREEN;
-		lv_list_focus(obj, LV_ANIM_ON);
-		Change_Screen = 1;
-    }
-	// else printf("NO select_logic %d\n", event);
+	return more;
 }
 
 static bool keypad_UP_DOWN_cb(lv_indev_drv_t * drv, lv_indev_data_t*data){
-
-	static uint8_t last_key = 0;
-	// printf("%d\n",gpio_get_level(GPIO_NUM_21));
-	if(gpio_get_level(GPIO_NUM_22)) { // Select UP
-		data->state = LV_BTN_STATE_PR;
-		// printf("button_read 1\n");
-		last_key = LV_KEY_UP;
-	}else if(gpio_get_level(GPIO_NUM_23)) { // Select DOWN
-		data->state = LV_BTN_STATE_PR;
-		// printf("button_read 1\n");
-		last_key = LV_KEY_DOWN;
-	}else data->state = LV_BTN_STATE_REL;
-
-	data->key = last_key;            /*Get the last pressed or released key*/
-
-	return false; /*No buffering now so no more data read*/
+	return keypad_indev_read(&keypad_UD, drv, data);
 }
 static bool keypad_Back_cb(lv_indev_drv_t * drv, lv_indev_data_t*data){
-	static uint8_t last_key = 0;
-	// printf("%d\n",gpio_get_level(GPIO_NUM_21));
-	if(gpio_get_level(GPIO_NUM_19) && Current_Screen != MENU_SCREEN) { // Select DOWN
-		data->state = LV_BTN_STATE_PR;
-		printf("Change to MENU\n");
-		last_key = LV_KEY_HOME;
-		Next_Screen = MENU_SCREEN;
-		Change_Screen = 1;
-	}else data->state = LV_BTN_STATE_REL;
+	bool more = keypad_indev_read(&keypad_BK, drv, data);
 
-	data->key = last_key;            /*Get the last pressed or released key*/
+	//No group takes it: it only leads back from the screen shown
+	if(data->state == LV_INDEV_STATE_PR) screen_post_back(&screen_mgr);
 
-	return false; /*No buffering now so no more data read*/
+	return more;
 }
 static bool keypad_ENTER_cb(lv_indev_drv_t * drv, lv_indev_data_t*data){
-	static uint8_t last_key = 0;
-	// printf("%d\n",gpio_get_level(GPIO_NUM_21));
-	if(gpio_get_level(GPIO_NUM_21)) {
-		data->state = LV_BTN_STATE_PR;
-		// printf("button_read 1\n");
-		last_key = LV_KEY_ENTER;
-	}
-	else data->state = LV_BTN_STATE_REL;
-	data->key = last_key;            /*Get the last pressed or released key*/
-	return false; /*No buffering now so no more data read*/
+	return keypad_indev_read(&keypad_EN, drv, data);
 }
 static bool keypad_LEFT_RIGHT_cb(lv_indev_drv_t * drv, lv_indev_data_t*data){
-	static uint8_t last_key = 0;
-	// printf("%d\n",gpio_get_level(GPIO_NUM_21));
-	if(gpio_get_level(GPIO_NUM_17)) { 		// Select Left
-		data->state = LV_BTN_STATE_PR;
-		// printf("button_read 1\n");
-		last_key = LV_KEY_LEFT;
-	}else if(gpio_get_level(GPIO_NUM_16)) { // Select Right
-		data->state = LV_BTN_STATE_PR;
-		// printf("button_read 1\n");
-		last_key = LV_KEY_RIGHT;
-	}else data->state = LV_BTN_STATE_REL;
-
-	data->key = last_key;            /*Ge-> the last pressed or released key*/
-
-	return false; /*No buffering now so no more data read*/
+	return keypad_indev_read(&keypad_LR, drv, data);
 }
 static void spinbox_frequency_cb(lv_obj_t * obj, lv_event_t event)
 {
     if(event == LV_EVENT_VALUE_CHANGED) {
         printf("Value: %d\n", lv_spinbox_get_value(obj));
+        MENU_CONFIG.frequency = lv_spinbox_get_value(obj);
+        audio_params_publish();
     }
     else if(event == LV_EVENT_CLICKED) {
         /*For simple test: Click the spinbox to increment its value*/
         lv_spinbox_increment(obj);
     }
 }
+//The rows of the sweep screen: a change goes to the audio task at once, ENTER moves to the next row
+static void roller_sweep_cb(lv_obj_t * obj, lv_event_t event){
+	if(event == LV_EVENT_VALUE_CHANGED) {
+		MENU_CONFIG.sweep = lv_roller_get_selected(obj);
+		audio_params_publish();
+	}
+	else if(event == LV_EVENT_CLICKED) lv_group_focus_next(lv_obj_get_group(obj));
+}
+static void spinbox_sweep_stop_cb(lv_obj_t * obj, lv_event_t event){
+	if(event == LV_EVENT_VALUE_CHANGED) {
+		MENU_CONFIG.sweep_stop = lv_spinbox_get_value(obj);
+		audio_params_publish();
+	}
+	else if(event == LV_EVENT_CLICKED) lv_group_focus_next(lv_obj_get_group(obj));
+}
+static void spinbox_sweep_time_cb(lv_obj_t * obj, lv_event_t event){
+	if(event == LV_EVENT_VALUE_CHANGED) {
+		MENU_CONFIG.sweep_ms = lv_spinbox_get_value(obj);
+		audio_params_publish();
+	}
+	else if(event == LV_EVENT_CLICKED) lv_group_focus_next(lv_obj_get_group(obj));
+}
+static void roller_logic_trigger_cb(lv_obj_t * obj, lv_event_t event){
+	if(event == LV_EVENT_VALUE_CHANGED) {
+		MENU_CONFIG.logic_trigger = lv_roller_get_selected(obj);
+		logic_rearm = true;		//The capture in progress is dropped
+		logic_refresh(&screens[MENU_LOGIC_SET_SCREEN]);
+	}
+}
 static void roller_waveform_cb(lv_obj_t * obj, lv_event_t event){
 	if(event == LV_EVENT_VALUE_CHANGED) {
         char buf[32];
         lv_roller_get_selected_str(obj, buf, sizeof(buf));
         printf("Selected waveform: %s\n", buf);
+        MENU_CONFIG.waveform = lv_roller_get_selected(obj);
+        audio_params_publish();
     }
 }
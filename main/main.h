@@ -9,33 +9,108 @@
 #include "freertos/semphr.h"
 #include "esp_system.h"
 #include "driver/gpio.h"
+#include "keypad.h"
+#include "dds.h"
+#include "dds_level.h"
+#include "dds_params.h"
+#include "dds_meas.h"
+#include "audio_out.h"
+#include "awg.h"
+#include "logic.h"
+#include "screen.h"
+#include "fs_stdio.h"
+#include "esp_spiffs.h"
+#if CONFIG_WAVEMAN_ENCODER
+#include "encoder_indev.h"
+#endif
 
 /* Littlevgl specific */
 #include "lvgl/lvgl.h"
 #include "lvgl_driver.h"
 
+#define STATS_TEXT_LEN    12
+
+//The values of the Stats screen
+enum {STATS_FREQUENCY, STATS_PERIOD, STATS_DUTY, STATS_UNDERRUNS, STATS_CPU, STATS_VALUE_CNT};
+
+//A value shown by a label, with the text it shows
+typedef struct {
+	lv_obj_t *label;
+	char text[STATS_TEXT_LEN];
+} stats_value_t;
+
 //STATIC PROTOTYPES
-static void IRAM_ATTR lv_tick_task(void *arg);
+static void IRAM_ATTR gui_wake_cb(void);
+static TickType_t gui_sleep_ticks(uint32_t sleep_ms);
+static void audio_render_cb(void *arg, int16_t *buf, size_t n);
+static void audio_params_get(dds_params_t *params);
+static void audio_params_publish(void);
+static void keypad_event_cb(keypad_t *kp);
+static void keypad_resume_reads(void);
+static void storage_init(void);
+static const char *waveform_get_name(uint8_t waveform);
+static void preview_create(lv_obj_t *parent);
+static void preview_update(const dds_params_t *params);
+static bool preview_design(lv_obj_t *chart, const lv_area_t *mask, lv_design_mode_t mode);
+static void logic_capture_get(logic_capture_t *cap);
+static void logic_refresh(screen_t *scr);
+static bool logic_draw(void);
+static void cpu_tick_hook(void);
+static void cpu_load_get(uint8_t *load);
+static void stats_create(lv_obj_t *parent);
+static void stats_refresh(screen_t *scr);
+static void stats_value_set(stats_value_t *value, const char *text);
+static void stats_format_milli(char *buf, size_t len, uint32_t milli, const char *unit);
+static void menu_build(screen_t *scr);
+static void menu_show(screen_t *scr);
+static void frequency_build(screen_t *scr);
+static void frequency_show(screen_t *scr);
+static void frequency_hide(screen_t *scr);
+static void amplitude_build(screen_t *scr);
+static void waveform_build(screen_t *scr);
+static void waveform_show(screen_t *scr);
+static void waveform_hide(screen_t *scr);
+static void logic_build(screen_t *scr);
+static void logic_show(screen_t *scr);
+static void logic_hide(screen_t *scr);
+static void sweep_build(screen_t *scr);
+static void sweep_show(screen_t *scr);
+static void stats_build(screen_t *scr);
+static void stats_show(screen_t *scr);
+static bool keypad_indev_read(keypad_t *kp, lv_indev_drv_t *drv, lv_indev_data_t *data);
 
 //Function prototypes
 void guiTask();
+#if LV_USE_REFR_PROF
+static void profTask(void *arg);
+static void prof_print_cb(const char * line);
+#endif
+#if LV_USE_MEM_TRACE
+static void mem_trace_check(void);
+static void mem_trace_write_cb(const void * data, uint32_t size);
+#endif
 static bool keypad_UP_DOWN_cb(lv_indev_drv_t * drv, lv_indev_data_t*data);
 static bool keypad_Back_cb(lv_indev_drv_t * drv, lv_indev_data_t*data);
 static bool keypad_ENTER_cb(lv_indev_drv_t * drv, lv_indev_data_t*data);
 static bool keypad_LEFT_RIGHT_cb(lv_indev_drv_t * drv, lv_indev_data_t*data);
 
-static void select_frequency(lv_obj_t * obj, lv_event_t event);
-static void select_amplitude(lv_obj_t * obj, lv_event_t event);
-static void select_waveform(lv_obj_t * obj, lv_event_t event);
-static void select_logic(lv_obj_t * obj, lv_event_t event);
-static void select_stats(lv_obj_t * obj, lv_event_t event);
+static void menu_select_cb(lv_obj_t * obj, lv_event_t event);
 
 static void spinbox_frequency_cb(lv_obj_t * obj, lv_event_t event);
 static void roller_waveform_cb(lv_obj_t * obj, lv_event_t event);
+static void roller_logic_trigger_cb(lv_obj_t * obj, lv_event_t event);
+static void roller_sweep_cb(lv_obj_t * obj, lv_event_t event);
+static void spinbox_sweep_stop_cb(lv_obj_t * obj, lv_event_t event);
+static void spinbox_sweep_time_cb(lv_obj_t * obj, lv_event_t event);
 
 struct MENU_DATA {
 	uint32_t frequency;
 	uint8_t  amplitude;
 	uint8_t  waveform;
 	uint8_t  gain;
+	int16_t  offset;	//mV
+	uint8_t  sweep;		//dds_sweep_mode_t, from frequency to sweep_stop
+	uint32_t sweep_stop;	//Hz
+	uint32_t sweep_ms;
+	uint8_t  logic_trigger;	//Index of the Logic In trigger roller
 };
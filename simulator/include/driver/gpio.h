@@ -0,0 +1,122 @@
+/**
+ * @file gpio.h
+ * Host simulator stand-in for the ESP-IDF GPIO driver.
+ * The input levels are played back from the keypad script (see sim_gpio.c).
+ */
+
+#ifndef _DRIVER_GPIO_H_
+#define _DRIVER_GPIO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include "esp_err.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define GPIO_PIN_COUNT      40
+
+#define GPIO_SEL_0          (BIT(0))
+#define GPIO_SEL_2          (BIT(2))
+#define GPIO_SEL_4          (BIT(4))
+#define GPIO_SEL_5          (BIT(5))
+#define GPIO_SEL_12         (BIT(12))
+#define GPIO_SEL_13         (BIT(13))
+#define GPIO_SEL_14         (BIT(14))
+#define GPIO_SEL_15         (BIT(15))
+#define GPIO_SEL_16         (BIT(16))
+#define GPIO_SEL_17         (BIT(17))
+#define GPIO_SEL_18         (BIT(18))
+#define GPIO_SEL_19         (BIT(19))
+#define GPIO_SEL_21         (BIT(21))
+#define GPIO_SEL_22         (BIT(22))
+#define GPIO_SEL_23         (BIT(23))
+#define GPIO_SEL_25         (BIT(25))
+#define GPIO_SEL_26         (BIT(26))
+#define GPIO_SEL_27         (BIT(27))
+#define GPIO_SEL_32         ((uint64_t)1 << 32)
+#define GPIO_SEL_33         ((uint64_t)1 << 33)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0 = 0, GPIO_NUM_1, GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4, GPIO_NUM_5,
+    GPIO_NUM_6, GPIO_NUM_7, GPIO_NUM_8, GPIO_NUM_9, GPIO_NUM_10, GPIO_NUM_11,
+    GPIO_NUM_12, GPIO_NUM_13, GPIO_NUM_14, GPIO_NUM_15, GPIO_NUM_16, GPIO_NUM_17,
+    GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_20, GPIO_NUM_21, GPIO_NUM_22, GPIO_NUM_23,
+    GPIO_NUM_25 = 25, GPIO_NUM_26, GPIO_NUM_27,
+    GPIO_NUM_32 = 32, GPIO_NUM_33, GPIO_NUM_34, GPIO_NUM_35, GPIO_NUM_36,
+    GPIO_NUM_37, GPIO_NUM_38, GPIO_NUM_39,
+    GPIO_NUM_MAX = GPIO_PIN_COUNT,
+} gpio_num_t;
+
+typedef enum {
+    GPIO_MODE_DISABLE = 0,
+    GPIO_MODE_INPUT = 1,
+    GPIO_MODE_OUTPUT = 2,
+    GPIO_MODE_INPUT_OUTPUT = 3,
+} gpio_mode_t;
+
+typedef enum {
+    GPIO_PULLUP_DISABLE = 0,
+    GPIO_PULLUP_ENABLE = 1,
+} gpio_pullup_t;
+
+typedef enum {
+    GPIO_PULLDOWN_DISABLE = 0,
+    GPIO_PULLDOWN_ENABLE = 1,
+} gpio_pulldown_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE = 1,
+    GPIO_INTR_NEGEDGE = 2,
+    GPIO_INTR_ANYEDGE = 3,
+    GPIO_INTR_LOW_LEVEL = 4,
+    GPIO_INTR_HIGH_LEVEL = 5,
+} gpio_int_type_t;
+
+#define GPIO_PIN_INTR_DISABLE   GPIO_INTR_DISABLE
+#define GPIO_PIN_INTR_POSEDGE   GPIO_INTR_POSEDGE
+#define GPIO_PIN_INTR_NEGEDGE   GPIO_INTR_NEGEDGE
+#define GPIO_PIN_INTR_ANYEDGE   GPIO_INTR_ANYEDGE
+
+typedef void (*gpio_isr_t)(void * arg);
+
+typedef struct {
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    gpio_pullup_t pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+esp_err_t gpio_config(const gpio_config_t * config);
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode);
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+int gpio_get_level(gpio_num_t gpio_num);
+esp_err_t gpio_pad_select_gpio(uint8_t gpio_num);
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type);
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num);
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num);
+esp_err_t gpio_install_isr_service(int intr_alloc_flags);
+void gpio_uninstall_isr_service(void);
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void * args);
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*_DRIVER_GPIO_H_*/
@@ -0,0 +1,82 @@
+/**
+ * @file i2c.h
+ * Host simulator stand-in for the ESP-IDF I2C master driver.
+ * The command links are decoded by the simulated SSD1306 panel (see sim_i2c.c).
+ */
+
+#ifndef _DRIVER_I2C_H_
+#define _DRIVER_I2C_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define I2C_MASTER_WRITE    0
+#define I2C_MASTER_READ     1
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    I2C_NUM_0 = 0,
+    I2C_NUM_1,
+    I2C_NUM_MAX,
+} i2c_port_t;
+
+typedef enum {
+    I2C_MODE_SLAVE = 0,
+    I2C_MODE_MASTER,
+    I2C_MODE_MAX,
+} i2c_mode_t;
+
+typedef struct {
+    i2c_mode_t mode;
+    int sda_io_num;
+    gpio_pullup_t sda_pullup_en;
+    int scl_io_num;
+    gpio_pullup_t scl_pullup_en;
+    union {
+        struct {
+            uint32_t clk_speed;
+        } master;
+        struct {
+            uint8_t addr_10bit_en;
+            uint16_t slave_addr;
+        } slave;
+    };
+} i2c_config_t;
+
+typedef struct sim_i2c_cmd * i2c_cmd_handle_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t * i2c_conf);
+esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t mode, size_t slv_rx_buf_len,
+                             size_t slv_tx_buf_len, int intr_alloc_flags);
+i2c_cmd_handle_t i2c_cmd_link_create(void);
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle);
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en);
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, uint8_t * data, size_t data_len, bool ack_en);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle);
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t ticks_to_wait);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*_DRIVER_I2C_H_*/
@@ -0,0 +1,13 @@
+/**
+ * @file esp_attr.h
+ * Host simulator stand-in: the memory placement attributes have no meaning off-target.
+ */
+
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+
+#endif /*ESP_ATTR_H*/
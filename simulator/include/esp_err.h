@@ -0,0 +1,55 @@
+/**
+ * @file esp_err.h
+ * Host simulator stand-in for the ESP-IDF error codes.
+ */
+
+#ifndef ESP_ERR_H
+#define ESP_ERR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define ESP_OK                  0
+#define ESP_FAIL                -1
+#define ESP_ERR_NO_MEM          0x101
+#define ESP_ERR_INVALID_ARG     0x102
+#define ESP_ERR_INVALID_STATE   0x103
+#define ESP_ERR_INVALID_SIZE    0x104
+#define ESP_ERR_NOT_FOUND       0x105
+#define ESP_ERR_TIMEOUT         0x107
+
+#define BIT(nr)                 (1UL << (nr))
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef int esp_err_t;
+
+/**********************
+ *      MACROS
+ **********************/
+#define ESP_ERROR_CHECK(x) do {                                             \
+        esp_err_t __err_rc = (x);                                           \
+        if (__err_rc != ESP_OK) {                                           \
+            fprintf(stderr, "ESP_ERROR_CHECK failed: 0x%x at %s:%d\n",      \
+                    __err_rc, __FILE__, __LINE__);                          \
+            abort();                                                        \
+        }                                                                   \
+    } while(0)
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*ESP_ERR_H*/
@@ -0,0 +1,17 @@
+/**
+ * @file esp_freertos_hooks.h
+ * Host simulator stand-in: the tick hooks run on every tick the simulated
+ * clock passes, the idle hooks are not simulated.
+ */
+
+#ifndef ESP_FREERTOS_HOOKS_H
+#define ESP_FREERTOS_HOOKS_H
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef void (*esp_freertos_tick_cb_t)(void);
+
+esp_err_t esp_register_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t new_tick_cb, UBaseType_t cpuid);
+
+#endif /*ESP_FREERTOS_HOOKS_H*/
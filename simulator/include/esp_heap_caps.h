@@ -0,0 +1,39 @@
+/**
+ * @file esp_heap_caps.h
+ * Host simulator stand-in for esp_heap_caps.h
+ */
+
+#ifndef ESP_HEAP_CAPS_H
+#define ESP_HEAP_CAPS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stddef.h>
+#include <stdint.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define MALLOC_CAP_EXEC         (1 << 0)
+#define MALLOC_CAP_32BIT        (1 << 1)
+#define MALLOC_CAP_8BIT         (1 << 2)
+#define MALLOC_CAP_DMA          (1 << 3)
+#define MALLOC_CAP_INTERNAL     (1 << 11)
+#define MALLOC_CAP_DEFAULT      (1 << 12)
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+void * heap_caps_malloc(size_t size, uint32_t caps);
+void heap_caps_free(void * ptr);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*ESP_HEAP_CAPS_H*/
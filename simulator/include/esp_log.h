@@ -0,0 +1,18 @@
+/**
+ * @file esp_log.h
+ * Host simulator stand-in for the ESP-IDF logging macros. Everything goes to stderr
+ * so stdout only carries the output of the application and the simulator statistics.
+ */
+
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) fprintf(stderr, "I (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) do { (void)(tag); } while(0)
+#define ESP_LOGV(tag, fmt, ...) do { (void)(tag); } while(0)
+
+#endif /*ESP_LOG_H*/
@@ -0,0 +1,40 @@
+/**
+ * @file esp_spiffs.h
+ * Host simulator stand-in for esp_spiffs.h. There is no partition to mount:
+ * CONFIG_WAVEMAN_STORAGE_PATH is a host directory, see SIM_STORAGE_DIR.
+ */
+
+#ifndef ESP_SPIFFS_H
+#define ESP_SPIFFS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    const char * base_path;
+    const char * partition_label;
+    size_t max_files;
+    bool format_if_mount_failed;
+} esp_vfs_spiffs_conf_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t * conf);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*ESP_SPIFFS_H*/
@@ -0,0 +1,34 @@
+/**
+ * @file esp_system.h
+ * Host simulator stand-in for esp_system.h
+ */
+
+#ifndef ESP_SYSTEM_H
+#define ESP_SYSTEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+uint32_t esp_get_free_heap_size(void);
+
+/* newlib provides itoa(), glibc doesn't */
+char * itoa(int value, char * str, int base);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*ESP_SYSTEM_H*/
@@ -0,0 +1,53 @@
+/**
+ * @file esp_timer.h
+ * Host simulator stand-in for esp_timer. The timers run on the simulated clock
+ * (see sim_rtos.c), their callbacks are called between two task switches.
+ */
+
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef void (*esp_timer_cb_t)(void * arg);
+
+typedef enum {
+    ESP_TIMER_TASK,
+} esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void * arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char * name;
+} esp_timer_create_args_t;
+
+typedef struct sim_timer * esp_timer_handle_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+esp_err_t esp_timer_create(const esp_timer_create_args_t * create_args, esp_timer_handle_t * out_handle);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*ESP_TIMER_H*/
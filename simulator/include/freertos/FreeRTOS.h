@@ -0,0 +1,67 @@
+/**
+ * @file FreeRTOS.h
+ * Host simulator stand-in for FreeRTOS. The tasks run cooperatively on a
+ * simulated clock, see sim_rtos.c.
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <assert.h>                 /*Pulled in by the FreeRTOSConfig.h of esp-idf*/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_attr.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define pdFALSE                 0
+#define pdTRUE                  1
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+
+#define portMAX_DELAY           ((TickType_t) 0xffffffffUL)
+#define portTICK_PERIOD_MS      ((TickType_t) 1000 / CONFIG_FREERTOS_HZ)
+#define portTICK_RATE_MS        portTICK_PERIOD_MS
+#define pdMS_TO_TICKS(ms)       ((TickType_t) (((TickType_t) (ms) * CONFIG_FREERTOS_HZ) / 1000))
+
+#define tskNO_AFFINITY          0x7FFFFFFF
+#define portNUM_PROCESSORS      1           /*Every task runs on the host thread*/
+
+/* There is no preemption: critical sections are no-ops */
+#define portMUX_INITIALIZER_UNLOCKED    0
+#define portENTER_CRITICAL(mux)         do { (void)(mux); } while(0)
+#define portEXIT_CRITICAL(mux)          do { (void)(mux); } while(0)
+#define portENTER_CRITICAL_ISR(mux)     do { (void)(mux); } while(0)
+#define portEXIT_CRITICAL_ISR(mux)      do { (void)(mux); } while(0)
+#define portYIELD_FROM_ISR()            do { } while(0)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef int portMUX_TYPE;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+BaseType_t xPortInIsrContext(void);
+BaseType_t xPortGetCoreID(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*INC_FREERTOS_H*/
@@ -0,0 +1,40 @@
+/**
+ * @file queue.h
+ * Host simulator stand-in for the FreeRTOS queues.
+ */
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "FreeRTOS.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct sim_queue * QueueHandle_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void * item, TickType_t ticks_to_wait);
+BaseType_t xQueueSendToBackFromISR(QueueHandle_t queue, const void * item, BaseType_t * higher_prio_task_woken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void * buf, TickType_t ticks_to_wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+void vQueueDelete(QueueHandle_t queue);
+
+#define xQueueSend(queue, item, ticks)                  xQueueSendToBack(queue, item, ticks)
+#define xQueueSendFromISR(queue, item, woken)           xQueueSendToBackFromISR(queue, item, woken)
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*QUEUE_H*/
@@ -0,0 +1,40 @@
+/**
+ * @file semphr.h
+ * Host simulator stand-in for the FreeRTOS semaphores.
+ * The scheduler is cooperative, so a mutex taken by the running task can't be
+ * contended while it runs; only the counting behavior is kept.
+ */
+
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "FreeRTOS.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct sim_semaphore * SemaphoreHandle_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t * higher_prio_task_woken);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*SEMAPHORE_H*/
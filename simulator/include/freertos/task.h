@@ -0,0 +1,49 @@
+/**
+ * @file task.h
+ * Host simulator stand-in for the FreeRTOS task API.
+ */
+
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "FreeRTOS.h"
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct sim_task * TaskHandle_t;
+typedef void (*TaskFunction_t)(void * arg);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task_code, const char * name, uint32_t stack_depth,
+                                   void * arg, UBaseType_t priority, TaskHandle_t * created_task,
+                                   BaseType_t core_id);
+BaseType_t xTaskCreate(TaskFunction_t task_code, const char * name, uint32_t stack_depth,
+                       void * arg, UBaseType_t priority, TaskHandle_t * created_task);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TaskHandle_t xTaskGetCurrentTaskHandleForCPU(BaseType_t cpuid);
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t cpuid);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t * higher_prio_task_woken);
+
+#define taskYIELD()     vTaskDelay(0)
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*INC_TASK_H*/
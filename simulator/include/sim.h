@@ -0,0 +1,147 @@
+/**
+ * @file sim.h
+ * Internal interface of the host simulator: simulated clock, keypad script
+ * playback, the simulated SSD1306 panel, the SPI bus, the audio sink, the
+ * logic inputs and the trace of the LittlevGL heap.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SIM_OLED_COLUMNS    132     /*Size of the controller RAM, not of the visible area*/
+#define SIM_OLED_PAGES      8
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    const char * name;
+    uint64_t cpu_ns;            /*Host CPU time spent in the task*/
+    uint32_t switches;          /*Number of times the task was scheduled*/
+    bool deleted;
+} sim_task_info_t;
+
+typedef struct {
+    uint32_t frames;            /*Bursts of display data committed to the panel*/
+    uint32_t transactions;      /*I2C transactions addressed to the panel*/
+    uint32_t bytes;             /*Bytes on the bus, address bytes included*/
+    uint32_t data_bytes;        /*Bytes written to the display RAM*/
+    uint64_t bus_time_us;       /*Simulated time the bus was busy*/
+} sim_oled_stats_t;
+
+typedef void (*sim_i2c_tap_t)(const uint8_t * buf, size_t len);
+
+typedef struct {
+    uint32_t transactions;      /*Transactions queued*/
+    uint32_t bytes;             /*Bytes of the transactions queued*/
+    uint64_t busy_us;           /*Simulated time the bus was busy*/
+} sim_spi_stats_t;
+
+typedef struct {
+    uint32_t blocks;            /*Blocks played*/
+    uint32_t underruns;         /*Blocks of silence played because no block was ready*/
+    uint32_t latency_us;        /*Longest time from write() to the start of a block*/
+} sim_audio_stats_t;
+
+typedef struct {
+    uint32_t blocks;            /*Blocks handed to the capture task*/
+    uint32_t overruns;          /*Blocks lost because the task was late*/
+} sim_logic_stats_t;
+
+typedef enum {
+    SIM_LOGIC_IDLE = 0,         /*Still inputs*/
+    SIM_LOGIC_CLOCK,            /*CH0: a clock of 8 samples*/
+    SIM_LOGIC_COUNTER,          /*CH0..3: a 4-bit counter, a count every 8 samples*/
+    SIM_LOGIC_UART,             /*CH0: random bytes at 115200 baud*/
+    SIM_LOGIC_PWM,              /*CH0..3: PWM of about 1000 samples, its duty stepping*/
+    SIM_LOGIC_NOISE,            /*CH0..3: random at every sample*/
+    SIM_LOGIC_MIX,              /*A 1 kHz clock, 9600 baud UART, 2 kHz PWM and slow pulses*/
+    SIM_LOGIC_PATTERN_MAX
+} sim_logic_pattern_t;
+
+typedef struct {
+    uint32_t bit_len;           /*Samples per bit*/
+    uint32_t left;              /*Samples left in the current bit*/
+    uint32_t bits;              /*Bits left to send, LSB first*/
+    uint32_t count;
+    uint8_t level;
+} sim_logic_uart_t;
+
+typedef struct {
+    sim_logic_pattern_t pattern;
+    uint32_t sample_rate;
+    uint64_t pos;               /*Samples generated*/
+    uint32_t rng;
+    sim_logic_uart_t uart;
+} sim_logic_synth_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/*sim_rtos.c*/
+uint64_t sim_time_us(void);
+void sim_sleep_us(uint64_t us);
+void sim_rtos_run(uint64_t until_us);
+void sim_rtos_add_yield_hook(void (*hook)(void));
+uint32_t sim_rtos_get_task_cnt(void);
+bool sim_rtos_get_task_info(uint32_t id, sim_task_info_t * info);
+uint32_t sim_rtos_notify_wait(void);
+
+/*sim_gpio.c*/
+int sim_gpio_load_script(const char * path);
+void sim_gpio_add_press(uint64_t at_us, int pin, uint64_t hold_us);
+void sim_gpio_set_bounce(bool en);
+
+/*sim_i2c.c*/
+void sim_oled_set_frame_dir(const char * dir);
+void sim_oled_commit(void);
+bool sim_oled_get_px(int x, int y);
+int sim_oled_write_pbm(const char * path);
+void sim_oled_get_stats(sim_oled_stats_t * stats);
+void sim_i2c_set_tap(sim_i2c_tap_t cb);
+
+/*sim_spi.c*/
+void sim_spi_sleep_us(uint64_t us);
+bool sim_spi_run_next(void);
+void sim_spi_get_stats(sim_spi_stats_t * stats);
+
+/*sim_audio.c*/
+void sim_audio_set_wav(const char * path);
+void sim_audio_set_render_cost(uint64_t us);
+void sim_audio_finish(void);
+void sim_audio_get_stats(sim_audio_stats_t * stats);
+
+/*sim_logic.c*/
+void sim_logic_set_pattern(sim_logic_pattern_t pattern);
+void sim_logic_get_stats(sim_logic_stats_t * stats);
+
+/*sim_mem_trace.c*/
+int sim_mem_trace_open(const char * path);
+void sim_mem_trace_close(void);
+int sim_mem_trace_dump(const char * path);
+
+/*sim_logic_synth.c*/
+void sim_logic_synth_init(sim_logic_synth_t * synth, sim_logic_pattern_t pattern, uint32_t sample_rate, uint32_t seed);
+const char * sim_logic_synth_name(sim_logic_pattern_t pattern);
+void sim_logic_synth_fill(sim_logic_synth_t * synth, uint8_t * buf, size_t n);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*SIM_H*/
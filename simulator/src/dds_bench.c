@@ -0,0 +1,416 @@
+/**
+ * @file dds_bench.c
+ * Host benchmark of the DDS engine (components/dds): renders every waveform at
+ * every quality block by block and reports the cost per sample, the peak
+ * levels and the aliasing energy of the output, then the throughput of the
+ * level kernel (components/dds/dds_level.h) by block size, against the same
+ * loop kept scalar, how closely the sweeps follow their curves, and last
+ * the tables dds_table_resample() makes of periods longer than a table.
+ *
+ * The aliasing is measured on tones of a whole number of periods in the FFT
+ * window: the power in the bins of the harmonics is the signal, the power in
+ * all the other bins (but DC) is what folded back from above Nyquist.
+ *
+ * The sweeps are checked against the analytic frequency at every sample: the
+ * phase advance over each block gives the mean frequency the generator had,
+ * the accumulator at the end of the block its instantaneous frequency.
+ *
+ * The resampled tables are checked on a constant, which every entry must
+ * keep exactly, and on a sine, which they must follow within the half a
+ * source sample the windows are rounded to. A check failing makes the
+ * bench exit with EXIT_FAILURE.
+ *
+ * Usage: dds_bench [-n block_samples] [-s seconds_of_audio]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dds.h"
+#include "dds_level.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BENCH_BLOCK_MAX     4096
+#define BENCH_FFT_BITS      12
+#define BENCH_FFT_SIZE      (1 << BENCH_FFT_BITS)
+#define BENCH_TONE_CNT      3
+#define BENCH_FREQ_HZ       1000
+#define BENCH_LEVEL_SAMPLES (1 << 28)
+#define BENCH_SWEEP_START   20
+#define BENCH_SWEEP_STOP    20000
+#define BENCH_SWEEP_MS      1000
+#define BENCH_RESAMPLE_MAX  (4 * DDS_TABLE_SIZE)
+#define BENCH_RESAMPLE_DC   12345
+#define BENCH_RESAMPLE_AMP  30000
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static double alias_db(dds_wave_t wave, dds_quality_t quality, uint32_t periods);
+static void bench_level(size_t block_len);
+static void level_apply_scalar(const dds_level_t * lvl, int16_t * buf, size_t n);
+static void check_sweep(dds_sweep_mode_t mode, size_t block_len);
+static double sweep_hz(dds_sweep_mode_t mode, double pos, double len);
+static bool check_resample(size_t n);
+static void fft(double * re, double * im);
+static double now_s(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * wave_names[DDS_WAVE_MAX] = {"sine", "triangle", "square"};
+static const char * quality_names[DDS_QUALITY_MAX] = {"naive", "polyblep", "minblep"};
+static const char * sweep_names[DDS_SWEEP_MAX] = {"off", "linear", "log"};
+
+/*Periods per FFT window, primes so no harmonic lands on another one's alias*/
+static const uint32_t tone_periods[BENCH_TONE_CNT] = {103, 419, 1021};
+static const size_t level_block_lens[] = {64, 256, 1024};
+/*Source periods averaged down to the table, a few samples more than it to four times as many*/
+static const size_t resample_lens[] = {DDS_TABLE_SIZE + 1, 1500, 2 * DDS_TABLE_SIZE - 1, 2 * DDS_TABLE_SIZE,
+                                       BENCH_RESAMPLE_MAX};
+
+static int16_t block[BENCH_BLOCK_MAX];
+static int16_t block_ref[BENCH_BLOCK_MAX];
+static double fft_re[BENCH_FFT_SIZE];
+static double fft_im[BENCH_FFT_SIZE];
+static int16_t resample_src[BENCH_RESAMPLE_MAX];
+static int16_t resample_table[DDS_TABLE_SIZE + 1];
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    unsigned long block_len = 256;
+    unsigned long seconds = 50;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:s:h")) != -1) {
+        switch(opt) {
+            case 'n':
+                block_len = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                seconds = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n block_samples] [-s seconds_of_audio]\n"
+                                "  -n  samples per dds_render() call (default 256, max %d)\n"
+                                "  -s  audio to render per waveform and quality (default 50 s)\n",
+                        argv[0], BENCH_BLOCK_MAX);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if(block_len == 0 || block_len > BENCH_BLOCK_MAX) block_len = BENCH_BLOCK_MAX;
+
+    printf("dds: %d Hz, table of %d samples, blocks of %lu samples, cost at %d Hz\n",
+           CONFIG_DDS_SAMPLE_RATE, DDS_TABLE_SIZE, block_len, BENCH_FREQ_HZ);
+    printf("dds: %-8s %-8s %7s %7s %9s", "wave", "quality", "min", "max", "ns/sample");
+    for(int t = 0; t < BENCH_TONE_CNT; t++) {
+        printf("  alias@%5.0fHz", (double)tone_periods[t] * CONFIG_DDS_SAMPLE_RATE / BENCH_FFT_SIZE);
+    }
+    printf("\n");
+
+    for(int w = 0; w < DDS_WAVE_MAX; w++) {
+        for(int q = 0; q < DDS_QUALITY_MAX; q++) {
+            /*The sine is always looked up: one line is enough*/
+            if(w == DDS_WAVE_SINE && q != DDS_QUALITY_NAIVE) continue;
+
+            dds_t dds;
+            dds_init(&dds, CONFIG_DDS_SAMPLE_RATE);
+            dds_set_quality(&dds, q);
+            dds_set_frequency(&dds, BENCH_FREQ_HZ);
+            dds_set_waveform(&dds, w);
+
+            /*Peaks over the first second: the corrections may overshoot*/
+            int16_t min = INT16_MAX, max = INT16_MIN;
+            for(uint32_t left = CONFIG_DDS_SAMPLE_RATE; left;) {
+                size_t n = left < block_len ? left : block_len;
+                dds_render(&dds, block, n);
+                for(size_t i = 0; i < n; i++) {
+                    if(block[i] < min) min = block[i];
+                    if(block[i] > max) max = block[i];
+                }
+                left -= n;
+            }
+
+            uint64_t total = (uint64_t)CONFIG_DDS_SAMPLE_RATE * seconds;
+            uint64_t done = 0;
+            int32_t sink = 0;
+            double start = now_s();
+            while(done < total) {
+                dds_render(&dds, block, block_len);
+                sink += block[block_len - 1];
+                done += block_len;
+            }
+            double elapsed = now_s() - start;
+
+            printf("dds: %-8s %-8s %7d %7d %9.2f%s", wave_names[w], quality_names[q], min, max,
+                   elapsed * 1e9 / done, sink == INT32_MIN ? " " : "");
+            for(int t = 0; t < BENCH_TONE_CNT; t++) {
+                printf("  %11.1fdB", alias_db(w, q, tone_periods[t]));
+            }
+            printf("\n");
+        }
+    }
+
+    printf("dds: level kernel: amplitude, gain, offset and clipping in one pass\n");
+    for(size_t i = 0; i < sizeof(level_block_lens) / sizeof(level_block_lens[0]); i++) {
+        bench_level(level_block_lens[i]);
+    }
+
+    printf("dds: sweeps from %d to %d Hz in %d ms, against the analytic curve\n",
+           BENCH_SWEEP_START, BENCH_SWEEP_STOP, BENCH_SWEEP_MS);
+    check_sweep(DDS_SWEEP_LINEAR, block_len);
+    check_sweep(DDS_SWEEP_LOG, block_len);
+
+    bool ok = true;
+    printf("dds: tables resampled from longer periods, a constant of %d and a sine of %d\n", BENCH_RESAMPLE_DC,
+           BENCH_RESAMPLE_AMP);
+    for(size_t i = 0; i < sizeof(resample_lens) / sizeof(resample_lens[0]); i++) {
+        ok &= check_resample(resample_lens[i]);
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Render a tone of exactly `periods` periods per FFT window and compare the
+ * power outside of its harmonics to the power in them
+ */
+static double alias_db(dds_wave_t wave, dds_quality_t quality, uint32_t periods)
+{
+    dds_t dds;
+    dds_init(&dds, CONFIG_DDS_SAMPLE_RATE);
+    dds_set_quality(&dds, quality);
+    dds_set_waveform(&dds, wave);
+    dds.phase_inc = periods << (32 - BENCH_FFT_BITS);    /*dds_set_frequency() would round it*/
+
+    /*Skip a window: the minBLEP corrections carry over from the previous edges*/
+    for(int pass = 0; pass < 2; pass++) {
+        for(size_t done = 0; done < BENCH_FFT_SIZE; done += BENCH_BLOCK_MAX) {
+            dds_render(&dds, block, BENCH_BLOCK_MAX);
+        }
+    }
+
+    for(size_t i = 0; i < BENCH_FFT_SIZE; i++) {
+        fft_re[i] = block[i];
+        fft_im[i] = 0;
+    }
+    fft(fft_re, fft_im);
+
+    double signal = 0, alias = 0;
+    for(uint32_t k = 1; k < BENCH_FFT_SIZE / 2; k++) {
+        double p = fft_re[k] * fft_re[k] + fft_im[k] * fft_im[k];
+        if(k % periods == 0) signal += p;
+        else alias += p;
+    }
+
+    return 10 * log10(alias / signal);
+}
+
+/**
+ * Level a sine, driven into clipping by the gain, in blocks of `block_len`
+ * samples with dds_level_apply() and with the scalar reference. Both are
+ * run over the same input, cached, and must give the same samples.
+ */
+static void bench_level(size_t block_len)
+{
+    dds_t dds;
+    dds_init(&dds, CONFIG_DDS_SAMPLE_RATE);
+    dds_set_frequency(&dds, BENCH_FREQ_HZ);
+
+    dds_level_t lvl;
+    dds_level_set(&lvl, 24576, 2 * 256, -1000, 30000);     /*0.75 x2: clips*/
+
+    int16_t input[BENCH_BLOCK_MAX];
+    dds_render(&dds, input, block_len);
+
+    memcpy(block, input, block_len * sizeof(int16_t));
+    memcpy(block_ref, input, block_len * sizeof(int16_t));
+    dds_level_apply(&lvl, block, block_len);
+    level_apply_scalar(&lvl, block_ref, block_len);
+    bool same = memcmp(block, block_ref, block_len * sizeof(int16_t)) == 0;
+
+    double ns[2];
+    for(int ref = 0; ref < 2; ref++) {
+        int16_t * buf = ref ? block_ref : block;
+        int32_t sink = 0;
+        double start = now_s();
+        for(uint64_t done = 0; done < BENCH_LEVEL_SAMPLES; done += block_len) {
+            /*Levelling its own output would end up at the clipping levels: start over each time*/
+            memcpy(buf, input, block_len * sizeof(int16_t));
+            if(ref) level_apply_scalar(&lvl, buf, block_len);
+            else dds_level_apply(&lvl, buf, block_len);
+            sink += buf[block_len - 1];
+        }
+        ns[ref] = (now_s() - start) * 1e9 / BENCH_LEVEL_SAMPLES + (sink == INT32_MIN);
+    }
+
+    printf("dds: level    %4u samples/block %6.3f ns/sample (%7.1f Msamples/s), scalar %6.3f ns/sample, x%.1f%s\n",
+           (unsigned int)block_len, ns[0], 1e3 / ns[0], ns[1], ns[1] / ns[0], same ? "" : ", OUTPUT DIFFERS");
+}
+
+/**
+ * dds_level_apply() kept from being vectorized: the baseline of the kernel.
+ * The copy includes a memcpy() per block, as does the kernel's.
+ */
+__attribute__((optimize("no-tree-vectorize")))
+static void level_apply_scalar(const dds_level_t * lvl, int16_t * buf, size_t n)
+{
+    const int32_t scale = lvl->scale, offset = lvl->offset, min = lvl->min, max = lvl->max;
+
+    for(size_t i = 0; i < n; i++) {
+        int32_t v = ((buf[i] * scale + (1 << (DDS_LEVEL_SHIFT - 1))) >> DDS_LEVEL_SHIFT) + offset;
+        v = v < min ? min : v;
+        v = v > max ? max : v;
+        buf[i] = (int16_t)v;
+    }
+}
+
+/**
+ * Render one whole sweep in blocks of `block_len` samples. The generator
+ * steps the phase by the curve at each sample, so the phase advance over a
+ * block must be the sum of the analytic frequencies at its samples. The
+ * errors are reported in Hz and in cents, the drift of the phase in cycles.
+ */
+static void check_sweep(dds_sweep_mode_t mode, size_t block_len)
+{
+    dds_t dds;
+    dds_init(&dds, CONFIG_DDS_SAMPLE_RATE);
+    dds_set_sweep(&dds, mode, BENCH_SWEEP_START, BENCH_SWEEP_STOP, BENCH_SWEEP_MS);
+
+    const double rate = CONFIG_DDS_SAMPLE_RATE;
+    const double len = dds.sweep.len;
+    double mean_hz = 0, mean_cents = 0, inst_hz = 0, inst_cents = 0, drift = 0;
+
+    for(uint32_t pos = 0; pos < dds.sweep.len;) {
+        size_t n = dds.sweep.len - pos < block_len ? dds.sweep.len - pos : block_len;
+        uint32_t phase = dds.phase;
+
+        double expected = 0;
+        for(size_t i = 0; i < n; i++) expected += sweep_hz(mode, pos + i, len) / rate;
+
+        dds_render(&dds, block, n);
+        pos += n;
+
+        /*Cycles: the whole ones are lost by the accumulator, the error is far below half of one*/
+        double got = (uint32_t)(dds.phase - phase) / 4294967296.0;
+        double err = got - (expected - floor(expected));
+        err -= round(err);
+        drift += err;
+
+        double hz = err * rate / n;
+        double mean = expected * rate / n;
+        if(fabs(hz) > fabs(mean_hz)) mean_hz = hz;
+        if(fabs(1200 * log2((mean + hz) / mean)) > fabs(mean_cents)) mean_cents = 1200 * log2((mean + hz) / mean);
+
+        /*The last block wraps the sweep back to its start*/
+        if(pos == dds.sweep.len) break;
+        double f = sweep_hz(mode, pos, len);
+        double inst = dds_get_frequency(&dds);
+        if(fabs(inst - f) > fabs(inst_hz)) inst_hz = inst - f;
+        if(fabs(1200 * log2(inst / f)) > fabs(inst_cents)) inst_cents = 1200 * log2(inst / f);
+    }
+
+    printf("dds: sweep %-6s block mean %+8.4f Hz %+8.4f cents, instantaneous %+8.4f Hz %+8.4f cents, drift %+.4f cycles%s\n",
+           sweep_names[mode], mean_hz, mean_cents, inst_hz, inst_cents, drift,
+           fabs(mean_cents) < 1 && fabs(inst_cents) < 1 ? "" : ", OFF THE CURVE");
+}
+
+/**
+ * Resample a constant and a sine of period `n` to a table and compare them
+ * to the constant and to the sine at the entries
+ * @return true if every entry is right
+ */
+static bool check_resample(size_t n)
+{
+    int32_t dc_err = 0;
+    double sine_err = 0;
+    /*The windows start and end on whole samples: their center is off by up to half a sample*/
+    double sine_max = BENCH_RESAMPLE_AMP * M_PI / n + 2;
+
+    for(size_t k = 0; k < n; k++) resample_src[k] = BENCH_RESAMPLE_DC;
+    esp_err_t res = dds_table_resample(resample_table, resample_src, n);
+    for(size_t i = 0; res == ESP_OK && i <= DDS_TABLE_SIZE; i++) {
+        if(abs(resample_table[i] - BENCH_RESAMPLE_DC) > abs(dc_err)) dc_err = resample_table[i] - BENCH_RESAMPLE_DC;
+    }
+
+    for(size_t k = 0; k < n; k++) resample_src[k] = (int16_t)lround(BENCH_RESAMPLE_AMP * sin(2 * M_PI * k / n));
+    if(res == ESP_OK) res = dds_table_resample(resample_table, resample_src, n);
+    for(size_t i = 0; res == ESP_OK && i <= DDS_TABLE_SIZE; i++) {
+        double err = resample_table[i] - BENCH_RESAMPLE_AMP * sin(2 * M_PI * i / DDS_TABLE_SIZE);
+        if(fabs(err) > fabs(sine_err)) sine_err = err;
+    }
+
+    bool ok = res == ESP_OK && dc_err == 0 && fabs(sine_err) <= sine_max;
+    printf("dds: resample %5zu samples: constant off by %d, sine off by %+7.1f (max %.1f)%s\n", n, dc_err,
+           sine_err, sine_max, ok ? "" : ", WRONG");
+    return ok;
+}
+
+/**
+ * Analytic frequency of a sweep `pos` samples after its start
+ */
+static double sweep_hz(dds_sweep_mode_t mode, double pos, double len)
+{
+    if(mode == DDS_SWEEP_LINEAR) return BENCH_SWEEP_START + (BENCH_SWEEP_STOP - BENCH_SWEEP_START) * pos / len;
+    return BENCH_SWEEP_START * pow((double)BENCH_SWEEP_STOP / BENCH_SWEEP_START, pos / len);
+}
+
+/**
+ * In place radix-2 FFT of BENCH_FFT_SIZE points
+ */
+static void fft(double * re, double * im)
+{
+    for(uint32_t i = 1, j = 0; i < BENCH_FFT_SIZE; i++) {
+        uint32_t bit = BENCH_FFT_SIZE >> 1;
+        for(; j & bit; bit >>= 1) j ^= bit;
+        j |= bit;
+        if(i < j) {
+            double t = re[i];
+            re[i] = re[j];
+            re[j] = t;
+            t = im[i];
+            im[i] = im[j];
+            im[j] = t;
+        }
+    }
+
+    for(uint32_t len = 2; len <= BENCH_FFT_SIZE; len <<= 1) {
+        double a = -2 * M_PI / len;
+        for(uint32_t i = 0; i < BENCH_FFT_SIZE; i += len) {
+            for(uint32_t k = 0; k < len / 2; k++) {
+                double wr = cos(a * k), wi = sin(a * k);
+                double xr = re[i + k + len / 2] * wr - im[i + k + len / 2] * wi;
+                double xi = re[i + k + len / 2] * wi + im[i + k + len / 2] * wr;
+                re[i + k + len / 2] = re[i + k] - xr;
+                im[i + k + len / 2] = im[i + k] - xi;
+                re[i + k] += xr;
+                im[i + k] += xi;
+            }
+        }
+    }
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,437 @@
+/**
+ * @file disp_bench.c
+ * Host benchmark of the display drivers (components/lvgl_esp32_drivers) on
+ * the simulated buses: what a flush puts on the wire and how long the bus
+ * is busy with it.
+ *
+ * SSD1306: flushes of the whole screen and of a part of it through the I2C
+ * stand-in (src/sim_i2c.c). Every transaction is checked byte by byte: one
+ * per page, the page and the column set up as single commands, then the
+ * columns of the area and nothing more.
+ *
+ * SPI (disp_spi): frames of a 320x240 ILI9341 flushed in stripes of two
+ * VDBs through the SPI master stand-in (src/sim_spi.c), the way
+ * LittlevGL does: render a stripe, wait for the flush of the previous one,
+ * flush. The flush is run queued, as the driver does, and blocking until
+ * the colors are sent, as it did before. For each rendering time it
+ * reports the frame rate, the time blocked in the flush, the time waiting
+ * for the previous one and how much of the bus time overlapped rendering.
+ *
+ * ILI9488: the RGB565 to RGB666 conversion of the colors, checked against
+ * the byte at a time loop the driver had, on lengths with and without a
+ * tail of less than 4 pixels, then both timed per pixel on the host CPU.
+ * The time per pixel is also given in cycles of the board's 240 MHz CPU,
+ * as a budget to hold the conversion to: it is the host's time, not a
+ * count of the Xtensa instructions.
+ *
+ * The drivers are built as they are for the board. LittlevGL isn't:
+ * lv_disp_flush_ready() is the bench's, to count the flushes.
+ *
+ * Usage: disp_bench [-n flushes]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim.h"
+#include "disp_spi.h"
+#include "ili9341.h"
+#undef DISP_BUF_SIZE                /*Each driver has its own, the board builds only one*/
+#include "ili9488.h"
+#undef DISP_BUF_SIZE
+#include "ssd1306.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BENCH_FLUSHES       100
+#define BENCH_TAP_MAX       16              /*Transactions recorded per flush*/
+#define BENCH_TAP_BYTES     256
+
+#define OLED_ADDRESS        0x3C
+#define OLED_WIDTH          128
+#define OLED_PAGES          8
+#define OLED_COLUMN_OFFSET  2
+
+#define TFT_HOR_RES         320
+#define TFT_VER_RES         240
+#define TFT_STRIPE          40              /*Lines per VDB, DISP_BUF_SIZE of the board*/
+#define TFT_SPI_HZ          (40 * 1000 * 1000)
+#define TFT_AREA_BYTES      11              /*CASET, PASET and RAMWR with their parameters*/
+
+#define CONV_PX             (480 * 4)       /*A chunk of the driver on a 480 pixel wide display*/
+#define CONV_REPEAT         100             /*Chunks converted per flush of -n*/
+#define CONV_CPU_MHZ        240             /*CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ of the board*/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint8_t buf[BENCH_TAP_BYTES];
+    size_t len;
+} bench_trans_t;
+
+typedef struct {
+    uint64_t elapsed_us;
+    uint64_t blocked_us;        /*In the flush*/
+    uint64_t wait_us;           /*For the previous flush to end*/
+    uint64_t busy_us;
+    uint64_t overlap_us;        /*Of the bus busy while rendering*/
+    uint32_t stripes;
+} bench_spi_result_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static bool check_ssd1306(const lv_area_t * area, unsigned long flushes);
+static void i2c_tap(const uint8_t * buf, size_t len);
+static bool bench_spi(uint32_t render_us, bool blocking, unsigned long frames, bench_spi_result_t * res);
+static void print_spi(const char * mode, uint32_t render_us, const bench_spi_result_t * res);
+static bool check_rgb666(void);
+static void bench_rgb666(unsigned long flushes);
+static void rgb565_to_rgb666_bytes(uint8_t * dest, const uint16_t * src, uint32_t px_num);
+static double now_s(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static bench_trans_t trans[BENCH_TAP_MAX];
+static uint32_t trans_cnt;
+static uint32_t flush_ready_cnt;
+
+static uint8_t vdb[OLED_WIDTH * OLED_PAGES];
+
+/*Rendering times of a stripe around the 5.1 ms its colors take on the bus*/
+static const uint32_t tft_render_us[] = {1000, 2500, 5000, 10000};
+static uint8_t tft_vdb[2][TFT_HOR_RES * TFT_STRIPE * 2];
+static lv_disp_t disp;
+static bool flushing;
+
+static uint16_t conv_src[CONV_PX];
+static uint32_t conv_dest[CONV_PX * 3 / 4 + 1];     /*Word aligned, as the DMA buffers*/
+static uint8_t conv_ref[CONV_PX * 3];
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    unsigned long flushes = BENCH_FLUSHES;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:h")) != -1) {
+        switch(opt) {
+            case 'n':
+                flushes = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n flushes]\n"
+                                "  -n  flushes timed per area (default %d)\n",
+                        argv[0], BENCH_FLUSHES);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if(flushes < 1) flushes = 1;
+
+    bool ok = true;
+
+    /*The areas as the rounder leaves them: whole pages*/
+    static const lv_area_t oled_areas[] = {
+        {0, 0, OLED_WIDTH - 1, OLED_PAGES * 8 - 1},     /*The whole screen*/
+        {10, 16, 49, 31},                               /*40 columns of pages 2 and 3*/
+        {127, 56, 127, 63},                             /*The last column of the last page*/
+    };
+    i2c_master_init();
+    printf("disp: ssd1306 %-9s %6s %6s %8s %12s\n", "area", "pages", "trans", "bytes", "bus us");
+    for(size_t i = 0; i < sizeof(oled_areas) / sizeof(oled_areas[0]); i++) {
+        ok &= check_ssd1306(&oled_areas[i], flushes);
+    }
+
+    spi_device_interface_config_t devcfg = {
+        .clock_speed_hz = TFT_SPI_HZ,
+        .spics_io_num = -1,
+        .flags = SPI_DEVICE_HALFDUPLEX,
+    };
+    disp_spi_add_device_config(VSPI_HOST, &devcfg);
+    printf("disp: ili9341 %dx%d in stripes of %d lines at %d MHz, %lu frames\n", TFT_HOR_RES, TFT_VER_RES,
+           TFT_STRIPE, TFT_SPI_HZ / 1000000, flushes);
+    for(size_t i = 0; i < sizeof(tft_render_us) / sizeof(tft_render_us[0]); i++) {
+        bench_spi_result_t blocking, queued;
+        ok &= bench_spi(tft_render_us[i], true, flushes, &blocking);
+        ok &= bench_spi(tft_render_us[i], false, flushes, &queued);
+        print_spi("blocking", tft_render_us[i], &blocking);
+        print_spi("queued", tft_render_us[i], &queued);
+
+        /*Queued, the flush only sets up the transactions*/
+        if(queued.blocked_us >= blocking.blocked_us || queued.elapsed_us > blocking.elapsed_us) {
+            fprintf(stderr, "disp: ili9341 render %u us: the queued flush isn't faster\n", tft_render_us[i]);
+            ok = false;
+        }
+    }
+
+    ok &= check_rgb666();
+    bench_rgb666(flushes);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * LittlevGL's, for the flushes of the drivers
+ */
+void lv_disp_flush_ready(lv_disp_drv_t * disp_drv)
+{
+    (void) disp_drv;
+    flush_ready_cnt++;
+    flushing = false;
+}
+
+/**
+ * LittlevGL's, disp_spi signals the end of the colors to the display refreshing
+ */
+lv_disp_t * lv_refr_get_disp_refreshing(void)
+{
+    return &disp;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Flush `area` from a page packed VDB holding a pattern and check the
+ * transactions on the wire, then time `flushes` of them on the bus
+ */
+static bool check_ssd1306(const lv_area_t * area, unsigned long flushes)
+{
+    uint32_t columns = area->x2 - area->x1 + 1;
+    uint32_t page1 = area->y1 >> 3, page2 = area->y2 >> 3;
+    uint32_t pages = page2 - page1 + 1;
+    uint32_t column = area->x1 + OLED_COLUMN_OFFSET;
+    lv_disp_drv_t drv;
+    bool ok = true;
+
+    for(uint32_t i = 0; i < columns * pages; i++) vdb[i] = (uint8_t)(i * 37 + 11);
+
+    trans_cnt = 0;
+    flush_ready_cnt = 0;
+    sim_i2c_set_tap(i2c_tap);
+    ssd1306_flush(&drv, area, (lv_color_t *) vdb);
+    sim_i2c_set_tap(NULL);
+
+    if(trans_cnt != pages || flush_ready_cnt != 1) {
+        fprintf(stderr, "disp: ssd1306 %ux%u: %u transactions for %u pages, flush ready %u times\n",
+                columns, pages * 8, trans_cnt, pages, flush_ready_cnt);
+        ok = false;
+    }
+
+    for(uint32_t p = 0; p < trans_cnt && p < pages; p++) {
+        const uint8_t head[] = {
+            OLED_ADDRESS << 1,
+            0x80, 0xB0 | (page1 + p),       /*Page, single command*/
+            0x80, column & 0x0F,            /*Column low nibble*/
+            0x80, 0x10 | (column >> 4),     /*Column high nibble*/
+            0x40,                           /*Then data to the end*/
+        };
+        const bench_trans_t * t = &trans[p];
+
+        if(t->len != sizeof(head) + columns || memcmp(t->buf, head, sizeof(head)) != 0 ||
+           memcmp(&t->buf[sizeof(head)], &vdb[p * columns], columns) != 0) {
+            fprintf(stderr, "disp: ssd1306 %ux%u: page %u: %zu bytes, expected %zu:", columns, pages * 8,
+                    page1 + p, t->len, sizeof(head) + columns);
+            for(size_t b = 0; b < t->len && b < sizeof(head) + 4; b++) fprintf(stderr, " %02x", t->buf[b]);
+            fprintf(stderr, "\n");
+            ok = false;
+        }
+    }
+
+    /*The panel got the same pixels*/
+    for(int32_t y = area->y1; y <= area->y2; y++) {
+        for(int32_t x = area->x1; x <= area->x2; x++) {
+            uint8_t byte = vdb[((y >> 3) - page1) * columns + (x - area->x1)];
+            if(sim_oled_get_px(x, y) != ((byte >> (y & 0x7)) & 0x1)) {
+                if(ok) fprintf(stderr, "disp: ssd1306 %ux%u: pixel %d,%d differs\n", columns, pages * 8, x, y);
+                ok = false;
+            }
+        }
+    }
+
+    sim_oled_stats_t start, end;
+    sim_oled_get_stats(&start);
+    for(unsigned long i = 0; i < flushes; i++) ssd1306_flush(&drv, area, (lv_color_t *) vdb);
+    sim_oled_get_stats(&end);
+
+    char name[16];
+    snprintf(name, sizeof(name), "%ux%u", columns, pages * 8);
+    printf("disp: ssd1306 %-9s %6u %6.1f %8.1f %12.1f%s\n", name, pages,
+           (double)(end.transactions - start.transactions) / flushes, (double)(end.bytes - start.bytes) / flushes,
+           (double)(end.bus_time_us - start.bus_time_us) / flushes, ok ? "" : ", WRONG BYTES");
+
+    return ok;
+}
+
+/**
+ * Render and flush the stripes of `frames` frames like LittlevGL with two VDBs:
+ * the stripe is rendered while the previous one may still be on the bus, then
+ * its flush waits for the previous flush to end.
+ * @param blocking true: the flush returns when the colors are sent
+ * @return true if every flush ended and every byte was sent
+ */
+static bool bench_spi(uint32_t render_us, bool blocking, unsigned long frames, bench_spi_result_t * res)
+{
+    const uint32_t stripes = frames * (TFT_VER_RES / TFT_STRIPE);
+    sim_spi_stats_t start, end, before, after;
+    lv_disp_drv_t drv;
+
+    memset(res, 0, sizeof(bench_spi_result_t));
+    flush_ready_cnt = 0;
+    sim_spi_get_stats(&start);
+    uint64_t start_us = sim_time_us();
+
+    for(uint32_t i = 0; i < stripes; i++) {
+        sim_spi_get_stats(&before);
+        sim_spi_sleep_us(render_us);
+        sim_spi_get_stats(&after);
+        res->overlap_us += after.busy_us - before.busy_us;
+
+        uint64_t t = sim_time_us();
+        while(flushing && sim_spi_run_next()) {}
+        res->wait_us += sim_time_us() - t;
+
+        lv_coord_t y = (i % (TFT_VER_RES / TFT_STRIPE)) * TFT_STRIPE;
+        lv_area_t area = {0, y, TFT_HOR_RES - 1, y + TFT_STRIPE - 1};
+        flushing = true;
+        t = sim_time_us();
+        ili9341_flush(&drv, &area, (lv_color_t *) tft_vdb[i & 1]);
+        if(blocking) disp_spi_wait_for_pending_transactions();
+        res->blocked_us += sim_time_us() - t;
+    }
+    while(flushing && sim_spi_run_next()) {}
+    res->elapsed_us = sim_time_us() - start_us;
+
+    /*Take the transactions back for the next run*/
+    disp_spi_wait_for_pending_transactions();
+    sim_spi_get_stats(&end);
+    res->busy_us = end.busy_us - start.busy_us;
+    res->stripes = stripes;
+
+    uint32_t bytes = stripes * (TFT_AREA_BYTES + TFT_HOR_RES * TFT_STRIPE * 2);
+    if(flush_ready_cnt != stripes || end.bytes - start.bytes != bytes) {
+        fprintf(stderr, "disp: ili9341 render %u us: %u flushes ended of %u, %u bytes sent of %u\n", render_us,
+                flush_ready_cnt, stripes, end.bytes - start.bytes, bytes);
+        return false;
+    }
+
+    return true;
+}
+
+static void print_spi(const char * mode, uint32_t render_us, const bench_spi_result_t * res)
+{
+    uint32_t frames = res->stripes / (TFT_VER_RES / TFT_STRIPE);
+
+    printf("disp: ili9341 %-8s render %5u us/stripe: %6.1f fps, blocked in flush %7.1f us/stripe, "
+           "waiting %7.1f us/stripe, bus busy %5.1f%%, %5.1f%% of it while rendering\n", mode, render_us,
+           frames * 1e6 / res->elapsed_us, (double)res->blocked_us / res->stripes,
+           (double)res->wait_us / res->stripes, 100.0 * res->busy_us / res->elapsed_us,
+           100.0 * res->overlap_us / res->busy_us);
+}
+
+/**
+ * Every RGB565 color, then lengths around the 4 pixel groups, converted by the
+ * driver and by the byte loop: the same bytes and nothing written past them
+ */
+static bool check_rgb666(void)
+{
+    static const uint32_t lens[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 13, CONV_PX - 3, CONV_PX - 1, CONV_PX};
+    uint8_t * dest = (uint8_t *) conv_dest;
+    bool ok = true;
+
+    for(uint32_t c = 0; c < 0x10000; c += CONV_PX) {
+        for(uint32_t i = 0; i < CONV_PX; i++) conv_src[i] = (uint16_t)(c + i);
+        ili9488_rgb565_to_rgb666(dest, conv_src, CONV_PX);
+        rgb565_to_rgb666_bytes(conv_ref, conv_src, CONV_PX);
+        if(memcmp(dest, conv_ref, CONV_PX * 3) != 0) {
+            fprintf(stderr, "disp: ili9488 rgb666 of the colors from 0x%04x differs\n", c);
+            ok = false;
+        }
+    }
+
+    srand(1);
+    for(uint32_t i = 0; i < CONV_PX; i++) conv_src[i] = (uint16_t) rand();
+    for(size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        uint32_t len = lens[l];
+        memset(conv_dest, 0xA5, sizeof(conv_dest));
+        ili9488_rgb565_to_rgb666(dest, conv_src + 1, len);
+        rgb565_to_rgb666_bytes(conv_ref, conv_src + 1, len);
+
+        bool tail_ok = true;
+        for(uint32_t i = len * 3; i < sizeof(conv_dest); i++) tail_ok &= dest[i] == 0xA5;
+        if(memcmp(dest, conv_ref, len * 3) != 0 || !tail_ok) {
+            fprintf(stderr, "disp: ili9488 rgb666 of %u pixels %s\n", len, tail_ok ? "differs" : "overruns");
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+/**
+ * Time the conversion of a chunk, the driver's against the byte loop
+ */
+static void bench_rgb666(unsigned long flushes)
+{
+    unsigned long repeat = flushes * CONV_REPEAT;
+    uint8_t * dest = (uint8_t *) conv_dest;
+
+    double start = now_s();
+    for(unsigned long r = 0; r < repeat; r++) ili9488_rgb565_to_rgb666(dest, conv_src, CONV_PX);
+    double words_s = now_s() - start;
+
+    start = now_s();
+    for(unsigned long r = 0; r < repeat; r++) rgb565_to_rgb666_bytes(conv_ref, conv_src, CONV_PX);
+    double bytes_s = now_s() - start;
+
+    double px = (double) repeat * CONV_PX;
+    double words_ns = words_s * 1e9 / px;
+    double bytes_ns = bytes_s * 1e9 / px;
+    printf("disp: ili9488 rgb666 of %d pixels: words %.3f ns/px, bytes %.3f ns/px (host)\n", CONV_PX,
+           words_ns, bytes_ns);
+    printf("disp: ili9488 rgb666 at %d MHz: words %.2f cycles/px, bytes %.2f cycles/px\n", CONV_CPU_MHZ,
+           words_ns * CONV_CPU_MHZ / 1000, bytes_ns * CONV_CPU_MHZ / 1000);
+}
+
+/**
+ * The conversion a byte at a time, as ili9488_flush() did it
+ */
+static void rgb565_to_rgb666_bytes(uint8_t * dest, const uint16_t * src, uint32_t px_num)
+{
+    for(uint32_t i = 0; i < px_num; i++) {
+        uint32_t c = src[i];
+        *dest++ = (uint8_t)((c & 0xF800) >> 8);
+        *dest++ = (uint8_t)((c & 0x07E0) >> 3);
+        *dest++ = (uint8_t)((c & 0x001F) << 3);
+    }
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void i2c_tap(const uint8_t * buf, size_t len)
+{
+    if(trans_cnt == BENCH_TAP_MAX) return;
+
+    bench_trans_t * t = &trans[trans_cnt++];
+    t->len = len;
+    memcpy(t->buf, buf, len < BENCH_TAP_BYTES ? len : BENCH_TAP_BYTES);
+}
@@ -0,0 +1,400 @@
+/**
+ * @file draw_bench.c
+ * Host check of the page packed VDB of the 1 bpp displays (LV_VDB_MONO_PAGE,
+ * the mono_page_*() functions of lv_draw_basic.c): fills, letters, maps and
+ * pixels drawn a byte at a time into the page packed VDB must give the very
+ * pixels of the same drawing done pixel by pixel, through `set_px_cb`, into a
+ * VDB of one byte per pixel.
+ *
+ * The areas start and end at every row of a page and run over the edges of
+ * the display and of the VDB, where the mask clips them: random ones, and
+ * the edge cases listed in `fills`. The VDB is the whole display, as the
+ * board has it, then a band of pages not starting at the left edge, as
+ * `ssd1306_rounder` can make it. The letters are of the fonts of the board,
+ * 1 bpp (Unscii 8) and 4 bpp (Roboto). Every drawing starts from the same
+ * random VDB, both paths are timed.
+ *
+ * lv_draw_basic.c is built once per path with its functions renamed
+ * draw_page_*() and draw_px_*(), see CMakeLists.txt.
+ *
+ * Usage: draw_bench [-n passes]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lvgl/lvgl.h"
+
+#if LV_COLOR_DEPTH != 1
+#error "draw_bench checks the 1 bpp VDB: the simulator has to be configured for the SSD1306"
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BENCH_PASSES        200
+#define BENCH_OPS           400             /*Random drawings of each kind per VDB*/
+#define BENCH_MAP_MAX       48              /*Side of the biggest map*/
+
+#define DISP_W              LV_HOR_RES_MAX
+#define DISP_H              LV_VER_RES_MAX
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    OP_FILL,
+    OP_LETTER,
+    OP_MAP,
+    OP_PX,
+    OP_CNT
+} op_type_t;
+
+typedef struct {
+    op_type_t type;
+    lv_area_t area;             /*Of the fill and the map, the position of the letter and the pixel*/
+    lv_color_t color;
+    const lv_font_t * font;
+    uint32_t letter;
+    const uint8_t * map;
+} op_t;
+
+typedef struct {
+    void (*px)(lv_coord_t x, lv_coord_t y, const lv_area_t * mask_p, lv_color_t color, lv_opa_t opa);
+    void (*fill)(const lv_area_t * cords_p, const lv_area_t * mask_p, lv_color_t color, lv_opa_t opa);
+    void (*letter)(const lv_point_t * pos_p, const lv_area_t * mask_p, const lv_font_t * font_p, uint32_t letter,
+                   lv_color_t color, lv_opa_t opa);
+    void (*map)(const lv_area_t * cords_p, const lv_area_t * mask_p, const uint8_t * map_p, lv_opa_t opa,
+                bool chroma_key, bool alpha_byte, lv_color_t recolor, lv_opa_t recolor_opa);
+} draw_path_t;
+
+/**********************
+ *  GLOBAL PROTOTYPES
+ **********************/
+#define DRAW_PROTOTYPES(prefix)                                                                                 \
+    void prefix##_px(lv_coord_t x, lv_coord_t y, const lv_area_t * mask_p, lv_color_t color, lv_opa_t opa);    \
+    void prefix##_fill(const lv_area_t * cords_p, const lv_area_t * mask_p, lv_color_t color, lv_opa_t opa);   \
+    void prefix##_letter(const lv_point_t * pos_p, const lv_area_t * mask_p, const lv_font_t * font_p,         \
+                         uint32_t letter, lv_color_t color, lv_opa_t opa);                                     \
+    void prefix##_map(const lv_area_t * cords_p, const lv_area_t * mask_p, const uint8_t * map_p, lv_opa_t opa, \
+                      bool chroma_key, bool alpha_byte, lv_color_t recolor, lv_opa_t recolor_opa);
+
+DRAW_PROTOTYPES(draw_page)
+DRAW_PROTOTYPES(draw_px)
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static uint32_t gen_ops(op_t * ops);
+static bool check_ops(const lv_area_t * vdb_area, const op_t * ops, uint32_t op_cnt);
+static void draw_ops(const draw_path_t * path, const lv_area_t * vdb_area, const op_t * ops, uint32_t op_cnt,
+                     op_type_t type, uint8_t * buf);
+static void vdb_init(const lv_area_t * vdb_area);
+static void set_px_cb(lv_disp_drv_t * disp_drv, uint8_t * buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y,
+                      lv_color_t color, lv_opa_t opa);
+static lv_coord_t rand_coord(lv_coord_t min, lv_coord_t max);
+static double now_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const draw_path_t paths[2] = {
+    {draw_page_px, draw_page_fill, draw_page_letter, draw_page_map},
+    {draw_px_px, draw_px_fill, draw_px_letter, draw_px_map},
+};
+#define PATH_PAGE   (&paths[0])
+#define PATH_PX     (&paths[1])
+
+static const char * op_names[OP_CNT] = {"fill", "letter", "map", "px"};
+
+/*The VDBs: the whole display, and a band of pages off the left edge*/
+static const lv_area_t vdb_areas[] = {
+    {0, 0, DISP_W - 1, DISP_H - 1},
+    {5, 16, DISP_W - 9, 39},
+};
+
+/*Fills from and to every row of a page, over the edges of the display and of the band VDB*/
+static const lv_area_t fills[] = {
+    {0, 0, DISP_W - 1, DISP_H - 1}, {-4, -4, DISP_W + 3, DISP_H + 3}, {0, 0, 0, 0},
+    {DISP_W - 1, DISP_H - 1, DISP_W - 1, DISP_H - 1}, {3, 1, 60, 6}, {3, 3, 3, 4}, {10, 7, 20, 8},
+    {10, 5, 20, 21}, {0, 8, DISP_W - 1, 15}, {1, 9, 126, 14}, {-10, 60, 10, 70}, {120, -3, 140, 2},
+    {2, 15, 90, 16}, {4, 17, 30, 38}, {4, 23, 30, 24}, {30, 39, 40, 40}, {0, 40, DISP_W - 1, 40},
+};
+
+static const lv_font_t * fonts[] = {&lv_font_unscii_8, &lv_font_roboto_12, &lv_font_roboto_16};
+
+static lv_disp_drv_t disp_drv_page;
+static lv_disp_drv_t disp_drv_px;
+static lv_disp_t disp;
+static lv_disp_buf_t vdb;
+
+static uint8_t bg[DISP_W * DISP_H];                 /*The pixels every drawing starts from*/
+static uint8_t buf_page[DISP_W * DISP_H / 8];
+static uint8_t buf_px[DISP_W * DISP_H];
+static uint8_t maps[BENCH_OPS][BENCH_MAP_MAX * BENCH_MAP_MAX];
+static op_t ops[BENCH_OPS * OP_CNT + sizeof(fills) / sizeof(fills[0])];
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    unsigned long passes = BENCH_PASSES;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:h")) != -1) {
+        switch(opt) {
+            case 'n':
+                passes = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n passes]\n"
+                                "  -n  drawings of the random areas timed (default %d)\n",
+                        argv[0], BENCH_PASSES);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if(passes < 1) passes = 1;
+
+    /*No lv_hal_disp.c either: the drivers are left zeroed, without GPU, the page path without `set_px_cb`*/
+    disp_drv_px.set_px_cb = set_px_cb;
+
+    srand(1);
+    for(uint32_t i = 0; i < sizeof(bg); i++) bg[i] = rand() & 1 ? LV_COLOR_WHITE.full : LV_COLOR_BLACK.full;
+    uint32_t op_cnt = gen_ops(ops);
+
+    bool ok = true;
+    printf("draw: %ux%u display, %u drawings per VDB, %lu passes\n", DISP_W, DISP_H, op_cnt, passes);
+    printf("draw: %-16s %-6s %11s %11s\n", "VDB", "", "page ns", "px ns");
+    for(size_t v = 0; v < sizeof(vdb_areas) / sizeof(vdb_areas[0]); v++) {
+        const lv_area_t * vdb_area = &vdb_areas[v];
+        char vdb_name[40];
+        snprintf(vdb_name, sizeof(vdb_name), "%d,%d %dx%d", vdb_area->x1, vdb_area->y1,
+                 lv_area_get_width(vdb_area), lv_area_get_height(vdb_area));
+
+        ok &= check_ops(vdb_area, ops, op_cnt);
+
+        for(int t = 0; t < OP_CNT; t++) {
+            uint32_t cnt = 0;
+            for(uint32_t i = 0; i < op_cnt; i++) cnt += ops[i].type == (op_type_t) t;
+
+            double time_ns[2];
+            for(int p = 0; p < 2; p++) {
+                uint8_t * buf = &paths[p] == PATH_PAGE ? buf_page : buf_px;
+                double start = now_ns();
+                for(unsigned long n = 0; n < passes; n++) draw_ops(&paths[p], vdb_area, ops, op_cnt, t, buf);
+                time_ns[p] = (now_ns() - start) / passes / cnt;
+            }
+            printf("draw: %-16s %-6s %11.1f %11.1f\n", t == 0 ? vdb_name : "", op_names[t], time_ns[0], time_ns[1]);
+        }
+    }
+
+    if(!ok) fprintf(stderr, "draw: the page packed VDB differs from the pixel by pixel one\n");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * The display being refreshed, for lv_draw_basic.c: the bench has no lv_refr.c
+ */
+lv_disp_t * lv_refr_get_disp_refreshing(void)
+{
+    return &disp;
+}
+
+lv_disp_buf_t * lv_disp_get_buf(lv_disp_t * d)
+{
+    return d->driver.buffer;
+}
+
+/**
+ * The line buffers of lv_font_fmt_txt.c, for the compressed fonts: the bench has no lv_draw.c
+ */
+void * lv_draw_get_buf(uint32_t size)
+{
+    static void * buf;
+    static uint32_t buf_size;
+
+    if(size > buf_size) {
+        void * p = realloc(buf, size);
+        if(p == NULL) return NULL;
+        buf = p;
+        buf_size = size;
+    }
+
+    return buf;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * The drawings: the edge case fills in both colors, then random fills, letters, maps and pixels
+ * @return number of drawings
+ */
+static uint32_t gen_ops(op_t * o)
+{
+    uint32_t cnt = 0;
+
+    for(size_t i = 0; i < sizeof(fills) / sizeof(fills[0]); i++) {
+        o[cnt++] = (op_t) {.type = OP_FILL, .area = fills[i], .color = i & 1 ? LV_COLOR_WHITE : LV_COLOR_BLACK};
+    }
+
+    for(uint32_t i = 0; i < BENCH_OPS; i++) {
+        for(int t = 0; t < OP_CNT; t++) {
+            op_t * op = &o[cnt++];
+            memset(op, 0, sizeof(op_t));
+            op->type = t;
+            op->color = rand() & 1 ? LV_COLOR_WHITE : LV_COLOR_BLACK;
+            op->area.x1 = rand_coord(-BENCH_MAP_MAX / 2, DISP_W);
+            op->area.y1 = rand_coord(-BENCH_MAP_MAX / 2, DISP_H);
+
+            switch(op->type) {
+                case OP_FILL:
+                case OP_MAP:
+                    op->area.x2 = op->area.x1 + rand_coord(0, BENCH_MAP_MAX - 1);
+                    op->area.y2 = op->area.y1 + rand_coord(0, BENCH_MAP_MAX - 1);
+                    break;
+                default:
+                    break;
+            }
+            if(op->type == OP_LETTER) {
+                op->font = fonts[rand() % (sizeof(fonts) / sizeof(fonts[0]))];
+                op->letter = rand_coord(' ', '~');
+            }
+            if(op->type == OP_MAP) {
+                for(uint32_t p = 0; p < BENCH_MAP_MAX * BENCH_MAP_MAX; p++) {
+                    maps[i][p] = rand() & 1 ? LV_COLOR_WHITE.full : LV_COLOR_BLACK.full;
+                }
+                op->map = maps[i];
+            }
+        }
+    }
+
+    return cnt;
+}
+
+/**
+ * Draw every drawing on its own on both paths, from the same VDB, and compare the pixels
+ * @return true: the VDBs are the same after every drawing
+ */
+static bool check_ops(const lv_area_t * vdb_area, const op_t * o, uint32_t op_cnt)
+{
+    lv_coord_t w = lv_area_get_width(vdb_area);
+    lv_coord_t h = lv_area_get_height(vdb_area);
+    uint32_t failed = 0;
+
+    for(uint32_t i = 0; i < op_cnt; i++) {
+        vdb_init(vdb_area);
+        draw_ops(PATH_PAGE, vdb_area, &o[i], 1, o[i].type, buf_page);
+        draw_ops(PATH_PX, vdb_area, &o[i], 1, o[i].type, buf_px);
+
+        uint32_t diff = 0;
+        lv_coord_t diff_x = 0, diff_y = 0;
+        for(lv_coord_t y = 0; y < h; y++) {
+            for(lv_coord_t x = 0; x < w; x++) {
+                bool black_page = buf_page[(y >> 3) * w + x] & (1 << (y & 0x7));
+                bool black_px = buf_px[y * w + x] == LV_COLOR_BLACK.full;
+                if(black_page != black_px && diff++ == 0) {
+                    diff_x = x;
+                    diff_y = y;
+                }
+            }
+        }
+
+        if(diff != 0) {
+            const lv_area_t * a = &o[i].area;
+            fprintf(stderr, "draw: VDB %d,%d %dx%d: %s %d,%d %d,%d: %u pixels differ, the first at %d,%d\n",
+                    vdb_area->x1, vdb_area->y1, w, h, op_names[o[i].type], a->x1, a->y1, a->x2, a->y2, diff,
+                    diff_x + vdb_area->x1, diff_y + vdb_area->y1);
+            failed++;
+        }
+    }
+
+    return failed == 0;
+}
+
+/**
+ * Draw the drawings of a kind on a path, masked with the VDB as `lv_refr` does
+ */
+static void draw_ops(const draw_path_t * path, const lv_area_t * vdb_area, const op_t * o, uint32_t op_cnt,
+                     op_type_t type, uint8_t * buf)
+{
+    disp.driver = path == PATH_PAGE ? disp_drv_page : disp_drv_px;
+    disp.driver.buffer = &vdb;
+    vdb.buf_act = buf;
+    lv_area_copy(&vdb.area, vdb_area);
+
+    for(uint32_t i = 0; i < op_cnt; i++) {
+        const op_t * op = &o[i];
+        if(op->type != type) continue;
+
+        switch(op->type) {
+            case OP_FILL:
+                path->fill(&op->area, vdb_area, op->color, LV_OPA_COVER);
+                break;
+            case OP_LETTER: {
+                lv_point_t pos = {op->area.x1, op->area.y1};
+                path->letter(&pos, vdb_area, op->font, op->letter, op->color, LV_OPA_COVER);
+                break;
+            }
+            case OP_MAP:
+                path->map(&op->area, vdb_area, op->map, LV_OPA_COVER, false, false, LV_COLOR_BLACK, LV_OPA_TRANSP);
+                break;
+            case OP_PX:
+                path->px(op->area.x1, op->area.y1, vdb_area, op->color, LV_OPA_COVER);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * Both VDBs from the pixels of `bg` in the VDB area
+ */
+static void vdb_init(const lv_area_t * vdb_area)
+{
+    lv_coord_t w = lv_area_get_width(vdb_area);
+    lv_coord_t h = lv_area_get_height(vdb_area);
+
+    memset(buf_page, 0, sizeof(buf_page));
+    for(lv_coord_t y = 0; y < h; y++) {
+        for(lv_coord_t x = 0; x < w; x++) {
+            uint8_t c = bg[(y + vdb_area->y1) * DISP_W + x + vdb_area->x1];
+            buf_px[y * w + x] = c;
+            if(c == LV_COLOR_BLACK.full) buf_page[(y >> 3) * w + x] |= (uint8_t)(1 << (y & 0x7));
+        }
+    }
+}
+
+/**
+ * A pixel of the VDB of one byte per pixel. Like `ssd1306_set_px_cb` the opacity is ignored.
+ */
+static void set_px_cb(lv_disp_drv_t * disp_drv, uint8_t * buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y,
+                      lv_color_t color, lv_opa_t opa)
+{
+    (void)disp_drv;
+    (void)opa;
+    buf[y * buf_w + x] = color.full;
+}
+
+static lv_coord_t rand_coord(lv_coord_t min, lv_coord_t max)
+{
+    return min + rand() % (max - min + 1);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file enc_bench.c
+ * Host check of the quadrature decoder of the rotary encoder driver
+ * (components/encoder/re_decoder.c): bursts of detents one way and the
+ * other, with edges from a millisecond down to 1.5 us apart and
+ * contact bounce on every edge, decoded as the driver would see them. Every
+ * burst must come out as its exact number of detents.
+ *
+ * Two observers of the A/B pins:
+ * - every change: the decoder is fed with the levels after each edge,
+ *   bounce included;
+ * - interrupt: the GPIO interrupt of an edge reads the pins a latency
+ *   later, the edges meanwhile coalesce into that read. On edges closer
+ *   than the latency the decoder sees both pins change and has to guess
+ *   the missed edge from the direction.
+ *
+ * The turns are kept to what a hand does to a mechanical encoder: a burst
+ * starts from rest with one slow quarter step, which gives the decoder its
+ * direction, and the bounce settles well before the next edge of the other
+ * pin. An interrupt reading the bounce and the next edge together could
+ * take a step back for the direction.
+ *
+ * Usage: enc_bench [-l isr_latency_ns]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "re_decoder.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BENCH_EDGES_MAX     32768
+#define BENCH_LATENCY_NS    2000        /*From the edge to the pins read in the ISR*/
+#define BENCH_REST_NS       20000000    /*Between two bursts*/
+#define BENCH_START_NS      100000      /*The first quarter step of a burst*/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint64_t at_ns;
+    uint8_t state;              /*A/B state after the edge, see RE_DECODER_STATE*/
+} bench_edge_t;
+
+typedef struct {
+    uint32_t edge_ns;           /*Between two quarter steps*/
+    uint32_t bounce;            /*Extra pulses of every edge*/
+} bench_case_t;
+
+typedef struct {
+    int32_t detents;
+    uint32_t skipped;
+    bool ok;
+} bench_result_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static uint32_t gen_bursts(const bench_case_t * c, uint64_t * burst_end_ns);
+static void decode(uint32_t edge_cnt, const uint64_t * burst_end_ns, uint32_t latency_ns, bench_result_t * res);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+/*Detents of the bursts: positive clockwise*/
+static const int32_t bursts[] = {50, -30, 1, -1, 1, 200, -200, -1, 2, -2};
+#define BURST_CNT   (sizeof(bursts) / sizeof(bursts[0]))
+
+static const bench_case_t cases[] = {
+    {1000000, 0}, {1000000, 3}, {100000, 0}, {100000, 3}, {20000, 3},
+    {5000, 0}, {5000, 3}, {2500, 0}, {1500, 0},
+};
+
+/*The states of the clockwise cycle (A, B): 11 -> 01 -> 00 -> 10*/
+static const uint8_t cw_cycle[4] = {
+    RE_DECODER_STATE(1, 1), RE_DECODER_STATE(0, 1), RE_DECODER_STATE(0, 0), RE_DECODER_STATE(1, 0)
+};
+
+static bench_edge_t edges[BENCH_EDGES_MAX];
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    unsigned long latency_ns = BENCH_LATENCY_NS;
+    int opt;
+
+    while((opt = getopt(argc, argv, "l:h")) != -1) {
+        switch(opt) {
+            case 'l':
+                latency_ns = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-l isr_latency_ns]\n"
+                                "  -l  from an edge to the pins read by its interrupt (default %d ns)\n",
+                        argv[0], BENCH_LATENCY_NS);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    int32_t expected = 0;
+    for(size_t b = 0; b < BURST_CNT; b++) expected += abs(bursts[b]);
+
+    bool ok = true;
+    printf("enc: %zu bursts of %d detents, interrupt latency %lu ns\n", BURST_CNT, expected, latency_ns);
+    printf("enc: %9s %6s %7s | %-25s | %-25s\n", "edge ns", "bounce", "edges", "every change", "interrupt");
+    for(size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const bench_case_t * c = &cases[i];
+        uint64_t burst_end_ns[BURST_CNT];
+        bench_result_t every, isr;
+
+        uint32_t edge_cnt = gen_bursts(c, burst_end_ns);
+        decode(edge_cnt, burst_end_ns, 0, &every);
+        /*Edges further apart than the latency are read one by one, closer ones two by two*/
+        bool isr_checked = c->edge_ns * 2 > latency_ns;
+        if(isr_checked) decode(edge_cnt, burst_end_ns, latency_ns, &isr);
+
+        printf("enc: %9u %6u %7u | %5d det %4u skip %-5s | ", c->edge_ns, c->bounce, edge_cnt,
+               every.detents, every.skipped, every.ok ? "ok" : "FAIL");
+        if(isr_checked) {
+            printf("%5d det %4u skip %-5s\n", isr.detents, isr.skipped, isr.ok ? "ok" : "FAIL");
+        } else {
+            printf("beyond two edges per read\n");
+        }
+
+        ok &= every.ok && every.skipped == 0;
+        if(isr_checked) ok &= isr.ok;
+    }
+
+    if(!ok) fprintf(stderr, "enc: a burst didn't decode to its detents\n");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * The edges of every burst, each quarter step `edge_ns` after the previous
+ * one but the first. A bouncing edge toggles its pin `bounce` times more,
+ * in the first third of the time to the next edge, before it stays.
+ * @param burst_end_ns the end of each burst, once the encoder is at rest
+ * @return number of edges
+ */
+static uint32_t gen_bursts(const bench_case_t * c, uint64_t * burst_end_ns)
+{
+    uint64_t t = BENCH_REST_NS;
+    uint32_t pos = 0, cnt = 0;
+
+    srand(1);
+    for(size_t b = 0; b < BURST_CNT; b++) {
+        int32_t dir = bursts[b] > 0 ? 1 : -1;
+
+        for(int32_t q = 0; q < abs(bursts[b]) * 4; q++) {
+            uint8_t from = cw_cycle[pos];
+            pos = (pos + dir) & 3;
+            uint8_t to = cw_cycle[pos];
+
+            /*Uneven pulses, together shorter than a third of the step*/
+            uint64_t at = t;
+            uint32_t pulse_max = c->edge_ns / (6 * (c->bounce + 1));
+            for(uint32_t k = 0; k < c->bounce && cnt + 2 < BENCH_EDGES_MAX; k++) {
+                edges[cnt++] = (bench_edge_t) {at, to};
+                at += pulse_max / 2 + rand() % (pulse_max / 2 + 1);
+                edges[cnt++] = (bench_edge_t) {at, from};
+                at += pulse_max / 2 + rand() % (pulse_max / 2 + 1);
+            }
+            if(cnt < BENCH_EDGES_MAX) edges[cnt++] = (bench_edge_t) {at, to};
+            t += q == 0 && c->edge_ns < BENCH_START_NS ? BENCH_START_NS : c->edge_ns;
+        }
+
+        burst_end_ns[b] = t;
+        t += BENCH_REST_NS;
+    }
+
+    return cnt;
+}
+
+/**
+ * Feed a decoder with the edges, at every one (`latency_ns` 0) or as the
+ * interrupts read them, and check the detents of every burst
+ */
+static void decode(uint32_t edge_cnt, const uint64_t * burst_end_ns, uint32_t latency_ns, bench_result_t * res)
+{
+    re_decoder_t d;
+    uint8_t level = RE_DECODER_REST;
+    bool pending = false;
+    uint64_t read_ns = 0;
+    uint32_t e = 0;
+
+    memset(res, 0, sizeof(bench_result_t));
+    res->ok = true;
+    re_decoder_init(&d, level);
+
+    for(size_t b = 0; b < BURST_CNT; b++) {
+        int32_t detents = 0;
+
+        while(e < edge_cnt && edges[e].at_ns < burst_end_ns[b]) {
+            /*The interrupt pending reads the pins before this edge*/
+            if(pending && read_ns <= edges[e].at_ns) {
+                detents += re_decoder_feed(&d, level);
+                pending = false;
+            }
+
+            level = edges[e].state;
+            if(latency_ns == 0) {
+                detents += re_decoder_feed(&d, level);
+            } else if(!pending) {
+                pending = true;
+                read_ns = edges[e].at_ns + latency_ns;
+            }
+            e++;
+        }
+        if(pending) {
+            detents += re_decoder_feed(&d, level);
+            pending = false;
+        }
+
+        if(detents != bursts[b]) {
+            fprintf(stderr, "enc: burst %zu of %d detents decoded as %d\n", b, bursts[b], detents);
+            res->ok = false;
+        }
+        res->detents += abs(detents);
+    }
+
+    res->skipped = d.skipped;
+}
@@ -0,0 +1,214 @@
+/**
+ * @file logic_bench.c
+ * Host benchmark of the logic input capture (components/logic): feeds every
+ * synthetic bitstream of sim_logic_synth.c block by block to an armed capture
+ * which never triggers, and reports the cost per sample, the compression of
+ * the run buffer and how much of the signal it holds; then captures a
+ * triggered window of each and checks its decimated view, column by column,
+ * against the same view made straight from the samples.
+ *
+ * Usage: logic_bench [-r sample_rate] [-n block_samples] [-s seconds_of_signal]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logic.h"
+#include "sim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BENCH_BUF_SAMPLES   (1 << 20)   /*Generated once per pattern, fed over and over*/
+#define BENCH_CHANNELS      0x0F
+#define BENCH_COLS          120         /*The view of the Logic In screen*/
+#define BENCH_PRE           2000
+#define BENCH_POST          6000
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void bench_feed(sim_logic_pattern_t pattern, uint32_t sample_rate, size_t block_len, uint64_t total);
+static bool check_view(sim_logic_pattern_t pattern, uint32_t sample_rate, size_t block_len);
+static double now_s(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static logic_t logic = {.channels = BENCH_CHANNELS};
+static uint8_t samples[BENCH_BUF_SAMPLES];
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    unsigned long sample_rate = CONFIG_LOGIC_SAMPLE_RATE;
+    unsigned long block_len = CONFIG_LOGIC_BLOCK_LEN;
+    unsigned long seconds = 10;
+    int opt;
+
+    while((opt = getopt(argc, argv, "r:n:s:h")) != -1) {
+        switch(opt) {
+            case 'r':
+                sample_rate = strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                block_len = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                seconds = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-r sample_rate] [-n block_samples] [-s seconds_of_signal]\n"
+                                "  -r  sample rate the patterns are timed for (default %d Hz)\n"
+                                "  -n  samples per logic_feed() call (default %d, max %d)\n"
+                                "  -s  signal to feed per pattern (default 10 s)\n",
+                        argv[0], CONFIG_LOGIC_SAMPLE_RATE, CONFIG_LOGIC_BLOCK_LEN, BENCH_BUF_SAMPLES);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if(sample_rate == 0) sample_rate = CONFIG_LOGIC_SAMPLE_RATE;
+    if(block_len == 0 || block_len > BENCH_BUF_SAMPLES) block_len = BENCH_BUF_SAMPLES;
+
+    printf("logic: %lu Hz, blocks of %lu samples, buffer of %d runs, %lu s per pattern\n",
+           sample_rate, block_len, CONFIG_LOGIC_RUN_COUNT, seconds);
+    printf("logic: %-8s %9s %9s %11s %11s %12s\n", "pattern", "ns/sample", "Msample/s", "runs/s", "compression",
+           "buffer holds");
+
+    for(int p = 0; p < SIM_LOGIC_PATTERN_MAX; p++) {
+        bench_feed(p, sample_rate, block_len, (uint64_t) sample_rate * seconds);
+    }
+
+    bool ok = true;
+    printf("logic: view of %d columns, %d samples before a rising edge of CH0 and %d after\n",
+           BENCH_COLS, BENCH_PRE, BENCH_POST);
+    for(int p = 0; p < SIM_LOGIC_PATTERN_MAX; p++) {
+        ok &= check_view(p, sample_rate, block_len);
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * The steady state: armed on a pattern of a channel which is never captured, so it never triggers
+ */
+static void bench_feed(sim_logic_pattern_t pattern, uint32_t sample_rate, size_t block_len, uint64_t total)
+{
+    sim_logic_synth_t synth;
+    sim_logic_synth_init(&synth, pattern, sample_rate, 1);
+    sim_logic_synth_fill(&synth, samples, BENCH_BUF_SAMPLES);
+
+    const logic_capture_t cap = {
+        .trigger = {.type = LOGIC_TRIG_PATTERN, .mask = 0x80, .value = 0x80},
+    };
+    logic.samples = 0;
+    logic.runs_total = 0;
+    logic_begin(&logic, &cap);
+
+    uint64_t done = 0;
+    size_t at = 0;
+    double start = now_s();
+    while(done < total) {
+        size_t n = block_len;
+        if(n > BENCH_BUF_SAMPLES - at) n = BENCH_BUF_SAMPLES - at;
+        logic_feed(&logic, samples + at, n);
+        at = (at + n) % BENCH_BUF_SAMPLES;
+        done += n;
+    }
+    double elapsed = now_s() - start;
+
+    /*Samples are a byte each, runs 4 bytes. Still inputs close no run at all.*/
+    char compression[16] = "-", held[16] = "all";
+    if(logic.runs_total) {
+        double samples_per_run = (double) done / logic.runs_total;
+        snprintf(compression, sizeof(compression), "%.1fx", samples_per_run / 4);
+        if(logic.runs_total >= CONFIG_LOGIC_RUN_COUNT) {
+            snprintf(held, sizeof(held), "%.1f ms", CONFIG_LOGIC_RUN_COUNT * samples_per_run * 1000.0 / sample_rate);
+        }
+    }
+
+    printf("logic: %-8s %9.2f %9.1f %11.0f %11s %12s\n", sim_logic_synth_name(pattern),
+           elapsed * 1e9 / done, done / elapsed / 1e6, logic.runs_total * (double) sample_rate / done,
+           compression, held);
+}
+
+/**
+ * Captures a window and checks its view against one made from the samples
+ */
+static bool check_view(sim_logic_pattern_t pattern, uint32_t sample_rate, size_t block_len)
+{
+    sim_logic_synth_t synth;
+    sim_logic_synth_init(&synth, pattern, sample_rate, 1);
+    sim_logic_synth_fill(&synth, samples, BENCH_BUF_SAMPLES);
+
+    /*Still inputs have no edge: free running*/
+    logic_capture_t cap = {
+        .trigger = {.type = pattern == SIM_LOGIC_IDLE ? LOGIC_TRIG_NONE : LOGIC_TRIG_RISING, .channel = 0},
+        .pre_samples = BENCH_PRE,
+        .post_samples = BENCH_POST,
+    };
+    logic_begin(&logic, &cap);
+    for(size_t at = 0; at < BENCH_BUF_SAMPLES && logic_get_state(&logic) != LOGIC_DONE; at += block_len) {
+        size_t n = block_len < BENCH_BUF_SAMPLES - at ? block_len : BENCH_BUF_SAMPLES - at;
+        logic_feed(&logic, samples + at, n);
+    }
+
+    const char * name = sim_logic_synth_name(pattern);
+    logic_column_t view[BENCH_COLS];
+    size_t trigger_col;
+    if(logic_view(&logic, view, BENCH_COLS, &trigger_col) != ESP_OK) {
+        printf("logic: %-8s no trigger\n", name);
+        return false;
+    }
+
+    uint64_t trig = logic.trigger_pos;
+    bool edge_ok = cap.trigger.type == LOGIC_TRIG_NONE || (!(samples[trig - 1] & 1) && (samples[trig] & 1));
+
+    /*The reference marks the columns each sample overlaps, where the buffer kept it*/
+    logic_column_t ref[BENCH_COLS];
+    memset(ref, 0, sizeof(ref));
+    uint64_t start = trig - BENCH_PRE, span = BENCH_PRE + BENCH_POST;
+    uint64_t from = logic.first > start ? logic.first : start;
+    uint64_t stop = logic.end < start + span ? logic.end : start + span;
+    for(uint64_t s = from; s < stop; s++) {
+        uint8_t level = samples[s] & BENCH_CHANNELS;
+        uint64_t a = s - start;
+        for(uint64_t c = a * BENCH_COLS / span; c < ((a + 1) * BENCH_COLS + span - 1) / span; c++) {
+            ref[c].high |= level;
+            ref[c].low |= ~level & BENCH_CHANNELS;
+        }
+    }
+
+    int bad_cols = 0;
+    for(int c = 0; c < BENCH_COLS; c++) {
+        if(view[c].high != ref[c].high || view[c].low != ref[c].low) bad_cols++;
+    }
+
+    printf("logic: %-8s trigger at %llu (column %u)%s, window kept %llu of %llu samples in %u runs, %s\n",
+           name, (unsigned long long) trig, (unsigned int) trigger_col, edge_ok ? "" : " NOT AN EDGE",
+           (unsigned long long)(stop - from), (unsigned long long) span, (unsigned int) logic.count,
+           bad_cols ? "VIEW MISMATCH" : "view ok");
+    if(bad_cols) printf("logic: %-8s %d columns differ\n", name, bad_cols);
+
+    return edge_ok && !bad_cols;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
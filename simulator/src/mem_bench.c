@@ -0,0 +1,307 @@
+/**
+ * @file mem_bench.c
+ * Host benchmark of the allocators of lv_mem: replays a trace of the
+ * LittlevGL heap of the application, as written by `waveman_sim -m`, on the
+ * first fit allocator and on the TLSF one (LV_MEM_TLSF), with the work
+ * memory of the board. For each one it reports the time of the allocations,
+ * reallocations and frees, the allocations which failed, the high-water mark
+ * of the heap and its fragmentation at the end of the trace. The times are
+ * the mean and the 99th percentile: the longest ones on the host are
+ * preemptions, not the allocator.
+ *
+ * lv_mem.c is built once per allocator with its functions renamed
+ * mem_ff_*() and mem_tlsf_*(), see CMakeLists.txt.
+ *
+ *     waveman_sim -t 8000 -s scripts/menu_tour.txt -m menu_tour.trace
+ *     mem_bench menu_tour.trace
+ *
+ * Usage: mem_bench [-n passes] trace
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lvgl/src/lv_misc/lv_mem.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BENCH_PASSES        20
+#define BENCH_ALLOCATOR_CNT 2
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    OP_ALLOC,
+    OP_REALLOC,
+    OP_FREE,
+    OP_CNT
+} op_type_t;
+
+typedef struct {
+    op_type_t type;
+    uint32_t id;
+    uint32_t size;
+} op_t;
+
+typedef struct {
+    const char * name;
+    void (*init)(void);
+    void (*deinit)(void);
+    void * (*alloc)(size_t size);
+    void * (*realloc)(void * data_p, size_t new_size);
+    void (*free)(const void * data);
+    void (*monitor)(lv_mem_monitor_t * mon_p);
+} allocator_t;
+
+typedef struct {
+    double * times_ns[OP_CNT];  /*Of every operation of the timed passes*/
+    uint32_t cnt[OP_CNT];
+    uint32_t failed;
+    uint32_t mem_peak;
+    uint32_t mem_peak_cnt;
+    lv_mem_monitor_t end;
+} bench_result_t;
+
+/**********************
+ *  GLOBAL PROTOTYPES
+ **********************/
+#define MEM_PROTOTYPES(prefix)                                          \
+    void prefix##_init(void);                                           \
+    void prefix##_deinit(void);                                         \
+    void * prefix##_alloc(size_t size);                                 \
+    void * prefix##_realloc(void * data_p, size_t new_size);            \
+    void prefix##_free(const void * data);                              \
+    void prefix##_monitor(lv_mem_monitor_t * mon_p);
+
+MEM_PROTOTYPES(mem_ff)
+MEM_PROTOTYPES(mem_tlsf)
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static int load_trace(const char * path);
+static void bench_replay(const allocator_t * a, bool timed, bench_result_t * res);
+static void time_stats(double * times, uint32_t cnt, double * mean, double * p99);
+static int cmp_double(const void * a, const void * b);
+static double now_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const allocator_t allocators[BENCH_ALLOCATOR_CNT] = {
+    {"first fit", mem_ff_init, mem_ff_deinit, mem_ff_alloc, mem_ff_realloc, mem_ff_free, mem_ff_monitor},
+    {"tlsf", mem_tlsf_init, mem_tlsf_deinit, mem_tlsf_alloc, mem_tlsf_realloc, mem_tlsf_free, mem_tlsf_monitor},
+};
+static op_t * ops;
+static uint32_t op_cnt;
+static void ** ptrs;        /*The pointer of each allocation of the trace, by id*/
+static uint32_t id_cnt;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    unsigned long passes = BENCH_PASSES;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:h")) != -1) {
+        switch(opt) {
+            case 'n':
+                passes = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n passes] trace\n"
+                                "  -n  replays of the trace timed (default %d)\n"
+                                "  trace: written by waveman_sim -m\n",
+                        argv[0], BENCH_PASSES);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if(optind != argc - 1) {
+        fprintf(stderr, "mem: a trace is needed, see %s -h\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if(load_trace(argv[optind]) != 0) return EXIT_FAILURE;
+    if(passes < 1) passes = 1;
+
+    uint32_t op_type_cnt[OP_CNT] = {0};
+    for(uint32_t i = 0; i < op_cnt; i++) op_type_cnt[ops[i].type]++;
+    printf("mem: %s: %u allocs, %u reallocs, %u frees, %lu passes, %u bytes of work memory\n", argv[optind],
+           op_type_cnt[OP_ALLOC], op_type_cnt[OP_REALLOC], op_type_cnt[OP_FREE], passes, (unsigned int) LV_MEM_SIZE);
+    printf("mem: %-10s %8s %8s %8s %8s %8s %8s %6s %12s %6s %9s\n", "", "alloc ns", "p99", "realc ns", "p99",
+           "free ns", "p99", "failed", "heap peak", "frag", "free max");
+
+    for(int a = 0; a < BENCH_ALLOCATOR_CNT; a++) {
+        bench_result_t res;
+
+        /*The heap statistics walk the heap after every operation: a pass of their own*/
+        bench_result_t heap;
+        bench_replay(&allocators[a], false, &heap);
+
+        memset(&res, 0, sizeof(res));
+        for(int t = 0; t < OP_CNT; t++) {
+            res.times_ns[t] = malloc((op_type_cnt[t] * passes + 1) * sizeof(double));
+            if(res.times_ns[t] == NULL) return EXIT_FAILURE;
+        }
+        /*A first pass to warm the caches up*/
+        bench_replay(&allocators[a], true, &res);
+        memset(res.cnt, 0, sizeof(res.cnt));
+        for(unsigned long p = 0; p < passes; p++) bench_replay(&allocators[a], true, &res);
+
+        double mean[OP_CNT], p99[OP_CNT];
+        for(int t = 0; t < OP_CNT; t++) {
+            time_stats(res.times_ns[t], res.cnt[t], &mean[t], &p99[t]);
+            free(res.times_ns[t]);
+        }
+        printf("mem: %-10s %8.1f %8.0f %8.1f %8.0f %8.1f %8.0f %6u %6u (%3u) %5u%% %9u\n", allocators[a].name,
+               mean[OP_ALLOC], p99[OP_ALLOC], mean[OP_REALLOC], p99[OP_REALLOC], mean[OP_FREE], p99[OP_FREE],
+               heap.failed, (unsigned int) heap.mem_peak, (unsigned int) heap.mem_peak_cnt, heap.end.frag_pct,
+               (unsigned int) heap.end.free_biggest_size);
+    }
+
+    free(ops);
+    free(ptrs);
+
+    return EXIT_SUCCESS;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static int load_trace(const char * path)
+{
+    FILE * f = fopen(path, "r");
+    if(f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    char line[64];
+    uint32_t cap = 0;
+    uint32_t line_nb = 0;
+    while(fgets(line, sizeof(line), f)) {
+        line_nb++;
+        if(line[0] == '#' || line[0] == '\n') continue;
+
+        op_t op = {0};
+        char type;
+        int n = sscanf(line, "%c %u %u", &type, &op.id, &op.size);
+        if(type == 'a' && n == 3) op.type = OP_ALLOC;
+        else if(type == 'r' && n == 3) op.type = OP_REALLOC;
+        else if(type == 'f' && n >= 2) op.type = OP_FREE;
+        else {
+            fprintf(stderr, "mem: %s:%u: not an operation\n", path, line_nb);
+            fclose(f);
+            return -1;
+        }
+
+        if(op_cnt == cap) {
+            cap = cap ? cap * 2 : 1024;
+            ops = realloc(ops, cap * sizeof(op_t));
+            if(ops == NULL) {
+                fclose(f);
+                return -1;
+            }
+        }
+        ops[op_cnt++] = op;
+        if(op.id >= id_cnt) id_cnt = op.id + 1;
+    }
+    fclose(f);
+
+    ptrs = calloc(id_cnt ? id_cnt : 1, sizeof(void *));
+    return ptrs ? 0 : -1;
+}
+
+/**
+ * Replay the trace from an empty heap. Timed, every operation is timed on its own,
+ * else the heap is looked at after every operation.
+ */
+static void bench_replay(const allocator_t * a, bool timed, bench_result_t * res)
+{
+    if(!timed) memset(res, 0, sizeof(*res));
+    memset(ptrs, 0, id_cnt * sizeof(void *));
+    a->init();
+
+    for(uint32_t i = 0; i < op_cnt; i++) {
+        const op_t * op = &ops[i];
+        void ** p = &ptrs[op->id];
+        bool failed = false;
+        double start = timed ? now_ns() : 0;
+
+        switch(op->type) {
+            case OP_ALLOC:
+                *p = a->alloc(op->size);
+                failed = *p == NULL;
+                break;
+            case OP_REALLOC:
+                /*Failed before: the trace goes on without it*/
+                if(*p) {
+                    void * r = a->realloc(*p, op->size);
+                    if(r) *p = r;
+                    failed = r == NULL;
+                }
+                break;
+            case OP_FREE:
+                a->free(*p);
+                *p = NULL;
+                break;
+            default:
+                break;
+        }
+
+        if(timed) {
+            res->times_ns[op->type][res->cnt[op->type]++] = now_ns() - start;
+        } else {
+            if(failed) res->failed++;
+
+            lv_mem_monitor_t mon;
+            a->monitor(&mon);
+            if(mon.total_size - mon.free_size > res->mem_peak) {
+                res->mem_peak = mon.total_size - mon.free_size;
+                res->mem_peak_cnt = mon.used_cnt;
+            }
+        }
+    }
+
+    if(!timed) a->monitor(&res->end);
+    a->deinit();
+}
+
+static void time_stats(double * times, uint32_t cnt, double * mean, double * p99)
+{
+    double total = 0;
+
+    *mean = 0;
+    *p99 = 0;
+    if(cnt == 0) return;
+
+    for(uint32_t i = 0; i < cnt; i++) total += times[i];
+    qsort(times, cnt, sizeof(double), cmp_double);
+    *mean = total / cnt;
+    *p99 = times[(uint64_t) cnt * 99 / 100];
+}
+
+static int cmp_double(const void * a, const void * b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
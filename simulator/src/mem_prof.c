@@ -0,0 +1,693 @@
+/**
+ * @file mem_prof.c
+ * Host profiler of the LittlevGL heap: replays a dump of the lv_mem trace
+ * (LV_USE_MEM_TRACE) to show how the fragmentation of the work memory went
+ * over the time the trace covers, where the allocations which failed came
+ * from and which functions and widgets own the memory at the dump.
+ *
+ * The dump holds the last records of the ring and the used entries at the
+ * moment: the records are undone from the entries back to the oldest one,
+ * then replayed forward. The free memory is what the used entries leave,
+ * joined the way the TLSF allocator and the auto defrag keep it.
+ *
+ * A call site is a return address, from the address of lv_mem_alloc. With
+ * the binary (-e) they are looked up with nm and addr2line, of the toolchain
+ * given by -x for a dump of the board, e.g. -x xtensa-esp32-elf-.
+ *
+ *     waveman_sim -t 8000 -s scripts/menu_tour.txt -M menu_tour.lvmt
+ *     mem_prof -e waveman_sim menu_tour.lvmt
+ *
+ * The dump is either the binary file of `waveman_sim -M` or a console log
+ * with the `lv_mem trace:` lines main.c prints after a failed allocation;
+ * of several dumps in a log the last one is used.
+ *
+ * Usage: mem_prof [-e elf] [-x toolchain_prefix] [-i interval_ms] [-n top] dump
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lvgl/src/lv_misc/lv_mem.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define PROF_ROWS_DEF       20      /*Rows of the time line without -i*/
+#define PROF_TOP_DEF        15
+#define PROF_LOG_PREFIX     "lv_mem trace: "
+#define PROF_NAME_LEN       128
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint32_t offset;
+    uint32_t size;
+} ent_t;
+
+typedef struct {
+    int32_t site;
+    uint32_t bytes;
+    uint32_t cnt;
+    char file[PROF_NAME_LEN];   /*Of the owners by file*/
+} owner_t;
+
+typedef struct {
+    int32_t site;
+    char func[PROF_NAME_LEN];
+    char file[PROF_NAME_LEN];
+    unsigned int line;          /*0 if unknown*/
+} sym_t;
+
+typedef struct {
+    uint64_t start_us;
+    uint32_t lowest;            /*Biggest free entry at its lowest*/
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t fails;
+} row_t;
+
+typedef struct {
+    uint32_t free_size;
+    uint32_t free_cnt;
+    uint32_t free_biggest;
+    uint32_t used_cnt;
+} heap_stat_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static int load_dump(const char * path);
+static int parse_dump(void);
+static int ent_find(const ent_t * ents, uint32_t cnt, uint32_t offset, bool * found);
+static void ent_add(ent_t ** ents, uint32_t * cnt, uint32_t * cap, uint32_t offset, uint32_t size);
+static void ent_del(ent_t * ents, uint32_t * cnt, uint32_t offset);
+static void heap_apply(const lv_mem_trace_rec_t * rec, bool undo);
+static void heap_get_stat(heap_stat_t * stat);
+static void print_timeline(uint64_t interval_us);
+static void print_row(const row_t * row, const heap_stat_t * stat);
+static void print_fails(void);
+static void print_owners(uint32_t top);
+static void owner_add(owner_t ** list, uint32_t * cnt, int32_t site, const char * file, uint32_t bytes,
+                      uint32_t allocs);
+static void sym_init(const char * elf, const char * prefix);
+static const sym_t * sym_get(int32_t site);
+static const char * site_name(int32_t site, char * buf, size_t size);
+static int cmp_owner(const void * a, const void * b);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static uint8_t * dump;
+static size_t dump_size;
+static lv_mem_trace_head_t head;
+static const lv_mem_trace_rec_t * recs;
+static const lv_mem_trace_ent_t * dump_ents;
+static const lv_mem_trace_slab_t * slabs;
+static uint64_t * rec_times;    /*us from the oldest record, the 32 bit times unwrapped*/
+
+static ent_t * heap;            /*The used entries during the replay, by offset*/
+static uint32_t heap_cnt;
+static uint32_t heap_cap;
+
+static owner_t * owners;
+static uint32_t owner_cnt;
+
+static const char * sym_elf;
+static const char * sym_prefix;
+static unsigned long long sym_base;   /*Address of lv_mem_alloc in the binary*/
+static sym_t * syms;
+static uint32_t sym_cnt;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    const char * elf = NULL;
+    const char * prefix = "";
+    unsigned long interval_ms = 0;
+    unsigned long top = PROF_TOP_DEF;
+    int opt;
+
+    while((opt = getopt(argc, argv, "e:x:i:n:h")) != -1) {
+        switch(opt) {
+            case 'e':
+                elf = optarg;
+                break;
+            case 'x':
+                prefix = optarg;
+                break;
+            case 'i':
+                interval_ms = strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                top = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-e elf] [-x toolchain_prefix] [-i interval_ms] [-n top] dump\n"
+                                "  -e  binary which wrote the dump, to name the call sites\n"
+                                "  -x  prefix of nm and addr2line, e.g. xtensa-esp32-elf-\n"
+                                "  -i  time between the rows of the time line (default: %d rows)\n"
+                                "  -n  call sites listed (default %d)\n"
+                                "  dump: written by waveman_sim -M, or a console log of the board\n",
+                        argv[0], PROF_ROWS_DEF, PROF_TOP_DEF);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if(optind != argc - 1) {
+        fprintf(stderr, "prof: a dump is needed, see %s -h\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if(load_dump(argv[optind]) != 0) return EXIT_FAILURE;
+    if(parse_dump() != 0) return EXIT_FAILURE;
+
+    uint64_t span_us = head.rec_cnt ? rec_times[head.rec_cnt - 1] : 0;
+    printf("prof: %s: %u records over %" PRIu64 " ms, %u lost before them, %u bytes of heap in %u entries, "
+           "%u slabs\n", argv[optind], head.rec_cnt, span_us / 1000, head.lost_cnt, head.heap_size, head.ent_cnt,
+           head.slab_cnt);
+
+    sym_init(elf, prefix);
+    uint64_t interval_us = interval_ms ? interval_ms * 1000 : span_us / PROF_ROWS_DEF + 1;
+    print_timeline(interval_us);
+    print_fails();
+    print_owners(top);
+
+    free(dump);
+    free(rec_times);
+    free(heap);
+    free(owners);
+    free(syms);
+
+    return EXIT_SUCCESS;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Read the binary dump, or the hex of the last dump of a console log
+ */
+static int load_dump(const char * path)
+{
+    FILE * f = fopen(path, "rb");
+    if(f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    char magic[4] = {0};
+    size_t n = fread(magic, 1, sizeof(magic), f);
+    rewind(f);
+
+    if(n == sizeof(magic) && memcmp(magic, "LVMT", sizeof(magic)) == 0) {
+        size_t cap = 0;
+        do {
+            if(dump_size == cap) {
+                cap = cap ? cap * 2 : 65536;
+                dump = realloc(dump, cap);
+                if(dump == NULL) break;
+            }
+            n = fread(dump + dump_size, 1, cap - dump_size, f);
+            dump_size += n;
+        } while(n != 0);
+    } else {
+        char line[512];
+        size_t cap = 0;
+        while(fgets(line, sizeof(line), f)) {
+            char * hex = strstr(line, PROF_LOG_PREFIX);
+            if(hex == NULL) continue;
+            hex += strlen(PROF_LOG_PREFIX);
+            /*The last dump wins. "begin" and "end" aren't hex: "be" would be*/
+            if(strncmp(hex, "begin", 5) == 0) {
+                dump_size = 0;
+                continue;
+            }
+            if(!isxdigit((unsigned char)hex[0]) || !isxdigit((unsigned char)hex[1])) continue;
+
+            for(; isxdigit((unsigned char)hex[0]) && isxdigit((unsigned char)hex[1]); hex += 2) {
+                if(dump_size == cap) {
+                    cap = cap ? cap * 2 : 65536;
+                    dump = realloc(dump, cap);
+                    if(dump == NULL) break;
+                }
+                unsigned int byte;
+                sscanf(hex, "%2x", &byte);
+                dump[dump_size++] = byte;
+            }
+            if(dump == NULL) break;
+        }
+    }
+    fclose(f);
+
+    if(dump == NULL || dump_size == 0) {
+        fprintf(stderr, "prof: %s: no dump of the lv_mem trace\n", path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int parse_dump(void)
+{
+    if(dump_size < sizeof(head)) {
+        fprintf(stderr, "prof: the dump is truncated\n");
+        return -1;
+    }
+    memcpy(&head, dump, sizeof(head));
+    if(memcmp(head.magic, "LVMT", sizeof(head.magic)) != 0 || head.version != 1) {
+        fprintf(stderr, "prof: not a dump of the lv_mem trace, or of another version\n");
+        return -1;
+    }
+
+    size_t size = sizeof(head) + (size_t)head.rec_cnt * sizeof(lv_mem_trace_rec_t) +
+                  (size_t)head.ent_cnt * sizeof(lv_mem_trace_ent_t) +
+                  (size_t)head.slab_cnt * sizeof(lv_mem_trace_slab_t);
+    if(dump_size < size) {
+        fprintf(stderr, "prof: the dump is truncated, %zu bytes of %zu\n", dump_size, size);
+        return -1;
+    }
+
+    /*The parts are 4 byte aligned in the dump, and so in the buffer*/
+    recs = (const lv_mem_trace_rec_t *)(dump + sizeof(head));
+    dump_ents = (const lv_mem_trace_ent_t *)(recs + head.rec_cnt);
+    slabs = (const lv_mem_trace_slab_t *)(dump_ents + head.ent_cnt);
+
+    rec_times = malloc((head.rec_cnt + 1) * sizeof(uint64_t));
+    if(rec_times == NULL) return -1;
+    uint64_t t = 0;
+    for(uint32_t i = 0; i < head.rec_cnt; i++) {
+        if(i) t += (uint32_t)(recs[i].time - recs[i - 1].time);
+        rec_times[i] = t;
+    }
+
+    return 0;
+}
+
+/**
+ * Index of the entry at `offset` or where it would be inserted
+ */
+static int ent_find(const ent_t * ents, uint32_t cnt, uint32_t offset, bool * found)
+{
+    uint32_t lo = 0, hi = cnt;
+
+    while(lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if(ents[mid].offset < offset) lo = mid + 1;
+        else hi = mid;
+    }
+    *found = lo < cnt && ents[lo].offset == offset;
+
+    return lo;
+}
+
+static void ent_add(ent_t ** ents, uint32_t * cnt, uint32_t * cap, uint32_t offset, uint32_t size)
+{
+    bool found;
+    int i = ent_find(*ents, *cnt, offset, &found);
+    if(found) {
+        (*ents)[i].size = size;
+        return;
+    }
+
+    if(*cnt == *cap) {
+        *cap = *cap ? *cap * 2 : 256;
+        *ents = realloc(*ents, *cap * sizeof(ent_t));
+        if(*ents == NULL) {
+            fprintf(stderr, "prof: out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memmove(&(*ents)[i + 1], &(*ents)[i], (*cnt - i) * sizeof(ent_t));
+    (*ents)[i].offset = offset;
+    (*ents)[i].size = size;
+    (*cnt)++;
+}
+
+static void ent_del(ent_t * ents, uint32_t * cnt, uint32_t offset)
+{
+    bool found;
+    int i = ent_find(ents, *cnt, offset, &found);
+    if(!found) return;
+
+    memmove(&ents[i], &ents[i + 1], (*cnt - i - 1) * sizeof(ent_t));
+    (*cnt)--;
+}
+
+/**
+ * Apply a record to the used entries, or undo it. The blocks of the slabs are in their entry.
+ */
+static void heap_apply(const lv_mem_trace_rec_t * rec, bool undo)
+{
+    uint32_t type = rec->size_type >> 24;
+    uint32_t size = rec->size_type & 0xffffff;
+    if(type & LV_MEM_TRACE_BLOCK) return;
+
+    bool add;
+    switch(type) {
+        case LV_MEM_TRACE_ALLOC:
+        case LV_MEM_TRACE_REALLOC:
+        case LV_MEM_TRACE_SLAB:
+            add = !undo;
+            break;
+        case LV_MEM_TRACE_FREE:
+            add = undo;
+            break;
+        default:
+            return;
+    }
+
+    if(add) ent_add(&heap, &heap_cnt, &heap_cap, rec->offset, size);
+    else ent_del(heap, &heap_cnt, rec->offset);
+}
+
+/**
+ * The free entries are what the used ones leave, less their header
+ */
+static void heap_get_stat(heap_stat_t * stat)
+{
+    uint32_t end = 0;   /*Of the last used entry*/
+
+    memset(stat, 0, sizeof(*stat));
+    stat->used_cnt = heap_cnt;
+    for(uint32_t i = 0; i <= heap_cnt; i++) {
+        uint32_t start = i < heap_cnt ? heap[i].offset - head.header_size : head.heap_size;
+        if(start > end && start - end > head.header_size) {
+            uint32_t free_size = start - end - head.header_size;
+            stat->free_size += free_size;
+            stat->free_cnt++;
+            if(free_size > stat->free_biggest) stat->free_biggest = free_size;
+        }
+        if(i < heap_cnt) end = heap[i].offset + heap[i].size;
+    }
+}
+
+/**
+ * Undo the records from the entries at the dump, then replay them
+ * printing the heap at every interval and the failed allocations
+ */
+static void print_timeline(uint64_t interval_us)
+{
+    for(uint32_t i = 0; i < head.ent_cnt; i++) {
+        ent_add(&heap, &heap_cnt, &heap_cap, dump_ents[i].offset, dump_ents[i].size);
+    }
+    heap_stat_t end_stat;
+    heap_get_stat(&end_stat);
+    for(uint32_t i = head.rec_cnt; i > 0; i--) heap_apply(&recs[i - 1], true);
+
+    printf("prof: %9s %8s %8s %5s %9s %9s %6s %6s %6s\n", "ms", "used", "free", "frag", "free max", "lowest",
+           "allocs", "frees", "failed");
+
+    heap_stat_t stat;
+    row_t row;
+    uint32_t lowest = UINT32_MAX;
+    uint32_t lowest_rec = 0;
+    heap_get_stat(&stat);
+    memset(&row, 0, sizeof(row));
+    row.lowest = stat.free_biggest;
+
+    for(uint32_t i = 0; i < head.rec_cnt; i++) {
+        /*The rows of the intervals which ended before this record*/
+        while(rec_times[i] >= row.start_us + interval_us) {
+            print_row(&row, &stat);
+            memset(&row, 0, sizeof(row));
+            row.start_us = rec_times[i] - rec_times[i] % interval_us;
+            row.lowest = stat.free_biggest;
+        }
+
+        const lv_mem_trace_rec_t * rec = &recs[i];
+        heap_apply(rec, false);
+        heap_get_stat(&stat);
+
+        switch((rec->size_type >> 24) & ~LV_MEM_TRACE_BLOCK) {
+            case LV_MEM_TRACE_FREE:
+                row.frees++;
+                break;
+            case LV_MEM_TRACE_FAIL:
+                row.fails++;
+                break;
+            default:
+                row.allocs++;
+                break;
+        }
+        if(stat.free_biggest < row.lowest) row.lowest = stat.free_biggest;
+        if(stat.free_biggest < lowest) {
+            lowest = stat.free_biggest;
+            lowest_rec = i;
+        }
+    }
+    print_row(&row, &stat);
+
+    if(lowest != UINT32_MAX) {
+        printf("prof: biggest free entry down to %u bytes at %" PRIu64 " ms\n", lowest, rec_times[lowest_rec] / 1000);
+    }
+    if(stat.free_size != end_stat.free_size || stat.free_biggest != end_stat.free_biggest) {
+        fprintf(stderr, "prof: the replay doesn't end on the entries of the dump, records are missing\n");
+    }
+}
+
+static void print_row(const row_t * row, const heap_stat_t * stat)
+{
+    printf("prof: %9" PRIu64 " %8u %8u %4u%% %9u %9u %6u %6u %6u\n", row->start_us / 1000,
+           head.heap_size - stat->free_size, stat->free_size,
+           stat->free_size ? 100 - stat->free_biggest * 100 / stat->free_size : 0, stat->free_biggest, row->lowest,
+           row->allocs, row->frees, row->fails);
+}
+
+static void print_fails(void)
+{
+    for(uint32_t i = 0; i < head.rec_cnt; i++) {
+        if((recs[i].size_type >> 24) != LV_MEM_TRACE_FAIL) continue;
+
+        char name[PROF_NAME_LEN * 2 + 4];
+        printf("prof: failed at %" PRIu64 " ms: %u bytes for %s\n", rec_times[i] / 1000,
+               recs[i].size_type & 0xffffff, site_name(recs[i].site, name, sizeof(name)));
+    }
+}
+
+/**
+ * Who owns the memory at the dump: the entries and the blocks of the slabs allocated
+ * in the trace, by call site, and those from before it
+ */
+static void print_owners(uint32_t top)
+{
+    ent_t * sites = NULL;        /*offset -> site of the live allocations, `size` holds the site*/
+    uint32_t site_cnt = 0, site_cap = 0;
+    ent_t * blocks = NULL;
+    uint32_t block_cnt = 0, block_cap = 0;
+
+    for(uint32_t i = 0; i < head.rec_cnt; i++) {
+        uint32_t type = recs[i].size_type >> 24;
+        bool block = type & LV_MEM_TRACE_BLOCK;
+        ent_t ** ents = block ? &blocks : &sites;
+        uint32_t * cnt = block ? &block_cnt : &site_cnt;
+        uint32_t * cap = block ? &block_cap : &site_cap;
+
+        switch(type & ~LV_MEM_TRACE_BLOCK) {
+            case LV_MEM_TRACE_ALLOC:
+            case LV_MEM_TRACE_REALLOC:
+            case LV_MEM_TRACE_SLAB:
+                ent_add(ents, cnt, cap, recs[i].offset, (uint32_t)recs[i].site);
+                break;
+            case LV_MEM_TRACE_FREE:
+                ent_del(*ents, cnt, recs[i].offset);
+                break;
+            default:
+                break;
+        }
+    }
+
+    /*The entries, but those of the slabs: their blocks are counted*/
+    owner_t before;
+    memset(&before, 0, sizeof(before));
+    for(uint32_t i = 0; i < head.ent_cnt; i++) {
+        bool slab = false;
+        for(uint32_t s = 0; s < head.slab_cnt; s++) slab |= slabs[s].offset == dump_ents[i].offset;
+        if(slab) continue;
+
+        bool found;
+        int k = ent_find(sites, site_cnt, dump_ents[i].offset, &found);
+        uint32_t bytes = dump_ents[i].size + head.header_size;
+        if(found) {
+            owner_add(&owners, &owner_cnt, (int32_t)sites[k].size, NULL, bytes, 1);
+        } else {
+            before.bytes += bytes;
+            before.cnt++;
+        }
+    }
+
+    if(head.slab_cnt) printf("prof: %-8s %6s %6s %8s\n", "slab", "blocks", "used", "size");
+    for(uint32_t s = 0; s < head.slab_cnt; s++) {
+        const lv_mem_trace_slab_t * slab = &slabs[s];
+        uint32_t traced = 0;
+        for(uint32_t b = 0; b < block_cnt; b++) {
+            if(blocks[b].offset >= slab->offset &&
+               blocks[b].offset < slab->offset + slab->block_size * slab->block_cnt) {
+                owner_add(&owners, &owner_cnt, (int32_t)blocks[b].size, NULL, slab->block_size, 1);
+                traced++;
+            }
+        }
+        if(slab->used_cnt > traced) {
+            before.bytes += (slab->used_cnt - traced) * slab->block_size;
+            before.cnt += slab->used_cnt - traced;
+        }
+        printf("prof: %-8.8s %6u %6u %8u\n", slab->name, slab->block_cnt, slab->used_cnt,
+               slab->block_size * slab->block_cnt);
+    }
+
+    uint32_t total = before.bytes;
+    for(uint32_t i = 0; i < owner_cnt; i++) total += owners[i].bytes;
+    printf("prof: %u bytes owned at the dump, %u of them allocated before the trace (%u times)\n", total,
+           before.bytes, before.cnt);
+
+    qsort(owners, owner_cnt, sizeof(owner_t), cmp_owner);
+    printf("prof: %8s %6s  %s\n", "bytes", "allocs", "call site");
+    for(uint32_t i = 0; i < owner_cnt && i < top; i++) {
+        char name[PROF_NAME_LEN * 2 + 4];
+        printf("prof: %8u %6u  %s\n", owners[i].bytes, owners[i].cnt, site_name(owners[i].site, name, sizeof(name)));
+    }
+
+    /*By the file of the call site: lv_label.c is the labels*/
+    owner_t * files = NULL;
+    uint32_t file_cnt = 0;
+    for(uint32_t i = 0; i < owner_cnt; i++) {
+        const sym_t * sym = sym_get(owners[i].site);
+        owner_add(&files, &file_cnt, 0, sym && sym->file[0] ? sym->file : "?", owners[i].bytes, owners[i].cnt);
+    }
+    qsort(files, file_cnt, sizeof(owner_t), cmp_owner);
+    printf("prof: %8s %6s  %s\n", "bytes", "allocs", "file");
+    for(uint32_t i = 0; i < file_cnt; i++) {
+        printf("prof: %8u %6u  %s\n", files[i].bytes, files[i].cnt, files[i].file);
+    }
+
+    free(files);
+    free(sites);
+    free(blocks);
+}
+
+/**
+ * Count bytes for an owner: a call site, or a file if `file` isn't NULL
+ */
+static void owner_add(owner_t ** list, uint32_t * cnt, int32_t site, const char * file, uint32_t bytes,
+                      uint32_t allocs)
+{
+    for(uint32_t i = 0; i < *cnt; i++) {
+        owner_t * o = &(*list)[i];
+        if(file ? strcmp(o->file, file) == 0 : o->site == site) {
+            o->bytes += bytes;
+            o->cnt += allocs;
+            return;
+        }
+    }
+
+    *list = realloc(*list, (*cnt + 1) * sizeof(owner_t));
+    if(*list == NULL) {
+        fprintf(stderr, "prof: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    owner_t * o = &(*list)[*cnt];
+    memset(o, 0, sizeof(owner_t));
+    o->site = site;
+    if(file) snprintf(o->file, sizeof(o->file), "%s", file);
+    o->bytes = bytes;
+    o->cnt = allocs;
+    (*cnt)++;
+}
+
+/**
+ * Find the address of lv_mem_alloc in the binary: the sites are from it
+ */
+static void sym_init(const char * elf, const char * prefix)
+{
+    char cmd[1024];
+    char line[1024];
+
+    sym_elf = elf;
+    sym_prefix = prefix;
+    if(elf == NULL) return;
+
+    snprintf(cmd, sizeof(cmd), "%snm '%s'", prefix, elf);
+    FILE * p = popen(cmd, "r");
+    if(p == NULL) return;
+    while(fgets(line, sizeof(line), p)) {
+        unsigned long long addr;
+        char type, name[256];
+        if(sscanf(line, "%llx %c %255s", &addr, &type, name) == 3 && strcmp(name, "lv_mem_alloc") == 0) sym_base = addr;
+    }
+    pclose(p);
+
+    if(sym_base == 0) fprintf(stderr, "prof: %s: lv_mem_alloc not found, the call sites are left as offsets\n", elf);
+}
+
+/**
+ * The function, file and line of a call site, from addr2line the first time
+ * @return the symbol or NULL if the binary wasn't given
+ */
+static const sym_t * sym_get(int32_t site)
+{
+    if(sym_base == 0) return NULL;
+
+    for(uint32_t i = 0; i < sym_cnt; i++) {
+        if(syms[i].site == site) return &syms[i];
+    }
+
+    syms = realloc(syms, (sym_cnt + 1) * sizeof(sym_t));
+    if(syms == NULL) {
+        fprintf(stderr, "prof: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    sym_t * sym = &syms[sym_cnt++];
+    memset(sym, 0, sizeof(sym_t));
+    sym->site = site;
+
+    /*A return address is after the call: the line of the call is the one of the byte before*/
+    char cmd[1024];
+    char line[1024];
+    snprintf(cmd, sizeof(cmd), "%saddr2line -f -e '%s' 0x%llx", sym_prefix, sym_elf,
+             (unsigned long long)(sym_base + site - 1));
+    FILE * p = popen(cmd, "r");
+    if(p == NULL) return sym;
+    if(fgets(line, sizeof(line), p)) {
+        line[strcspn(line, "\n")] = '\0';
+        if(strcmp(line, "??") != 0) snprintf(sym->func, sizeof(sym->func), "%.*s", PROF_NAME_LEN - 1, line);
+    }
+    if(fgets(line, sizeof(line), p)) {
+        /*The file name, without its directory, then the line without the discriminator*/
+        char * colon = strchr(line, ':');
+        if(colon) sym->line = strtoul(colon + 1, NULL, 10);
+        line[strcspn(line, ":\n")] = '\0';
+        const char * file = strrchr(line, '/');
+        if(strcmp(line, "??") != 0) snprintf(sym->file, sizeof(sym->file), "%.*s", PROF_NAME_LEN - 1,
+                                             file ? file + 1 : line);
+    }
+    pclose(p);
+
+    return sym;
+}
+
+static const char * site_name(int32_t site, char * buf, size_t size)
+{
+    const sym_t * sym = sym_get(site);
+
+    if(sym && sym->func[0] && sym->file[0]) snprintf(buf, size, "%s (%s:%u)", sym->func, sym->file, sym->line);
+    else if(sym && sym->func[0]) snprintf(buf, size, "%s", sym->func);
+    else snprintf(buf, size, "lv_mem_alloc%+" PRId32, site);
+
+    return buf;
+}
+
+static int cmp_owner(const void * a, const void * b)
+{
+    const owner_t * x = a, * y = b;
+    return (x->bytes < y->bytes) - (x->bytes > y->bytes);
+}
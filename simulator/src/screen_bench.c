@@ -0,0 +1,400 @@
+/**
+ * @file screen_bench.c
+ * Host benchmark of the screen manager (components/screen): walks a menu of
+ * screens like the one of the application, from the menu to each screen and
+ * back, first deleting and building the screens on every transition, then
+ * building them once and hiding them. For each way it reports the time a
+ * transition takes, up to the objects of the new screen set up, and the time
+ * to draw its first frame, the high-water mark of the LittlevGL heap and its
+ * fragmentation after the walk.
+ *
+ * The screens have the objects of those of the application, without what
+ * they show: a list of 6 buttons, spinboxes, rollers, labels, a canvas and a
+ * chart, on the SSD1306 resolution and theme. The display is a page packed
+ * buffer sent nowhere.
+ *
+ * Usage: screen_bench [-n rounds]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lvgl/lvgl.h"
+#include "lvgl/src/lv_themes/lv_theme_mono.h"
+#include "screen.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BENCH_ROUNDS        100
+#define BENCH_SCREEN_CNT    6           /*Besides the menu*/
+#define BENCH_CANVAS_W      120
+#define BENCH_CANVAS_H      28
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    double show_first_us;       /*Transitions of the first round, where the pool builds*/
+    double show_us;             /*The other rounds*/
+    double show_max_us;
+    double frame_us;
+    double frame_max_us;
+    uint32_t mem_peak;
+    uint32_t mem_peak_cnt;
+} bench_result_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void bench_walk(bool rebuild, uint32_t rounds, bench_result_t * res);
+static void bench_transition(screen_t * scr, uint32_t round, bench_result_t * res, uint32_t * cnt);
+static void disp_init(void);
+static void disp_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p);
+static void disp_rounder(lv_disp_drv_t * drv, lv_area_t * area);
+static void disp_set_px(lv_disp_drv_t * drv, uint8_t * buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y,
+                        lv_color_t color, lv_opa_t opa);
+static bool keypad_read(lv_indev_drv_t * drv, lv_indev_data_t * data);
+static void menu_build(screen_t * scr);
+static void frequency_build(screen_t * scr);
+static void amplitude_build(screen_t * scr);
+static void waveform_build(screen_t * scr);
+static void logic_build(screen_t * scr);
+static void stats_build(screen_t * scr);
+static void sweep_build(screen_t * scr);
+static lv_obj_t * spinbox_create(lv_obj_t * parent, uint8_t digits, lv_coord_t w);
+static lv_obj_t * label_create(lv_obj_t * parent, const char * text, lv_coord_t x, lv_coord_t y);
+static double now_us(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static screen_mgr_t mgr;
+static screen_t menu = {.name = "Menu", .build = menu_build};
+static screen_t screens[BENCH_SCREEN_CNT] = {
+    {.name = "Frequency", .build = frequency_build, .keys_lr = true},
+    {.name = "Amplitude", .build = amplitude_build},
+    {.name = "Waveform",  .build = waveform_build},
+    {.name = "Logic In",  .build = logic_build},
+    {.name = "Stats",     .build = stats_build, .tab = 1},
+    {.name = "Sweep",     .build = sweep_build, .keys_lr = true},
+};
+static lv_color_t disp_buf1[LV_HOR_RES_MAX * LV_VER_RES_MAX];
+static uint8_t canvas_buf[LV_CANVAS_BUF_SIZE_INDEXED_1BIT(BENCH_CANVAS_W, BENCH_CANVAS_H)];
+static double clock_start_us;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    unsigned long rounds = BENCH_ROUNDS;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:h")) != -1) {
+        switch(opt) {
+            case 'n':
+                rounds = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-n rounds]\n"
+                                "  -n  walks from the menu to every screen and back (default %d)\n",
+                        argv[0], BENCH_ROUNDS);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if(rounds < 2) rounds = 2;
+
+    clock_start_us = now_us();
+    lv_init();
+    disp_init();
+    lv_theme_mono_init(0, NULL);
+    lv_theme_set_current(lv_theme_get_mono());
+
+    lv_obj_t * tabview = lv_tabview_create(lv_scr_act(), NULL);
+    lv_obj_t * tabs[2] = {lv_tabview_add_tab(tabview, "SET"), lv_tabview_add_tab(tabview, "ACTIVE")};
+    menu.parent = tabs[0];
+    for(int i = 0; i < BENCH_SCREEN_CNT; i++) screens[i].parent = tabs[screens[i].tab];
+
+    /*Up and down, enter, and left and right*/
+    for(int i = 0; i < 3; i++) {
+        lv_indev_drv_t drv;
+        lv_indev_drv_init(&drv);
+        drv.type = LV_INDEV_TYPE_KEYPAD;
+        drv.read_cb = keypad_read;
+        lv_indev_t * indev = lv_indev_drv_register(&drv);
+        if(i < 2) mgr.indevs[i] = indev;
+        else mgr.indev_lr = indev;
+    }
+    mgr.tabview = tabview;
+    screen_mgr_init(&mgr);
+    screen_show(&mgr, &menu);
+    lv_refr_now(NULL);
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    printf("screen: %lu rounds of %d screens, the menu and the tabs take %u bytes of %u in %u blocks\n",
+           rounds, BENCH_SCREEN_CNT, (unsigned int)(mon.total_size - mon.free_size), (unsigned int) mon.total_size,
+           (unsigned int) mon.used_cnt);
+    printf("screen: %-8s %10s %10s %10s %10s %10s %12s %6s %10s\n", "", "show 1st", "show us", "show max",
+           "frame us", "frame max", "heap peak", "frag", "free max");
+
+    bench_result_t res[2];
+    for(int rebuild = 1; rebuild >= 0; rebuild--) {
+        bench_walk(rebuild, rounds, &res[rebuild]);
+
+        lv_mem_monitor(&mon);
+        printf("screen: %-8s %10.1f %10.1f %10.1f %10.1f %10.1f %6u (%3u) %5u%% %10u\n",
+               rebuild ? "rebuild" : "pool", res[rebuild].show_first_us, res[rebuild].show_us,
+               res[rebuild].show_max_us, res[rebuild].frame_us, res[rebuild].frame_max_us,
+               (unsigned int) res[rebuild].mem_peak, (unsigned int) res[rebuild].mem_peak_cnt,
+               mon.frag_pct, (unsigned int) mon.free_biggest_size);
+    }
+
+    printf("screen: pool: transitions %.1fx faster, %u more bytes of heap for the screens kept\n",
+           res[1].show_us / res[0].show_us, (unsigned int)(res[0].mem_peak - res[1].mem_peak));
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * ESP-IDF clock of the screen manager and of the LittlevGL tick: the host clock
+ */
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t)(now_us() - clock_start_us);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * From the menu to every screen and back, `rounds` times. The screens start deleted.
+ */
+static void bench_walk(bool rebuild, uint32_t rounds, bench_result_t * res)
+{
+    uint32_t cnt[2] = {0, 0};
+
+    for(int i = 0; i < BENCH_SCREEN_CNT; i++) screen_free(&mgr, &screens[i]);
+    mgr.rebuild = rebuild;
+    *res = (bench_result_t) {0};
+
+    for(uint32_t round = 0; round < rounds; round++) {
+        for(int i = 0; i < BENCH_SCREEN_CNT; i++) {
+            bench_transition(&screens[i], round, res, cnt);
+            bench_transition(&menu, round, res, cnt);
+        }
+    }
+
+    res->show_first_us /= cnt[0];
+    res->show_us /= cnt[1];
+    res->frame_us /= cnt[0] + cnt[1];
+}
+
+static void bench_transition(screen_t * scr, uint32_t round, bench_result_t * res, uint32_t * cnt)
+{
+    screen_show(&mgr, scr);
+    double show = (double) mgr.stats.time_us;
+
+    /*The heap is fullest right after the build, the frame only borrows from it*/
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    if(mon.total_size - mon.free_size > res->mem_peak) {
+        res->mem_peak = mon.total_size - mon.free_size;
+        res->mem_peak_cnt = mon.used_cnt;
+    }
+
+    double start = now_us();
+    lv_refr_now(NULL);
+    double frame = now_us() - start;
+
+    if(round == 0) res->show_first_us += show;
+    else res->show_us += show;
+    cnt[round ? 1 : 0]++;
+    if(show > res->show_max_us) res->show_max_us = show;
+    res->frame_us += frame;
+    if(frame > res->frame_max_us) res->frame_max_us = frame;
+}
+
+static void disp_init(void)
+{
+    static lv_disp_buf_t disp_buf;
+    lv_disp_buf_init(&disp_buf, disp_buf1, NULL, LV_HOR_RES_MAX * LV_VER_RES_MAX);
+
+    lv_disp_drv_t drv;
+    lv_disp_drv_init(&drv);
+    drv.flush_cb = disp_flush;
+    drv.rounder_cb = disp_rounder;
+    drv.set_px_cb = disp_set_px;
+    drv.buffer = &disp_buf;
+    lv_disp_drv_register(&drv);
+}
+
+static void disp_flush(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    (void) area;
+    (void) color_p;
+    lv_disp_flush_ready(drv);
+}
+
+/*Whole pages of 8 rows, like the SSD1306*/
+static void disp_rounder(lv_disp_drv_t * drv, lv_area_t * area)
+{
+    (void) drv;
+    area->y1 = area->y1 & ~0x7;
+    area->y2 = (area->y2 & ~0x7) + 7;
+}
+
+static void disp_set_px(lv_disp_drv_t * drv, uint8_t * buf, lv_coord_t buf_w, lv_coord_t x, lv_coord_t y,
+                        lv_color_t color, lv_opa_t opa)
+{
+    (void) drv;
+    (void) opa;
+    uint8_t * byte = &buf[x + (y >> 3) * buf_w];
+
+    if(color.full == 0) *byte |= 1 << (y & 0x7);
+    else *byte &= ~(1 << (y & 0x7));
+}
+
+/*No key is ever pressed: the devices only follow the screens*/
+static bool keypad_read(lv_indev_drv_t * drv, lv_indev_data_t * data)
+{
+    (void) drv;
+    data->key = LV_KEY_ENTER;
+    data->state = LV_INDEV_STATE_REL;
+    return false;
+}
+
+static void menu_build(screen_t * scr)
+{
+    static const char * names[] = {"1.Frequency", "2.Amplitude", "3.Waveform", "4.Logic In", "5.Stats", "6.Sweep"};
+
+    lv_obj_t * list = lv_list_create(scr->cont, NULL);
+    lv_obj_set_size(list, 128, 50);
+    lv_list_set_sb_mode(list, LV_SB_MODE_OFF);
+    lv_list_set_single_mode(list, true);
+    for(int i = 0; i < BENCH_SCREEN_CNT; i++) lv_list_add_btn(list, NULL, names[i]);
+
+    lv_group_add_obj(scr->group, list);
+}
+
+static void frequency_build(screen_t * scr)
+{
+    lv_obj_t * spinbox = spinbox_create(scr->cont, 9, 110);
+    lv_obj_align(spinbox, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -8);
+    label_create(scr->cont, "Set Frequency:", 5, 5);
+
+    lv_group_add_obj(scr->group, spinbox);
+}
+
+static void amplitude_build(screen_t * scr)
+{
+    label_create(scr->cont, "SET_AMPLITUDE", 5, 5);
+}
+
+static void waveform_build(screen_t * scr)
+{
+    lv_obj_t * roller = lv_roller_create(scr->cont, NULL);
+    lv_roller_set_options(roller, "Sinosoid\nTriangular\nSquare", LV_ROLLER_MODE_NORMAL);
+    lv_roller_set_visible_row_count(roller, 2);
+    lv_obj_align(roller, NULL, LV_ALIGN_IN_BOTTOM_MID, 0, -4);
+    label_create(scr->cont, "SET WAVEFORM", 5, 5);
+
+    lv_group_add_obj(scr->group, roller);
+}
+
+static void logic_build(screen_t * scr)
+{
+    lv_obj_t * roller = lv_roller_create(scr->cont, NULL);
+    lv_roller_set_options(roller, "Free\nCH0 rise\nCH0 fall\nCH1 rise\nCH1 fall\nCH2 rise\nCH2 fall\nCH3 rise\nCH3 fall",
+                          LV_ROLLER_MODE_NORMAL);
+    lv_roller_set_visible_row_count(roller, 1);
+    lv_roller_set_fix_width(roller, 64);
+    lv_obj_align(roller, NULL, LV_ALIGN_IN_TOP_RIGHT, -4, 0);
+    label_create(scr->cont, "TRIG", 4, 2);
+
+    lv_obj_t * canvas = lv_canvas_create(scr->cont, NULL);
+    lv_canvas_set_buffer(canvas, canvas_buf, BENCH_CANVAS_W, BENCH_CANVAS_H, LV_IMG_CF_INDEXED_1BIT);
+    lv_canvas_set_palette(canvas, 0, LV_COLOR_BLACK);
+    lv_canvas_set_palette(canvas, 1, LV_COLOR_WHITE);
+    lv_canvas_fill_bg(canvas, LV_COLOR_WHITE);
+    lv_obj_align(canvas, roller, LV_ALIGN_OUT_BOTTOM_RIGHT, 0, 1);
+
+    lv_group_add_obj(scr->group, roller);
+}
+
+static void stats_build(screen_t * scr)
+{
+    static const char * names[] = {"FRQ", "PER", "DTY", "UND", "CPU"};
+    static const char * values[] = {"1000.0Hz", "1.000ms", "50.0%", "0", "12%"};
+
+    for(int i = 0; i < 5; i++) {
+        label_create(scr->cont, names[i], 4, i * 9);
+        label_create(scr->cont, values[i], 32, i * 9);
+    }
+
+    lv_obj_t * chart = lv_chart_create(scr->cont, NULL);
+    lv_obj_set_size(chart, 32, 28);
+    lv_chart_set_point_count(chart, 32);
+    lv_chart_series_t * ser = lv_chart_add_series(chart, LV_COLOR_BLACK);
+    lv_chart_init_points(chart, ser, 14);
+    lv_obj_align(chart, NULL, LV_ALIGN_IN_TOP_RIGHT, -4, 0);
+}
+
+static void sweep_build(screen_t * scr)
+{
+    static const char * labels[] = {"SWEEP", "STOP Hz", "TIME ms"};
+    lv_obj_t * rows[3];
+
+    rows[0] = lv_roller_create(scr->cont, NULL);
+    lv_roller_set_options(rows[0], "Off\nLinear\nLog", LV_ROLLER_MODE_NORMAL);
+    lv_roller_set_visible_row_count(rows[0], 1);
+    lv_roller_set_fix_width(rows[0], 52);
+    lv_obj_align(rows[0], NULL, LV_ALIGN_IN_TOP_RIGHT, -4, 0);
+
+    for(int i = 1; i < 3; i++) {
+        rows[i] = spinbox_create(scr->cont, 5, 52);
+        lv_obj_align(rows[i], rows[0], LV_ALIGN_OUT_BOTTOM_RIGHT, 0, 1 + (i - 1) * 14);
+    }
+    for(int i = 0; i < 3; i++) {
+        lv_obj_t * label = label_create(scr->cont, labels[i], 4, 0);
+        lv_obj_align(label, rows[i], LV_ALIGN_OUT_LEFT_MID, 0, 0);
+        lv_obj_set_x(label, 4);
+        lv_group_add_obj(scr->group, rows[i]);
+    }
+}
+
+static lv_obj_t * spinbox_create(lv_obj_t * parent, uint8_t digits, lv_coord_t w)
+{
+    lv_obj_t * spinbox = lv_spinbox_create(parent, NULL);
+    lv_spinbox_set_digit_format(spinbox, digits, 0);
+    lv_ta_set_cursor_type(spinbox, LV_CURSOR_BLOCK);
+    lv_ta_set_cursor_blink_time(spinbox, 0);
+    lv_obj_set_width(spinbox, w);
+
+    return spinbox;
+}
+
+static lv_obj_t * label_create(lv_obj_t * parent, const char * text, lv_coord_t x, lv_coord_t y)
+{
+    lv_obj_t * label = lv_label_create(parent, NULL);
+    lv_label_set_static_text(label, text);
+    lv_obj_set_pos(label, x, y);
+
+    return label;
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
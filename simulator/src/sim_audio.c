@@ -0,0 +1,273 @@
+/**
+ * @file sim_audio.c
+ * Audio sink of the host simulator: plays the blocks of the output stage
+ * (components/audio_out) in real time on the simulated clock, optionally into
+ * a WAV file.
+ *
+ * It stands in for the DAC sink of the board, audio_sink_i2s_init(), and
+ * models its DMA: two buffers, one playing while the other waits with the
+ * next block, write() blocking while both are full. When the playing block
+ * ends with no other one waiting, a block of silence is played and counted
+ * as an underrun.
+ *
+ * Rendering takes no simulated time, so the output task is never late on
+ * its own; sim_audio_set_render_cost() charges it simulated time per block.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio_out.h"
+#include "esp_timer.h"
+#include "sim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SIM_AUDIO_BUF_CNT       2
+#define SIM_WAV_HEADER_SIZE     44
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    int16_t * bufs[SIM_AUDIO_BUF_CNT];
+    uint64_t written_us[SIM_AUDIO_BUF_CNT];
+    uint32_t head;              /*The playing buffer, or the next one to play*/
+    uint32_t count;             /*Buffers holding a block, the playing one included*/
+    bool started;               /*The first block started the DMA*/
+    bool playing;
+    size_t block_len;
+    uint32_t sample_rate;
+    esp_timer_handle_t timer;
+    TaskHandle_t writer;
+    bool writer_waiting;
+    FILE * wav;
+    uint32_t wav_samples;
+    audio_sink_t * sink;
+} sim_audio_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static esp_err_t sink_start(audio_sink_t * sink, uint32_t sample_rate, size_t block_len);
+static esp_err_t sink_write(audio_sink_t * sink, const int16_t * block);
+static void sink_stop(audio_sink_t * sink);
+static void block_end_cb(void * arg);
+static void wav_write_header(FILE * f, uint32_t sample_rate, uint32_t samples);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static sim_audio_t audio;
+static const char * wav_path;
+static uint64_t render_cost_us;
+static sim_audio_stats_t stats;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Record what's played into a WAV file (16-bit mono), NULL to play into the void
+ */
+void sim_audio_set_wav(const char * path)
+{
+    wav_path = path;
+}
+
+/**
+ * Simulated time the output task spends on each block before writing it
+ */
+void sim_audio_set_render_cost(uint64_t us)
+{
+    render_cost_us = us;
+}
+
+/**
+ * Stop the sink if it still runs and close the WAV file
+ */
+void sim_audio_finish(void)
+{
+    if(audio.sink) sink_stop(audio.sink);
+}
+
+void sim_audio_get_stats(sim_audio_stats_t * out)
+{
+    *out = stats;
+}
+
+/**
+ * The DAC of the board is the simulated sink
+ */
+esp_err_t audio_sink_i2s_init(audio_sink_t * sink)
+{
+    if(sink == NULL) return ESP_ERR_INVALID_ARG;
+
+    sink->start = sink_start;
+    sink->write = sink_write;
+    sink->stop = sink_stop;
+    sink->ctx = &audio;
+    sink->underruns = 0;
+    sink->latency_us = 0;
+
+    return ESP_OK;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static esp_err_t sink_start(audio_sink_t * sink, uint32_t sample_rate, size_t block_len)
+{
+    memset(&audio, 0, sizeof(audio));
+    memset(&stats, 0, sizeof(stats));
+
+    for(uint32_t i = 0; i < SIM_AUDIO_BUF_CNT; i++) {
+        audio.bufs[i] = malloc(block_len * sizeof(int16_t));
+        if(audio.bufs[i] == NULL) return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = block_end_cb,
+        .name = "sim_audio",
+    };
+    if(esp_timer_create(&timer_args, &audio.timer) != ESP_OK) return ESP_ERR_NO_MEM;
+
+    if(wav_path) {
+        audio.wav = fopen(wav_path, "wb");
+        if(audio.wav == NULL) {
+            fprintf(stderr, "sim: can't write %s\n", wav_path);
+            return ESP_FAIL;
+        }
+        wav_write_header(audio.wav, sample_rate, 0);
+    }
+
+    audio.block_len = block_len;
+    audio.sample_rate = sample_rate;
+    audio.sink = sink;
+    sink->underruns = 0;
+    sink->latency_us = 0;
+
+    return ESP_OK;
+}
+
+static esp_err_t sink_write(audio_sink_t * sink, const int16_t * block)
+{
+    (void) sink;
+
+    if(render_cost_us) sim_sleep_us(render_cost_us);
+
+    /*Like i2s_write(): wait for a free DMA buffer*/
+    while(audio.count == SIM_AUDIO_BUF_CNT) {
+        audio.writer = xTaskGetCurrentTaskHandle();
+        audio.writer_waiting = true;
+        sim_rtos_notify_wait();
+    }
+
+    uint32_t i = (audio.head + audio.count) % SIM_AUDIO_BUF_CNT;
+    memcpy(audio.bufs[i], block, audio.block_len * sizeof(int16_t));
+    audio.written_us[i] = sim_time_us();
+    audio.count++;
+
+    if(!audio.started) {
+        /*The first block starts the DMA*/
+        uint64_t block_us = (uint64_t) audio.block_len * 1000000 / audio.sample_rate;
+        audio.started = true;
+        esp_timer_start_periodic(audio.timer, block_us);
+        block_end_cb(NULL);
+    }
+
+    return ESP_OK;
+}
+
+static void sink_stop(audio_sink_t * sink)
+{
+    (void) sink;
+
+    if(audio.timer) {
+        esp_timer_stop(audio.timer);
+        esp_timer_delete(audio.timer);
+        audio.timer = NULL;
+    }
+
+    if(audio.wav) {
+        fseek(audio.wav, 0, SEEK_SET);
+        wav_write_header(audio.wav, audio.sample_rate, audio.wav_samples);
+        fclose(audio.wav);
+        audio.wav = NULL;
+    }
+
+    for(uint32_t i = 0; i < SIM_AUDIO_BUF_CNT; i++) {
+        free(audio.bufs[i]);
+        audio.bufs[i] = NULL;
+    }
+
+    audio.sink = NULL;
+}
+
+/**
+ * The "DMA interrupt": the playing block is over, start the next one
+ */
+static void block_end_cb(void * arg)
+{
+    (void) arg;
+
+    if(audio.playing) {
+        audio.head = (audio.head + 1) % SIM_AUDIO_BUF_CNT;
+        audio.count--;
+        audio.playing = false;
+
+        if(audio.writer_waiting) {
+            audio.writer_waiting = false;
+            xTaskNotifyGive(audio.writer);
+        }
+    }
+
+    const int16_t * samples = NULL;
+    if(audio.count) {
+        uint32_t latency_us = (uint32_t)(sim_time_us() - audio.written_us[audio.head]);
+        if(latency_us > stats.latency_us) stats.latency_us = latency_us;
+        samples = audio.bufs[audio.head];
+        audio.playing = true;
+        stats.blocks++;
+    }
+    else {
+        stats.underruns++;
+    }
+    audio.sink->underruns = stats.underruns;
+    audio.sink->latency_us = stats.latency_us;
+
+    if(audio.wav) {
+        for(size_t i = 0; i < audio.block_len; i++) {
+            int16_t s = samples ? samples[i] : 0;
+            uint8_t le[2] = {(uint8_t) s, (uint8_t)((uint16_t) s >> 8)};
+            fwrite(le, 1, 2, audio.wav);
+        }
+        audio.wav_samples += audio.block_len;
+    }
+}
+
+static void wav_write_header(FILE * f, uint32_t sample_rate, uint32_t samples)
+{
+    uint32_t data_size = samples * 2;
+    uint8_t h[SIM_WAV_HEADER_SIZE];
+    uint32_t fields[] = {
+        0x46464952, 36 + data_size, 0x45564157,     /*"RIFF", size, "WAVE"*/
+        0x20746d66, 16, 0x00010001,                 /*"fmt ", 16, PCM, mono*/
+        sample_rate, sample_rate * 2, 0x00100002,   /*rate, bytes/s, block align 2, 16 bits*/
+        0x61746164, data_size                       /*"data", size*/
+    };
+
+    for(uint32_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        h[4 * i] = (uint8_t) fields[i];
+        h[4 * i + 1] = (uint8_t)(fields[i] >> 8);
+        h[4 * i + 2] = (uint8_t)(fields[i] >> 16);
+        h[4 * i + 3] = (uint8_t)(fields[i] >> 24);
+    }
+    fwrite(h, 1, sizeof(h), f);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file sim_esp.c
+ * The few ESP-IDF system and C library extras the application needs on the host.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_spiffs.h"
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+uint32_t esp_get_free_heap_size(void)
+{
+    return 0;   /*The host heap says nothing about the target one*/
+}
+
+/**
+ * Every host allocation can do DMA: word aligned, as the DMA capable ones are
+ */
+void * heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void) caps;
+    return malloc(size);
+}
+
+void heap_caps_free(void * ptr)
+{
+    free(ptr);
+}
+
+esp_err_t esp_vfs_spiffs_register(const esp_vfs_spiffs_conf_t * conf)
+{
+    (void) conf;
+    return ESP_OK;  /*The base path is a host directory already*/
+}
+
+/**
+ * newlib's itoa: `value` in `base` (2..36), negative only in base 10
+ */
+char * itoa(int value, char * str, int base)
+{
+    if(base < 2 || base > 36) {
+        str[0] = '\0';
+        return str;
+    }
+
+    char * p = str;
+    unsigned int uvalue = (unsigned int) value;
+    if(base == 10 && value < 0) {
+        *p++ = '-';
+        uvalue = -uvalue;
+    }
+
+    char * digits = p;
+    do {
+        unsigned int d = uvalue % base;
+        *p++ = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+        uvalue /= base;
+    } while(uvalue);
+    *p = '\0';
+
+    /*The digits came out least significant first*/
+    for(char * q = p - 1; digits < q; digits++, q--) {
+        char c = *digits;
+        *digits = *q;
+        *q = c;
+    }
+
+    return str;
+}
@@ -0,0 +1,407 @@
+/**
+ * @file sim_gpio.c
+ * GPIO stand-in playing back a keypad script.
+ *
+ * Script format, one press per line, `#` starts a comment:
+ *
+ *     <at_ms> <key> [hold_ms]
+ *     <at_ms> cw|ccw [detents] [ms_per_detent]
+ *
+ * `key` is one of up, down, left, right, enter, back or gpio<N>.
+ * The pin is driven against its pull from `at_ms` for `hold_ms` (default 50 ms)
+ * of simulated time: a key with a pull down reads high while pressed.
+ *
+ * cw and ccw turn the rotary encoder, when the board has one, by `detents`
+ * (default 1) at `ms_per_detent` (default 20 ms). Each detent is a full
+ * quadrature cycle on the A and B pins.
+ *
+ * The edges raise the pin interrupts registered with gpio_isr_handler_add,
+ * from an esp_timer set to the next edge. With contact bounce enabled each
+ * edge chatters for a millisecond before the level is stable.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "sdkconfig.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "sim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SIM_PRESS_MAX           1024
+#define SIM_DEFAULT_HOLD_MS     50
+#define SIM_BOUNCE_STEP_US      250
+#define SIM_BOUNCE_STEPS        4       /*Level flips before an edge settles*/
+#define SIM_DEFAULT_DETENT_MS   20
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint64_t at_us;
+    uint64_t hold_us;
+    int pin;
+    bool bounce;            /*The encoder contacts are left clean*/
+} sim_press_t;
+
+typedef struct {
+    const char * name;
+    int pin;
+} sim_key_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static int key_to_pin(const char * key);
+static void add_turn(uint64_t at_us, int32_t detents, uint64_t detent_us);
+static int press_level(const sim_press_t * press, uint64_t now);
+static uint64_t next_edge_us(uint64_t after_us);
+static void edge_timer_cb(void * arg);
+static void schedule_edge(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+/*Keypad wiring of the board, see the keypad read callbacks in main.c*/
+static const sim_key_t keys[] = {
+    {"up",    GPIO_NUM_22},
+    {"down",  GPIO_NUM_23},
+    {"left",  GPIO_NUM_17},
+    {"right", GPIO_NUM_16},
+    {"enter", GPIO_NUM_21},
+    {"back",  GPIO_NUM_19},
+};
+
+static sim_press_t presses[SIM_PRESS_MAX];
+static uint32_t press_cnt;
+static uint32_t output_levels[GPIO_PIN_COUNT];
+static bool pull_ups[GPIO_PIN_COUNT];
+static bool bounce;
+
+static bool isr_service;
+static gpio_isr_t isr_handlers[GPIO_PIN_COUNT];
+static void * isr_args[GPIO_PIN_COUNT];
+static gpio_int_type_t intr_types[GPIO_PIN_COUNT];
+static bool intr_enabled[GPIO_PIN_COUNT];
+static int isr_levels[GPIO_PIN_COUNT];      /*Level seen by the last interrupt check*/
+static esp_timer_handle_t edge_timer;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Load a keypad script.
+ * @return 0 on success, -1 if the file can't be read or has a bad line
+ */
+int sim_gpio_load_script(const char * path)
+{
+    FILE * f = fopen(path, "r");
+    if(f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    char line[128];
+    uint32_t line_nr = 0;
+    int res = 0;
+
+    while(fgets(line, sizeof(line), f)) {
+        line_nr++;
+
+        char * comment = strchr(line, '#');
+        if(comment) *comment = '\0';
+
+        unsigned long at_ms;
+        unsigned long hold_ms = SIM_DEFAULT_HOLD_MS;
+        unsigned long detent_ms = SIM_DEFAULT_DETENT_MS;
+        char key[16];
+        int n = sscanf(line, "%lu %15s %lu %lu", &at_ms, key, &hold_ms, &detent_ms);
+        if(n <= 0) continue;    /*Empty line*/
+
+        if(n >= 2 && (strcmp(key, "cw") == 0 || strcmp(key, "ccw") == 0)) {
+            int32_t detents = n >= 3 ? (int32_t) hold_ms : 1;
+            add_turn(at_ms * 1000, key[1] == 'w' ? detents : -detents, detent_ms * 1000);
+            continue;
+        }
+
+        int pin = n >= 2 ? key_to_pin(key) : -1;
+        if(pin < 0) {
+            fprintf(stderr, "%s:%u: expected `<at_ms> <key> [hold_ms]`\n", path, line_nr);
+            res = -1;
+            break;
+        }
+
+        sim_gpio_add_press(at_ms * 1000, pin, hold_ms * 1000);
+    }
+
+    fclose(f);
+    return res;
+}
+
+void sim_gpio_add_press(uint64_t at_us, int pin, uint64_t hold_us)
+{
+    if(press_cnt >= SIM_PRESS_MAX) {
+        fprintf(stderr, "sim: too many key presses, the rest is ignored\n");
+        return;
+    }
+
+    presses[press_cnt].at_us = at_us;
+    presses[press_cnt].hold_us = hold_us;
+    presses[press_cnt].pin = pin;
+    presses[press_cnt].bounce = true;
+    press_cnt++;
+}
+
+/**
+ * Let every key edge chatter like a real contact does
+ */
+void sim_gpio_set_bounce(bool en)
+{
+    bounce = en;
+}
+
+/*=====================
+ * GPIO driver API
+ *====================*/
+
+esp_err_t gpio_config(const gpio_config_t * config)
+{
+    if(config == NULL || config->pin_bit_mask == 0) return ESP_ERR_INVALID_ARG;
+
+    for(int pin = 0; pin < GPIO_PIN_COUNT; pin++) {
+        if(config->pin_bit_mask & ((uint64_t) 1 << pin)) {
+            intr_types[pin] = config->intr_type;
+            intr_enabled[pin] = config->intr_type != GPIO_INTR_DISABLE;
+            pull_ups[pin] = config->pull_up_en == GPIO_PULLUP_ENABLE;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    (void) mode;
+    if(gpio_num < 0 || gpio_num >= GPIO_PIN_COUNT) return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if(gpio_num < 0 || gpio_num >= GPIO_PIN_COUNT) return ESP_ERR_INVALID_ARG;
+
+    output_levels[gpio_num] = level ? 1 : 0;
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    if(gpio_num < 0 || gpio_num >= GPIO_PIN_COUNT) return 0;
+
+    uint64_t now = sim_time_us();
+    for(uint32_t i = 0; i < press_cnt; i++) {
+        if(presses[i].pin == gpio_num && press_level(&presses[i], now)) return pull_ups[gpio_num] ? 0 : 1;
+    }
+
+    /*An input with a pull up floats high, otherwise the pin reads back what was written to it*/
+    return pull_ups[gpio_num] ? 1 : output_levels[gpio_num];
+}
+
+esp_err_t gpio_pad_select_gpio(uint8_t gpio_num)
+{
+    (void) gpio_num;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    if(gpio_num < 0 || gpio_num >= GPIO_PIN_COUNT) return ESP_ERR_INVALID_ARG;
+
+    intr_types[gpio_num] = intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num)
+{
+    if(gpio_num < 0 || gpio_num >= GPIO_PIN_COUNT) return ESP_ERR_INVALID_ARG;
+
+    isr_levels[gpio_num] = gpio_get_level(gpio_num);
+    intr_enabled[gpio_num] = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num)
+{
+    if(gpio_num < 0 || gpio_num >= GPIO_PIN_COUNT) return ESP_ERR_INVALID_ARG;
+
+    intr_enabled[gpio_num] = false;
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+    (void) intr_alloc_flags;
+
+    if(isr_service) return ESP_ERR_INVALID_STATE;
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = edge_timer_cb,
+        .name = "sim_gpio_edge"
+    };
+    esp_err_t res = esp_timer_create(&timer_args, &edge_timer);
+    if(res != ESP_OK) return res;
+
+    isr_service = true;
+    schedule_edge();
+    return ESP_OK;
+}
+
+void gpio_uninstall_isr_service(void)
+{
+    if(!isr_service) return;
+
+    esp_timer_stop(edge_timer);
+    esp_timer_delete(edge_timer);
+    isr_service = false;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void * args)
+{
+    if(!isr_service) return ESP_ERR_INVALID_STATE;
+    if(gpio_num < 0 || gpio_num >= GPIO_PIN_COUNT) return ESP_ERR_INVALID_ARG;
+
+    isr_levels[gpio_num] = gpio_get_level(gpio_num);
+    isr_args[gpio_num] = args;
+    isr_handlers[gpio_num] = isr_handler;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+    if(!isr_service) return ESP_ERR_INVALID_STATE;
+    if(gpio_num < 0 || gpio_num >= GPIO_PIN_COUNT) return ESP_ERR_INVALID_ARG;
+
+    isr_handlers[gpio_num] = NULL;
+    return ESP_OK;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Level of a pin due to one press. With bounce the level flips every
+ * SIM_BOUNCE_STEP_US after both edges before it settles.
+ */
+static int press_level(const sim_press_t * press, uint64_t now)
+{
+    uint64_t release_us = press->at_us + press->hold_us;
+    uint64_t bounce_us = bounce && press->bounce ? SIM_BOUNCE_STEPS * SIM_BOUNCE_STEP_US : 0;
+
+    if(now < press->at_us || now >= release_us + bounce_us) return 0;
+
+    if(now < press->at_us + bounce_us) return ((now - press->at_us) / SIM_BOUNCE_STEP_US) % 2 == 0;
+    if(now < release_us) return 1;
+    return ((now - release_us) / SIM_BOUNCE_STEP_US) % 2 == 1;
+}
+
+/**
+ * The first time after `after_us` a press can change the level of its pin
+ */
+static uint64_t next_edge_us(uint64_t after_us)
+{
+    uint64_t next = UINT64_MAX;
+
+    for(uint32_t i = 0; i < press_cnt; i++) {
+        uint32_t steps = bounce && presses[i].bounce ? SIM_BOUNCE_STEPS : 0;
+        uint64_t edges[2] = {presses[i].at_us, presses[i].at_us + presses[i].hold_us};
+        for(uint32_t e = 0; e < 2; e++) {
+            for(uint32_t s = 0; s <= steps; s++) {
+                uint64_t t = edges[e] + s * SIM_BOUNCE_STEP_US;
+                if(t > after_us && t < next) next = t;
+            }
+        }
+    }
+
+    return next;
+}
+
+/**
+ * Raise the interrupts of the pins which changed, then wait for the next edge
+ */
+static void edge_timer_cb(void * arg)
+{
+    (void) arg;
+
+    for(int pin = 0; pin < GPIO_PIN_COUNT; pin++) {
+        if(isr_handlers[pin] == NULL || !intr_enabled[pin]) continue;
+
+        int level = gpio_get_level(pin);
+        if(level == isr_levels[pin]) continue;
+        isr_levels[pin] = level;
+
+        gpio_int_type_t type = intr_types[pin];
+        if(type == GPIO_INTR_ANYEDGE || (type == GPIO_INTR_POSEDGE && level) ||
+           (type == GPIO_INTR_NEGEDGE && !level)) {
+            isr_handlers[pin](isr_args[pin]);
+        }
+    }
+
+    schedule_edge();
+}
+
+static void schedule_edge(void)
+{
+    uint64_t now = sim_time_us();
+    uint64_t next = next_edge_us(now);
+
+    if(next != UINT64_MAX) esp_timer_start_once(edge_timer, next - now);
+}
+
+/**
+ * Turn the encoder, clockwise for positive `detents`. A and B are driven low
+ * for half a detent each, B a quarter detent after A, or A after B the other way.
+ */
+static void add_turn(uint64_t at_us, int32_t detents, uint64_t detent_us)
+{
+#if CONFIG_WAVEMAN_ENCODER
+    int first = detents > 0 ? CONFIG_WAVEMAN_ENCODER_PIN_A : CONFIG_WAVEMAN_ENCODER_PIN_B;
+    int second = detents > 0 ? CONFIG_WAVEMAN_ENCODER_PIN_B : CONFIG_WAVEMAN_ENCODER_PIN_A;
+    uint32_t cnt = detents > 0 ? detents : -detents;
+
+    for(uint32_t i = 0; i < cnt && press_cnt + 2 <= SIM_PRESS_MAX; i++) {
+        uint64_t start_us = at_us + i * detent_us;
+        sim_gpio_add_press(start_us, first, detent_us / 2);
+        sim_gpio_add_press(start_us + detent_us / 4, second, detent_us / 2);
+        presses[press_cnt - 2].bounce = false;
+        presses[press_cnt - 1].bounce = false;
+    }
+#else
+    (void) at_us;
+    (void) detents;
+    (void) detent_us;
+    fprintf(stderr, "sim: the board has no rotary encoder, turn ignored\n");
+#endif
+}
+
+static int key_to_pin(const char * key)
+{
+    for(uint32_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        if(strcmp(key, keys[i].name) == 0) return keys[i].pin;
+    }
+
+    if(strncmp(key, "gpio", 4) == 0 && isdigit((unsigned char) key[4])) {
+        int pin = atoi(&key[4]);
+        if(pin < GPIO_PIN_COUNT) return pin;
+    }
+
+    return -1;
+}
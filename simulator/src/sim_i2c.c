@@ -0,0 +1,325 @@
+/**
+ * @file sim_i2c.c
+ * I2C master stand-in with a simulated SSD1306 (SH1106 style) panel on the bus.
+ *
+ * The command links built by the display driver are decoded like the
+ * controller does: control bytes select command or data, page addressing
+ * mode with the column pointer incrementing after every data byte. Each
+ * transfer blocks the calling task for the time it takes on the real bus.
+ *
+ * A frame is the data written between two vTaskDelay calls. When a frame
+ * directory is set every frame is dumped there as a PBM image.
+ *
+ * A tap set with sim_i2c_set_tap() sees every transaction as it goes on the
+ * wire, address byte included.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/i2c.h"
+#include "sim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SIM_OLED_ADDRESS        0x3C
+#define SIM_OLED_COLUMN_OFFSET  2       /*The 128 visible columns start at RAM column 2*/
+#define SIM_OLED_WIDTH          (SIM_OLED_COLUMNS - 2 * SIM_OLED_COLUMN_OFFSET)
+#define SIM_OLED_HEIGHT         (SIM_OLED_PAGES * 8)
+
+#define SIM_I2C_CMD_MAX         1024
+#define SIM_I2C_DEFAULT_HZ      100000
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+struct sim_i2c_cmd {
+    uint8_t buf[SIM_I2C_CMD_MAX];
+    size_t len;
+    uint32_t starts;
+    bool overflow;
+};
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void oled_write(const uint8_t * buf, size_t len);
+static void oled_command(uint8_t byte);
+static uint8_t oled_command_args(uint8_t cmd);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static uint32_t bus_hz[I2C_NUM_MAX] = {SIM_I2C_DEFAULT_HZ, SIM_I2C_DEFAULT_HZ};
+
+static uint8_t oled_ram[SIM_OLED_PAGES][SIM_OLED_COLUMNS];
+static uint8_t oled_page;
+static uint8_t oled_column;
+static uint8_t oled_cmd_args;       /*Arguments of the last command still to come*/
+static bool oled_inverted;
+static bool oled_dirty;
+
+static const char * frame_dir;
+static sim_oled_stats_t stats;
+static sim_i2c_tap_t tap;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Dump every frame to `dir` as frame_<n>_<ms>ms.pbm. NULL keeps the frames in memory only.
+ */
+void sim_oled_set_frame_dir(const char * dir)
+{
+    frame_dir = dir;
+}
+
+/**
+ * Close the current frame. Called from vTaskDelay, see sim_rtos_add_yield_hook.
+ */
+void sim_oled_commit(void)
+{
+    if(!oled_dirty) return;
+    oled_dirty = false;
+
+    if(frame_dir) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/frame_%05u_%08llums.pbm", frame_dir, stats.frames,
+                 (unsigned long long)(sim_time_us() / 1000));
+        sim_oled_write_pbm(path);
+    }
+
+    stats.frames++;
+}
+
+/**
+ * Read a pixel of the visible area in LittlevGL coordinates.
+ * @return true if the pixel is lit
+ */
+bool sim_oled_get_px(int x, int y)
+{
+    if(x < 0 || x >= SIM_OLED_WIDTH || y < 0 || y >= SIM_OLED_HEIGHT) return false;
+
+    bool lit = (oled_ram[y >> 3][x + SIM_OLED_COLUMN_OFFSET] >> (y & 0x7)) & 0x1;
+    return lit != oled_inverted;
+}
+
+/**
+ * Save the visible area as a binary PBM. Lit pixels are black, like the
+ * LittlevGL rendering they come from.
+ * @return 0 on success, -1 on error
+ */
+int sim_oled_write_pbm(const char * path)
+{
+    FILE * f = fopen(path, "wb");
+    if(f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    fprintf(f, "P4\n%d %d\n", SIM_OLED_WIDTH, SIM_OLED_HEIGHT);
+    for(int y = 0; y < SIM_OLED_HEIGHT; y++) {
+        uint8_t row[(SIM_OLED_WIDTH + 7) / 8] = {0};
+        for(int x = 0; x < SIM_OLED_WIDTH; x++) {
+            if(sim_oled_get_px(x, y)) row[x >> 3] |= 0x80 >> (x & 0x7);
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+
+    fclose(f);
+    return 0;
+}
+
+void sim_oled_get_stats(sim_oled_stats_t * out)
+{
+    *out = stats;
+}
+
+/**
+ * Call `cb` with the bytes of every transaction sent, NULL to stop
+ */
+void sim_i2c_set_tap(sim_i2c_tap_t cb)
+{
+    tap = cb;
+}
+
+/*=====================
+ * I2C driver API
+ *====================*/
+
+esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t * i2c_conf)
+{
+    if(i2c_num >= I2C_NUM_MAX || i2c_conf == NULL) return ESP_ERR_INVALID_ARG;
+
+    if(i2c_conf->mode == I2C_MODE_MASTER && i2c_conf->master.clk_speed) {
+        bus_hz[i2c_num] = i2c_conf->master.clk_speed;
+    }
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t mode, size_t slv_rx_buf_len,
+                             size_t slv_tx_buf_len, int intr_alloc_flags)
+{
+    (void) mode;
+    (void) slv_rx_buf_len;
+    (void) slv_tx_buf_len;
+    (void) intr_alloc_flags;
+
+    if(i2c_num >= I2C_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void)
+{
+    return calloc(1, sizeof(struct sim_i2c_cmd));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle)
+{
+    free(cmd_handle);
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle)
+{
+    cmd_handle->starts++;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en)
+{
+    return i2c_master_write(cmd_handle, &data, 1, ack_en);
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, uint8_t * data, size_t data_len, bool ack_en)
+{
+    (void) ack_en;
+
+    if(cmd_handle->len + data_len > SIM_I2C_CMD_MAX) {
+        cmd_handle->overflow = true;
+        return ESP_ERR_NO_MEM;
+    }
+
+    memcpy(&cmd_handle->buf[cmd_handle->len], data, data_len);
+    cmd_handle->len += data_len;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle)
+{
+    (void) cmd_handle;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t ticks_to_wait)
+{
+    (void) ticks_to_wait;
+
+    if(i2c_num >= I2C_NUM_MAX || cmd_handle->overflow) return ESP_ERR_INVALID_ARG;
+    if(cmd_handle->len == 0) return ESP_OK;
+
+    /*9 clocks per byte (ACK included) plus the start and stop conditions*/
+    uint64_t bits = cmd_handle->len * 9 + cmd_handle->starts * 2;
+    uint64_t bus_us = (bits * 1000000 + bus_hz[i2c_num] - 1) / bus_hz[i2c_num];
+
+    stats.bytes += cmd_handle->len;
+    stats.bus_time_us += bus_us;
+    sim_sleep_us(bus_us);
+    if(tap) tap(cmd_handle->buf, cmd_handle->len);
+
+    /*Nobody but the panel answers*/
+    if((cmd_handle->buf[0] >> 1) != SIM_OLED_ADDRESS) return ESP_FAIL;
+
+    stats.transactions++;
+    oled_write(&cmd_handle->buf[1], cmd_handle->len - 1);
+    return ESP_OK;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Decode the bytes following the address of one transaction.
+ * A control byte with Co = 0 turns the rest of the transaction into a
+ * stream; with Co = 1 only the next byte is affected.
+ */
+static void oled_write(const uint8_t * buf, size_t len)
+{
+    size_t i = 0;
+
+    while(i < len) {
+        uint8_t control = buf[i++];
+        bool single = (control & 0x80) != 0;
+        bool data = (control & 0x40) != 0;
+        size_t end = single && i + 1 < len ? i + 1 : len;
+
+        for(; i < end; i++) {
+            if(!data) {
+                oled_command(buf[i]);
+                continue;
+            }
+
+            if(oled_column < SIM_OLED_COLUMNS) {
+                oled_ram[oled_page][oled_column++] = buf[i];
+            }
+            stats.data_bytes++;
+            oled_dirty = true;
+        }
+    }
+}
+
+static void oled_command(uint8_t byte)
+{
+    if(oled_cmd_args) {
+        oled_cmd_args--;
+        return;     /*The arguments only set up the analog side of the panel*/
+    }
+
+    oled_cmd_args = oled_command_args(byte);
+    if(oled_cmd_args) return;
+
+    if(byte <= 0x0F) {
+        oled_column = (oled_column & 0xF0) | (byte & 0x0F);
+    } else if(byte >= 0x10 && byte <= 0x1F) {
+        oled_column = (oled_column & 0x0F) | ((byte & 0x0F) << 4);
+    } else if(byte >= 0xB0 && byte <= 0xB7) {
+        oled_page = byte & 0x07;
+    } else if(byte == 0xA6) {
+        oled_inverted = false;
+        oled_dirty = true;
+    } else if(byte == 0xA7) {
+        oled_inverted = true;
+        oled_dirty = true;
+    }
+}
+
+/**
+ * Number of argument bytes following a command
+ */
+static uint8_t oled_command_args(uint8_t cmd)
+{
+    switch(cmd) {
+        case 0x20:  /*Memory addressing mode*/
+        case 0x81:  /*Contrast*/
+        case 0x8D:  /*Charge pump*/
+        case 0xA8:  /*Multiplex ratio*/
+        case 0xAD:  /*DC-DC control (SH1106)*/
+        case 0xD3:  /*Display offset*/
+        case 0xD5:  /*Clock divide*/
+        case 0xD9:  /*Pre-charge period*/
+        case 0xDA:  /*COM pins*/
+        case 0xDB:  /*VCOMH level*/
+            return 1;
+        case 0x21:  /*Column address*/
+        case 0x22:  /*Page address*/
+            return 2;
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,152 @@
+/**
+ * @file sim_logic.c
+ * Logic input source of the host simulator: hands synthetic bitstreams
+ * (sim_logic_synth.c) to the capture task of components/logic in real time on
+ * the simulated clock.
+ *
+ * It stands in for the I2S source of the board, logic_source_i2s_init(), and
+ * models its DMA: a block is complete a block period after the previous one,
+ * read() waits for it. A reader more than SIM_LOGIC_BUF_CNT - 1 blocks late
+ * finds the oldest ones written over: they are skipped and counted as
+ * overruns.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "logic.h"
+#include "sim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SIM_LOGIC_BUF_CNT       4       /*The DMA ring of the board*/
+#define SIM_LOGIC_SEED          1
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    sim_logic_synth_t synth;
+    uint8_t * block;
+    size_t block_len;
+    uint32_t sample_rate;
+    uint64_t start_us;
+    uint64_t blocks;            /*Blocks complete or skipped since the start*/
+} sim_logic_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static esp_err_t source_start(logic_source_t * src, uint32_t sample_rate, size_t block_len);
+static esp_err_t source_read(logic_source_t * src, const uint8_t ** block, uint32_t timeout_ms);
+static void source_stop(logic_source_t * src);
+static uint64_t block_done_us(uint64_t block);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static sim_logic_t logic;
+static sim_logic_pattern_t pattern = SIM_LOGIC_MIX;
+static sim_logic_stats_t stats;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * What the inputs see from the next start on
+ */
+void sim_logic_set_pattern(sim_logic_pattern_t p)
+{
+    pattern = p;
+}
+
+void sim_logic_get_stats(sim_logic_stats_t * out)
+{
+    *out = stats;
+}
+
+/**
+ * The I2S capture of the board is the simulated source
+ */
+esp_err_t logic_source_i2s_init(logic_source_t * src)
+{
+    if(src == NULL) return ESP_ERR_INVALID_ARG;
+
+    src->start = source_start;
+    src->read = source_read;
+    src->stop = source_stop;
+    src->ctx = &logic;
+    src->overruns = 0;
+
+    return ESP_OK;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static esp_err_t source_start(logic_source_t * src, uint32_t sample_rate, size_t block_len)
+{
+    memset(&logic, 0, sizeof(logic));
+
+    logic.block = malloc(block_len);
+    if(logic.block == NULL) return ESP_ERR_NO_MEM;
+
+    sim_logic_synth_init(&logic.synth, pattern, sample_rate, SIM_LOGIC_SEED);
+    logic.block_len = block_len;
+    logic.sample_rate = sample_rate;
+    logic.start_us = sim_time_us();
+    src->overruns = 0;
+
+    return ESP_OK;
+}
+
+static esp_err_t source_read(logic_source_t * src, const uint8_t ** block, uint32_t timeout_ms)
+{
+    uint64_t now = sim_time_us();
+
+    /*Late: the DMA went round the ring over the blocks not read*/
+    while(block_done_us(logic.blocks + SIM_LOGIC_BUF_CNT) <= now) {
+        sim_logic_synth_fill(&logic.synth, logic.block, logic.block_len);
+        logic.blocks++;
+        stats.overruns++;
+        src->overruns++;
+    }
+
+    uint64_t due = block_done_us(logic.blocks + 1);
+    if(due > now) {
+        if(due - now > (uint64_t) timeout_ms * 1000) {
+            sim_sleep_us((uint64_t) timeout_ms * 1000);
+            return ESP_ERR_TIMEOUT;
+        }
+        sim_sleep_us(due - now);
+    }
+
+    sim_logic_synth_fill(&logic.synth, logic.block, logic.block_len);
+    logic.blocks++;
+    stats.blocks++;
+
+    *block = logic.block;
+    return ESP_OK;
+}
+
+static void source_stop(logic_source_t * src)
+{
+    (void) src;
+
+    free(logic.block);
+    logic.block = NULL;
+}
+
+/**
+ * When a block is complete, counted from 1 since the start
+ */
+static uint64_t block_done_us(uint64_t block)
+{
+    return logic.start_us + block * logic.block_len * 1000000 / logic.sample_rate;
+}
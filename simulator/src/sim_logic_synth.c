@@ -0,0 +1,176 @@
+/**
+ * @file sim_logic_synth.c
+ * Synthetic bitstreams for the logic input capture (components/logic): what
+ * the inputs of the board would see, one byte per sample with channel i in
+ * bit i. Used by the simulated source, sim_logic.c, and by logic_bench.
+ *
+ * The patterns range from what compresses best to what can't be compressed
+ * at all: still inputs, a fast clock, a counter, a UART line, PWM, noise,
+ * and a mix of slower signals which reads well on the screen.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <string.h>
+
+#include "sim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SYNTH_IDLE_LEVEL        0x05
+#define SYNTH_CLOCK_HALF        4           /*Samples per half period of the fast clock*/
+#define SYNTH_COUNTER_STEP      8           /*Samples per count*/
+#define SYNTH_UART_BAUD         115200
+#define SYNTH_UART_GAP_MAX      4           /*Idle bits between two bytes, up to*/
+#define SYNTH_PWM_PERIOD        1000        /*Samples, channel i at period + 250 * i*/
+#define SYNTH_MIX_CLOCK_HZ      1000
+#define SYNTH_MIX_BAUD          9600
+#define SYNTH_MIX_PWM_HZ        2000
+#define SYNTH_MIX_SLOW_HZ       200
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static uint32_t rng_next(uint32_t * state);
+static uint8_t uart_next(sim_logic_uart_t * uart, uint32_t * rng);
+static void uart_init(sim_logic_uart_t * uart, uint32_t sample_rate, uint32_t baud);
+static uint32_t period_samples(uint32_t sample_rate, uint32_t hz);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const char * pattern_names[SIM_LOGIC_PATTERN_MAX] = {
+    "idle", "clock", "counter", "uart", "pwm", "noise", "mix"
+};
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void sim_logic_synth_init(sim_logic_synth_t * synth, sim_logic_pattern_t pattern, uint32_t sample_rate, uint32_t seed)
+{
+    memset(synth, 0, sizeof(*synth));
+    synth->pattern = pattern;
+    synth->sample_rate = sample_rate;
+    synth->rng = seed ? seed : 1;
+
+    uart_init(&synth->uart, sample_rate, pattern == SIM_LOGIC_MIX ? SYNTH_MIX_BAUD : SYNTH_UART_BAUD);
+}
+
+const char * sim_logic_synth_name(sim_logic_pattern_t pattern)
+{
+    return pattern < SIM_LOGIC_PATTERN_MAX ? pattern_names[pattern] : "?";
+}
+
+/**
+ * The next `n` samples of the pattern
+ */
+void sim_logic_synth_fill(sim_logic_synth_t * synth, uint8_t * buf, size_t n)
+{
+    uint64_t t = synth->pos;
+
+    switch(synth->pattern) {
+        case SIM_LOGIC_IDLE:
+            memset(buf, SYNTH_IDLE_LEVEL, n);
+            break;
+        case SIM_LOGIC_CLOCK:
+            for(size_t i = 0; i < n; i++) buf[i] = (uint8_t)((t + i) / SYNTH_CLOCK_HALF & 1);
+            break;
+        case SIM_LOGIC_COUNTER:
+            for(size_t i = 0; i < n; i++) buf[i] = (uint8_t)((t + i) / SYNTH_COUNTER_STEP & 0x0F);
+            break;
+        case SIM_LOGIC_UART:
+            for(size_t i = 0; i < n; i++) buf[i] = uart_next(&synth->uart, &synth->rng);
+            break;
+        case SIM_LOGIC_PWM:
+            /*The duty steps every period: 10 %, 20 %... 90 %*/
+            for(size_t i = 0; i < n; i++) {
+                uint8_t level = 0;
+                for(uint32_t ch = 0; ch < 4; ch++) {
+                    uint32_t period = SYNTH_PWM_PERIOD + 250 * ch;
+                    uint64_t k = (t + i) / period;
+                    uint32_t duty = period * (uint32_t)(1 + k % 9) / 10;
+                    if((t + i) % period < duty) level |= 1 << ch;
+                }
+                buf[i] = level;
+            }
+            break;
+        case SIM_LOGIC_NOISE:
+            for(size_t i = 0; i < n; i++) buf[i] = (uint8_t)(rng_next(&synth->rng) >> 28);
+            break;
+        case SIM_LOGIC_MIX: {
+            uint32_t clock = period_samples(synth->sample_rate, SYNTH_MIX_CLOCK_HZ);
+            uint32_t pwm = period_samples(synth->sample_rate, SYNTH_MIX_PWM_HZ);
+            uint32_t slow = period_samples(synth->sample_rate, SYNTH_MIX_SLOW_HZ);
+            for(size_t i = 0; i < n; i++) {
+                uint64_t s = t + i;
+                uint8_t level = (s % clock) < clock / 2;                                /*CH0: clock*/
+                level |= uart_next(&synth->uart, &synth->rng) << 1;                     /*CH1: UART*/
+                level |= ((s % pwm) < pwm * (1 + s / pwm % 4) / 5) << 2;                /*CH2: PWM*/
+                level |= ((s / slow) % 3 == 0) << 3;                                    /*CH3: slow pulses*/
+                buf[i] = level;
+            }
+            break;
+        }
+        default:
+            memset(buf, 0, n);
+            break;
+    }
+
+    synth->pos += n;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/*xorshift32: the same bits on every host*/
+static uint32_t rng_next(uint32_t * state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void uart_init(sim_logic_uart_t * uart, uint32_t sample_rate, uint32_t baud)
+{
+    uart->bit_len = (sample_rate + baud / 2) / baud;
+    if(uart->bit_len == 0) uart->bit_len = 1;
+    uart->left = 0;
+    uart->bits = 0;
+    uart->count = 0;
+    uart->level = 1;
+}
+
+/**
+ * Level of the next sample of an 8N1 line sending random bytes, a few idle bits apart
+ */
+static uint8_t uart_next(sim_logic_uart_t * uart, uint32_t * rng)
+{
+    if(uart->left == 0) {
+        if(uart->count == 0) {
+            uint32_t r = rng_next(rng);
+            /*LSB first: start bit, 8 data bits, then stop and idle bits*/
+            uart->bits = ((r & 0xFF) << 1) | (0xFFFFFu << 9);
+            uart->count = 10 + (r >> 8) % (SYNTH_UART_GAP_MAX + 1);
+        }
+        uart->level = uart->bits & 1;
+        uart->bits >>= 1;
+        uart->count--;
+        uart->left = uart->bit_len;
+    }
+    uart->left--;
+
+    return uart->level;
+}
+
+static uint32_t period_samples(uint32_t sample_rate, uint32_t hz)
+{
+    uint32_t period = sample_rate / hz;
+    return period > 1 ? period : 2;
+}
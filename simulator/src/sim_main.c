@@ -0,0 +1,242 @@
+/**
+ * @file sim_main.c
+ * Entry point of the host simulator: runs app_main() on the simulated clock
+ * for a fixed time, plays back a keypad script and reports what it cost.
+ *
+ * Usage: waveman_sim [-t duration_ms] [-s keypad_script] [-o frame_dir] [-a] [-b]
+ *                    [-w wav_file] [-c render_us] [-l logic_pattern] [-m mem_trace]
+ *                    [-M mem_dump]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lvgl/lvgl.h"
+#include "esp_system.h"
+#include "sim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SIM_DEFAULT_DURATION_MS     5000
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void usage(const char * prog);
+static int set_logic_pattern(const char * name);
+static void print_stats(void);
+static void print_screen(void);
+static void sample_mem(void);
+#if LV_USE_REFR_PROF
+static void print_prof_line(const char * line);
+#endif
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static uint32_t mem_peak;
+static uint32_t mem_peak_cnt;
+
+/**********************
+ *  GLOBAL PROTOTYPES
+ **********************/
+void app_main(void);
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+int main(int argc, char ** argv)
+{
+    unsigned long duration_ms = SIM_DEFAULT_DURATION_MS;
+    const char * frame_dir = NULL;
+    const char * mem_dump = NULL;
+    bool ascii = false;
+    int opt;
+
+    while((opt = getopt(argc, argv, "t:s:o:abw:c:l:m:M:h")) != -1) {
+        switch(opt) {
+            case 't':
+                duration_ms = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                if(sim_gpio_load_script(optarg) != 0) return EXIT_FAILURE;
+                break;
+            case 'o':
+                frame_dir = optarg;
+                break;
+            case 'a':
+                ascii = true;
+                break;
+            case 'b':
+                sim_gpio_set_bounce(true);
+                break;
+            case 'w':
+                sim_audio_set_wav(optarg);
+                break;
+            case 'c':
+                sim_audio_set_render_cost(strtoull(optarg, NULL, 10));
+                break;
+            case 'l':
+                if(set_logic_pattern(optarg) != 0) return EXIT_FAILURE;
+                break;
+            case 'm':
+                if(sim_mem_trace_open(optarg) != 0) return EXIT_FAILURE;
+                break;
+            case 'M':
+                mem_dump = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    sim_oled_set_frame_dir(frame_dir);
+    sim_rtos_add_yield_hook(sim_oled_commit);
+    sim_rtos_add_yield_hook(sample_mem);
+
+    app_main();
+    sim_rtos_run((uint64_t) duration_ms * 1000);
+    sim_oled_commit();
+    sim_audio_finish();
+    sim_mem_trace_close();
+    if(mem_dump && sim_mem_trace_dump(mem_dump) != 0) return EXIT_FAILURE;
+
+    if(frame_dir) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/last.pbm", frame_dir);
+        sim_oled_write_pbm(path);
+    }
+
+    fflush(stdout);
+    if(ascii) print_screen();
+    print_stats();
+
+    return EXIT_SUCCESS;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void usage(const char * prog)
+{
+    fprintf(stderr, "Usage: %s [-t duration_ms] [-s keypad_script] [-o frame_dir] [-a] [-b]\n"
+                    "          [-w wav_file] [-c render_us] [-l logic_pattern] [-m mem_trace]\n"
+                    "          [-M mem_dump]\n"
+                    "  -t  simulated time to run (default %d ms)\n"
+                    "  -s  keypad script, lines of `<at_ms> <key> [hold_ms]`\n"
+                    "  -o  dump every frame as a PBM image into this directory\n"
+                    "  -a  print the last frame as text\n"
+                    "  -b  let the keys bounce for 1 ms on every edge\n"
+                    "  -w  record the audio output into a WAV file\n"
+                    "  -c  simulated time the audio task spends on each block\n"
+                    "  -l  what the logic inputs see: idle, clock, counter, uart, pwm, noise or mix (default)\n"
+                    "  -m  trace the LittlevGL heap into this file, see src/mem_bench.c\n"
+                    "  -M  dump the lv_mem trace into this file at the end, see src/mem_prof.c\n",
+            prog, SIM_DEFAULT_DURATION_MS);
+}
+
+static int set_logic_pattern(const char * name)
+{
+    for(int p = 0; p < SIM_LOGIC_PATTERN_MAX; p++) {
+        if(strcmp(name, sim_logic_synth_name(p)) == 0) {
+            sim_logic_set_pattern(p);
+            return 0;
+        }
+    }
+
+    fprintf(stderr, "sim: no logic pattern %s\n", name);
+    return -1;
+}
+
+/**
+ * The statistics go to stderr so stdout stays the output of the application.
+ * Everything but the host CPU times is the same from one run to the next.
+ */
+static void print_stats(void)
+{
+    sim_oled_stats_t oled;
+    sim_oled_get_stats(&oled);
+
+    fprintf(stderr, "sim: %llu ms simulated\n", (unsigned long long)(sim_time_us() / 1000));
+    fprintf(stderr, "sim: display: %u frames, %u transactions, %u bytes (%u pixel data), bus busy %llu.%03llu ms\n",
+            oled.frames, oled.transactions, oled.bytes, oled.data_bytes,
+            (unsigned long long)(oled.bus_time_us / 1000), (unsigned long long)(oled.bus_time_us % 1000));
+
+    for(uint32_t i = 0; i < sim_rtos_get_task_cnt(); i++) {
+        sim_task_info_t task;
+        sim_rtos_get_task_info(i, &task);
+        fprintf(stderr, "sim: task %-12s %u switches, host cpu %.3f ms%s\n", task.name, task.switches,
+                task.cpu_ns / 1e6, task.deleted ? " (deleted)" : "");
+        if(oled.frames) {
+            fprintf(stderr, "sim: task %-12s host cpu %.1f us/frame\n", task.name, task.cpu_ns / 1e3 / oled.frames);
+        }
+    }
+
+    sim_audio_stats_t audio;
+    sim_audio_get_stats(&audio);
+    fprintf(stderr, "sim: audio: %u blocks played, %u underruns, latency up to %u us\n",
+            audio.blocks, audio.underruns, audio.latency_us);
+
+    sim_logic_stats_t logic;
+    sim_logic_get_stats(&logic);
+    fprintf(stderr, "sim: logic: %u blocks captured, %u overruns\n", logic.blocks, logic.overruns);
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    fprintf(stderr, "sim: lv_mem: %u of %u bytes used (%u%%) in %u blocks, frag %u%%, biggest free %u\n",
+            (unsigned int)(mon.total_size - mon.free_size), (unsigned int) mon.total_size, mon.used_pct,
+            (unsigned int) mon.used_cnt, mon.frag_pct, (unsigned int) mon.free_biggest_size);
+    fprintf(stderr, "sim: lv_mem: peak %u bytes in %u blocks (sampled once per task switch)\n",
+            (unsigned int) mem_peak, (unsigned int) mem_peak_cnt);
+    fprintf(stderr, "sim: lv_mem: %u bytes of slabs, %u free\n",
+            (unsigned int) mon.slab_size, (unsigned int) mon.slab_free_size);
+    lv_mem_slab_t * slab;
+    for(slab = lv_mem_slab_get_next(NULL); slab != NULL; slab = lv_mem_slab_get_next(slab)) {
+        fprintf(stderr, "sim: lv_mem: slab %-8s %3u of %3u blocks of %3u bytes used, peak %3u, %u times full\n",
+                slab->name, slab->used_cnt, slab->block_cnt, (unsigned int) slab->block_size, slab->used_max,
+                slab->full_cnt);
+    }
+
+#if LV_USE_REFR_PROF
+    /*On the simulated clock drawing takes no time, the flushes take the bus time*/
+    lv_refr_prof_dump(LV_REFR_PROF_FRAME_CNT, print_prof_line);
+#endif
+}
+
+#if LV_USE_REFR_PROF
+static void print_prof_line(const char * line)
+{
+    fprintf(stderr, "sim: refr: %s\n", line);
+}
+#endif
+
+static void sample_mem(void)
+{
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+
+    if(mon.total_size - mon.free_size > mem_peak) {
+        mem_peak = mon.total_size - mon.free_size;
+        mem_peak_cnt = mon.used_cnt;
+    }
+}
+
+static void print_screen(void)
+{
+    for(int y = 0; y < LV_VER_RES_MAX; y++) {
+        char line[LV_HOR_RES_MAX + 2];
+        for(int x = 0; x < LV_HOR_RES_MAX; x++) line[x] = sim_oled_get_px(x, y) ? '#' : '.';
+        line[LV_HOR_RES_MAX] = '\n';
+        line[LV_HOR_RES_MAX + 1] = '\0';
+        fputs(line, stderr);
+    }
+}
@@ -0,0 +1,210 @@
+/**
+ * @file sim_mem_trace.c
+ * Trace of the LittlevGL heap of the simulator: every lv_mem_alloc,
+ * lv_mem_realloc and lv_mem_free the application makes, as a line of text,
+ * for src/mem_bench.c to replay on the allocators of lv_mem.
+ *
+ * The calls from outside lv_mem.c are wrapped at link time (-Wl,--wrap), so
+ * the reallocations lv_mem makes with its own functions are a single line.
+ * An allocation is named by its rank among the allocations of the trace:
+ *
+ *     a <id> <size>       lv_mem_alloc, or lv_mem_realloc of nothing
+ *     r <id> <size>       lv_mem_realloc
+ *     f <id>              lv_mem_free
+ *
+ * Allocations of 0 bytes and those which failed aren't traced, nor the
+ * blocks of the slabs (lv_mem_slab_alloc) and the memory lv_mem takes for them.
+ *
+ * With LV_USE_MEM_TRACE the wrappers pass their caller on to the trace of
+ * lv_mem, which sim_mem_trace_dump() writes for src/mem_prof.c.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lvgl/lvgl.h"
+#include "sim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define TRACE_LIVE_MAX      2048
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    const void * ptr;
+    uint32_t id;
+} trace_live_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void live_add(const void * ptr);
+static trace_live_t * live_find(const void * ptr);
+static void live_del(trace_live_t * live);
+#if LV_USE_MEM_TRACE
+static void dump_write_cb(const void * data, uint32_t size);
+#endif
+
+/**********************
+ *  GLOBAL PROTOTYPES
+ **********************/
+void * __real_lv_mem_alloc(size_t size);
+void * __real_lv_mem_realloc(void * data_p, size_t new_size);
+void __real_lv_mem_free(const void * data);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static FILE * trace_file;
+static FILE * dump_file;
+static trace_live_t live[TRACE_LIVE_MAX];   /*The allocations not freed yet*/
+static uint32_t live_cnt;
+static uint32_t next_id;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Start tracing into a file
+ * @param path path of the trace
+ * @return 0 on success, -1 if the file couldn't be created
+ */
+int sim_mem_trace_open(const char * path)
+{
+    trace_file = fopen(path, "w");
+    if(trace_file == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    fprintf(trace_file, "# lv_mem trace: a <id> <size>, r <id> <size>, f <id>\n");
+    return 0;
+}
+
+void sim_mem_trace_close(void)
+{
+    if(trace_file == NULL) return;
+
+    fclose(trace_file);
+    trace_file = NULL;
+}
+
+/**
+ * Write the trace of lv_mem (LV_USE_MEM_TRACE) into a file
+ * @param path path of the dump
+ * @return 0 on success, -1 if the file couldn't be written or there is no trace
+ */
+int sim_mem_trace_dump(const char * path)
+{
+#if LV_USE_MEM_TRACE
+    dump_file = fopen(path, "wb");
+    if(dump_file == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    lv_mem_trace_dump(dump_write_cb);
+    int res = ferror(dump_file) ? -1 : 0;
+    if(fclose(dump_file) != 0) res = -1;
+    dump_file = NULL;
+    if(res != 0) perror(path);
+
+    return res;
+#else
+    fprintf(stderr, "sim: %s: LV_USE_MEM_TRACE is 0, no trace\n", path);
+    return -1;
+#endif
+}
+
+void * __wrap_lv_mem_alloc(size_t size)
+{
+    LV_MEM_TRACE_SET_CALLER();
+    void * p = __real_lv_mem_alloc(size);
+
+    if(trace_file && p && size) {
+        fprintf(trace_file, "a %u %u\n", next_id, (unsigned int) size);
+        live_add(p);
+    }
+
+    return p;
+}
+
+void * __wrap_lv_mem_realloc(void * data_p, size_t new_size)
+{
+    LV_MEM_TRACE_SET_CALLER();
+    void * p = __real_lv_mem_realloc(data_p, new_size);
+    if(trace_file == NULL || p == NULL || new_size == 0) return p;
+
+    trace_live_t * old = live_find(data_p);
+    if(old) {
+        fprintf(trace_file, "r %u %u\n", old->id, (unsigned int) new_size);
+        old->ptr = p;
+    } else {
+        fprintf(trace_file, "a %u %u\n", next_id, (unsigned int) new_size);
+        live_add(p);
+    }
+
+    return p;
+}
+
+void __wrap_lv_mem_free(const void * data)
+{
+    if(trace_file) {
+        trace_live_t * l = live_find(data);
+        if(l) {
+            fprintf(trace_file, "f %u\n", l->id);
+            live_del(l);
+        }
+    }
+
+    LV_MEM_TRACE_SET_CALLER();
+    __real_lv_mem_free(data);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void live_add(const void * ptr)
+{
+    if(live_cnt == TRACE_LIVE_MAX) {
+        fprintf(stderr, "sim: lv_mem trace: more than %d allocations, the trace stops\n", TRACE_LIVE_MAX);
+        sim_mem_trace_close();
+        return;
+    }
+
+    live[live_cnt].ptr = ptr;
+    live[live_cnt].id = next_id++;
+    live_cnt++;
+}
+
+/*From the last one: what was just allocated is often freed first*/
+static trace_live_t * live_find(const void * ptr)
+{
+    if(ptr == NULL) return NULL;
+
+    for(uint32_t i = live_cnt; i > 0; i--) {
+        if(live[i - 1].ptr == ptr) return &live[i - 1];
+    }
+
+    return NULL;
+}
+
+static void live_del(trace_live_t * l)
+{
+    *l = live[--live_cnt];
+}
+
+#if LV_USE_MEM_TRACE
+static void dump_write_cb(const void * data, uint32_t size)
+{
+    fwrite(data, 1, size, dump_file);
+}
+#endif
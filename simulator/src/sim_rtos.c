@@ -0,0 +1,627 @@
+/**
+ * @file sim_rtos.c
+ * Cooperative FreeRTOS and esp_timer stand-in running on a simulated clock.
+ *
+ * Every task gets its own ucontext stack. A task runs until it blocks
+ * (vTaskDelay, a semaphore or notification wait or a simulated bus transfer), then the
+ * scheduler advances the clock to the next wake up, firing the esp_timer
+ * callbacks on the way. Computation takes no simulated time, so a run with
+ * the same keypad script always produces the same frames; the host CPU time
+ * of each task is measured separately. The tick hooks run on every tick
+ * the clock passes while no task runs: the CPU is idle at every tick.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_freertos_hooks.h"
+#include "sim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SIM_TASK_MAX        16
+#define SIM_TIMER_MAX       16
+#define SIM_YIELD_HOOK_MAX  4
+#define SIM_TICK_HOOK_MAX   4
+#define SIM_STACK_MIN       (64 * 1024)     /*Host frames are bigger than Xtensa ones*/
+#define SIM_TICK_US         (1000000ULL / CONFIG_FREERTOS_HZ)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+struct sim_task {
+    ucontext_t ctx;
+    void * stack;
+    TaskFunction_t code;
+    void * arg;
+    const char * name;
+    UBaseType_t priority;
+    uint64_t wake_us;
+    uint64_t cpu_ns;
+    uint32_t notify_cnt;
+    bool notify_waiting;
+    uint32_t switches;
+    uint32_t id;
+    bool deleted;
+};
+
+struct sim_timer {
+    esp_timer_cb_t callback;
+    void * arg;
+    uint64_t period_us;
+    uint64_t expiry_us;
+    bool active;
+};
+
+struct sim_semaphore {
+    UBaseType_t count;
+    UBaseType_t max_count;
+};
+
+struct sim_queue {
+    uint8_t * items;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void task_entry(void);
+static void task_block_until(uint64_t wake_us);
+static void call_yield_hooks(void);
+static void clock_advance(uint64_t to_us);
+static uint32_t notify_take(BaseType_t clear_on_exit, uint64_t timeout_us);
+static struct sim_task * next_task(void);
+static struct sim_timer * next_timer(void);
+static uint64_t thread_cpu_ns(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static struct sim_task tasks[SIM_TASK_MAX];
+static uint32_t task_cnt;
+static struct sim_task * cur_task;
+static ucontext_t sched_ctx;
+
+static struct sim_timer timers[SIM_TIMER_MAX];
+static uint32_t timer_cnt;
+
+static void (*yield_hooks[SIM_YIELD_HOOK_MAX])(void);
+static uint32_t yield_hook_cnt;
+
+static esp_freertos_tick_cb_t tick_hooks[SIM_TICK_HOOK_MAX];
+static uint32_t tick_hook_cnt;
+static struct sim_task idle_task = {.name = "IDLE"};     /*Runs whenever the clock moves*/
+
+static uint64_t now_us;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+uint64_t sim_time_us(void)
+{
+    return now_us;
+}
+
+/**
+ * Block the calling task for `us` of simulated time, e.g. for a bus transfer.
+ * Outside of a task (before the scheduler runs) the clock simply moves on.
+ */
+void sim_sleep_us(uint64_t us)
+{
+    if(cur_task == NULL) {
+        clock_advance(now_us + us);
+        return;
+    }
+    task_block_until(now_us + us);
+}
+
+/**
+ * Run the tasks and timers until the simulated clock reaches `until_us`
+ * or no task is left.
+ */
+void sim_rtos_run(uint64_t until_us)
+{
+    while(1) {
+        struct sim_task * task = next_task();
+        if(task == NULL) break;
+
+        /*Timers due before the task wakes up fire first. A callback can wake
+         *a task with a notification, so pick the next task again after each*/
+        struct sim_timer * timer = next_timer();
+        if(timer != NULL && timer->expiry_us <= task->wake_us) {
+            if(timer->expiry_us >= until_us) break;
+            clock_advance(timer->expiry_us);
+            if(timer->period_us) timer->expiry_us += timer->period_us;
+            else timer->active = false;
+            timer->callback(timer->arg);
+            continue;
+        }
+
+        if(task->wake_us >= until_us) break;
+        if(task->wake_us > now_us) clock_advance(task->wake_us);
+
+        cur_task = task;
+        task->switches++;
+        uint64_t start_ns = thread_cpu_ns();
+        swapcontext(&sched_ctx, &task->ctx);
+        task->cpu_ns += thread_cpu_ns() - start_ns;
+        cur_task = NULL;
+
+        if(task->deleted && task->stack) {
+            free(task->stack);
+            task->stack = NULL;
+        }
+    }
+
+    if(now_us < until_us) clock_advance(until_us);
+}
+
+/**
+ * Register a function called every time a task gives up the CPU with vTaskDelay
+ * or ulTaskNotifyTake.
+ * The display model uses it to tell one refresh from the next.
+ */
+void sim_rtos_add_yield_hook(void (*hook)(void))
+{
+    if(yield_hook_cnt < SIM_YIELD_HOOK_MAX) yield_hooks[yield_hook_cnt++] = hook;
+}
+
+uint32_t sim_rtos_get_task_cnt(void)
+{
+    return task_cnt;
+}
+
+bool sim_rtos_get_task_info(uint32_t id, sim_task_info_t * info)
+{
+    if(id >= task_cnt) return false;
+
+    info->name = tasks[id].name;
+    info->cpu_ns = tasks[id].cpu_ns;
+    info->switches = tasks[id].switches;
+    info->deleted = tasks[id].deleted;
+    return true;
+}
+
+/*=====================
+ * FreeRTOS task API
+ *====================*/
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task_code, const char * name, uint32_t stack_depth,
+                                   void * arg, UBaseType_t priority, TaskHandle_t * created_task,
+                                   BaseType_t core_id)
+{
+    (void) core_id;
+
+    if(task_cnt >= SIM_TASK_MAX) return pdFAIL;
+
+    struct sim_task * task = &tasks[task_cnt];
+    size_t stack_size = stack_depth * 4 < SIM_STACK_MIN ? SIM_STACK_MIN : stack_depth * 4;
+
+    memset(task, 0, sizeof(struct sim_task));
+    task->stack = malloc(stack_size);
+    if(task->stack == NULL) return pdFAIL;
+
+    task->code = task_code;
+    task->arg = arg;
+    task->name = name;
+    task->priority = priority;
+    task->wake_us = now_us;
+    task->id = task_cnt;
+
+    getcontext(&task->ctx);
+    task->ctx.uc_stack.ss_sp = task->stack;
+    task->ctx.uc_stack.ss_size = stack_size;
+    task->ctx.uc_link = &sched_ctx;
+    makecontext(&task->ctx, task_entry, 0);
+
+    task_cnt++;
+    if(created_task) *created_task = task;
+
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task_code, const char * name, uint32_t stack_depth,
+                       void * arg, UBaseType_t priority, TaskHandle_t * created_task)
+{
+    return xTaskCreatePinnedToCore(task_code, name, stack_depth, arg, priority, created_task, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if(task == NULL) task = cur_task;
+    if(task == NULL) return;
+
+    task->deleted = true;
+    if(task == cur_task) swapcontext(&task->ctx, &sched_ctx);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    call_yield_hooks();
+
+    sim_sleep_us((uint64_t) ticks * SIM_TICK_US);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    if(cur_task == NULL) return 0;
+
+    call_yield_hooks();
+
+    return notify_take(clear_on_exit, ticks_to_wait == portMAX_DELAY ? UINT64_MAX : now_us + ticks_to_wait * SIM_TICK_US);
+}
+
+/**
+ * ulTaskNotifyTake(pdTRUE, portMAX_DELAY) for the simulated peripherals: it
+ * waits like a driver blocked on its interrupt, without the yield hooks
+ * which would take the wait for the end of a display refresh.
+ */
+uint32_t sim_rtos_notify_wait(void)
+{
+    if(cur_task == NULL) return 0;
+
+    return notify_take(pdTRUE, UINT64_MAX);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    task->notify_cnt++;
+
+    /*Wake it now; the running task goes on until it blocks, like on the other core*/
+    if(task->notify_waiting && task->wake_us > now_us) task->wake_us = now_us;
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t * higher_prio_task_woken)
+{
+    xTaskNotifyGive(task);
+    if(higher_prio_task_woken) *higher_prio_task_woken = pdFALSE;
+}
+
+/**
+ * Timer callbacks run from the scheduler, outside of any task: treat them as interrupts
+ */
+BaseType_t xPortInIsrContext(void)
+{
+    return cur_task == NULL;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(now_us / SIM_TICK_US);
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return cur_task;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandleForCPU(BaseType_t cpuid)
+{
+    (void) cpuid;
+
+    return cur_task ? cur_task : &idle_task;
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t cpuid)
+{
+    (void) cpuid;
+
+    return &idle_task;
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    return 0;
+}
+
+esp_err_t esp_register_freertos_tick_hook_for_cpu(esp_freertos_tick_cb_t new_tick_cb, UBaseType_t cpuid)
+{
+    if(cpuid >= portNUM_PROCESSORS) return ESP_ERR_INVALID_ARG;
+    if(tick_hook_cnt >= SIM_TICK_HOOK_MAX) return ESP_ERR_NO_MEM;
+
+    tick_hooks[tick_hook_cnt++] = new_tick_cb;
+    return ESP_OK;
+}
+
+/*=====================
+ * Semaphores
+ *====================*/
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    struct sim_semaphore * sem = malloc(sizeof(struct sim_semaphore));
+    if(sem == NULL) return NULL;
+
+    sem->count = initial_count;
+    sem->max_count = max_count;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait)
+{
+    uint64_t timeout_us = ticks_to_wait == portMAX_DELAY ? UINT64_MAX : now_us + ticks_to_wait * SIM_TICK_US;
+
+    /*Nothing preempts the running task, so poll the count once per tick*/
+    while(sem->count == 0) {
+        if(now_us >= timeout_us) return pdFALSE;
+        sim_sleep_us(SIM_TICK_US);
+    }
+
+    sem->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    if(sem->count >= sem->max_count) return pdFALSE;
+
+    sem->count++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t * higher_prio_task_woken)
+{
+    if(higher_prio_task_woken) *higher_prio_task_woken = pdFALSE;
+    return xSemaphoreGive(sem);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    free(sem);
+}
+
+/*=====================
+ * Queues
+ *====================*/
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct sim_queue * queue = calloc(1, sizeof(struct sim_queue));
+    if(queue == NULL) return NULL;
+
+    queue->items = malloc((size_t) length * item_size);
+    if(queue->items == NULL) {
+        free(queue);
+        return NULL;
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void * item, TickType_t ticks_to_wait)
+{
+    uint64_t timeout_us = ticks_to_wait == portMAX_DELAY ? UINT64_MAX : now_us + ticks_to_wait * SIM_TICK_US;
+
+    /*Polled once per tick like the semaphores*/
+    while(queue->count >= queue->length) {
+        if(now_us >= timeout_us || cur_task == NULL) return pdFALSE;
+        sim_sleep_us(SIM_TICK_US);
+    }
+
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(&queue->items[tail * queue->item_size], item, queue->item_size);
+    queue->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendToBackFromISR(QueueHandle_t queue, const void * item, BaseType_t * higher_prio_task_woken)
+{
+    if(higher_prio_task_woken) *higher_prio_task_woken = pdFALSE;
+    return xQueueSendToBack(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void * buf, TickType_t ticks_to_wait)
+{
+    uint64_t timeout_us = ticks_to_wait == portMAX_DELAY ? UINT64_MAX : now_us + ticks_to_wait * SIM_TICK_US;
+
+    while(queue->count == 0) {
+        if(now_us >= timeout_us || cur_task == NULL) return pdFALSE;
+        sim_sleep_us(SIM_TICK_US);
+    }
+
+    memcpy(buf, &queue->items[queue->head * queue->item_size], queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->count;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    free(queue->items);
+    free(queue);
+}
+
+/*=====================
+ * esp_timer
+ *====================*/
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t * create_args, esp_timer_handle_t * out_handle)
+{
+    if(create_args == NULL || create_args->callback == NULL || out_handle == NULL) return ESP_ERR_INVALID_ARG;
+    if(timer_cnt >= SIM_TIMER_MAX) return ESP_ERR_NO_MEM;
+
+    struct sim_timer * timer = &timers[timer_cnt++];
+    memset(timer, 0, sizeof(struct sim_timer));
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    if(timer->active) return ESP_ERR_INVALID_STATE;
+
+    timer->period_us = period;
+    timer->expiry_us = now_us + period;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    if(timer->active) return ESP_ERR_INVALID_STATE;
+
+    timer->period_us = 0;
+    timer->expiry_us = now_us + timeout_us;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if(!timer->active) return ESP_ERR_INVALID_STATE;
+
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if(timer->active) return ESP_ERR_INVALID_STATE;
+
+    timer->callback = NULL;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t) now_us;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void task_entry(void)
+{
+    cur_task->code(cur_task->arg);
+
+    /*A FreeRTOS task must not return, but don't take the simulator down with it*/
+    fprintf(stderr, "sim: task \"%s\" returned\n", cur_task->name);
+    cur_task->deleted = true;
+}
+
+static void task_block_until(uint64_t wake_us)
+{
+    struct sim_task * task = cur_task;
+
+    task->wake_us = wake_us;
+    swapcontext(&task->ctx, &sched_ctx);
+}
+
+/**
+ * The task to run next: the earliest wake up, then the highest priority,
+ * then the oldest task.
+ */
+static void call_yield_hooks(void)
+{
+    for(uint32_t i = 0; i < yield_hook_cnt; i++) yield_hooks[i]();
+}
+
+/**
+ * Move the clock forward, through the tick interrupts on the way
+ */
+static void clock_advance(uint64_t to_us)
+{
+    for(uint64_t tick = now_us / SIM_TICK_US + 1; tick * SIM_TICK_US <= to_us; tick++) {
+        now_us = tick * SIM_TICK_US;
+        for(uint32_t i = 0; i < tick_hook_cnt; i++) tick_hooks[i]();
+    }
+    now_us = to_us;
+}
+
+static uint32_t notify_take(BaseType_t clear_on_exit, uint64_t timeout_us)
+{
+    struct sim_task * task = cur_task;
+
+    if(task->notify_cnt == 0 && timeout_us > now_us) {
+        task->notify_waiting = true;
+        task_block_until(timeout_us);
+        task->notify_waiting = false;
+    }
+
+    uint32_t cnt = task->notify_cnt;
+    if(clear_on_exit) task->notify_cnt = 0;
+    else if(cnt) task->notify_cnt--;
+
+    return cnt;
+}
+
+static struct sim_task * next_task(void)
+{
+    struct sim_task * best = NULL;
+
+    for(uint32_t i = 0; i < task_cnt; i++) {
+        struct sim_task * task = &tasks[i];
+        if(task->deleted) continue;
+
+        if(best == NULL || task->wake_us < best->wake_us ||
+           (task->wake_us == best->wake_us && task->priority > best->priority)) {
+            best = task;
+        }
+    }
+
+    return best;
+}
+
+static struct sim_timer * next_timer(void)
+{
+    struct sim_timer * best = NULL;
+
+    for(uint32_t i = 0; i < timer_cnt; i++) {
+        struct sim_timer * timer = &timers[i];
+        if(!timer->active || timer->callback == NULL) continue;
+        if(best == NULL || timer->expiry_us < best->expiry_us) best = timer;
+    }
+
+    return best;
+}
+
+static uint64_t thread_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
@@ -0,0 +1,242 @@
+/**
+ * @file sim_spi.c
+ * SPI master stand-in clocking the transactions out on the simulated clock.
+ *
+ * A device sends its transactions one after the other, each one starting
+ * when the bus is free and taking its bits at the clock of the device plus
+ * the set up of the transfer. Nothing is on the other end: only the time of
+ * the bus and the callbacks are simulated.
+ *
+ * The time is worked out when a transaction is queued; pre_cb and post_cb
+ * run as the clock passes its start and its end, which happens when the
+ * caller waits for a result, or lets time go by with sim_spi_sleep_us() or
+ * sim_spi_run_next(). Like on the ESP32, post_cb is the interrupt of the
+ * end of the transfer: the caller doesn't run while it does.
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/spi_master.h"
+#include "sim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SIM_SPI_QUEUE_MAX   32
+#define SIM_SPI_SETUP_US    2       /*Set up of the registers and of the DMA descriptors per transaction*/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    spi_transaction_t * trans;
+    uint64_t start_us;
+    uint64_t end_us;
+    bool started;
+    bool done;
+} sim_spi_slot_t;
+
+struct spi_device_t {
+    spi_device_interface_config_t cfg;
+    sim_spi_slot_t slots[SIM_SPI_QUEUE_MAX];    /*Ring of the transactions not returned yet*/
+    uint32_t head;
+    uint32_t cnt;
+};
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static sim_spi_slot_t * next_event(uint64_t * at_us);
+static void run_until(uint64_t until_us);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static struct spi_device_t * device;    /*The display is alone on its bus*/
+static uint64_t bus_free_us;
+static sim_spi_stats_t stats;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Let `us` of simulated time go by with the bus running: the transactions
+ * starting and ending meanwhile call their callbacks
+ */
+void sim_spi_sleep_us(uint64_t us)
+{
+    run_until(sim_time_us() + us);
+}
+
+/**
+ * Move the clock to the next start or end of a transaction and call its callback
+ * @return false if the bus has nothing left to do
+ */
+bool sim_spi_run_next(void)
+{
+    uint64_t at_us;
+    if(next_event(&at_us) == NULL) return false;
+
+    run_until(at_us);
+    return true;
+}
+
+/**
+ * The bus statistics, the time it was busy up to the current time
+ */
+void sim_spi_get_stats(sim_spi_stats_t * out)
+{
+    uint64_t now = sim_time_us();
+
+    *out = stats;
+    for(uint32_t i = 0; device && i < device->cnt; i++) {
+        const sim_spi_slot_t * slot = &device->slots[(device->head + i) % SIM_SPI_QUEUE_MAX];
+        if(slot->done || slot->start_us >= now) continue;
+        out->busy_us += (slot->end_us < now ? slot->end_us : now) - slot->start_us;
+    }
+}
+
+/*=====================
+ * SPI master driver API
+ *====================*/
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t * bus_config, int dma_chan)
+{
+    (void) host;
+    (void) dma_chan;
+
+    return bus_config ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t * dev_config,
+                             spi_device_handle_t * handle)
+{
+    (void) host;
+
+    if(dev_config == NULL || handle == NULL || dev_config->clock_speed_hz <= 0) return ESP_ERR_INVALID_ARG;
+    if(dev_config->queue_size < 1 || dev_config->queue_size > SIM_SPI_QUEUE_MAX) return ESP_ERR_INVALID_ARG;
+    if(device) return ESP_ERR_NO_MEM;
+
+    device = calloc(1, sizeof(struct spi_device_t));
+    if(device == NULL) return ESP_ERR_NO_MEM;
+
+    device->cfg = *dev_config;
+    *handle = device;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t * trans_desc, TickType_t ticks_to_wait)
+{
+    (void) ticks_to_wait;
+
+    if(handle != device || trans_desc == NULL) return ESP_ERR_INVALID_ARG;
+
+    /*Only spi_device_get_trans_result() makes room: waiting here would never end*/
+    if(handle->cnt == (uint32_t) handle->cfg.queue_size) {
+        fprintf(stderr, "sim: spi: queue of %d transactions full\n", handle->cfg.queue_size);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    uint64_t now = sim_time_us();
+    uint64_t bits = trans_desc->length;
+    sim_spi_slot_t * slot = &handle->slots[(handle->head + handle->cnt) % SIM_SPI_QUEUE_MAX];
+
+    memset(slot, 0, sizeof(sim_spi_slot_t));
+    slot->trans = trans_desc;
+    slot->start_us = bus_free_us > now ? bus_free_us : now;
+    slot->end_us = slot->start_us + SIM_SPI_SETUP_US +
+                   (bits * 1000000 + handle->cfg.clock_speed_hz - 1) / handle->cfg.clock_speed_hz;
+    bus_free_us = slot->end_us;
+    handle->cnt++;
+
+    stats.transactions++;
+    stats.bytes += (bits + 7) / 8;
+
+    /*Started at once on a free bus*/
+    run_until(now);
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t ** trans_desc,
+                                      TickType_t ticks_to_wait)
+{
+    (void) ticks_to_wait;
+
+    if(handle != device || trans_desc == NULL) return ESP_ERR_INVALID_ARG;
+    if(handle->cnt == 0) return ESP_ERR_TIMEOUT;
+
+    sim_spi_slot_t * slot = &handle->slots[handle->head];
+    if(!slot->done) run_until(slot->end_us);
+
+    *trans_desc = slot->trans;
+    handle->head = (handle->head + 1) % SIM_SPI_QUEUE_MAX;
+    handle->cnt--;
+    return ESP_OK;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t * trans_desc)
+{
+    spi_transaction_t * done;
+
+    esp_err_t res = spi_device_queue_trans(handle, trans_desc, portMAX_DELAY);
+    if(res != ESP_OK) return res;
+
+    /*The transactions queued before come back first*/
+    do {
+        res = spi_device_get_trans_result(handle, &done, portMAX_DELAY);
+    } while(res == ESP_OK && done != trans_desc);
+
+    return res;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * The slot of the next start or end on the bus
+ */
+static sim_spi_slot_t * next_event(uint64_t * at_us)
+{
+    for(uint32_t i = 0; device && i < device->cnt; i++) {
+        sim_spi_slot_t * slot = &device->slots[(device->head + i) % SIM_SPI_QUEUE_MAX];
+        if(slot->done) continue;
+
+        *at_us = slot->started ? slot->end_us : slot->start_us;
+        return slot;
+    }
+
+    return NULL;
+}
+
+/**
+ * Run the bus up to `until_us`, the callbacks called in time order
+ */
+static void run_until(uint64_t until_us)
+{
+    uint64_t at_us;
+    sim_spi_slot_t * slot;
+
+    while((slot = next_event(&at_us)) != NULL && at_us <= until_us) {
+        uint64_t now = sim_time_us();
+        if(at_us > now) sim_sleep_us(at_us - now);
+
+        if(!slot->started) {
+            slot->started = true;
+            if(device->cfg.pre_cb) device->cfg.pre_cb(slot->trans);
+        } else {
+            slot->done = true;
+            stats.busy_us += slot->end_us - slot->start_us;
+            if(device->cfg.post_cb) device->cfg.post_cb(slot->trans);
+        }
+    }
+
+    uint64_t now = sim_time_us();
+    if(until_us > now) sim_sleep_us(until_us - now);
+}